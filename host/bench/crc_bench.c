@@ -0,0 +1,145 @@
+/******************************************************************************************************************************
+ File Name      : crc_bench.c
+ Description    : Host benchmark for the checksum/CRC module: verifies the check values, then reports MB/s per algorithm
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
+
+#define BENCH_BYTES_PER_RUN (64u * 1024u * 1024u)  // Bytes hashed per algorithm and block size
+
+/* Reference: the byte loop calculate_fcc() used before the word-at-a-time version.
+ * Kept scalar so the numbers reflect a core without SIMD, like the LX7; the host compiler would vectorise it. */
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((optimize("no-tree-vectorize")))
+#endif
+static tbyte fcc_bytewise(const tbyte *data, size_t length) {
+    uint16_t sum = 0;
+    for (size_t i = 0; i < length; ++i) {
+        sum += data[i];
+    }
+    return (tbyte)(~sum + 1);
+}
+
+static tlong crc32_bitwise(tlong crc, const tbyte *data, size_t length) {
+    crc = ~crc;
+    while (length-- > 0) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static volatile tlong sink;
+
+typedef tlong (*t_bench_fn)(const tbyte *data, size_t length);
+
+static tlong run_fcc_bytewise(const tbyte *d, size_t n) { return fcc_bytewise(d, n); }
+static tlong run_fcc(const tbyte *d, size_t n)          { return CRC_FCC_Calculate(d, n); }
+static tlong run_crc8(const tbyte *d, size_t n)         { return CRC8_Update(CRC8_INIT, d, n); }
+static tlong run_crc16(const tbyte *d, size_t n)        { return CRC16_CCITT_Update(CRC16_CCITT_INIT, d, n); }
+static tlong run_crc32(const tbyte *d, size_t n)        { return CRC32_Update(CRC32_INIT, d, n); }
+static tlong run_crc32_bitwise(const tbyte *d, size_t n) { return crc32_bitwise(CRC32_INIT, d, n); }
+
+static int check(const char *name, tlong got, tlong expected) {
+    if (got != expected) {
+        printf("FAIL %-20s got 0x%08lX expected 0x%08lX\n", name, (unsigned long)got, (unsigned long)expected);
+        return 1;
+    }
+    return 0;
+}
+
+static int self_test(const tbyte *random, size_t length) {
+    static const tbyte vector[] = "123456789";
+    int failures = 0;
+
+    failures += check("sum8", CRC_Sum8_Update(CRC_SUM8_INIT, vector, 9), 0xDD);
+    failures += check("fcc", CRC_FCC_Calculate(vector, 9), 0x23);
+    failures += check("crc8", CRC8_Update(CRC8_INIT, vector, 9), 0xF4);
+    failures += check("crc16-ccitt", CRC16_CCITT_Update(CRC16_CCITT_INIT, vector, 9), 0x29B1);
+    failures += check("crc32", CRC32_Update(CRC32_INIT, vector, 9), 0xCBF43926);
+
+    // Every length and misalignment against the reference, and streaming split at every point
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t n = 0; n < 600 && offset + n <= length; n++) {
+            const tbyte *p = random + offset;
+            failures += check("fcc vs byte loop", CRC_FCC_Calculate(p, n), fcc_bytewise(p, n));
+            failures += check("crc32 vs bitwise", CRC32_Update(CRC32_INIT, p, n), crc32_bitwise(CRC32_INIT, p, n));
+        }
+    }
+    for (size_t split = 0; split <= 300; split++) {
+        failures += check("sum8 streaming", CRC_Sum8_Update(CRC_Sum8_Update(CRC_SUM8_INIT, random, split), random + split, 300 - split),
+                          CRC_Sum8_Update(CRC_SUM8_INIT, random, 300));
+        failures += check("crc8 streaming", CRC8_Update(CRC8_Update(CRC8_INIT, random, split), random + split, 300 - split),
+                          CRC8_Update(CRC8_INIT, random, 300));
+        failures += check("crc16 streaming", CRC16_CCITT_Update(CRC16_CCITT_Update(CRC16_CCITT_INIT, random, split), random + split, 300 - split),
+                          CRC16_CCITT_Update(CRC16_CCITT_INIT, random, 300));
+        failures += check("crc32 streaming", CRC32_Update(CRC32_Update(CRC32_INIT, random, split), random + split, 300 - split),
+                          CRC32_Update(CRC32_INIT, random, 300));
+    }
+    return failures;
+}
+
+int main(void) {
+    static const struct { const char *name; t_bench_fn fn; } algorithms[] = {
+        { "fcc (byte loop)",   run_fcc_bytewise },
+        { "fcc (word)",        run_fcc },
+        { "crc8 (slice-8)",    run_crc8 },
+        { "crc16 (slice-8)",   run_crc16 },
+        { "crc32 (bitwise)",   run_crc32_bitwise },
+        { "crc32 (slice-8)",   run_crc32 },
+    };
+    static const size_t block_sizes[] = { 16, 64, 256, 4096 };
+    size_t buffer_size = 4096 + 8;
+    tbyte *buffer = malloc(buffer_size);
+
+    if (buffer == NULL) {
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < buffer_size; i++) {
+        buffer[i] = (tbyte)rand();
+    }
+    CRC_Init();
+
+    int failures = self_test(buffer, buffer_size);
+    printf("self-test: %s\n\n", failures == 0 ? "ok" : "FAILED");
+
+    printf("%-18s", "MB/s");
+    for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++) {
+        printf("%10zu B", block_sizes[b]);
+    }
+    printf("\n");
+    for (size_t a = 0; a < sizeof(algorithms) / sizeof(algorithms[0]); a++) {
+        printf("%-18s", algorithms[a].name);
+        for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++) {
+            size_t block = block_sizes[b];
+            size_t runs = BENCH_BYTES_PER_RUN / block;
+            // The bitwise CRC is ~50x slower; hash less so the table still prints quickly
+            if (algorithms[a].fn == run_crc32_bitwise) {
+                runs /= 16;
+            }
+            double start = now_s();
+            for (size_t r = 0; r < runs; r++) {
+                sink += algorithms[a].fn(buffer + (r & 7), block);
+            }
+            double elapsed = now_s() - start;
+            printf("%12.1f", (double)(runs * block) / elapsed / 1e6);
+        }
+        printf("\n");
+    }
+
+    free(buffer);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/******************************************************************************************************************************
+ File Name      : lz_bench.c
+ Description    : Host benchmark for the LZ codec: round-trip self-test, then ratio and encode/decode MB/s per data set
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "LZ/MCAL_ESP32_S2_SOLO_2_N4R2_LZ.h"
+
+#define BENCH_BYTES_PER_RUN (32u * 1024u * 1024u)  // Bytes encoded and decoded per data set
+#define BENCH_MAX_SAMPLE    4096u
+
+typedef struct {
+    const char *name;
+    tbyte data[BENCH_MAX_SAMPLE];
+    size_t length;
+} t_sample;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static volatile size_t sink;
+
+/* A device config the way the application stores it: NVS_Write_String() of a cJSON print */
+static void make_json(t_sample *sample) {
+    size_t used = (size_t)snprintf((char *)sample->data, sizeof(sample->data),
+                                   "{\"device\":\"esp32s2-node-07\",\"fw\":\"1.4.2\",\"wifi\":{\"ssid\":\"plant-floor\","
+                                   "\"retry_ms\":500,\"max_retries\":8},\"channels\":[");
+    for (int i = 0; i < 16; i++) {
+        used += (size_t)snprintf((char *)sample->data + used, sizeof(sample->data) - used,
+                                 "%s{\"id\":%d,\"name\":\"adc_ch%d\",\"enabled\":%s,\"gain\":%d,\"offset\":%d,"
+                                 "\"unit\":\"mV\",\"period_ms\":%d}",
+                                 i > 0 ? "," : "", i, i, i % 3 ? "true" : "false", 1 << (i % 4), i * 7 - 40, 100 * (1 + i % 5));
+    }
+    used += (size_t)snprintf((char *)sample->data + used, sizeof(sample->data) - used, "]}");
+    sample->name = "json config";
+    sample->length = used + 1;
+}
+
+/* A calibration curve as NVS_Write_Array() stores it: tsword samples of a smooth, quantised function */
+static void make_table(t_sample *sample) {
+    tsword *table = (tsword *)sample->data;
+    size_t count = 1024;
+    for (size_t i = 0; i < count; i++) {
+        table[i] = (tsword)((i * i) / 256 / 8 * 8);
+    }
+    sample->name = "tsword lookup table";
+    sample->length = count * sizeof(tsword);
+}
+
+static void make_random(t_sample *sample) {
+    for (size_t i = 0; i < 2048; i++) {
+        sample->data[i] = (tbyte)rand();
+    }
+    sample->name = "random";
+    sample->length = 2048;
+}
+
+static int round_trip(const tbyte *data, size_t length, tbyte *packed, tbyte *unpacked) {
+    size_t compressed = LZ_Compress(data, length, packed, LZ_BOUND(length), NULL);
+    if (length > 0 && compressed == 0) {
+        return 1;
+    }
+    if (length == 0) {
+        return compressed != 0;
+    }
+    size_t restored = LZ_Decompress(packed, compressed, unpacked, length);
+    return restored != length || memcmp(unpacked, data, length) != 0;
+}
+
+static int self_test(tbyte *scratch, size_t size) {
+    tbyte *packed = malloc(LZ_BOUND(size));
+    tbyte *unpacked = malloc(size);
+    int failures = 0;
+
+    // Every length of random, run-length and short-period data
+    for (size_t n = 0; n <= 600; n++) {
+        for (size_t i = 0; i < n; i++) {
+            scratch[i] = (tbyte)rand();
+        }
+        failures += round_trip(scratch, n, packed, unpacked);
+        memset(scratch, 'a', n);
+        failures += round_trip(scratch, n, packed, unpacked);
+        for (size_t i = 0; i < n; i++) {
+            scratch[i] = (tbyte)"abc"[i % 3];
+        }
+        failures += round_trip(scratch, n, packed, unpacked);
+    }
+    // Long literal runs and long matches need extension bytes
+    for (size_t i = 0; i < size; i++) {
+        scratch[i] = i < size / 2 ? (tbyte)rand() : 0;
+    }
+    failures += round_trip(scratch, size, packed, unpacked);
+
+    // Too-small output must fail cleanly, and corrupt blocks must never write past capacity
+    memset(scratch, 'x', 1000);
+    size_t compressed = LZ_Compress(scratch, 1000, packed, LZ_BOUND(1000), NULL);
+    failures += LZ_Compress(scratch, 1000, packed, compressed - 1, NULL) != 0;
+    failures += LZ_Decompress(packed, compressed, unpacked, 999) != 0;
+    for (int trial = 0; trial < 20000; trial++) {
+        size_t n = 1 + (size_t)rand() % 64;
+        for (size_t i = 0; i < n; i++) {
+            packed[i] = (tbyte)rand();
+        }
+        unpacked[256] = 0xA5;
+        LZ_Decompress(packed, n, unpacked, 256);
+        failures += unpacked[256] != 0xA5;
+    }
+
+    if (failures > 0) {
+        printf("FAIL %d round trips\n", failures);
+    }
+    free(packed);
+    free(unpacked);
+    return failures;
+}
+
+int main(void) {
+    static t_sample samples[3];
+    size_t scratch_size = LZ_MAX_INPUT;
+    tbyte *scratch = malloc(scratch_size);
+    tbyte *packed = malloc(LZ_BOUND(BENCH_MAX_SAMPLE));
+    tbyte *unpacked = malloc(BENCH_MAX_SAMPLE);
+    static tword work[LZ_HASH_SIZE];
+
+    if (scratch == NULL || packed == NULL || unpacked == NULL) {
+        return 1;
+    }
+    srand(1);
+    int failures = self_test(scratch, scratch_size);
+    printf("self-test: %s\n\n", failures == 0 ? "ok" : "FAILED");
+
+    make_json(&samples[0]);
+    make_table(&samples[1]);
+    make_random(&samples[2]);
+    printf("%-22s%8s%10s%8s%14s%14s\n", "data", "bytes", "packed", "ratio", "encode MB/s", "decode MB/s");
+    for (size_t s = 0; s < sizeof(samples) / sizeof(samples[0]); s++) {
+        const t_sample *sample = &samples[s];
+        size_t runs = BENCH_BYTES_PER_RUN / sample->length;
+        size_t compressed = 0;
+
+        double start = now_s();
+        for (size_t r = 0; r < runs; r++) {
+            compressed = LZ_Compress(sample->data, sample->length, packed, LZ_BOUND(sample->length), work);
+            sink += compressed;
+        }
+        double encode = now_s() - start;
+
+        start = now_s();
+        for (size_t r = 0; r < runs; r++) {
+            sink += LZ_Decompress(packed, compressed, unpacked, sizeof(samples[0].data));
+        }
+        double decode = now_s() - start;
+        failures += memcmp(unpacked, sample->data, sample->length) != 0;
+
+        printf("%-22s%8zu%10zu%8.2f%14.1f%14.1f\n", sample->name, sample->length, compressed,
+               (double)sample->length / (double)compressed, (double)(runs * sample->length) / encode / 1e6,
+               (double)(runs * sample->length) / decode / 1e6);
+    }
+
+    free(scratch);
+    free(packed);
+    free(unpacked);
+    return failures == 0 ? 0 : 1;
+}
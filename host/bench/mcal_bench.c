@@ -0,0 +1,1270 @@
+/******************************************************************************************************************************
+ File Name      : mcal_bench.c
+ Description    : Host benchmark for the MCAL drivers: per-call latency and throughput of the GPIO, UART, NVS, flash log
+                  and WiFi APIs
+                  running on the stand-in ESP-IDF layer. Numbers are host CPU cost of the driver code plus the stand-in,
+                  so compare them run to run rather than against the target.
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.h"
+#include "UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART.h"
+#include "UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD.h"
+#include "FLASH_LOG/MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG.h"
+#include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI.h"
+#include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE.h"
+#include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+
+#define BENCH_NVS_FILE          "mcal_bench_nvs.bin"
+#define BENCH_LOG_FILE          "mcal_bench_log.bin"
+#define BENCH_CAPTURE_FILE      "mcal_bench_capture.bin"     // gpio_capture_vcd mcal_bench_capture.bin out.vcd
+#define BENCH_LOG_SIZE          (64u * 1024u)
+#define BENCH_LOG_RECORDS       20000
+#define BENCH_UART_BLOCK        256
+#define BENCH_UART_BYTES        (4u * 1024u * 1024u)
+#define BENCH_FRAMES            2000
+#define BENCH_CONFIG_KEYS       40
+#define BENCH_PULSES            100000
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static volatile tlong sink;
+
+static void report(const char *name, size_t calls, double elapsed, const char *extra) {
+    printf("%-28s %10.1f ns/call %12.0f calls/s  %s\n", name, elapsed * 1e9 / (double)calls, (double)calls / elapsed,
+           extra != NULL ? extra : "");
+}
+
+/*==============================================================================================================================*/
+/* GPIO */
+
+static void bench_gpio(void) {
+    const size_t calls = 1000000;
+    char extra[96];
+
+    GPIO_Output_Init(Pin_21, 0);
+    GPIO_Input_Init(Pin_46);
+
+    uint64_t writes = host_gpio_register_writes();
+    double start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        GPIO_Value_Set(Pin_21, i & 1);
+    }
+    double elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.2f reg writes/call", (double)(host_gpio_register_writes() - writes) / calls);
+    report("GPIO_Value_Set", calls, elapsed, extra);
+
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        sink += GPIO_Value_Get(Pin_46);
+    }
+    report("GPIO_Value_Get", calls, now_s() - start, NULL);
+
+    writes = host_gpio_register_writes();
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        GPIO_Value_Tog(Pin_21);
+    }
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.2f reg writes/call", (double)(host_gpio_register_writes() - writes) / calls);
+    report("GPIO_Value_Tog", calls, elapsed, extra);
+
+    // Bit-banged SPI mode 0 byte: data on Pin_1, clock on Pin_2 (one rising and one falling edge per bit)
+    GPIO_Output_Init(Pin_1, 0);
+    GPIO_Output_Init(Pin_2, 0);
+    writes = host_gpio_register_writes();
+    start = now_s();
+    for (size_t i = 0; i < calls / 8; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            GPIO_Value_Set(Pin_1, (i >> bit) & 1);
+            GPIO_Value_Tog(Pin_2);
+            GPIO_Value_Tog(Pin_2);
+        }
+    }
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.2f reg writes/byte", (double)(host_gpio_register_writes() - writes) / (calls / 8));
+    report("bit-bang SPI byte", calls / 8, elapsed, extra);
+
+    // 8-bit parallel bus on Pin_0..Pin_7: one pin at a time vs one port write
+    static const tpin bus[8] = {Pin_0, Pin_1, Pin_2, Pin_3, Pin_4, Pin_5, Pin_6, Pin_7};
+    const t_gpio_mask bus_mask = 0xFF;
+    for (size_t b = 0; b < 8; b++) {
+        GPIO_Output_Init(bus[b], 0);
+    }
+    writes = host_gpio_register_writes();
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        for (size_t b = 0; b < 8; b++) {
+            GPIO_Value_Set(bus[b], (i >> b) & 1);
+        }
+    }
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.2f reg writes/byte", (double)(host_gpio_register_writes() - writes) / calls);
+    report("bus byte, 8x GPIO_Value_Set", calls, elapsed, extra);
+
+    writes = host_gpio_register_writes();
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        GPIO_Port_Write(bus_mask, (t_gpio_mask)(i & 0xFF));
+    }
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.2f reg writes/byte", (double)(host_gpio_register_writes() - writes) / calls);
+    report("bus byte, GPIO_Port_Write", calls, elapsed, extra);
+
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        sink += (size_t)GPIO_Port_Read(bus_mask | GPIO_PIN_MASK(Pin_46));
+    }
+    report("GPIO_Port_Read (2 banks)", calls, now_s() - start, NULL);
+
+    // Board bring-up: 24 outputs and 8 pulled-up inputs, one Init call per pin vs one pin table
+    static const t_gpio_pin_config board_pins[] = {
+        GPIO_PIN_CONFIG(Pin_0,  output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_1,  output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_2,  output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_3,  output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_4,  output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_5,  output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_6,  output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_7,  output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_8,  output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_9,  output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_10, output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_11, output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_12, output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_13, output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_14, output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_15, output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_16, output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_17, output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_18, output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_19, output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_33, output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_34, output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_35, output, pull_none, 0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_36, output, pull_none, 1, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_37, input,  pull_up,   0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_38, input,  pull_up,   0, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_39, input,  pull_up,   0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_40, input,  pull_up,   0, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_41, input,  pull_up,   0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_42, input,  pull_up,   0, GPIO_INTR_DISABLE),
+        GPIO_PIN_CONFIG(Pin_43, input,  pull_up,   0, GPIO_INTR_DISABLE), GPIO_PIN_CONFIG(Pin_46, input,  pull_up,   0, GPIO_INTR_DISABLE),
+    };
+    const size_t board_count = sizeof(board_pins) / sizeof(board_pins[0]);
+    const size_t boots = 20000;
+    uint64_t configs = host_gpio_config_calls();
+    writes = host_gpio_register_writes();
+    start = now_s();
+    for (size_t i = 0; i < boots; i++) {
+        for (size_t p = 0; p < board_count; p++) {
+            if (board_pins[p].direction == output) {
+                GPIO_Output_Init(board_pins[p].pin, board_pins[p].level);
+            } else {
+                GPIO_Input_Init(board_pins[p].pin);
+            }
+        }
+    }
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.0f gpio_config + %.0f reg writes/boot",
+             (double)(host_gpio_config_calls() - configs) / boots, (double)(host_gpio_register_writes() - writes) / boots);
+    report("board init, per-pin Init", boots, elapsed, extra);
+
+    configs = host_gpio_config_calls();
+    writes = host_gpio_register_writes();
+    start = now_s();
+    for (size_t i = 0; i < boots; i++) {
+        sink += GPIO_Config_Table(board_pins, board_count);
+    }
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.0f gpio_config + %.0f reg writes/boot",
+             (double)(host_gpio_config_calls() - configs) / boots, (double)(host_gpio_register_writes() - writes) / boots);
+    report("board init, GPIO_Config_Table", boots, elapsed, extra);
+
+    start = now_s();
+    for (size_t i = 0; i < boots; i++) {
+        GPIO_SAFEGUARD_Init();
+    }
+    report("GPIO_SAFEGUARD_Init", boots, now_s() - start, NULL);
+}
+
+/*==============================================================================================================================*/
+/* GPIO events (interrupt-driven inputs, edges injected with host_gpio_drive_input) */
+
+static volatile bool pulse_watch_stop;
+static volatile tlong pulses_queued;
+
+/* Counts the rising edges of a pulse train through the event ring */
+static void pulse_event_task(void *arg) {
+    t_gpio_event event;
+    (void)arg;
+    while (!pulse_watch_stop) {
+        if (GPIO_Event_Wait(&event, pdMS_TO_TICKS(10)) == ESP_OK) {
+            pulses_queued += event.level;
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void busy_wait_us(double us) {
+    double until = now_s() + us / 1e6;
+    while (now_s() < until) {
+    }
+}
+
+static void bench_gpio_event(void) {
+    const size_t edges = 1000000;
+    char extra[96];
+    t_gpio_event event;
+    t_gpio_event_stats before, after;
+    t_gpio_input_config config = GPIO_INPUT_CONFIG_DEFAULT();
+
+    GPIO_Event_Init();
+    GPIO_Event_Attach(Pin_40, &config);
+
+    // ISR + ring cost per edge, drained by the same thread in bursts of 32
+    GPIO_Event_Get_Stats(&before);
+    double start = now_s();
+    for (size_t i = 0; i < edges; i++) {
+        host_gpio_drive_input((gpio_num_t)Pin_40, !(i & 1));
+        if ((i & 31) == 31) {
+            while (GPIO_Event_Wait(&event, 0) == ESP_OK) {
+                sink += event.level;
+            }
+        }
+    }
+    double elapsed = now_s() - start;
+    GPIO_Event_Get_Stats(&after);
+    snprintf(extra, sizeof(extra), "%.3f wakeups/edge, %lu overflows", (double)(after.wakeups - before.wakeups) / edges,
+             (unsigned long)(after.overflows - before.overflows));
+    report("edge -> GPIO_Event_Wait", edges, elapsed, extra);
+
+    // Zero-width pulses: one GPIO_Value_Get() poll per pulse period vs a task blocked on the ring.
+    // The host has no ISR preemption, so the pulse source yields every 16 pulses (half the ring).
+    tlong polled = 0;
+    pulse_watch_stop = false;
+    xTaskCreate(pulse_event_task, "pulse_event", 4096, NULL, 5, NULL);
+    vTaskDelay(pdMS_TO_TICKS(20));
+    GPIO_Event_Get_Stats(&before);
+    start = now_s();
+    for (size_t i = 0; i < BENCH_PULSES; i++) {
+        host_gpio_drive_input((gpio_num_t)Pin_40, 1);
+        host_gpio_drive_input((gpio_num_t)Pin_40, 0);
+        polled += GPIO_Value_Get(Pin_40);
+        if ((i & 15) == 15) {
+            vTaskDelay(0);
+        }
+    }
+    elapsed = now_s() - start;
+    vTaskDelay(pdMS_TO_TICKS(50));
+    pulse_watch_stop = true;
+    vTaskDelay(pdMS_TO_TICKS(50));
+    GPIO_Event_Get_Stats(&after);
+    snprintf(extra, sizeof(extra), "polled %lu, queued %lu of %u pulses, %lu overflows", (unsigned long)polled,
+             (unsigned long)pulses_queued, BENCH_PULSES, (unsigned long)(after.overflows - before.overflows));
+    report("short pulses, poll vs event", BENCH_PULSES, elapsed, extra);
+
+    // Pulse counting and frequency: rising edges only, nothing queued
+    tlong count, millihertz;
+    config.edge = edge_rising;
+    config.mode = event_count;
+    config.pull = pull_none;
+    host_gpio_drive_input((gpio_num_t)Pin_41, 0);
+    GPIO_Event_Attach(Pin_41, &config);
+    GPIO_Event_Get_Frequency(Pin_41, &millihertz);
+    start = now_s();
+    for (size_t i = 0; i < BENCH_PULSES; i++) {
+        host_gpio_drive_input((gpio_num_t)Pin_41, 1);
+        host_gpio_drive_input((gpio_num_t)Pin_41, 0);
+        busy_wait_us(10.0);
+    }
+    elapsed = now_s() - start;
+    GPIO_Event_Get_Frequency(Pin_41, &millihertz);
+    GPIO_Event_Get_Count(Pin_41, &count, true);
+    snprintf(extra, sizeof(extra), "counted %lu of %u, %.1f kHz measured, %.1f kHz driven", (unsigned long)count,
+             BENCH_PULSES, millihertz / 1e6, BENCH_PULSES / elapsed / 1e3);
+    report("pulse count + frequency", BENCH_PULSES, elapsed, extra);
+
+    // Bouncing button: 5 edges per press or release, 200 us apart, 50 us debounce
+    const size_t presses = 1000;
+    config.edge = edge_both;
+    config.mode = event_count;
+    config.debounce_us = 50;
+    GPIO_Event_Attach(Pin_42, &config);
+    GPIO_Event_Get_Stats(&before);
+    start = now_s();
+    for (size_t i = 0; i < presses; i++) {
+        for (int bounce = 0; bounce < 5; bounce++) {
+            host_gpio_drive_input((gpio_num_t)Pin_42, !(bounce & 1));
+        }
+        busy_wait_us(200.0);
+        for (int bounce = 0; bounce < 5; bounce++) {
+            host_gpio_drive_input((gpio_num_t)Pin_42, bounce & 1);
+        }
+        busy_wait_us(200.0);
+    }
+    elapsed = now_s() - start;
+    GPIO_Event_Get_Count(Pin_42, &count, false);
+    GPIO_Event_Get_Stats(&after);
+    snprintf(extra, sizeof(extra), "%lu edges accepted of %lu presses+releases, %lu bounces dropped",
+             (unsigned long)count, (unsigned long)(2 * presses), (unsigned long)(after.bounces - before.bounces));
+    report("debounced button", presses, elapsed, extra);
+
+    GPIO_Event_Detach(Pin_40);
+    GPIO_Event_Detach(Pin_41);
+    GPIO_Event_Detach(Pin_42);
+}
+
+/*==============================================================================================================================*/
+/* GPIO sequencer (esp_timer stand-in thread plays the role of the timer ISR) */
+
+#define SEQ_CLK     GPIO_PIN_MASK(Pin_4)
+#define SEQ_DATA    GPIO_PIN_MASK(Pin_5)
+
+/* One byte 0xA5 on a 2-wire clock/data bus, built at compile time: data changes with the clock low */
+static const t_gpio_seq_step seq_byte[] = {
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, SEQ_DATA, 100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, 0,        100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, SEQ_DATA, 100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, 0,        100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, 0,        100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, SEQ_DATA, 100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, 0,        100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+    GPIO_SEQ_STEP(SEQ_CLK | SEQ_DATA, SEQ_DATA, 100), GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 100),
+};
+
+static double seq_play(const t_gpio_seq_step *steps, size_t count, tlong repeat, t_gpio_seq_stats *delta) {
+    t_gpio_seq_stats before;
+    GPIO_Seq_Get_Stats(&before);
+    double start = now_s();
+    GPIO_Seq_Start(steps, count, repeat);
+    while (GPIO_Seq_Is_Running()) {
+        vTaskDelay(1);
+    }
+    double elapsed = now_s() - start;
+    GPIO_Seq_Get_Stats(delta);
+    delta->steps -= before.steps;
+    delta->late_steps -= before.late_steps;
+    delta->underruns -= before.underruns;
+    return elapsed;
+}
+
+static void bench_gpio_seq(void) {
+    char extra[128];
+    t_gpio_seq_stats delta;
+    const tlong bytes = 100;
+    const size_t steps = sizeof(seq_byte) / sizeof(seq_byte[0]);
+    static t_gpio_seq_step fast[2] = {GPIO_SEQ_STEP(SEQ_CLK, SEQ_CLK, 10), GPIO_SEQ_STEP(SEQ_CLK, 0, 10)};
+
+    GPIO_Port_Write(SEQ_CLK | SEQ_DATA, 0);
+    GPIO_Seq_Init();
+
+    // Timer-driven holds: 100 bytes of 16 steps at 100 us
+    double elapsed = seq_play(seq_byte, steps, bytes, &delta);
+    double expected = bytes * steps * 100e-6;
+    snprintf(extra, sizeof(extra), "%.1f ms for %.1f ms of steps, %lu late, max late %lu us", elapsed * 1e3, expected * 1e3,
+             (unsigned long)delta.late_steps, (unsigned long)delta.max_late_us);
+    report("seq 100 us steps", delta.steps, elapsed, extra);
+
+    // Spun holds: 10 us half-periods
+    elapsed = seq_play(fast, 2, 1000, &delta);
+    snprintf(extra, sizeof(extra), "%.1f ms for %.1f ms of steps, %lu late", elapsed * 1e3, 2000 * 10e-3,
+             (unsigned long)delta.late_steps);
+    report("seq 10 us steps (spun)", delta.steps, elapsed, extra);
+
+    // Streaming: two tables refilled alternately while the other plays
+    static t_gpio_seq_step stream[2][16];
+    const int buffers = 50;
+    GPIO_Seq_Get_Stats(&delta);
+    tlong underruns = delta.underruns, played = delta.steps;
+    double start = now_s();
+    for (int b = 0; b < buffers; b++) {
+        t_gpio_seq_step *table = stream[b & 1];
+        for (size_t i = 0; i < 16; i++) {
+            table[i].mask = SEQ_CLK | SEQ_DATA;
+            table[i].levels = (i & 1 ? SEQ_CLK : 0) | ((b >> (i / 2)) & 1 ? SEQ_DATA : 0);
+            table[i].delay_us = 100;
+        }
+        GPIO_Seq_Queue(table, 16, 1, portMAX_DELAY);
+    }
+    while (GPIO_Seq_Is_Running()) {
+        vTaskDelay(1);
+    }
+    elapsed = now_s() - start;
+    GPIO_Seq_Get_Stats(&delta);
+    // The last buffer ends the stream, which counts as one underrun
+    snprintf(extra, sizeof(extra), "%d buffers, %lu gaps, %.1f ms for %.1f ms of steps", buffers,
+             (unsigned long)(delta.underruns - underruns - 1), elapsed * 1e3, buffers * 16 * 0.1);
+    report("seq double-buffered stream", delta.steps - played, elapsed, extra);
+}
+
+/*==============================================================================================================================*/
+/* GPIO capture */
+
+static void bench_gpio_capture(void) {
+    const size_t calls = 1000000;
+    char extra[128];
+    t_gpio_capture_status status;
+    t_gpio_capture_config config = {.pins = SEQ_CLK | SEQ_DATA};
+
+    // Cost on the write path: capture off, a pin outside the capture, a watched pin (continuous mode)
+    for (int armed = 0; armed < 2; armed++) {
+        if (armed) {
+            GPIO_Capture_Arm(&config);
+        }
+        double start = now_s();
+        for (size_t i = 0; i < calls; i++) {
+            GPIO_Value_Set(Pin_21, i & 1);
+        }
+        report(armed ? "GPIO_Value_Set, not watched" : "GPIO_Value_Set, capture off", calls, now_s() - start, NULL);
+    }
+
+
+    double start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        GPIO_Value_Set(Pin_4, i & 1);
+    }
+    double elapsed = now_s() - start;
+    GPIO_Capture_Get_Status(&status);
+    snprintf(extra, sizeof(extra), "%lu records, %lu overwritten", (unsigned long)status.records,
+             (unsigned long)status.overwritten);
+    report("GPIO_Value_Set, watched", calls, elapsed, extra);
+
+    // Triggered capture of the sequencer: a fault line raised mid-stream, 16 records before it and 64 after
+    GPIO_Output_Init(Pin_6, 0);
+    GPIO_Port_Write(SEQ_CLK | SEQ_DATA, 0);
+    config.pins = SEQ_CLK | SEQ_DATA | GPIO_PIN_MASK(Pin_6);
+    config.trigger_mask = GPIO_PIN_MASK(Pin_6);
+    config.trigger_levels = GPIO_PIN_MASK(Pin_6);
+    config.pre_trigger = 16;
+    config.post_trigger = 64;
+    GPIO_Capture_Arm(&config);
+    GPIO_Seq_Start(seq_byte, sizeof(seq_byte) / sizeof(seq_byte[0]), 10);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    GPIO_Value_Set(Pin_6, 1);
+    while (GPIO_Seq_Is_Running()) {
+        vTaskDelay(1);
+    }
+    GPIO_Value_Set(Pin_6, 0);
+    GPIO_Capture_Get_Status(&status);
+
+    static tbyte image[GPIO_CAPTURE_MAX_SIZE];
+    size_t length = 0;
+    start = now_s();
+    esp_err_t err = GPIO_Capture_Serialize(image, sizeof(image), &length);
+    elapsed = now_s() - start;
+    FILE *file = fopen(BENCH_CAPTURE_FILE, "wb");
+    if (file != NULL) {
+        fwrite(image, 1, length, file);
+        fclose(file);
+    }
+    snprintf(extra, sizeof(extra), "%s, %s, %zu of %lu records, %zu B -> %s",
+             err == ESP_OK ? "ok" : esp_err_to_name(err), status.state == capture_done ? "done" : "not triggered",
+             (length - GPIO_CAPTURE_HEADER_SIZE - 4) / GPIO_CAPTURE_RECORD_SIZE, (unsigned long)status.records, length,
+             BENCH_CAPTURE_FILE);
+    report("GPIO_Capture_Serialize", 1, elapsed, extra);
+}
+
+/*==============================================================================================================================*/
+/* UART (UART0 -> UART1 loopback; raw sends run without baud-rate pacing, so they measure pure software cost) */
+
+static volatile size_t uart_received;
+static volatile bool uart_sink_stop;
+
+static void uart_sink_task(void *arg) {
+    tbyte buffer[BENCH_UART_BLOCK];
+    (void)arg;
+    while (!uart_sink_stop) {
+        UART_Rx_Fill(ESP_UART_NUM_1, pdMS_TO_TICKS(10));
+        size_t length;
+        while ((length = UART_Rx_Read(ESP_UART_NUM_1, buffer, sizeof(buffer))) > 0) {
+            uart_received += length;
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+/* Sends 'calls' blocks, holding back whenever the receiver falls half a driver buffer behind, so nothing is dropped. */
+static double uart_loopback(const t_uart_iovec *iov, size_t count, size_t calls, size_t bytes_per_call) {
+    size_t sent = 0;
+    size_t last;
+    // Let the previous burst land first so it is not counted here
+    do {
+        last = uart_received;
+        vTaskDelay(pdMS_TO_TICKS(20));
+    } while (uart_received != last);
+    uart_received = 0;
+    double start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        while (sent - uart_received > UART_BUF_SIZE / 2) {
+            vTaskDelay(0);
+        }
+        UART_Send_Vector(iov, count, ESP_UART_NUM_0);
+        sent += bytes_per_call;
+    }
+    while (uart_received < sent && now_s() - start < 10.0) {
+        vTaskDelay(0);
+    }
+    return (double)uart_received / (now_s() - start) / 1e6;
+}
+
+static void bench_uart(void) {
+    static tbyte block[BENCH_UART_BLOCK];
+    char extra[96];
+    const size_t calls = BENCH_UART_BYTES / BENCH_UART_BLOCK;
+
+    host_uart_set_wire_pacing(false);
+    UART_Init(ESP_UART_NUM_0, ESP_baudrate_921600, ESP_UART_DATA_8_BITS, ESP_UART_PARITY_DISABLE,
+              ESP_UART_STOP_BITS_1, ESP_UART_HW_FLOWCTRL_DISABLE);
+    UART_Init(ESP_UART_NUM_1, ESP_baudrate_921600, ESP_UART_DATA_8_BITS, ESP_UART_PARITY_DISABLE,
+              ESP_UART_STOP_BITS_1, ESP_UART_HW_FLOWCTRL_DISABLE);
+    memset(block, 0x55, sizeof(block));
+
+    xTaskCreate(uart_sink_task, "uart_sink", 4096, NULL, 5, NULL);
+
+    // Per-call cost: the receiver may drop some of this burst, which does not matter here
+    double start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        UART_Send_Buffer(block, sizeof(block), ESP_UART_NUM_0);
+    }
+    double elapsed = now_s() - start;
+    t_uart_iovec single = { block, sizeof(block) };
+    snprintf(extra, sizeof(extra), "%.1f MB/s lossless loopback", uart_loopback(&single, 1, calls, sizeof(block)));
+    report("UART_Send_Buffer (256 B)", calls, elapsed, extra);
+
+    // Header + payload + trailer, the shape of a frame built in pieces
+    tbyte header[5] = { 0xAA, 0x02, 0x00, 0x00, 0xF0 };
+    tbyte trailer[1] = { 0x00 };
+    t_uart_iovec iov[3] = { { header, sizeof(header) }, { block, 240 }, { trailer, sizeof(trailer) } };
+    uint64_t writes = host_uart_write_calls(ESP_UART_NUM_0);
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        UART_Send_Vector(iov, 3, ESP_UART_NUM_0);
+    }
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%.2f driver writes/call, %.1f MB/s lossless",
+             (double)(host_uart_write_calls(ESP_UART_NUM_0) - writes) / calls, uart_loopback(iov, 3, calls, 246));
+    report("UART_Send_Vector (3 seg)", calls, elapsed, extra);
+
+    // The frame transport takes over the RX side of both ports. Without pacing a window of frames lands faster than
+    // the 1 KB driver buffer drains, so run it at the real 921600 baud and report goodput against the wire
+    uart_sink_stop = true;
+    host_uart_set_wire_pacing(true);
+    vTaskDelay(pdMS_TO_TICKS(20));
+    while (UART_Rx_Read(ESP_UART_NUM_1, block, sizeof(block)) > 0) {
+    }
+    UART_Frame_Init(ESP_UART_NUM_0, NULL);
+    UART_Frame_Init(ESP_UART_NUM_1, NULL);
+    tbyte payload[UART_FRAME_MAX_PAYLOAD];
+    size_t length;
+    size_t delivered = 0;
+    memset(payload, 0x33, sizeof(payload));
+    start = now_s();
+    for (size_t i = 0; i < BENCH_FRAMES; i++) {
+        UART_Frame_Send(ESP_UART_NUM_0, payload, sizeof(payload), portMAX_DELAY);
+        while (UART_Frame_Receive(ESP_UART_NUM_1, block, &length, 0) == ESP_OK) {
+            delivered++;
+        }
+    }
+    UART_Frame_Flush(ESP_UART_NUM_0, pdMS_TO_TICKS(5000));
+    while (delivered < BENCH_FRAMES && UART_Frame_Receive(ESP_UART_NUM_1, block, &length, pdMS_TO_TICKS(100)) == ESP_OK) {
+        delivered++;
+    }
+    elapsed = now_s() - start;
+    t_uart_frame_stats stats;
+    UART_Frame_Get_Stats(ESP_UART_NUM_0, &stats);
+    snprintf(extra, sizeof(extra), "%.1f KB/s goodput at 921600, %lu retx, avg ack %lu us",
+             (double)delivered * UART_FRAME_MAX_PAYLOAD / elapsed / 1e3, (unsigned long)stats.retransmissions,
+             stats.frames_acked ? (unsigned long)(stats.latency_total_us / stats.frames_acked) : 0UL);
+    report("UART_Frame_Send (240 B)", BENCH_FRAMES, elapsed, extra);
+}
+
+/*==============================================================================================================================*/
+/* NVS (file-backed store; every write reaches the "flash" file) */
+
+static void bench_nvs(void) {
+    const size_t calls = 2000;
+    char extra[96];
+    t_host_nvs_counters counters;
+    tsword value;
+    tsbyte text[32];
+
+    remove(BENCH_NVS_FILE);
+    host_nvs_set_file(BENCH_NVS_FILE);
+    NVS_Init();
+
+    host_nvs_reset_counters();
+    double start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        NVS_Write_Int("counter", (tsword)i);
+    }
+    double elapsed = now_s() - start;
+    host_nvs_get_counters(&counters);
+    snprintf(extra, sizeof(extra), "%.2f opens/call, %.2f flash writes/call",
+             (double)counters.opens / calls, (double)counters.flash_writes / calls);
+    report("NVS_Write_Int", calls, elapsed, extra);
+
+    host_nvs_reset_counters();
+    start = now_s();
+    for (size_t i = 0; i < calls * 10; i++) {
+        NVS_Read_Int("counter", &value);
+        sink += (tlong)value;
+    }
+    elapsed = now_s() - start;
+    host_nvs_get_counters(&counters);
+    snprintf(extra, sizeof(extra), "%.2f opens/call", (double)counters.opens / (calls * 10));
+    report("NVS_Read_Int", calls * 10, elapsed, extra);
+
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        snprintf(text, sizeof(text), "value-%zu", i);
+        NVS_Write_String("name", text);
+    }
+    report("NVS_Write_String", calls, now_s() - start, NULL);
+
+    start = now_s();
+    for (size_t i = 0; i < calls * 10; i++) {
+        NVS_Read_String("name", text, sizeof(text));
+        sink += (tlong)text[0];
+    }
+    report("NVS_Read_String", calls * 10, now_s() - start, NULL);
+
+    // Boot-time config load: a few dozen keys read once each
+    tsbyte key[16];
+    for (int k = 0; k < BENCH_CONFIG_KEYS; k++) {
+        snprintf(key, sizeof(key), "cfg%d", k);
+        NVS_Write_Int(key, k);
+    }
+    host_nvs_reset_counters();
+    start = now_s();
+    for (int k = 0; k < BENCH_CONFIG_KEYS; k++) {
+        snprintf(key, sizeof(key), "cfg%d", k);
+        NVS_Read_Int(key, &value);
+        sink += (tlong)value;
+    }
+    elapsed = now_s() - start;
+    host_nvs_get_counters(&counters);
+    snprintf(extra, sizeof(extra), "%.1f us total, %llu opens", elapsed * 1e6, (unsigned long long)counters.opens);
+    report("config load (40 keys)", BENCH_CONFIG_KEYS, elapsed, extra);
+
+    // The same 40 values as one typed record: one lookup, one blob
+    static struct { tsword value[BENCH_CONFIG_KEYS]; } config;
+    static t_nvs_field config_fields[BENCH_CONFIG_KEYS];
+    for (int k = 0; k < BENCH_CONFIG_KEYS; k++) {
+        config_fields[k] = (t_nvs_field){ (tbyte)(k + 1), NVS_FIELD_INT, (tword)(k * sizeof(tsword)), sizeof(tsword) };
+        config.value[k] = k;
+    }
+    const t_nvs_record_schema config_schema = NVS_RECORD_SCHEMA(1, config, config_fields, NULL);
+    tbyte encoded[512];
+    size_t encoded_length;
+    NVS_Record_Encode(&config_schema, &config, encoded, sizeof(encoded), &encoded_length);
+    NVS_Record_Write("config", &config_schema, &config);
+    host_nvs_reset_counters();
+    start = now_s();
+    NVS_Record_Read("config", &config_schema, &config);
+    elapsed = now_s() - start;
+    host_nvs_get_counters(&counters);
+    // Flash entries are 32 bytes: one per integer key, or one header plus the data for a blob
+    snprintf(extra, sizeof(extra), "%.1f us total, %llu reads, %zu B on flash vs %d B as keys", elapsed * 1e6,
+             (unsigned long long)counters.reads, (1 + (encoded_length + 31) / 32) * 32, BENCH_CONFIG_KEYS * 32);
+    report("config load (1 record)", BENCH_CONFIG_KEYS, elapsed, extra);
+
+    // A group of 20 counters updated 5 times each, per call and then through one transaction
+    host_nvs_reset_counters();
+    start = now_s();
+    for (int round = 0; round < 5; round++) {
+        for (int k = 0; k < 20; k++) {
+            snprintf(key, sizeof(key), "cnt%d", k);
+            NVS_Write_Int(key, round * 100 + k);
+        }
+    }
+    elapsed = now_s() - start;
+    host_nvs_get_counters(&counters);
+    snprintf(extra, sizeof(extra), "%llu flash writes, %llu commits",
+             (unsigned long long)counters.flash_writes, (unsigned long long)counters.commits);
+    report("group update, per call", 100, elapsed, extra);
+
+    t_nvs_txn *txn;
+    t_nvs_txn_stats txn_stats;
+    NVS_Txn_Reset_Stats();
+    host_nvs_reset_counters();
+    start = now_s();
+    NVS_Txn_Begin(NULL, NULL, &txn);
+    for (int round = 5; round < 10; round++) {
+        for (int k = 0; k < 20; k++) {
+            snprintf(key, sizeof(key), "cnt%d", k);
+            NVS_Txn_Write_Int(txn, key, round * 100 + k);
+        }
+    }
+    NVS_Txn_Commit(txn);
+    elapsed = now_s() - start;
+    host_nvs_get_counters(&counters);
+    NVS_Txn_Get_Stats(&txn_stats);
+    snprintf(extra, sizeof(extra), "%llu flash writes, %llu commits, %lu commits saved",
+             (unsigned long long)counters.flash_writes, (unsigned long long)counters.commits,
+             (unsigned long)txn_stats.commits_saved);
+    report("group update, transaction", 100, elapsed, extra);
+
+    // A JSON config string and a calibration table, stored raw and then compressed
+    static tsbyte json[2048];
+    static tsword table[1024];
+    size_t json_length = 0;
+    json_length += (size_t)snprintf(json, sizeof(json), "{\"device\":\"esp32s2-node-07\",\"channels\":[");
+    for (int i = 0; i < 16; i++) {
+        json_length += (size_t)snprintf(json + json_length, sizeof(json) - json_length,
+                                        "%s{\"id\":%d,\"name\":\"adc_ch%d\",\"enabled\":%s,\"gain\":%d,\"unit\":\"mV\"}",
+                                        i > 0 ? "," : "", i, i, i % 3 ? "true" : "false", 1 << (i % 4));
+    }
+    snprintf(json + json_length, sizeof(json) - json_length, "]}");
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        table[i] = (tsword)((i * i) / 256 / 8 * 8);
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        nvs_stats_t before, after;
+        NVS_Compression_Set(pass == 0 ? 0 : 256);
+        nvs_get_stats(NULL, &before);
+        start = now_s();
+        NVS_Write_String(pass == 0 ? "json_raw" : "json_lz", json);
+        NVS_Write_Array(pass == 0 ? "table_raw" : "table_lz", table, sizeof(table) / sizeof(table[0]));
+        elapsed = now_s() - start;
+        nvs_get_stats(NULL, &after);
+        snprintf(extra, sizeof(extra), "%zu entries for %zu B", after.used_entries - before.used_entries,
+                 strlen(json) + 1 + sizeof(table));
+        report(pass == 0 ? "json + table write, raw" : "json + table write, lz", 2, elapsed, extra);
+
+        static tsbyte json_back[2048];
+        static tsword table_back[1024];
+        start = now_s();
+        for (size_t i = 0; i < calls / 10; i++) {
+            NVS_Read_String(pass == 0 ? "json_raw" : "json_lz", json_back, sizeof(json_back));
+            NVS_Read_Array(pass == 0 ? "table_raw" : "table_lz", table_back, sizeof(table_back) / sizeof(table_back[0]));
+        }
+        elapsed = now_s() - start;
+        bool same = strcmp(json_back, json) == 0 && memcmp(table_back, table, sizeof(table)) == 0;
+        report(pass == 0 ? "json + table read, raw" : "json + table read, lz", calls / 10, elapsed,
+               same ? NULL : "MISMATCH");
+    }
+    t_nvs_compression_stats lz_stats;
+    NVS_Compression_Get_Stats(&lz_stats);
+    printf("    compression: %lu packed writes, %lu -> %lu B, %lu unpacked reads, %lu errors\n",
+           (unsigned long)lz_stats.packed_writes, (unsigned long)lz_stats.bytes_in, (unsigned long)lz_stats.bytes_stored,
+           (unsigned long)lz_stats.unpacked_reads, (unsigned long)lz_stats.unpack_errors);
+    NVS_Compression_Set(0);
+
+    // Factory reset of one subsystem's 40 keys: key by key, then as one namespace operation
+    for (int pass = 0; pass < 2; pass++) {
+        for (int k = 0; k < BENCH_CONFIG_KEYS; k++) {
+            snprintf(key, sizeof(key), "cal%d", k);
+            NVS_NS_Write_Int("sensor", key, k);
+        }
+        host_nvs_reset_counters();
+        start = now_s();
+        if (pass == 0) {
+            for (int k = 0; k < BENCH_CONFIG_KEYS; k++) {
+                snprintf(key, sizeof(key), "cal%d", k);
+                NVS_NS_Erase_Key("sensor", key);
+            }
+        } else {
+            NVS_NS_Erase_All("sensor");
+        }
+        elapsed = now_s() - start;
+        host_nvs_get_counters(&counters);
+        snprintf(extra, sizeof(extra), "%.1f us total, %llu flash writes, %llu commits", elapsed * 1e6,
+                 (unsigned long long)counters.flash_writes, (unsigned long long)counters.commits);
+        report(pass == 0 ? "reset 40 keys, key by key" : "reset 40 keys, erase all", 1, elapsed, extra);
+    }
+
+    // Hot keys and the config load again, with the read cache in front of flash
+    t_nvs_cache_stats cache_stats;
+    NVS_Cache_Enable();
+    NVS_Cache_Reset_Stats();
+    host_nvs_reset_counters();
+    start = now_s();
+    for (size_t i = 0; i < calls * 10; i++) {
+        NVS_Read_Int("counter", &value);
+        sink += (tlong)value;
+    }
+    elapsed = now_s() - start;
+    host_nvs_get_counters(&counters);
+    snprintf(extra, sizeof(extra), "%llu flash reads", (unsigned long long)counters.reads);
+    report("NVS_Read_Int, cached", calls * 10, elapsed, extra);
+
+    start = now_s();
+    for (size_t i = 0; i < calls * 10; i++) {
+        NVS_Read_String("name", text, sizeof(text));
+        sink += (tlong)text[0];
+    }
+    report("NVS_Read_String, cached", calls * 10, now_s() - start, NULL);
+
+    for (int pass = 0; pass < 2; pass++) {
+        start = now_s();
+        for (int k = 0; k < BENCH_CONFIG_KEYS; k++) {
+            snprintf(key, sizeof(key), "cfg%d", k);
+            NVS_Read_Int(key, &value);
+            sink += (tlong)value;
+        }
+        elapsed = now_s() - start;
+        snprintf(extra, sizeof(extra), "%.1f us total, %s", elapsed * 1e6, pass == 0 ? "cold" : "warm");
+        report("config load, cached", BENCH_CONFIG_KEYS, elapsed, extra);
+    }
+    NVS_Cache_Get_Stats(&cache_stats);
+    printf("    cache: %lu hits, %lu misses, %lu evictions, %u entries\n", (unsigned long)cache_stats.hits,
+           (unsigned long)cache_stats.misses, (unsigned long)cache_stats.evictions, (unsigned)cache_stats.entries);
+    NVS_Cache_Disable();
+
+    remove(BENCH_NVS_FILE);
+}
+
+/*==============================================================================================================================*/
+/* Flash log (file-backed partition) against the key/value path for 16-byte telemetry samples */
+
+static void bench_flash_log(void) {
+    char extra[96];
+    tsword sample[4] = { 0 };
+    t_host_nvs_counters nvs_counters;
+    t_host_partition_counters counters;
+    t_flash_log_stats stats;
+    t_flash_log *log;
+
+    remove(BENCH_NVS_FILE);
+    host_nvs_set_file(BENCH_NVS_FILE);
+    NVS_Init();
+    host_nvs_reset_counters();
+    const size_t nvs_calls = 1000;
+    double start = now_s();
+    for (size_t i = 0; i < nvs_calls; i++) {
+        sample[0] = (tsword)i;
+        NVS_Write_Array("sample", sample, 4);
+    }
+    double elapsed = now_s() - start;
+    host_nvs_get_counters(&nvs_counters);
+    snprintf(extra, sizeof(extra), "%.2f flash writes/record, keeps only the last",
+             (double)nvs_counters.flash_writes / nvs_calls);
+    report("NVS_Write_Array (16 B)", nvs_calls, elapsed, extra);
+    remove(BENCH_NVS_FILE);
+
+    remove(BENCH_LOG_FILE);
+    if (host_partition_add("flashlog", FLASH_LOG_PARTITION_SUBTYPE, BENCH_LOG_SIZE, BENCH_LOG_FILE) != ESP_OK ||
+        Flash_Log_Open("flashlog", &log) != ESP_OK) {
+        printf("flash log: no partition\n");
+        return;
+    }
+    host_partition_reset_counters();
+    start = now_s();
+    for (size_t i = 0; i < BENCH_LOG_RECORDS; i++) {
+        sample[0] = (tsword)i;
+        Flash_Log_Append(log, sample, sizeof(sample), NULL);
+    }
+    Flash_Log_Sync(log);
+    elapsed = now_s() - start;
+    host_partition_get_counters(&counters);
+    Flash_Log_Get_Stats(log, &stats);
+    snprintf(extra, sizeof(extra), "%.3f flash writes/record, %llu sector erases, %lu dropped",
+             (double)counters.writes / BENCH_LOG_RECORDS, (unsigned long long)counters.erases,
+             (unsigned long)stats.records_dropped);
+    report("Flash_Log_Append (16 B)", BENCH_LOG_RECORDS, elapsed, extra);
+
+    t_flash_log_iter iter;
+    size_t length;
+    size_t records = 0;
+    Flash_Log_Iter_Init(log, FLASH_LOG_SEQ_OLDEST, &iter);
+    start = now_s();
+    while (Flash_Log_Read_Next(&iter, sample, sizeof(sample), &length, NULL) == ESP_OK) {
+        sink += (tlong)sample[0];
+        records++;
+    }
+    elapsed = now_s() - start;
+    report("Flash_Log_Read_Next", records > 0 ? records : 1, elapsed, NULL);
+
+    start = now_s();
+    Flash_Log_Close(log);
+    host_partition_reload();
+    Flash_Log_Open("flashlog", &log);
+    elapsed = now_s() - start;
+    snprintf(extra, sizeof(extra), "%u KB partition", (unsigned)(BENCH_LOG_SIZE / 1024));
+    report("Flash_Log_Open (recovery)", 1, elapsed, extra);
+    Flash_Log_Close(log);
+    remove(BENCH_LOG_FILE);
+}
+
+/*==============================================================================================================================*/
+/* WiFi (simulated AP; shortened radio timings so the run stays quick) */
+
+static double wait_for_ip(double timeout_s) {
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t ip_info;
+    double start = now_s();
+
+    while (now_s() - start < timeout_s) {
+        if (esp_netif_get_ip_info(netif, &ip_info) == ESP_OK && ip_info.ip.addr != 0) {
+            return now_s() - start;
+        }
+        vTaskDelay(1);
+    }
+    return -1.0;
+}
+
+static tlong wifi_connects(void) {
+    t_wifi_connect_stats stats;
+    WiFi_Get_Connect_Stats(&stats);
+    return stats.connects;
+}
+
+/* Waits for the connection after 'connects' and prints its time to IP with the radio work it took.
+ * The netif address cannot be polled here: a reused lease is on the interface before the link is up. */
+static void wifi_report_connect(const char *name, tlong connects, const t_host_wifi_stats *before) {
+    t_host_wifi_stats radio_before, radio_after;
+    t_wifi_connect_stats stats;
+    if (before != NULL) {
+        radio_before = *before;
+    } else {
+        host_wifi_get_stats(&radio_before);
+    }
+    double start = now_s();
+    while (wifi_connects() == connects && now_s() - start < 5.0) {
+        vTaskDelay(1);
+    }
+    WiFi_Get_Connect_Stats(&stats);
+    host_wifi_get_stats(&radio_after);
+    printf("%-28s %10.1f ms          %s, %u channels scanned, %u DHCP\n", name, stats.last_time_to_ip_us / 1e3,
+           stats.last_was_fast ? "directed" : "scanned", (unsigned)(radio_after.channels_scanned - radio_before.channels_scanned),
+           (unsigned)(radio_after.dhcp_leases - radio_before.dhcp_leases));
+}
+
+/* A duty-cycle wake: radio off, then WiFi_Connect() */
+static void wifi_wake(const char *name) {
+    t_host_wifi_stats before;
+    WiFi_Disable();
+    vTaskDelay(1);
+    tlong connects = wifi_connects();
+    host_wifi_get_stats(&before);
+    WiFi_Connect("bench-ap", "bench-pass");
+    wifi_report_connect(name, connects, &before);
+}
+
+static t_wifi_reconnect_state wifi_wait_reconnect_state(t_wifi_reconnect_state state, double timeout_s) {
+    t_wifi_reconnect_stats stats;
+    double start = now_s();
+    do {
+        WiFi_Get_Reconnect_Stats(&stats);
+        if (stats.state == state) {
+            break;
+        }
+        vTaskDelay(1);
+    } while (now_s() - start < timeout_s);
+    return stats.state;
+}
+
+static double wifi_wait_probe(t_wifi_probe_state state, double timeout_s) {
+    double start = now_s();
+    while (WiFi_Probe_Get_State() != state) {
+        if (now_s() - start >= timeout_s) {
+            return -1.0;
+        }
+        vTaskDelay(1);
+    }
+    return now_s() - start;
+}
+
+/* Reachability probe against local targets: a TCP listener on loopback and the loopback ICMP echo */
+static void bench_wifi_probe(void) {
+    const size_t calls = 1000000;
+    char extra[96];
+    struct sockaddr_in listen_address = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t address_length = sizeof(listen_address);
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&listen_address, sizeof(listen_address)) != 0 ||
+        listen(listener, 16) != 0 || getsockname(listener, (struct sockaddr *)&listen_address, &address_length) != 0) {
+        printf("%-28s skipped: no loopback TCP\n", "WiFi probe");
+        return;
+    }
+
+    t_wifi_probe_config config = {
+        .targets = {
+            { .kind = wifi_probe_tcp, .address = "127.0.0.1", .port = ntohs(listen_address.sin_port) },
+            { .kind = wifi_probe_icmp, .address = "127.0.0.1" },
+        },
+        .target_count = 2, .period_ms = 20, .timeout_ms = 100, .fail_rounds = 2,
+    };
+    double start = now_s();
+    WiFi_Probe_Start(&config);
+    wifi_wait_probe(wifi_probe_reachable, 2.0);
+    printf("%-28s %10.1f ms          (period %lu ms)\n", "probe start -> reachable", (now_s() - start) * 1e3,
+           (unsigned long)config.period_ms);
+
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        sink += (tlong)WiFi_Check_Internet();
+    }
+    report("WiFi_Check_Internet", calls, now_s() - start, "cached; was a 1000 ms vTaskDelay per call");
+
+    t_wifi_probe_stats stats;
+    vTaskDelay(pdMS_TO_TICKS(200));
+    WiFi_Probe_Get_Stats(&stats);
+    snprintf(extra, sizeof(extra), "min %lu us, max %lu us, %lu rounds", (unsigned long)stats.min_rtt_us,
+             (unsigned long)stats.max_rtt_us, (unsigned long)stats.rounds);
+    printf("%-28s %10.1f us          %s\n", "TCP probe RTT (avg)", (double)stats.avg_rtt_us, extra);
+
+    // The TCP target goes away: the round moves on to the ICMP target and the state holds
+    close(listener);
+    start = now_s();
+    do {
+        vTaskDelay(1);
+        WiFi_Probe_Get_Stats(&stats);
+    } while (stats.last_target != 1 && now_s() - start < 2.0);
+    vTaskDelay(pdMS_TO_TICKS(200));
+    WiFi_Probe_Get_Stats(&stats);
+    printf("%-28s %10.1f us          %s, %lu lost, %lu transitions\n", "TCP down, ICMP RTT (last)", (double)stats.last_rtt_us,
+           stats.state == wifi_probe_reachable ? "reachable" : "NOT reachable", (unsigned long)stats.lost,
+           (unsigned long)stats.transitions);
+    WiFi_Probe_Stop();
+
+    // A single TCP target that goes away: unreachable after fail_rounds rounds without an answer
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    listen_address.sin_port = 0;
+    address_length = sizeof(listen_address);
+    bind(listener, (struct sockaddr *)&listen_address, sizeof(listen_address));
+    listen(listener, 16);
+    getsockname(listener, (struct sockaddr *)&listen_address, &address_length);
+    config.targets[0].port = ntohs(listen_address.sin_port);
+    config.target_count = 1;
+    WiFi_Probe_Start(&config);
+    wifi_wait_probe(wifi_probe_reachable, 2.0);
+    WiFi_Probe_Get_Stats(&stats);
+    tlong rounds = stats.rounds;
+    close(listener);
+    double detect = wifi_wait_probe(wifi_probe_unreachable, 2.0);
+    WiFi_Probe_Get_Stats(&stats);
+    printf("%-28s %10.1f ms          after %lu rounds (fail_rounds %u)\n", "target down -> unreachable", detect * 1e3,
+           (unsigned long)(stats.rounds - rounds), (unsigned)config.fail_rounds);
+    WiFi_Probe_Stop();
+}
+
+/* Uplink model for the TX controller: the AP hears us at its RSSI plus our power above 19.5 dBm.
+ * 1% of frames are retried with 25 dB of margin over -95 dBm, 4% more per dB below that. */
+static void txctl_traffic(tsbyte ap_rssi, double duration_s, double *retry_sum, tlong *ticks) {
+    const tlong frames = 20;            // Per 5 ms: 4000 frames/s of 1500 bytes
+    double start = now_s();
+    while (now_s() - start < duration_s) {
+        t_host_wifi_stats radio;
+        host_wifi_get_stats(&radio);
+        double margin = ap_rssi + (radio.tx_power - 78) / 4.0 + 95.0;
+        double retry = margin >= 25.0 ? 0.01 : 0.01 + (25.0 - margin) * 0.04;
+        retry = retry > 1.0 ? 1.0 : retry;
+        tlong retries = (tlong)(frames * retry + 0.5);
+        // 11B carries about 0.5 Mbps of payload: 312 bytes per 5 ms
+        tlong bytes = (frames - retries) * 1500;
+        bytes = radio.protocol == WIFI_PROTOCOL_11B && bytes > 312 ? 312 : bytes;
+        WiFi_TxCtl_Report(bytes, frames, retries);
+        *retry_sum += retry;
+        (*ticks)++;
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+}
+
+static void bench_wifi_txctl(void) {
+    static const struct {
+        const char *name;
+        tsbyte rssi;
+        double seconds;
+    } phases[] = {
+        { "TX control, strong (-50)", -50, 1.5 },
+        { "TX control, weak (-70)", -70, 1.0 },
+        { "TX control, strong again", -50, 1.5 },
+    };
+    t_wifi_txctl_config config = WIFI_TXCTL_CONFIG_DEFAULT();
+    t_wifi_txctl_status status;
+    t_wifi_snapshot snapshot;
+    config.period_ms = 20;
+    config.target_bps = 20000000;
+    esp_log_level_set("wifi_txctl", ESP_LOG_WARN);
+    WiFi_Get_Snapshot(&snapshot);
+
+    WiFi_TxCtl_Start(&config);
+    for (size_t p = 0; p < sizeof(phases) / sizeof(phases[0]); p++) {
+        double retry_sum = 0;
+        tlong ticks = 0;
+        WiFi_TxCtl_Get_Status(&status);
+        tlong samples = status.samples, power = status.power_samples, ups = status.steps_up, downs = status.steps_down;
+        host_wifi_set_ap_rssi(snapshot.bssid, phases[p].rssi);
+        txctl_traffic(phases[p].rssi, phases[p].seconds, &retry_sum, &ticks);
+        WiFi_TxCtl_Get_Status(&status);
+        double avg_power = status.samples > samples ? (status.power_samples - power) / 4.0 / (status.samples - samples) : 0;
+        printf("%-28s %10.1f dBm avg      level %u at %.2f dBm, %.1f%% retries, %lu up / %lu down\n", phases[p].name,
+               avg_power, (unsigned)status.level, status.power / 4.0, retry_sum * 100 / ticks,
+               (unsigned long)(status.steps_up - ups), (unsigned long)(status.steps_down - downs));
+    }
+    WiFi_TxCtl_Stop();
+
+    t_wifi_txctl_decision log[WIFI_TXCTL_LOG_DEPTH];
+    tword decisions = WiFi_TxCtl_Get_Log(log, WIFI_TXCTL_LOG_DEPTH);
+    if (decisions == 0) {
+        printf("%-28s no decisions logged\n", "TX control, whole run");
+    } else {
+        printf("%-28s %10.1f dBm avg      vs 19.50 dBm fixed, %u decisions logged, first %u -> %u, last %u -> %u\n",
+               "TX control, whole run", status.samples ? status.power_samples / 4.0 / status.samples : 0,
+               (unsigned)decisions, log[0].from_level, log[0].to_level, log[decisions - 1].from_level,
+               log[decisions - 1].to_level);
+    }
+
+    // Started on the rate-limited 11B rung: the throughput target must not pin it there
+    double retry_sum = 0;
+    tlong ticks = 0;
+    config.start_level = config.level_count - 1;
+    host_wifi_set_ap_rssi(snapshot.bssid, -50);
+    WiFi_TxCtl_Start(&config);
+    txctl_traffic(-50, 1.0, &retry_sum, &ticks);
+    WiFi_TxCtl_Get_Status(&status);
+    WiFi_TxCtl_Stop();
+    printf("%-28s %10u level       from %u, %lu down, %lu driver errors\n", "TX control, start on 11B",
+           (unsigned)status.level, (unsigned)config.start_level, (unsigned long)status.steps_down,
+           (unsigned long)status.apply_failures);
+    host_wifi_set_ap_rssi(snapshot.bssid, -55);
+}
+
+/* Reconnect policy: an outage, its recovery, and a wrong password, with a short backoff */
+static void bench_wifi_reconnect(const t_host_wifi_ap *ap) {
+    t_wifi_reconnect_policy policy = WIFI_RECONNECT_POLICY_DEFAULT();
+    t_wifi_reconnect_stats stats;
+    t_host_wifi_stats before, after;
+    const double outage_s = 1.0;
+    policy.initial_delay_ms = 20;
+    policy.max_delay_ms = 160;
+    policy.auth_retry_delay_ms = 50;
+    WiFi_Set_Reconnect_Policy(&policy);
+
+    host_wifi_get_stats(&before);
+    host_wifi_set_ap_up(ap->bssid, false);
+    vTaskDelay(pdMS_TO_TICKS((tlong)(outage_s * 1000)));
+    host_wifi_get_stats(&after);
+    WiFi_Get_Reconnect_Stats(&stats);
+    printf("%-28s %10.1f /s          backoff 20..160 ms, next delay %lu ms, %u channels scanned\n", "AP down: connect attempts",
+           (after.connect_attempts - before.connect_attempts) / outage_s, (unsigned long)stats.next_delay_ms,
+           (unsigned)(after.channels_scanned - before.channels_scanned));
+
+    double start = now_s();
+    host_wifi_set_ap_up(ap->bssid, true);
+    wifi_wait_reconnect_state(wifi_reconnect_connected, 5.0);
+    printf("%-28s %10.1f ms          (bounded by max_delay_ms + connect)\n", "AP back: time to IP", (now_s() - start) * 1e3);
+
+    WiFi_Disable();
+    vTaskDelay(1);
+    host_wifi_get_stats(&before);
+    start = now_s();
+    WiFi_Connect("bench-ap", "wrong-pass");
+    t_wifi_reconnect_state state = wifi_wait_reconnect_state(wifi_reconnect_gave_up, 5.0);
+    host_wifi_get_stats(&after);
+    printf("%-28s %10.1f ms          %s after %u attempts\n", "wrong password", (now_s() - start) * 1e3,
+           state == wifi_reconnect_gave_up ? "gave up" : "still trying", (unsigned)(after.connect_attempts - before.connect_attempts));
+
+    WiFi_Get_Reconnect_Stats(&stats);
+    printf("%-28s %lu link lost, %lu not found, %lu auth, %lu local, %lu other; %lu beacon timeouts\n", "disconnects by reason",
+           (unsigned long)stats.disconnects[wifi_reason_link_lost], (unsigned long)stats.disconnects[wifi_reason_not_found],
+           (unsigned long)stats.disconnects[wifi_reason_auth], (unsigned long)stats.disconnects[wifi_reason_local],
+           (unsigned long)stats.disconnects[wifi_reason_other], (unsigned long)WiFi_Get_Disconnect_Count(WIFI_REASON_BEACON_TIMEOUT));
+
+    t_wifi_reconnect_policy defaults = WIFI_RECONNECT_POLICY_DEFAULT();
+    WiFi_Set_Reconnect_Policy(&defaults);
+}
+
+static void bench_wifi(void) {
+    const size_t calls = 200000;
+    char extra[96];
+    t_host_wifi_timing timing = { .scan_dwell_ms = 4, .auth_assoc_ms = 3, .dhcp_ms = 10 };
+    t_host_wifi_ap ap = {
+        .ssid = "bench-ap", .password = "bench-pass", .bssid = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 },
+        .channel = 11, .rssi = -55, .lease_time_s = 2, .up = true
+    };
+    ap.lease.ip.addr = ESP_IP4TOADDR(192, 168, 1, 50);
+    ap.lease.netmask.addr = ESP_IP4TOADDR(255, 255, 255, 0);
+    ap.lease.gw.addr = ESP_IP4TOADDR(192, 168, 1, 1);
+    host_wifi_set_timing(&timing);
+    host_wifi_add_ap(&ap);
+
+    host_nvs_set_file(BENCH_NVS_FILE);
+    WiFi_Init();
+    double start = now_s();
+    WiFi_Connect("bench-ap", "bench-pass");
+    double to_ip = wait_for_ip(5.0);
+    snprintf(extra, sizeof(extra), "(scan %u ms/ch, assoc %u ms, dhcp %u ms)",
+             (unsigned)timing.scan_dwell_ms, (unsigned)timing.auth_assoc_ms, (unsigned)timing.dhcp_ms);
+    printf("%-28s %10.1f ms          %s\n", "WiFi_Connect -> IP", to_ip * 1e3, extra);
+
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        sink += (tlong)WiFi_Check_Connection();
+    }
+    report("WiFi_Check_Connection", calls, now_s() - start, "link state kept by the event handler");
+
+    t_wifi_snapshot snapshot;
+    start = now_s();
+    for (size_t i = 0; i < calls; i++) {
+        WiFi_Get_Snapshot(&snapshot);
+        sink += snapshot.ip;
+    }
+    snprintf(extra, sizeof(extra), "channel %u, %d dBm, up %.1f ms", (unsigned)snapshot.channel, snapshot.rssi,
+             snapshot.connected_us / 1e3);
+    report("WiFi_Get_Snapshot", calls, now_s() - start, extra);
+
+    host_wifi_drop_link(WIFI_REASON_BEACON_TIMEOUT);
+    WiFi_Wait_For_State(wifi_link_down, pdMS_TO_TICKS(1000));
+    start = now_s();
+    esp_err_t waited = WiFi_Wait_For_State(wifi_link_connected, pdMS_TO_TICKS(5000));
+    printf("%-28s %10.1f ms          %s, reconnect after link loss\n", "WiFi_Wait_For_State", (now_s() - start) * 1e3,
+           waited == ESP_OK ? "connected" : "timed out");
+
+    host_wifi_drop_link(WIFI_REASON_BEACON_TIMEOUT);
+    vTaskDelay(1);
+    to_ip = wait_for_ip(5.0);
+    printf("%-28s %10.1f ms\n", "reconnect after link loss", to_ip * 1e3);
+
+    // Fast connect: the first connection fills the cache, the next wake goes straight to the AP
+    WiFi_Set_Fast_Connect(true, true);
+    wifi_wake("wake, fast connect (cold)");
+    wifi_wake("wake, fast connect");
+    vTaskDelay(pdMS_TO_TICKS(2100));
+    wifi_wake("wake, lease expired");
+
+    tlong connects = wifi_connects();
+    host_wifi_drop_link(WIFI_REASON_BEACON_TIMEOUT);
+    wifi_report_connect("reconnect, fast connect", connects, NULL);
+
+    // The cached AP is gone and the network moved to another AP: directed attempt, then a scan
+    t_host_wifi_ap moved = ap;
+    moved.bssid[5] = 0x02;
+    moved.channel = 6;
+    host_wifi_add_ap(&moved);
+    host_wifi_set_ap_up(ap.bssid, false);
+    wifi_wake("wake, cached AP gone");
+
+    t_wifi_connect_stats stats;
+    WiFi_Get_Connect_Stats(&stats);
+    printf("%-28s %lu connects, %lu fast, %lu fallbacks, best %.1f ms, worst %.1f ms\n", "fast connect totals",
+           (unsigned long)stats.connects, (unsigned long)stats.fast_connects, (unsigned long)stats.fallbacks,
+           stats.best_time_to_ip_us / 1e3, stats.worst_time_to_ip_us / 1e3);
+
+    WiFi_Set_Fast_Connect(false, false);
+    WiFi_Forget_Fast_Connect();
+    bench_wifi_probe();
+    bench_wifi_txctl();
+    bench_wifi_reconnect(&moved);
+    remove(BENCH_NVS_FILE);
+}
+
+int main(void) {
+    printf("mcal_bench (host stand-in)\n\n");
+    bench_gpio();
+    bench_gpio_event();
+    bench_gpio_seq();
+    bench_gpio_capture();
+    bench_uart();
+    bench_nvs();
+    bench_flash_log();
+    bench_wifi();
+    return 0;
+}
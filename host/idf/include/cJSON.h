@@ -0,0 +1,11 @@
+/******************************************************************************************************************************
+ File Name      : cJSON.h
+ Description    : Host stand-in for the cJSON component (no MCAL driver uses it)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_CJSON_H_
+#define HOST_CJSON_H_
+
+typedef struct cJSON cJSON;
+
+#endif /* HOST_CJSON_H_ */
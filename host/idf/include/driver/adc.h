@@ -0,0 +1,11 @@
+/******************************************************************************************************************************
+ File Name      : adc.h
+ Description    : Host stand-in for the ESP-IDF legacy ADC driver (no MCAL driver uses it)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_DRIVER_ADC_H_
+#define HOST_DRIVER_ADC_H_
+
+#include "esp_err.h"
+
+#endif /* HOST_DRIVER_ADC_H_ */
@@ -0,0 +1,22 @@
+/******************************************************************************************************************************
+ File Name      : periph_ctrl.h
+ Description    : Host stand-in for the ESP-IDF peripheral clock control
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_DRIVER_PERIPH_CTRL_H_
+#define HOST_DRIVER_PERIPH_CTRL_H_
+
+typedef enum {
+    PERIPH_UART0_MODULE,
+    PERIPH_UART1_MODULE,
+    PERIPH_I2C0_MODULE,
+    PERIPH_I2C1_MODULE,
+    PERIPH_RMT_MODULE,
+    PERIPH_TIMG0_MODULE,
+    PERIPH_MODULE_MAX
+} periph_module_t;
+
+void periph_module_enable(periph_module_t periph);
+void periph_module_disable(periph_module_t periph);
+
+#endif /* HOST_DRIVER_PERIPH_CTRL_H_ */
@@ -0,0 +1,14 @@
+/******************************************************************************************************************************
+ File Name      : esp_attr.h
+ Description    : Host stand-in for the ESP-IDF section attributes
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_ESP_ATTR_H_
+#define HOST_ESP_ATTR_H_
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif /* HOST_ESP_ATTR_H_ */
@@ -0,0 +1,73 @@
+/******************************************************************************************************************************
+ File Name      : esp_partition.h
+ Description    : Host stand-in for the ESP-IDF partition API (NOR flash semantics, file-backed)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_ESP_PARTITION_H_
+#define HOST_ESP_PARTITION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define SPI_FLASH_SEC_SIZE  4096
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP  = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+    ESP_PARTITION_TYPE_ANY  = 0xff,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_DATA_OTA      = 0x00,
+    ESP_PARTITION_SUBTYPE_DATA_PHY      = 0x01,
+    ESP_PARTITION_SUBTYPE_DATA_NVS      = 0x02,
+    ESP_PARTITION_SUBTYPE_DATA_COREDUMP = 0x03,
+    ESP_PARTITION_SUBTYPE_DATA_NVS_KEYS = 0x04,
+    ESP_PARTITION_SUBTYPE_DATA_FAT      = 0x81,
+    ESP_PARTITION_SUBTYPE_DATA_SPIFFS   = 0x82,
+    ESP_PARTITION_SUBTYPE_ANY           = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    void *flash_chip;
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
+/* Like NOR flash, a write can only clear bits: the stored bytes become (old & new). */
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size);
+/* offset and size must be multiples of SPI_FLASH_SEC_SIZE. */
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+
+/* Host-only hooks ==============================================================================================================
+ * Data partitions are declared at run time and backed by a file each. Every write and erase reaches the file
+ * before the call returns, so a process killed at any point leaves exactly what real flash would hold.
+ */
+typedef struct {
+    uint64_t reads;             // esp_partition_read() calls
+    uint64_t writes;            // esp_partition_write() calls
+    uint64_t erases;            // Sectors erased
+    uint64_t bytes_written;
+} t_host_partition_counters;
+
+/* Declares a data partition. A new or short file is extended with erased (0xFF) bytes. */
+esp_err_t host_partition_add(const char *label, esp_partition_subtype_t subtype, uint32_t size, const char *path);
+void host_partition_get_counters(t_host_partition_counters *counters);
+void host_partition_reset_counters(void);
+/* Simulates a reboot: reloads every partition from its file. */
+void host_partition_reload(void);
+/* Fault injection: after 'operations' more writes/erases, the next one only programs (or erases) its first
+ * 'torn_bytes' bytes and then kills the process with _exit(HOST_PARTITION_POWER_CUT_EXIT). Run the code under test
+ * in a fork()ed child. A negative value disarms it. */
+#define HOST_PARTITION_POWER_CUT_EXIT 86
+void host_partition_power_cut_after(int operations, size_t torn_bytes);
+
+#endif /* HOST_ESP_PARTITION_H_ */
@@ -0,0 +1,50 @@
+/******************************************************************************************************************************
+ File Name      : esp_ping.h
+ Description    : Host stand-in for the legacy lwIP esp_ping API
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_ESP_PING_H_
+#define HOST_ESP_PING_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    PING_TARGET_IP_ADDRESS          = 50,
+    PING_TARGET_IP_ADDRESS_COUNT    = 51,
+    PING_TARGET_RCV_TIMEO           = 52,
+    PING_TARGET_DELAY_TIME          = 53,
+    PING_TARGET_ID                  = 54,
+    PING_TARGET_RES_FN              = 55,
+    PING_TARGET_RES_RESET           = 56,
+    PING_TARGET_DATA_LEN            = 57,
+    PING_TARGET_IP_TOS              = 58,
+    PING_TARGET_IF_INDEX            = 59
+} ping_target_id_t;
+
+typedef enum {
+    PING_RES_TIMEOUT    = 0,
+    PING_RES_OK         = 1,
+    PING_RES_FINISH     = 2
+} ping_res_t;
+
+typedef struct {
+    uint32_t resp_time;
+    uint32_t timeout_count;
+    uint32_t send_count;
+    uint32_t recv_count;
+    uint32_t err_count;
+    uint32_t bytes;
+    uint32_t total_bytes;
+    uint32_t total_time;
+    uint32_t min_time;
+    uint32_t max_time;
+    int8_t ping_err;
+} esp_ping_found;
+
+esp_err_t esp_ping_set_target(ping_target_id_t opt_id, void *opt_val, uint32_t opt_len);
+esp_err_t esp_ping_get_target(ping_target_id_t opt_id, void *opt_val, uint32_t opt_len);
+/* Host model: ESP_OK when res_val is PING_RES_OK and the simulated station has internet access. */
+esp_err_t esp_ping_result(uint8_t res_val, uint16_t res_len, uint32_t res_time);
+
+#endif /* HOST_ESP_PING_H_ */
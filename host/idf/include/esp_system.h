@@ -0,0 +1,15 @@
+/******************************************************************************************************************************
+ File Name      : esp_system.h
+ Description    : Host stand-in for the ESP-IDF system API
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_ESP_SYSTEM_H_
+#define HOST_ESP_SYSTEM_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+uint32_t esp_random(void);
+void esp_restart(void);
+
+#endif /* HOST_ESP_SYSTEM_H_ */
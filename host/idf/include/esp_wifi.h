@@ -0,0 +1,290 @@
+/******************************************************************************************************************************
+ File Name      : esp_wifi.h
+ Description    : Host stand-in for the ESP-IDF WiFi station API, driven by a simulated radio environment
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_ESP_WIFI_H_
+#define HOST_ESP_WIFI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+    WIFI_MODE_MAX
+} wifi_mode_t;
+
+typedef enum {
+    ESP_IF_WIFI_STA = 0,
+    ESP_IF_WIFI_AP,
+    ESP_IF_ETH,
+    ESP_IF_MAX
+} esp_interface_t;
+
+typedef enum {
+    WIFI_IF_STA = ESP_IF_WIFI_STA,
+    WIFI_IF_AP  = ESP_IF_WIFI_AP
+} wifi_interface_t;
+
+#define WIFI_PROTOCOL_11B   1
+#define WIFI_PROTOCOL_11G   2
+#define WIFI_PROTOCOL_11N   4
+#define WIFI_PROTOCOL_LR    8
+
+typedef enum {
+    WIFI_BW_HT20 = 1,
+    WIFI_BW_HT40
+} wifi_bandwidth_t;
+
+typedef enum {
+    WIFI_PS_NONE,
+    WIFI_PS_MIN_MODEM,
+    WIFI_PS_MAX_MODEM
+} wifi_ps_type_t;
+
+typedef enum {
+    WIFI_SECOND_CHAN_NONE = 0,
+    WIFI_SECOND_CHAN_ABOVE,
+    WIFI_SECOND_CHAN_BELOW
+} wifi_second_chan_t;
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA2_ENTERPRISE,
+    WIFI_AUTH_WPA3_PSK,
+    WIFI_AUTH_WPA2_WPA3_PSK,
+    WIFI_AUTH_MAX
+} wifi_auth_mode_t;
+
+typedef enum {
+    WIFI_FAST_SCAN = 0,
+    WIFI_ALL_CHANNEL_SCAN
+} wifi_scan_method_t;
+
+typedef enum {
+    WIFI_CONNECT_AP_BY_SIGNAL = 0,
+    WIFI_CONNECT_AP_BY_SECURITY
+} wifi_sort_method_t;
+
+typedef enum {
+    WIFI_SCAN_TYPE_ACTIVE = 0,
+    WIFI_SCAN_TYPE_PASSIVE
+} wifi_scan_type_t;
+
+typedef struct {
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} wifi_scan_threshold_t;
+
+typedef struct {
+    bool capable;
+    bool required;
+} wifi_pmf_config_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    wifi_scan_method_t scan_method;
+    bool bssid_set;
+    uint8_t bssid[6];
+    uint8_t channel;            // 0: unknown; 1..13: scan this channel first
+    uint16_t listen_interval;
+    wifi_sort_method_t sort_method;
+    wifi_scan_threshold_t threshold;
+    wifi_pmf_config_t pmf_cfg;
+} wifi_sta_config_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    uint8_t ssid_len;
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    uint8_t max_connection;
+} wifi_ap_config_t;
+
+typedef union {
+    wifi_ap_config_t ap;
+    wifi_sta_config_t sta;
+} wifi_config_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t ssid[33];
+    uint8_t primary;
+    wifi_second_chan_t second;
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+    uint32_t phy_11b : 1;
+    uint32_t phy_11g : 1;
+    uint32_t phy_11n : 1;
+    uint32_t phy_lr : 1;
+    uint32_t reserved : 28;
+} wifi_ap_record_t;
+
+typedef struct {
+    uint8_t *ssid;
+    uint8_t *bssid;
+    uint8_t channel;
+    bool show_hidden;
+    wifi_scan_type_t scan_type;
+} wifi_scan_config_t;
+
+typedef struct {
+    int magic;
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_MAGIC      0x1F2F3F4F
+#define WIFI_INIT_CONFIG_DEFAULT()  { .magic = WIFI_INIT_CONFIG_MAGIC }
+
+ESP_EVENT_DECLARE_BASE(WIFI_EVENT);
+
+typedef enum {
+    WIFI_EVENT_WIFI_READY = 0,
+    WIFI_EVENT_SCAN_DONE,
+    WIFI_EVENT_STA_START,
+    WIFI_EVENT_STA_STOP,
+    WIFI_EVENT_STA_CONNECTED,
+    WIFI_EVENT_STA_DISCONNECTED,
+    WIFI_EVENT_STA_AUTHMODE_CHANGE,
+    WIFI_EVENT_STA_WPS_ER_SUCCESS,
+    WIFI_EVENT_STA_WPS_ER_FAILED,
+    WIFI_EVENT_STA_WPS_ER_TIMEOUT,
+    WIFI_EVENT_STA_WPS_ER_PIN,
+    WIFI_EVENT_STA_WPS_ER_PBC_OVERLAP,
+    WIFI_EVENT_AP_START,
+    WIFI_EVENT_AP_STOP,
+    WIFI_EVENT_AP_STACONNECTED,
+    WIFI_EVENT_AP_STADISCONNECTED,
+    WIFI_EVENT_AP_PROBEREQRECVED,
+    WIFI_EVENT_STA_BSS_RSSI_LOW = 20,
+    WIFI_EVENT_MAX
+} wifi_event_t;
+
+typedef enum {
+    WIFI_REASON_UNSPECIFIED             = 1,
+    WIFI_REASON_AUTH_EXPIRE             = 2,
+    WIFI_REASON_AUTH_LEAVE              = 3,
+    WIFI_REASON_ASSOC_EXPIRE            = 4,
+    WIFI_REASON_ASSOC_TOOMANY           = 5,
+    WIFI_REASON_NOT_AUTHED              = 6,
+    WIFI_REASON_NOT_ASSOCED             = 7,
+    WIFI_REASON_ASSOC_LEAVE             = 8,
+    WIFI_REASON_ASSOC_NOT_AUTHED        = 9,
+    WIFI_REASON_MIC_FAILURE             = 14,
+    WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT  = 15,
+    WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT = 16,
+    WIFI_REASON_802_1X_AUTH_FAILED      = 23,
+    WIFI_REASON_BEACON_TIMEOUT          = 200,
+    WIFI_REASON_NO_AP_FOUND             = 201,
+    WIFI_REASON_AUTH_FAIL               = 202,
+    WIFI_REASON_ASSOC_FAIL              = 203,
+    WIFI_REASON_HANDSHAKE_TIMEOUT       = 204,
+    WIFI_REASON_CONNECTION_FAIL         = 205
+} wifi_err_reason_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+} wifi_event_sta_connected_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+} wifi_event_sta_disconnected_t;
+
+typedef struct {
+    uint32_t status;
+    uint8_t number;
+    uint8_t scan_id;
+} wifi_event_sta_scan_done_t;
+
+typedef struct {
+    int32_t rssi;
+} wifi_event_bss_rssi_low_t;
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config);
+esp_err_t esp_wifi_deinit(void);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_get_mode(wifi_mode_t *mode);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_stop(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_set_protocol(wifi_interface_t ifx, uint8_t protocol_bitmap);
+esp_err_t esp_wifi_get_protocol(wifi_interface_t ifx, uint8_t *protocol_bitmap);
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t bw);
+esp_err_t esp_wifi_get_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t *bw);
+esp_err_t esp_wifi_set_max_tx_power(int8_t power);
+esp_err_t esp_wifi_get_max_tx_power(int8_t *power);
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t *type);
+esp_err_t esp_wifi_get_channel(uint8_t *primary, wifi_second_chan_t *second);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info);
+esp_err_t esp_wifi_set_rssi_threshold(int32_t rssi);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block);
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records);
+
+/* Host-only hooks ==============================================================================================================
+ * The simulated environment is a list of access points. Connecting scans channel by channel (scan_dwell_ms each),
+ * authenticates (auth_assoc_ms), then waits for DHCP (dhcp_ms) unless the station has a static IP. Starting the DHCP
+ * client while associated runs one more lease (a renewal) after dhcp_ms. Times are real milliseconds of FreeRTOS
+ * delay, so shrink them in tests.
+ */
+typedef struct {
+    char ssid[33];
+    char password[64];
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    esp_netif_ip_info_t lease;  // Address the AP's DHCP server hands out
+    uint32_t lease_time_s;      // Lease time it grants; 0: one day
+    bool up;
+} t_host_wifi_ap;
+
+typedef struct {
+    uint32_t scan_dwell_ms;     // Per channel (real active scan: ~120 ms)
+    uint32_t auth_assoc_ms;     // Authentication + association + 4-way handshake
+    uint32_t dhcp_ms;           // DHCP discover..ack
+} t_host_wifi_timing;
+
+typedef struct {
+    uint32_t connect_attempts;
+    uint32_t channels_scanned;
+    uint32_t dhcp_leases;
+    int8_t tx_power;            // Last esp_wifi_set_max_tx_power() value (0.25 dBm units)
+    uint8_t protocol;
+    wifi_bandwidth_t bandwidth;
+} t_host_wifi_stats;
+
+void host_wifi_add_ap(const t_host_wifi_ap *ap);
+void host_wifi_clear_aps(void);
+void host_wifi_set_ap_up(const uint8_t bssid[6], bool up);
+void host_wifi_set_ap_rssi(const uint8_t bssid[6], int8_t rssi);
+void host_wifi_set_timing(const t_host_wifi_timing *timing);
+/* Drops the current association as if the AP went away, with the given reason code. */
+void host_wifi_drop_link(uint8_t reason);
+/* Whether the simulated uplink beyond the AP reaches the internet (default true). */
+void host_wifi_set_internet(bool reachable);
+bool host_wifi_internet_reachable(void);
+void host_wifi_get_stats(t_host_wifi_stats *stats);
+
+#endif /* HOST_ESP_WIFI_H_ */
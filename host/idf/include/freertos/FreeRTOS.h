@@ -0,0 +1,54 @@
+/******************************************************************************************************************************
+ File Name      : FreeRTOS.h
+ Description    : Host stand-in for the FreeRTOS kernel (pthread based, 1 kHz tick)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "esp_attr.h"
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define configMAX_PRIORITIES    25
+#define configASSERT(x)         do { if (!(x)) { abort(); } } while (0)
+#define tskNO_AFFINITY          0x7FFFFFFF
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+
+/* Critical sections map onto one process-wide recursive lock, which is what "interrupts off" means on the single-core S2. */
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+
+void host_critical_enter(portMUX_TYPE *mux);
+void host_critical_exit(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux)      host_critical_enter(mux)
+#define portEXIT_CRITICAL(mux)       host_critical_exit(mux)
+#define portENTER_CRITICAL_ISR(mux)  host_critical_enter(mux)
+#define portEXIT_CRITICAL_ISR(mux)   host_critical_exit(mux)
+#define portENTER_CRITICAL_SAFE(mux) host_critical_enter(mux)
+#define portEXIT_CRITICAL_SAFE(mux)  host_critical_exit(mux)
+#define portMUX_INITIALIZE(mux)      do { (mux)->owner = 0; (mux)->count = 0; } while (0)
+
+
+
+#endif /* HOST_FREERTOS_H_ */
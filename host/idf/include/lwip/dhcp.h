@@ -0,0 +1,20 @@
+/******************************************************************************************************************************
+ File Name      : dhcp.h
+ Description    : Host stand-in for lwip/dhcp.h (the lease times of the last offer)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_LWIP_DHCP_H_
+#define HOST_LWIP_DHCP_H_
+
+#include <stdint.h>
+#include "lwip/netif.h"
+
+struct dhcp {
+    uint32_t offered_t0_lease;  // Lease time of the last ACK, in seconds
+    uint32_t offered_t1_renew;
+    uint32_t offered_t2_rebind;
+};
+
+#define netif_dhcp_data(netif) ((netif)->dhcp)
+
+#endif /* HOST_LWIP_DHCP_H_ */
@@ -0,0 +1,15 @@
+/******************************************************************************************************************************
+ File Name      : inet.h
+ Description    : Host stand-in for lwip/inet.h (lwIP maps inet_aton onto its own ip4_addr_t parser)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_LWIP_INET_H_
+#define HOST_LWIP_INET_H_
+
+#include <arpa/inet.h>
+#include "lwip/ip4_addr.h"
+
+#undef inet_aton
+#define inet_aton(cp, addr) ip4addr_aton((cp), (ip4_addr_t *)(addr))
+
+#endif /* HOST_LWIP_INET_H_ */
@@ -0,0 +1,21 @@
+/******************************************************************************************************************************
+ File Name      : ip4_addr.h
+ Description    : Host stand-in for the lwIP IPv4 address helpers
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_LWIP_IP4_ADDR_H_
+#define HOST_LWIP_IP4_ADDR_H_
+
+#include <stdint.h>
+
+typedef struct ip4_addr {
+    uint32_t addr;      // Network byte order
+} ip4_addr_t;
+
+#define IP4_ADDR(ipaddr, a, b, c, d) \
+    (ipaddr)->addr = ((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(a)
+
+int ip4addr_aton(const char *cp, ip4_addr_t *addr);
+char *ip4addr_ntoa(const ip4_addr_t *addr);
+
+#endif /* HOST_LWIP_IP4_ADDR_H_ */
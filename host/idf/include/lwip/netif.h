@@ -0,0 +1,15 @@
+/******************************************************************************************************************************
+ File Name      : netif.h
+ Description    : Host stand-in for lwip/netif.h (only the DHCP client data the MCAL reads)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_LWIP_NETIF_H_
+#define HOST_LWIP_NETIF_H_
+
+struct dhcp;
+
+struct netif {
+    struct dhcp *dhcp;
+};
+
+#endif /* HOST_LWIP_NETIF_H_ */
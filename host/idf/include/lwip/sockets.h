@@ -0,0 +1,18 @@
+/******************************************************************************************************************************
+ File Name      : sockets.h
+ Description    : Host stand-in for lwip/sockets.h (the BSD socket calls lwIP provides map onto the host's own)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_LWIP_SOCKETS_H_
+#define HOST_LWIP_SOCKETS_H_
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include "lwip/ip4_addr.h"
+
+#endif /* HOST_LWIP_SOCKETS_H_ */
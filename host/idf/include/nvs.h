@@ -0,0 +1,118 @@
+/******************************************************************************************************************************
+ File Name      : nvs.h
+ Description    : Host stand-in for the ESP-IDF NVS API (v4.x signatures), backed by a file
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_NVS_H_
+#define HOST_NVS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define NVS_DEFAULT_PART_NAME   "nvs"
+#define NVS_PART_NAME_MAX_SIZE  16
+#define NVS_KEY_NAME_MAX_SIZE   16
+#define NVS_NS_NAME_MAX_SIZE    NVS_KEY_NAME_MAX_SIZE
+
+typedef uint32_t nvs_handle_t;
+typedef nvs_handle_t nvs_handle;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE
+} nvs_open_mode_t;
+typedef nvs_open_mode_t nvs_open_mode;
+
+typedef enum {
+    NVS_TYPE_U8   = 0x01,
+    NVS_TYPE_I8   = 0x11,
+    NVS_TYPE_U16  = 0x02,
+    NVS_TYPE_I16  = 0x12,
+    NVS_TYPE_U32  = 0x04,
+    NVS_TYPE_I32  = 0x14,
+    NVS_TYPE_U64  = 0x08,
+    NVS_TYPE_I64  = 0x18,
+    NVS_TYPE_STR  = 0x21,
+    NVS_TYPE_BLOB = 0x42,
+    NVS_TYPE_ANY  = 0xff
+} nvs_type_t;
+
+typedef struct {
+    char namespace_name[NVS_NS_NAME_MAX_SIZE];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_type_t type;
+} nvs_entry_info_t;
+
+typedef struct nvs_opaque_iterator_t *nvs_iterator_t;
+
+typedef struct {
+    size_t used_entries;
+    size_t free_entries;
+    size_t total_entries;
+    size_t namespace_count;
+} nvs_stats_t;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+esp_err_t nvs_open_from_partition(const char *part_name, const char *name, nvs_open_mode_t open_mode,
+                                  nvs_handle_t *out_handle);
+void nvs_close(nvs_handle_t handle);
+esp_err_t nvs_commit(nvs_handle_t handle);
+
+esp_err_t nvs_set_i8(nvs_handle_t handle, const char *key, int8_t value);
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value);
+esp_err_t nvs_set_i16(nvs_handle_t handle, const char *key, int16_t value);
+esp_err_t nvs_set_u16(nvs_handle_t handle, const char *key, uint16_t value);
+esp_err_t nvs_set_i32(nvs_handle_t handle, const char *key, int32_t value);
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value);
+esp_err_t nvs_set_i64(nvs_handle_t handle, const char *key, int64_t value);
+esp_err_t nvs_set_u64(nvs_handle_t handle, const char *key, uint64_t value);
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length);
+
+esp_err_t nvs_get_i8(nvs_handle_t handle, const char *key, int8_t *out_value);
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value);
+esp_err_t nvs_get_i16(nvs_handle_t handle, const char *key, int16_t *out_value);
+esp_err_t nvs_get_u16(nvs_handle_t handle, const char *key, uint16_t *out_value);
+esp_err_t nvs_get_i32(nvs_handle_t handle, const char *key, int32_t *out_value);
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value);
+esp_err_t nvs_get_i64(nvs_handle_t handle, const char *key, int64_t *out_value);
+esp_err_t nvs_get_u64(nvs_handle_t handle, const char *key, uint64_t *out_value);
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length);
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key);
+esp_err_t nvs_erase_all(nvs_handle_t handle);
+
+esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats);
+esp_err_t nvs_get_used_entry_count(nvs_handle_t handle, size_t *used_entries);
+
+nvs_iterator_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type);
+nvs_iterator_t nvs_entry_next(nvs_iterator_t iterator);
+void nvs_entry_info(nvs_iterator_t iterator, nvs_entry_info_t *out_info);
+void nvs_release_iterator(nvs_iterator_t iterator);
+
+/* Host-only hooks ==============================================================================================================
+ * The store lives in memory and is rewritten to its file after every set/erase, the way the real NVS writes flash
+ * immediately. The file defaults to "mcal_host_nvs.bin" in the working directory, or $MCAL_HOST_NVS_FILE.
+ */
+typedef struct {
+    uint64_t opens;         // nvs_open() calls
+    uint64_t commits;       // nvs_commit() calls
+    uint64_t reads;         // nvs_get_*() calls
+    uint64_t flash_writes;  // set/erase operations that reached "flash"
+} t_host_nvs_counters;
+
+void host_nvs_set_file(const char *path);
+void host_nvs_get_counters(t_host_nvs_counters *counters);
+void host_nvs_reset_counters(void);
+/* Simulates a reboot: drops the in-memory state and every open handle, then reloads the file. */
+void host_nvs_reload(void);
+/* Fault injection: after 'writes' more flash writes, the next one kills the process with _exit(HOST_NVS_POWER_CUT_EXIT)
+ * before anything reaches the file. Run the code under test in a fork()ed child. A negative value disarms it. */
+#define HOST_NVS_POWER_CUT_EXIT 86
+void host_nvs_power_cut_after(int writes);
+/* Fault injection: the next nvs_commit() on a valid handle returns err. The writes before it stay in the store. */
+void host_nvs_fail_next_commit(esp_err_t err);
+
+#endif /* HOST_NVS_H_ */
@@ -0,0 +1,18 @@
+/******************************************************************************************************************************
+ File Name      : nvs_flash.h
+ Description    : Host stand-in for the ESP-IDF NVS flash initialisation API
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_NVS_FLASH_H_
+#define HOST_NVS_FLASH_H_
+
+#include "esp_err.h"
+#include "nvs.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_init_partition(const char *partition_label);
+esp_err_t nvs_flash_deinit(void);
+esp_err_t nvs_flash_erase(void);
+esp_err_t nvs_flash_erase_partition(const char *part_name);
+
+#endif /* HOST_NVS_FLASH_H_ */
@@ -0,0 +1,26 @@
+/******************************************************************************************************************************
+ File Name      : gpio_reg.h
+ Description    : Host stand-in for the ESP32-S2 GPIO register map
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_SOC_GPIO_REG_H_
+#define HOST_SOC_GPIO_REG_H_
+
+#include "soc/soc.h"
+
+#define GPIO_OUT_REG            (DR_REG_GPIO_BASE + 0x0004)
+#define GPIO_OUT_W1TS_REG       (DR_REG_GPIO_BASE + 0x0008)
+#define GPIO_OUT_W1TC_REG       (DR_REG_GPIO_BASE + 0x000c)
+#define GPIO_OUT1_REG           (DR_REG_GPIO_BASE + 0x0010)
+#define GPIO_OUT1_W1TS_REG      (DR_REG_GPIO_BASE + 0x0014)
+#define GPIO_OUT1_W1TC_REG      (DR_REG_GPIO_BASE + 0x0018)
+#define GPIO_ENABLE_REG         (DR_REG_GPIO_BASE + 0x0020)
+#define GPIO_ENABLE_W1TS_REG    (DR_REG_GPIO_BASE + 0x0024)
+#define GPIO_ENABLE_W1TC_REG    (DR_REG_GPIO_BASE + 0x0028)
+#define GPIO_ENABLE1_REG        (DR_REG_GPIO_BASE + 0x002c)
+#define GPIO_ENABLE1_W1TS_REG   (DR_REG_GPIO_BASE + 0x0030)
+#define GPIO_ENABLE1_W1TC_REG   (DR_REG_GPIO_BASE + 0x0034)
+#define GPIO_IN_REG             (DR_REG_GPIO_BASE + 0x003c)
+#define GPIO_IN1_REG            (DR_REG_GPIO_BASE + 0x0040)
+
+#endif /* HOST_SOC_GPIO_REG_H_ */
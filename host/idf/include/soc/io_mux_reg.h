@@ -0,0 +1,11 @@
+/******************************************************************************************************************************
+ File Name      : io_mux_reg.h
+ Description    : Host stand-in for the ESP32-S2 IO MUX register map
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_SOC_IO_MUX_REG_H_
+#define HOST_SOC_IO_MUX_REG_H_
+
+#include "soc/soc.h"
+
+#endif /* HOST_SOC_IO_MUX_REG_H_ */
@@ -0,0 +1,14 @@
+/******************************************************************************************************************************
+ File Name      : sens_reg.h
+ Description    : Host stand-in for the ESP32-S2 SENS (SAR ADC) register map
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_SOC_SENS_REG_H_
+#define HOST_SOC_SENS_REG_H_
+
+#include "soc/soc.h"
+
+#define SENS_SAR_MEAS1_MUX_REG  (DR_REG_SENS_BASE + 0x0010)
+#define SENS_SAR_MEAS2_MUX_REG  (DR_REG_SENS_BASE + 0x0034)
+
+#endif /* HOST_SOC_SENS_REG_H_ */
@@ -0,0 +1,34 @@
+/******************************************************************************************************************************
+ File Name      : soc.h
+ Description    : Host stand-in for the ESP32-S2 register access macros (routed to the host register model)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#ifndef HOST_SOC_SOC_H_
+#define HOST_SOC_SOC_H_
+
+#include <stdint.h>
+
+#ifndef BIT
+#define BIT(nr)                 (1UL << (nr))
+#endif
+#define BIT0                    0x00000001
+#define BIT1                    0x00000002
+#define BIT2                    0x00000004
+#define BIT3                    0x00000008
+#define BIT4                    0x00000010
+#define BIT5                    0x00000020
+#define BIT6                    0x00000040
+#define BIT7                    0x00000080
+
+#define DR_REG_GPIO_BASE        0x3f404000
+#define DR_REG_SENS_BASE        0x3f408800
+
+void host_reg_write(uint32_t addr, uint32_t value);
+uint32_t host_reg_read(uint32_t addr);
+
+#define REG_WRITE(addr, val)    host_reg_write((uint32_t)(addr), (uint32_t)(val))
+#define REG_READ(addr)          host_reg_read((uint32_t)(addr))
+#define REG_SET_BIT(addr, bit)  REG_WRITE((addr), REG_READ(addr) | (bit))
+#define REG_CLR_BIT(addr, bit)  REG_WRITE((addr), REG_READ(addr) & ~(bit))
+
+#endif /* HOST_SOC_SOC_H_ */
@@ -0,0 +1,248 @@
+/******************************************************************************************************************************
+ File Name      : host_esp.c
+ Description    : Host stand-in for esp_err, esp_log, esp_system, periph_ctrl and esp_timer
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "driver/periph_ctrl.h"
+
+pthread_condattr_t *host_monotonic_condattr(void);
+
+/*==============================================================================================================================*/
+/* esp_err */
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                        return "ESP_OK";
+        case ESP_FAIL:                      return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:                return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:           return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:         return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:          return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:             return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:         return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:               return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_CRC:           return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION:       return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_NVS_NOT_INITIALIZED:   return "ESP_ERR_NVS_NOT_INITIALIZED";
+        case ESP_ERR_NVS_NOT_FOUND:         return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_TYPE_MISMATCH:     return "ESP_ERR_NVS_TYPE_MISMATCH";
+        case ESP_ERR_NVS_READ_ONLY:         return "ESP_ERR_NVS_READ_ONLY";
+        case ESP_ERR_NVS_NOT_ENOUGH_SPACE:  return "ESP_ERR_NVS_NOT_ENOUGH_SPACE";
+        case ESP_ERR_NVS_INVALID_NAME:      return "ESP_ERR_NVS_INVALID_NAME";
+        case ESP_ERR_NVS_INVALID_HANDLE:    return "ESP_ERR_NVS_INVALID_HANDLE";
+        case ESP_ERR_NVS_KEY_TOO_LONG:      return "ESP_ERR_NVS_KEY_TOO_LONG";
+        case ESP_ERR_NVS_INVALID_LENGTH:    return "ESP_ERR_NVS_INVALID_LENGTH";
+        case ESP_ERR_NVS_VALUE_TOO_LONG:    return "ESP_ERR_NVS_VALUE_TOO_LONG";
+        default:                            return "UNKNOWN ERROR";
+    }
+}
+
+/*==============================================================================================================================*/
+/* esp_log */
+
+static esp_log_level_t log_level = ESP_LOG_WARN;
+static bool log_level_loaded;
+
+static esp_log_level_t current_log_level(void) {
+    if (!log_level_loaded) {
+        const char *env = getenv("MCAL_HOST_LOG_LEVEL");
+        if (env != NULL) {
+            log_level = (esp_log_level_t)atoi(env);
+        }
+        log_level_loaded = true;
+    }
+    return log_level;
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    (void)tag;
+    log_level = level;
+    log_level_loaded = true;
+}
+
+uint32_t esp_log_timestamp(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = "NEWIDV";
+    if (level > current_log_level()) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%c (%u) %s: ", letters[level], (unsigned)esp_log_timestamp(), tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+/*==============================================================================================================================*/
+/* esp_system / periph_ctrl */
+
+uint32_t esp_random(void) {
+    static __thread uint32_t state;
+    if (state == 0) {
+        state = (uint32_t)esp_timer_get_time() | 1u;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void esp_restart(void) {
+    exit(0);
+}
+
+void periph_module_enable(periph_module_t periph) {
+    (void)periph;
+}
+
+void periph_module_disable(periph_module_t periph) {
+    (void)periph;
+}
+
+/*==============================================================================================================================*/
+/* esp_timer: one dispatcher thread runs every callback, like the esp_timer task on target */
+
+struct host_esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t due_us;
+    uint64_t period_us;
+    bool active;
+    struct host_esp_timer *next;
+};
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_changed;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+static struct host_esp_timer *timer_list;
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void *timer_dispatch(void *unused) {
+    (void)unused;
+    pthread_mutex_lock(&timer_lock);
+    for (;;) {
+        struct host_esp_timer *earliest = NULL;
+        for (struct host_esp_timer *t = timer_list; t != NULL; t = t->next) {
+            if (t->active && (earliest == NULL || t->due_us < earliest->due_us)) {
+                earliest = t;
+            }
+        }
+        if (earliest == NULL) {
+            pthread_cond_wait(&timer_changed, &timer_lock);
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (earliest->due_us > now) {
+            struct timespec ts = { (time_t)(earliest->due_us / 1000000), (long)(earliest->due_us % 1000000) * 1000 };
+            pthread_cond_timedwait(&timer_changed, &timer_lock, &ts);
+            continue;
+        }
+        if (earliest->period_us != 0) {
+            earliest->due_us += (int64_t)earliest->period_us;
+        } else {
+            earliest->active = false;
+        }
+        esp_timer_cb_t callback = earliest->callback;
+        void *arg = earliest->arg;
+        pthread_mutex_unlock(&timer_lock);
+        callback(arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+static void timer_start_dispatcher(void) {
+    pthread_t thread;
+    pthread_cond_init(&timer_changed, host_monotonic_condattr());
+    pthread_create(&thread, NULL, timer_dispatch, NULL);
+    pthread_detach(thread);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle) {
+    if (args == NULL || args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_once(&timer_once, timer_start_dispatcher);
+    struct host_esp_timer *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    pthread_mutex_lock(&timer_lock);
+    timer->next = timer_list;
+    timer_list = timer;
+    pthread_mutex_unlock(&timer_lock);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_arm(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+    pthread_mutex_lock(&timer_lock);
+    if (timer->active) {
+        pthread_mutex_unlock(&timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+    timer->period_us = period_us;
+    timer->active = true;
+    pthread_cond_broadcast(&timer_changed);
+    pthread_mutex_unlock(&timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return timer_arm(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    return timer_arm(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer_lock);
+    esp_err_t err = timer->active ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    pthread_cond_broadcast(&timer_changed);
+    pthread_mutex_unlock(&timer_lock);
+    return err;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer_lock);
+    bool active = timer->active;
+    pthread_mutex_unlock(&timer_lock);
+    return active;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer_lock);
+    for (struct host_esp_timer **link = &timer_list; *link != NULL; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&timer_lock);
+    free(timer);
+    return ESP_OK;
+}
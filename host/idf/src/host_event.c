@@ -0,0 +1,158 @@
+/******************************************************************************************************************************
+ File Name      : host_event.c
+ Description    : Host stand-in for the ESP-IDF default event loop: one dispatcher task fed by a queue
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_event.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#define HOST_EVENT_QUEUE_LEN        32
+#define HOST_EVENT_MAX_DISPATCH     32
+#define HOST_EVENT_TASK_PRIORITY    20
+
+typedef struct t_host_event_handler {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *arg;
+    struct t_host_event_handler *next;
+} t_host_event_handler;
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    void *data;
+} t_host_event;
+
+static pthread_mutex_t event_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static t_host_event_handler *handlers;
+static QueueHandle_t event_queue;
+
+static void event_loop_task(void *arg) {
+    (void)arg;
+    t_host_event event;
+
+    for (;;) {
+        if (xQueueReceive(event_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // Snapshot the matching handlers so they may (un)register handlers themselves
+        t_host_event_handler matches[HOST_EVENT_MAX_DISPATCH];
+        int count = 0;
+        pthread_mutex_lock(&event_lock);
+        for (t_host_event_handler *h = handlers; h != NULL && count < HOST_EVENT_MAX_DISPATCH; h = h->next) {
+            if ((h->base == ESP_EVENT_ANY_BASE || h->base == event.base) &&
+                (h->id == ESP_EVENT_ANY_ID || h->id == event.id)) {
+                matches[count++] = *h;
+            }
+        }
+        pthread_mutex_unlock(&event_lock);
+        for (int i = 0; i < count; i++) {
+            matches[i].handler(matches[i].arg, event.base, event.id, event.data);
+        }
+        free(event.data);
+    }
+}
+
+esp_err_t esp_event_loop_create_default(void) {
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&event_lock);
+    if (event_queue != NULL) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        event_queue = xQueueCreate(HOST_EVENT_QUEUE_LEN, sizeof(t_host_event));
+        xTaskCreate(event_loop_task, "sys_evt", 4096, NULL, HOST_EVENT_TASK_PRIORITY, NULL);
+    }
+    pthread_mutex_unlock(&event_lock);
+    return err;
+}
+
+esp_err_t esp_event_loop_delete_default(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t event_base, int32_t event_id,
+                                              esp_event_handler_t event_handler, void *event_handler_arg,
+                                              esp_event_handler_instance_t *instance) {
+    if (event_handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    t_host_event_handler *h = calloc(1, sizeof(*h));
+    if (h == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    h->base = event_base;
+    h->id = event_id;
+    h->handler = event_handler;
+    h->arg = event_handler_arg;
+    pthread_mutex_lock(&event_lock);
+    // Append, so handlers run in registration order as on the target
+    t_host_event_handler **tail = &handlers;
+    while (*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = h;
+    pthread_mutex_unlock(&event_lock);
+    if (instance != NULL) {
+        *instance = h;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void *event_handler_arg) {
+    return esp_event_handler_instance_register(event_base, event_id, event_handler, event_handler_arg, NULL);
+}
+
+static esp_err_t unregister_matching(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, esp_event_handler_instance_t instance) {
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    pthread_mutex_lock(&event_lock);
+    for (t_host_event_handler **link = &handlers; *link != NULL; link = &(*link)->next) {
+        t_host_event_handler *h = *link;
+        if (h->base == event_base && h->id == event_id &&
+            (instance != NULL ? (void *)h == instance : h->handler == event_handler)) {
+            *link = h->next;
+            free(h);
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&event_lock);
+    return err;
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base, int32_t event_id,
+                                       esp_event_handler_t event_handler) {
+    return unregister_matching(event_base, event_id, event_handler, NULL);
+}
+
+esp_err_t esp_event_handler_instance_unregister(esp_event_base_t event_base, int32_t event_id,
+                                                esp_event_handler_instance_t instance) {
+    return unregister_matching(event_base, event_id, NULL, instance);
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id, const void *event_data,
+                         size_t event_data_size, TickType_t ticks_to_wait) {
+    if (event_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    t_host_event event = { .base = event_base, .id = event_id, .data = NULL };
+    if (event_data != NULL && event_data_size > 0) {
+        event.data = malloc(event_data_size);
+        if (event.data == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(event.data, event_data, event_data_size);
+    }
+    if (xQueueSend(event_queue, &event, ticks_to_wait) != pdTRUE) {
+        free(event.data);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,504 @@
+/******************************************************************************************************************************
+ File Name      : host_freertos.c
+ Description    : Host stand-in for the FreeRTOS kernel: tasks are pthreads, queues are mutex/condvar rings
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+typedef enum {
+    HOST_QUEUE,
+    HOST_MUTEX,
+    HOST_RECURSIVE_MUTEX
+} t_host_queue_kind;
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    t_host_queue_kind kind;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    pthread_t owner;
+    UBaseType_t recursion;
+    uint8_t *storage;
+};
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t entry;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    uint32_t notify_value;
+};
+
+struct host_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    EventBits_t bits;
+};
+
+static pthread_mutex_t critical_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread struct host_task *current_task;
+
+/*==============================================================================================================================*/
+/* Time */
+
+static struct timespec deadline_after(TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ);
+    ts.tv_sec += (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+/* Waits on cond until a peer signals it or the tick budget runs out; returns false on timeout. */
+static bool wait_on(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, const struct timespec *deadline) {
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+static pthread_condattr_t condattr;
+static pthread_once_t condattr_once = PTHREAD_ONCE_INIT;
+
+static void condattr_init(void) {
+    pthread_condattr_init(&condattr);
+    pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC);
+}
+
+/* Every condvar waits against CLOCK_MONOTONIC so tick deadlines survive wall-clock changes. */
+pthread_condattr_t *host_monotonic_condattr(void) {
+    pthread_once(&condattr_once, condattr_init);
+    return &condattr;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)((uint64_t)ts.tv_sec * configTICK_RATE_HZ + (uint64_t)ts.tv_nsec / (1000000000ULL / configTICK_RATE_HZ));
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    struct timespec ts = { (time_t)(ticks / configTICK_RATE_HZ),
+                           (long)((ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ)) };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+/*==============================================================================================================================*/
+/* Critical sections */
+
+void host_critical_enter(portMUX_TYPE *mux) {
+    pthread_mutex_lock(&critical_lock);
+    mux->count++;
+}
+
+void host_critical_exit(portMUX_TYPE *mux) {
+    mux->count--;
+    pthread_mutex_unlock(&critical_lock);
+}
+
+/*==============================================================================================================================*/
+/* Tasks */
+
+static void *task_trampoline(void *arg) {
+    struct host_task *task = arg;
+    current_task = task;
+    task->entry(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t entry, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->entry = entry;
+    task->arg = arg;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->notified, host_monotonic_condattr());
+    if (handle != NULL) {
+        *handle = task;
+    }
+    if (pthread_create(&task->thread, NULL, task_trampoline, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    (void)core;
+    return xTaskCreate(entry, name, stack_depth, arg, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+    if (handle == NULL || handle == current_task) {
+        pthread_exit(NULL);
+    }
+    pthread_cancel(handle->thread);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (current_task == NULL) {
+        /* The main thread gets a handle lazily so it can take notifications too. */
+        current_task = calloc(1, sizeof(*current_task));
+        current_task->thread = pthread_self();
+        pthread_mutex_init(&current_task->lock, NULL);
+        pthread_cond_init(&current_task->notified, host_monotonic_condattr());
+    }
+    return current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+    pthread_mutex_lock(&handle->lock);
+    handle->notify_value++;
+    pthread_cond_broadcast(&handle->notified);
+    pthread_mutex_unlock(&handle->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t *woken) {
+    xTaskNotifyGive(handle);
+    if (woken != NULL) {
+        *woken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_value == 0) {
+        if (!wait_on(&task->notified, &task->lock, ticks, &deadline)) {
+            break;
+        }
+    }
+    uint32_t value = task->notify_value;
+    if (value != 0) {
+        task->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+/*==============================================================================================================================*/
+/* Queues and semaphores */
+
+static QueueHandle_t queue_create(UBaseType_t length, UBaseType_t item_size, t_host_queue_kind kind) {
+    struct host_queue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->storage = calloc(length ? length : 1, item_size ? item_size : 1);
+    if (queue->storage == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, host_monotonic_condattr());
+    queue->kind = kind;
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    return queue_create(length, item_size, HOST_QUEUE);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (queue == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->changed);
+    free(queue->storage);
+    free(queue);
+}
+
+static BaseType_t queue_send(QueueHandle_t queue, const void *item, TickType_t ticks, bool front, bool overwrite) {
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length && !overwrite) {
+        if (!wait_on(&queue->changed, &queue->lock, ticks, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFAIL;
+        }
+    }
+    if (overwrite && queue->count == queue->length) {
+        queue->count--;
+    }
+    UBaseType_t slot;
+    if (front) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        slot = queue->head;
+    } else {
+        slot = (queue->head + queue->count) % queue->length;
+    }
+    if (item != NULL && queue->item_size != 0) {    // Semaphores give with no item
+        memcpy(queue->storage + (size_t)slot * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+static BaseType_t queue_receive(QueueHandle_t queue, void *item, TickType_t ticks, bool peek) {
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        if (!wait_on(&queue->changed, &queue->lock, ticks, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFAIL;
+        }
+    }
+    if (queue->item_size != 0 && item != NULL) {
+        memcpy(item, queue->storage + (size_t)queue->head * queue->item_size, queue->item_size);
+    }
+    if (!peek) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return queue_send(queue, item, ticks, false, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return queue_send(queue, item, ticks, true, false);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return queue_send(queue, item, 0, false, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+    return queue_send(queue, item, 0, false, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    return queue_receive(queue, item, ticks, false);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void *item, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return queue_receive(queue, item, 0, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks) {
+    return queue_receive(queue, item, ticks, true);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t spaces = queue->length - queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return spaces;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->count = 0;
+    queue->head = 0;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return queue_create(1, 0, HOST_QUEUE);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    SemaphoreHandle_t sem = queue_create(max_count, 0, HOST_QUEUE);
+    if (sem != NULL) {
+        sem->count = initial_count;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t sem = queue_create(1, 0, HOST_MUTEX);
+    if (sem != NULL) {
+        sem->count = 1;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    SemaphoreHandle_t sem = queue_create(1, 0, HOST_RECURSIVE_MUTEX);
+    if (sem != NULL) {
+        sem->count = 1;
+    }
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    return queue_receive(sem, NULL, ticks, false);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return queue_send(sem, NULL, 0, false, false);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return queue_send(sem, NULL, 0, false, false);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    pthread_mutex_lock(&sem->lock);
+    if (sem->recursion > 0 && pthread_equal(sem->owner, pthread_self())) {
+        sem->recursion++;
+        pthread_mutex_unlock(&sem->lock);
+        return pdPASS;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    if (queue_receive(sem, NULL, ticks, false) != pdPASS) {
+        return pdFAIL;
+    }
+    pthread_mutex_lock(&sem->lock);
+    sem->owner = pthread_self();
+    sem->recursion = 1;
+    pthread_mutex_unlock(&sem->lock);
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->lock);
+    if (sem->recursion == 0 || !pthread_equal(sem->owner, pthread_self())) {
+        pthread_mutex_unlock(&sem->lock);
+        return pdFAIL;
+    }
+    bool release = (--sem->recursion == 0);
+    pthread_mutex_unlock(&sem->lock);
+    return release ? queue_send(sem, NULL, 0, false, false) : pdPASS;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem) {
+    return uxQueueMessagesWaiting(sem);
+}
+
+/*==============================================================================================================================*/
+/* Event groups */
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    struct host_event_group *group = calloc(1, sizeof(*group));
+    if (group != NULL) {
+        pthread_mutex_init(&group->lock, NULL);
+        pthread_cond_init(&group->changed, host_monotonic_condattr());
+    }
+    return group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+    if (group != NULL) {
+        pthread_mutex_destroy(&group->lock);
+        pthread_cond_destroy(&group->changed);
+        free(group);
+    }
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t result = group->bits;
+    pthread_cond_broadcast(&group->changed);
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t *woken) {
+    xEventGroupSetBits(group, bits);
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t bits = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks) {
+    struct timespec deadline = deadline_after(ticks);
+    pthread_mutex_lock(&group->lock);
+    for (;;) {
+        EventBits_t matched = group->bits & bits;
+        if (wait_for_all ? (matched == bits) : (matched != 0)) {
+            break;
+        }
+        if (!wait_on(&group->changed, &group->lock, ticks, &deadline)) {
+            break;
+        }
+    }
+    EventBits_t result = group->bits;
+    EventBits_t matched = result & bits;
+    if (clear_on_exit && (wait_for_all ? (matched == bits) : (matched != 0))) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
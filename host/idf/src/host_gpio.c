@@ -0,0 +1,276 @@
+/******************************************************************************************************************************
+ File Name      : host_gpio.c
+ Description    : Host stand-in for the ESP32-S2 GPIO matrix: a register model shared by gpio_* and REG_READ/REG_WRITE
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/sens_reg.h"
+
+typedef struct {
+    gpio_isr_t handler;
+    void *arg;
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+} t_host_gpio_isr;
+
+static pthread_mutex_t gpio_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static uint32_t out_reg[2];
+static uint32_t enable_reg[2];
+static uint32_t external_in[2];
+static uint32_t sens_regs[2];
+static uint64_t register_writes;
+static uint64_t config_calls;
+static bool isr_service_installed;
+static t_host_gpio_isr isr_table[GPIO_NUM_MAX];
+
+static bool pin_is_valid(int pin) {
+    return pin >= 0 && pin < GPIO_NUM_MAX && !(pin >= 22 && pin <= 25);
+}
+
+/* Outputs read back what they drive; inputs read the externally driven level. */
+static uint32_t input_bank(int bank) {
+    return (out_reg[bank] & enable_reg[bank]) | (external_in[bank] & ~enable_reg[bank]);
+}
+
+static int pin_level(int pin) {
+    return (int)((input_bank(pin / 32) >> (pin % 32)) & 1u);
+}
+
+/* Runs edge ISRs for every pin whose sampled level changed between the two snapshots. */
+static void dispatch_edges(const uint32_t before[2]) {
+    if (!isr_service_installed) {
+        return;
+    }
+    for (int bank = 0; bank < 2; bank++) {
+        uint32_t changed = before[bank] ^ input_bank(bank);
+        while (changed != 0) {
+            int bit = __builtin_ctz(changed);
+            changed &= changed - 1;
+            int pin = bank * 32 + bit;
+            if (pin >= GPIO_NUM_MAX) {
+                continue;
+            }
+            t_host_gpio_isr *isr = &isr_table[pin];
+            int level = pin_level(pin);
+            bool fire = false;
+            switch (isr->intr_type) {
+                case GPIO_INTR_POSEDGE:    fire = level == 1; break;
+                case GPIO_INTR_NEGEDGE:    fire = level == 0; break;
+                case GPIO_INTR_ANYEDGE:    fire = true;       break;
+                case GPIO_INTR_HIGH_LEVEL: fire = level == 1; break;
+                case GPIO_INTR_LOW_LEVEL:  fire = level == 0; break;
+                default:                   break;
+            }
+            if (fire && isr->intr_enabled && isr->handler != NULL) {
+                isr->handler(isr->arg);
+            }
+        }
+    }
+}
+
+static void snapshot(uint32_t before[2]) {
+    before[0] = input_bank(0);
+    before[1] = input_bank(1);
+}
+
+void host_reg_write(uint32_t addr, uint32_t value) {
+    uint32_t before[2];
+    pthread_mutex_lock(&gpio_lock);
+    snapshot(before);
+    register_writes++;
+    switch (addr) {
+        case GPIO_OUT_REG:          out_reg[0] = value;         break;
+        case GPIO_OUT_W1TS_REG:     out_reg[0] |= value;        break;
+        case GPIO_OUT_W1TC_REG:     out_reg[0] &= ~value;       break;
+        case GPIO_OUT1_REG:         out_reg[1] = value;         break;
+        case GPIO_OUT1_W1TS_REG:    out_reg[1] |= value;        break;
+        case GPIO_OUT1_W1TC_REG:    out_reg[1] &= ~value;       break;
+        case GPIO_ENABLE_REG:       enable_reg[0] = value;      break;
+        case GPIO_ENABLE_W1TS_REG:  enable_reg[0] |= value;     break;
+        case GPIO_ENABLE_W1TC_REG:  enable_reg[0] &= ~value;    break;
+        case GPIO_ENABLE1_REG:      enable_reg[1] = value;      break;
+        case GPIO_ENABLE1_W1TS_REG: enable_reg[1] |= value;     break;
+        case GPIO_ENABLE1_W1TC_REG: enable_reg[1] &= ~value;    break;
+        case SENS_SAR_MEAS1_MUX_REG: sens_regs[0] = value;      break;
+        case SENS_SAR_MEAS2_MUX_REG: sens_regs[1] = value;      break;
+        default:                                                break;
+    }
+    dispatch_edges(before);
+    pthread_mutex_unlock(&gpio_lock);
+}
+
+uint32_t host_reg_read(uint32_t addr) {
+    uint32_t value = 0;
+    pthread_mutex_lock(&gpio_lock);
+    switch (addr) {
+        case GPIO_OUT_REG:      value = out_reg[0];     break;
+        case GPIO_OUT1_REG:     value = out_reg[1];     break;
+        case GPIO_ENABLE_REG:   value = enable_reg[0];  break;
+        case GPIO_ENABLE1_REG:  value = enable_reg[1];  break;
+        case GPIO_IN_REG:       value = input_bank(0);  break;
+        case GPIO_IN1_REG:      value = input_bank(1);  break;
+        default:                                        break;
+    }
+    pthread_mutex_unlock(&gpio_lock);
+    return value;
+}
+
+uint64_t host_gpio_register_writes(void) {
+    return register_writes;
+}
+
+uint64_t host_gpio_config_calls(void) {
+    return config_calls;
+}
+
+void host_gpio_drive_input(gpio_num_t gpio_num, uint32_t level) {
+    uint32_t before[2];
+    pthread_mutex_lock(&gpio_lock);
+    snapshot(before);
+    if (level) {
+        external_in[gpio_num / 32] |= 1u << (gpio_num % 32);
+    } else {
+        external_in[gpio_num / 32] &= ~(1u << (gpio_num % 32));
+    }
+    dispatch_edges(before);
+    pthread_mutex_unlock(&gpio_lock);
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    if (config == NULL || config->pin_bit_mask == 0 || (config->pin_bit_mask >> GPIO_NUM_MAX) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    config_calls++;
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if ((config->pin_bit_mask >> pin) & 1u) {
+            if (!pin_is_valid(pin) || (pin == GPIO_NUM_46 && (config->mode & GPIO_MODE_DEF_OUTPUT))) {
+                pthread_mutex_unlock(&gpio_lock);
+                return ESP_ERR_INVALID_ARG;
+            }
+            gpio_set_direction((gpio_num_t)pin, config->mode);
+            gpio_set_intr_type((gpio_num_t)pin, config->intr_type);
+            if (config->pull_up_en && !(config->mode & GPIO_MODE_DEF_OUTPUT)) {
+                external_in[pin / 32] |= 1u << (pin % 32);
+            }
+        }
+    }
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    return gpio_set_direction(gpio_num, GPIO_MODE_DISABLE);
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!pin_is_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (gpio_num < 32) {
+        host_reg_write(level ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, 1u << gpio_num);
+    } else {
+        host_reg_write(level ? GPIO_OUT1_W1TS_REG : GPIO_OUT1_W1TC_REG, 1u << (gpio_num - 32));
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (!pin_is_valid(gpio_num)) {
+        return 0;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    int level = pin_level(gpio_num);
+    pthread_mutex_unlock(&gpio_lock);
+    return level;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    if (!pin_is_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t bit = 1u << (gpio_num % 32);
+    if (mode & GPIO_MODE_DEF_OUTPUT) {
+        host_reg_write(gpio_num < 32 ? GPIO_ENABLE_W1TS_REG : GPIO_ENABLE1_W1TS_REG, bit);
+    } else {
+        host_reg_write(gpio_num < 32 ? GPIO_ENABLE_W1TC_REG : GPIO_ENABLE1_W1TC_REG, bit);
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!pin_is_valid(gpio_num) || intr_type >= GPIO_INTR_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    isr_table[gpio_num].intr_type = intr_type;
+    isr_table[gpio_num].intr_enabled = intr_type != GPIO_INTR_DISABLE;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+    if (!pin_is_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    isr_table[gpio_num].intr_enabled = true;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+    if (!pin_is_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    isr_table[gpio_num].intr_enabled = false;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    pthread_mutex_lock(&gpio_lock);
+    esp_err_t err = isr_service_installed ? ESP_ERR_INVALID_STATE : ESP_OK;
+    isr_service_installed = true;
+    pthread_mutex_unlock(&gpio_lock);
+    return err;
+}
+
+void gpio_uninstall_isr_service(void) {
+    pthread_mutex_lock(&gpio_lock);
+    isr_service_installed = false;
+    memset(isr_table, 0, sizeof(isr_table));
+    pthread_mutex_unlock(&gpio_lock);
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args) {
+    if (!pin_is_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    if (!isr_service_installed) {
+        pthread_mutex_unlock(&gpio_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    isr_table[gpio_num].handler = isr_handler;
+    isr_table[gpio_num].arg = args;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+    if (!pin_is_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    isr_table[gpio_num].handler = NULL;
+    isr_table[gpio_num].arg = NULL;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,599 @@
+/******************************************************************************************************************************
+ File Name      : host_nvs.c
+ Description    : Host stand-in for the ESP-IDF NVS library: an in-memory key/value store mirrored to a file
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nvs.h"
+#include "nvs_flash.h"
+
+/* Capacity model of the default 24 KB "nvs" partition: 6 pages of 126 32-byte entries, one page kept free for
+ * garbage collection. Integers take one entry; strings and blobs take one header entry plus their data. */
+#define HOST_NVS_ENTRY_SIZE         32
+#define HOST_NVS_TOTAL_ENTRIES      (5 * 126)
+#define HOST_NVS_MAX_NAMESPACES     254
+#define HOST_NVS_MAX_STR_LENGTH     4000
+#define HOST_NVS_MAX_HANDLES        256
+#define HOST_NVS_FILE_MAGIC         0x53564E48u     // "HNVS"
+
+typedef struct {
+    int ns;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_type_t type;
+    size_t length;
+    uint8_t *data;
+} t_host_nvs_item;
+
+typedef struct {
+    nvs_handle_t id;    // 0 when the slot is free
+    int ns;
+    bool writable;
+} t_host_nvs_handle;
+
+struct nvs_opaque_iterator_t {
+    nvs_entry_info_t *entries;
+    size_t count;
+    size_t position;
+};
+
+static pthread_mutex_t nvs_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static bool initialized;
+static char file_path[512];
+static char namespaces[HOST_NVS_MAX_NAMESPACES][NVS_NS_NAME_MAX_SIZE];
+static int namespace_count;
+static t_host_nvs_item *items;
+static size_t item_count;
+static size_t item_capacity;
+static t_host_nvs_handle handles[HOST_NVS_MAX_HANDLES];
+static nvs_handle_t next_handle_id = 1;
+static t_host_nvs_counters counters;
+static int power_cut_remaining = -1;
+static esp_err_t commit_failure = ESP_OK;    // Returned once by the next nvs_commit()
+
+/*==============================================================================================================================*/
+/* Storage model */
+
+static size_t item_entries(nvs_type_t type, size_t length) {
+    if (type == NVS_TYPE_STR || type == NVS_TYPE_BLOB) {
+        return 1 + (length + HOST_NVS_ENTRY_SIZE - 1) / HOST_NVS_ENTRY_SIZE;
+    }
+    return 1;
+}
+
+static size_t used_entries(void) {
+    size_t used = (size_t)namespace_count;
+    for (size_t i = 0; i < item_count; i++) {
+        used += item_entries(items[i].type, items[i].length);
+    }
+    return used;
+}
+
+static const char *store_path(void) {
+    if (file_path[0] == '\0') {
+        const char *env = getenv("MCAL_HOST_NVS_FILE");
+        snprintf(file_path, sizeof(file_path), "%s", env != NULL ? env : "mcal_host_nvs.bin");
+    }
+    return file_path;
+}
+
+static void clear_memory(void) {
+    for (size_t i = 0; i < item_count; i++) {
+        free(items[i].data);
+    }
+    free(items);
+    items = NULL;
+    item_count = 0;
+    item_capacity = 0;
+    namespace_count = 0;
+    memset(handles, 0, sizeof(handles));
+}
+
+static void save_file(void) {
+    char tmp[sizeof(file_path) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", store_path());
+    FILE *file = fopen(tmp, "wb");
+    if (file == NULL) {
+        return;
+    }
+    uint32_t header[3] = { HOST_NVS_FILE_MAGIC, (uint32_t)namespace_count, (uint32_t)item_count };
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(namespaces, NVS_NS_NAME_MAX_SIZE, (size_t)namespace_count, file);
+    for (size_t i = 0; i < item_count; i++) {
+        uint32_t meta[3] = { (uint32_t)items[i].ns, (uint32_t)items[i].type, (uint32_t)items[i].length };
+        fwrite(meta, sizeof(meta), 1, file);
+        fwrite(items[i].key, NVS_KEY_NAME_MAX_SIZE, 1, file);
+        fwrite(items[i].data, 1, items[i].length, file);
+    }
+    fclose(file);
+    rename(tmp, store_path());
+}
+
+static void load_file(void) {
+    FILE *file = fopen(store_path(), "rb");
+    uint32_t header[3];
+
+    clear_memory();
+    if (file == NULL) {
+        return;
+    }
+    if (fread(header, sizeof(header), 1, file) != 1 || header[0] != HOST_NVS_FILE_MAGIC ||
+        header[1] > HOST_NVS_MAX_NAMESPACES ||
+        fread(namespaces, NVS_NS_NAME_MAX_SIZE, header[1], file) != header[1]) {
+        fclose(file);
+        return;
+    }
+    namespace_count = (int)header[1];
+    for (uint32_t i = 0; i < header[2]; i++) {
+        uint32_t meta[3];
+        t_host_nvs_item item;
+        if (fread(meta, sizeof(meta), 1, file) != 1 || fread(item.key, NVS_KEY_NAME_MAX_SIZE, 1, file) != 1) {
+            break;
+        }
+        item.ns = (int)meta[0];
+        item.type = (nvs_type_t)meta[1];
+        item.length = meta[2];
+        item.data = malloc(item.length > 0 ? item.length : 1);
+        if (item.data == NULL || fread(item.data, 1, item.length, file) != item.length) {
+            free(item.data);
+            break;
+        }
+        if (item_count == item_capacity) {
+            item_capacity = item_capacity ? item_capacity * 2 : 64;
+            items = realloc(items, item_capacity * sizeof(*items));
+        }
+        items[item_count++] = item;
+    }
+    fclose(file);
+}
+
+/* Every set/erase goes through here before it touches the store, so an armed power cut loses exactly this write. */
+static void flash_write(void) {
+    if (power_cut_remaining == 0) {
+        fflush(NULL);
+        _exit(HOST_NVS_POWER_CUT_EXIT);
+    }
+    if (power_cut_remaining > 0) {
+        power_cut_remaining--;
+    }
+    counters.flash_writes++;
+}
+
+static int find_namespace(const char *name) {
+    for (int i = 0; i < namespace_count; i++) {
+        if (strncmp(namespaces[i], name, NVS_NS_NAME_MAX_SIZE) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Like the real NVS, a key holds one entry per type: sets and gets match the type, nvs_erase_key() takes the first
+ * entry of any type (NVS_TYPE_ANY). */
+static t_host_nvs_item *find_item(int ns, const char *key, nvs_type_t type) {
+    for (size_t i = 0; i < item_count; i++) {
+        if (items[i].ns == ns && (type == NVS_TYPE_ANY || items[i].type == type) &&
+            strncmp(items[i].key, key, NVS_KEY_NAME_MAX_SIZE) == 0) {
+            return &items[i];
+        }
+    }
+    return NULL;
+}
+
+static void remove_item(t_host_nvs_item *item) {
+    free(item->data);
+    *item = items[--item_count];
+}
+
+static t_host_nvs_handle *lookup_handle(nvs_handle_t id) {
+    if (id == 0) {
+        return NULL;
+    }
+    for (int i = 0; i < HOST_NVS_MAX_HANDLES; i++) {
+        if (handles[i].id == id) {
+            return &handles[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t check_name(const char *name) {
+    if (name == NULL || name[0] == '\0') {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    if (strlen(name) > NVS_KEY_NAME_MAX_SIZE - 1) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t write_item(nvs_handle_t id, const char *key, nvs_type_t type, const void *data, size_t length) {
+    esp_err_t err = check_name(key);
+    if (err != ESP_OK) {
+        return err;
+    }
+    pthread_mutex_lock(&nvs_lock);
+    t_host_nvs_handle *handle = lookup_handle(id);
+    if (handle == NULL) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (!handle->writable) {
+        err = ESP_ERR_NVS_READ_ONLY;
+    } else {
+        t_host_nvs_item *existing = find_item(handle->ns, key, type);
+        size_t freed = existing != NULL ? item_entries(existing->type, existing->length) : 0;
+        if (existing != NULL && existing->length == length &&
+            memcmp(existing->data, data, length) == 0) {
+            err = ESP_OK;   // Same value: the real NVS skips the flash write too
+        } else if (used_entries() - freed + item_entries(type, length) > HOST_NVS_TOTAL_ENTRIES) {
+            err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        } else {
+            uint8_t *copy = malloc(length > 0 ? length : 1);
+            if (copy == NULL) {
+                err = ESP_ERR_NO_MEM;
+            } else {
+                flash_write();
+                memcpy(copy, data, length);
+                if (existing != NULL) {
+                    free(existing->data);
+                } else {
+                    if (item_count == item_capacity) {
+                        item_capacity = item_capacity ? item_capacity * 2 : 64;
+                        items = realloc(items, item_capacity * sizeof(*items));
+                    }
+                    existing = &items[item_count++];
+                    existing->ns = handle->ns;
+                    memset(existing->key, 0, sizeof(existing->key));
+                    strncpy(existing->key, key, NVS_KEY_NAME_MAX_SIZE - 1);
+                }
+                existing->type = type;
+                existing->length = length;
+                existing->data = copy;
+                save_file();
+                err = ESP_OK;
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+/* Copies the item out. For strings and blobs *length is the buffer size on entry and the stored size on return. */
+static esp_err_t read_item(nvs_handle_t id, const char *key, nvs_type_t type, void *out, size_t *length) {
+    esp_err_t err = check_name(key);
+    if (err != ESP_OK) {
+        return err;
+    }
+    pthread_mutex_lock(&nvs_lock);
+    counters.reads++;
+    t_host_nvs_handle *handle = lookup_handle(id);
+    t_host_nvs_item *item = handle != NULL ? find_item(handle->ns, key, type) : NULL;
+    if (handle == NULL) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (item == NULL) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (type != NVS_TYPE_STR && type != NVS_TYPE_BLOB) {
+        memcpy(out, item->data, item->length);
+    } else if (out == NULL) {
+        *length = item->length;
+    } else if (*length < item->length) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out, item->data, item->length);
+        *length = item->length;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+/*==============================================================================================================================*/
+/* nvs_flash */
+
+esp_err_t nvs_flash_init(void) {
+    pthread_mutex_lock(&nvs_lock);
+    if (!initialized) {
+        load_file();
+        initialized = true;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_init_partition(const char *partition_label) {
+    (void)partition_label;
+    return nvs_flash_init();
+}
+
+esp_err_t nvs_flash_deinit(void) {
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = initialized ? ESP_OK : ESP_ERR_NVS_NOT_INITIALIZED;
+    clear_memory();
+    initialized = false;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    pthread_mutex_lock(&nvs_lock);
+    clear_memory();
+    initialized = false;
+    remove(store_path());
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase_partition(const char *part_name) {
+    (void)part_name;
+    return nvs_flash_erase();
+}
+
+/*==============================================================================================================================*/
+/* nvs */
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    esp_err_t err = check_name(name);
+    if (err != ESP_OK) {
+        return err;
+    }
+    pthread_mutex_lock(&nvs_lock);
+    counters.opens++;
+    int ns = initialized ? find_namespace(name) : -1;
+    if (!initialized) {
+        err = ESP_ERR_NVS_NOT_INITIALIZED;
+    } else if (ns < 0 && open_mode == NVS_READONLY) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (ns < 0 && namespace_count == HOST_NVS_MAX_NAMESPACES) {
+        err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    } else {
+        if (ns < 0) {
+            flash_write();
+            ns = namespace_count++;
+            memset(namespaces[ns], 0, NVS_NS_NAME_MAX_SIZE);
+            strncpy(namespaces[ns], name, NVS_NS_NAME_MAX_SIZE - 1);
+            save_file();
+        }
+        err = ESP_ERR_NO_MEM;
+        for (int i = 0; i < HOST_NVS_MAX_HANDLES; i++) {
+            if (handles[i].id == 0) {
+                handles[i].id = next_handle_id++;
+                handles[i].ns = ns;
+                handles[i].writable = open_mode == NVS_READWRITE;
+                *out_handle = handles[i].id;
+                err = ESP_OK;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_open_from_partition(const char *part_name, const char *name, nvs_open_mode_t open_mode,
+                                  nvs_handle_t *out_handle) {
+    (void)part_name;
+    return nvs_open(name, open_mode, out_handle);
+}
+
+void nvs_close(nvs_handle_t id) {
+    pthread_mutex_lock(&nvs_lock);
+    t_host_nvs_handle *handle = lookup_handle(id);
+    if (handle != NULL) {
+        handle->id = 0;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t id) {
+    pthread_mutex_lock(&nvs_lock);
+    counters.commits++;
+    esp_err_t err = lookup_handle(id) != NULL ? commit_failure : ESP_ERR_NVS_INVALID_HANDLE;
+    commit_failure = ESP_OK;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+#define HOST_NVS_INTEGER_ACCESSORS(suffix, ctype, nvs_type)                                         \
+    esp_err_t nvs_set_##suffix(nvs_handle_t handle, const char *key, ctype value) {                 \
+        return write_item(handle, key, nvs_type, &value, sizeof(value));                            \
+    }                                                                                               \
+    esp_err_t nvs_get_##suffix(nvs_handle_t handle, const char *key, ctype *out_value) {            \
+        size_t length = sizeof(*out_value);                                                         \
+        return read_item(handle, key, nvs_type, out_value, &length);                                \
+    }
+
+HOST_NVS_INTEGER_ACCESSORS(i8,  int8_t,   NVS_TYPE_I8)
+HOST_NVS_INTEGER_ACCESSORS(u8,  uint8_t,  NVS_TYPE_U8)
+HOST_NVS_INTEGER_ACCESSORS(i16, int16_t,  NVS_TYPE_I16)
+HOST_NVS_INTEGER_ACCESSORS(u16, uint16_t, NVS_TYPE_U16)
+HOST_NVS_INTEGER_ACCESSORS(i32, int32_t,  NVS_TYPE_I32)
+HOST_NVS_INTEGER_ACCESSORS(u32, uint32_t, NVS_TYPE_U32)
+HOST_NVS_INTEGER_ACCESSORS(i64, int64_t,  NVS_TYPE_I64)
+HOST_NVS_INTEGER_ACCESSORS(u64, uint64_t, NVS_TYPE_U64)
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    size_t length = strlen(value) + 1;
+    if (length > HOST_NVS_MAX_STR_LENGTH) {
+        return ESP_ERR_NVS_VALUE_TOO_LONG;
+    }
+    return write_item(handle, key, NVS_TYPE_STR, value, length);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    return write_item(handle, key, NVS_TYPE_BLOB, value, length);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length) {
+    return read_item(handle, key, NVS_TYPE_STR, out_value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    return read_item(handle, key, NVS_TYPE_BLOB, out_value, length);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t id, const char *key) {
+    esp_err_t err = check_name(key);
+    if (err != ESP_OK) {
+        return err;
+    }
+    pthread_mutex_lock(&nvs_lock);
+    t_host_nvs_handle *handle = lookup_handle(id);
+    t_host_nvs_item *item = handle != NULL ? find_item(handle->ns, key, NVS_TYPE_ANY) : NULL;
+    if (handle == NULL) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (!handle->writable) {
+        err = ESP_ERR_NVS_READ_ONLY;
+    } else if (item == NULL) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        flash_write();
+        remove_item(item);
+        save_file();
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t id) {
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&nvs_lock);
+    t_host_nvs_handle *handle = lookup_handle(id);
+    if (handle == NULL) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (!handle->writable) {
+        err = ESP_ERR_NVS_READ_ONLY;
+    } else {
+        flash_write();
+        for (size_t i = item_count; i-- > 0;) {
+            if (items[i].ns == handle->ns) {
+                remove_item(&items[i]);
+            }
+        }
+        save_file();
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats) {
+    (void)part_name;
+    if (nvs_stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = initialized ? ESP_OK : ESP_ERR_NVS_NOT_INITIALIZED;
+    nvs_stats->used_entries = used_entries();
+    nvs_stats->total_entries = HOST_NVS_TOTAL_ENTRIES;
+    nvs_stats->free_entries = HOST_NVS_TOTAL_ENTRIES - nvs_stats->used_entries;
+    nvs_stats->namespace_count = (size_t)namespace_count;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_get_used_entry_count(nvs_handle_t id, size_t *used) {
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&nvs_lock);
+    t_host_nvs_handle *handle = lookup_handle(id);
+    *used = 0;
+    if (handle == NULL) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else {
+        for (size_t i = 0; i < item_count; i++) {
+            if (items[i].ns == handle->ns) {
+                *used += item_entries(items[i].type, items[i].length);
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+/* Iterators take a snapshot of the matching entries, so writes during iteration do not disturb them. */
+nvs_iterator_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type) {
+    (void)part_name;
+    pthread_mutex_lock(&nvs_lock);
+    int ns = namespace_name != NULL ? find_namespace(namespace_name) : -1;
+    nvs_iterator_t iterator = NULL;
+    if (initialized && (namespace_name == NULL || ns >= 0)) {
+        iterator = calloc(1, sizeof(*iterator));
+        iterator->entries = calloc(item_count > 0 ? item_count : 1, sizeof(nvs_entry_info_t));
+        for (size_t i = 0; i < item_count; i++) {
+            if ((namespace_name == NULL || items[i].ns == ns) && (type == NVS_TYPE_ANY || items[i].type == type)) {
+                nvs_entry_info_t *info = &iterator->entries[iterator->count++];
+                memcpy(info->namespace_name, namespaces[items[i].ns], NVS_NS_NAME_MAX_SIZE);
+                memcpy(info->key, items[i].key, NVS_KEY_NAME_MAX_SIZE);
+                info->type = items[i].type;
+            }
+        }
+        if (iterator->count == 0) {
+            nvs_release_iterator(iterator);
+            iterator = NULL;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return iterator;
+}
+
+nvs_iterator_t nvs_entry_next(nvs_iterator_t iterator) {
+    if (iterator == NULL) {
+        return NULL;
+    }
+    if (++iterator->position >= iterator->count) {
+        nvs_release_iterator(iterator);
+        return NULL;
+    }
+    return iterator;
+}
+
+void nvs_entry_info(nvs_iterator_t iterator, nvs_entry_info_t *out_info) {
+    *out_info = iterator->entries[iterator->position];
+}
+
+void nvs_release_iterator(nvs_iterator_t iterator) {
+    if (iterator != NULL) {
+        free(iterator->entries);
+        free(iterator);
+    }
+}
+
+/*==============================================================================================================================*/
+/* Host hooks */
+
+void host_nvs_set_file(const char *path) {
+    pthread_mutex_lock(&nvs_lock);
+    snprintf(file_path, sizeof(file_path), "%s", path);
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void host_nvs_get_counters(t_host_nvs_counters *out) {
+    pthread_mutex_lock(&nvs_lock);
+    *out = counters;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void host_nvs_reset_counters(void) {
+    pthread_mutex_lock(&nvs_lock);
+    memset(&counters, 0, sizeof(counters));
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void host_nvs_reload(void) {
+    pthread_mutex_lock(&nvs_lock);
+    load_file();
+    initialized = true;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void host_nvs_power_cut_after(int writes) {
+    pthread_mutex_lock(&nvs_lock);
+    power_cut_remaining = writes < 0 ? -1 : writes;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void host_nvs_fail_next_commit(esp_err_t err) {
+    pthread_mutex_lock(&nvs_lock);
+    commit_failure = err;
+    pthread_mutex_unlock(&nvs_lock);
+}
@@ -0,0 +1,208 @@
+/******************************************************************************************************************************
+ File Name      : host_partition.c
+ Description    : Host stand-in for the ESP-IDF partition API: data partitions held in memory and mirrored to files
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_partition.h"
+
+#define HOST_PARTITION_MAX  4
+
+typedef struct {
+    esp_partition_t info;
+    char path[256];
+    uint8_t *data;
+    int fd;
+} t_host_partition;
+
+static pthread_mutex_t partition_lock = PTHREAD_MUTEX_INITIALIZER;
+static t_host_partition partitions[HOST_PARTITION_MAX];
+static int partition_count;
+static t_host_partition_counters counters;
+static int power_cut_remaining = -1;
+static size_t power_cut_torn_bytes;
+
+static t_host_partition *lookup(const esp_partition_t *partition) {
+    for (int i = 0; i < partition_count; i++) {
+        if (&partitions[i].info == partition) {
+            return &partitions[i];
+        }
+    }
+    return NULL;
+}
+
+static void load(t_host_partition *part) {
+    memset(part->data, 0xFF, part->info.size);
+    ssize_t got = pread(part->fd, part->data, part->info.size, 0);
+    if (got < (ssize_t)part->info.size) {
+        // New or short file: pad it with erased flash
+        size_t have = got > 0 ? (size_t)got : 0;
+        memset(part->data + have, 0xFF, part->info.size - have);
+        if (pwrite(part->fd, part->data + have, part->info.size - have, (off_t)have) < 0) {
+            perror("host_partition");
+        }
+    }
+}
+
+static void store(t_host_partition *part, size_t offset, size_t size) {
+    if (pwrite(part->fd, part->data + offset, size, (off_t)offset) != (ssize_t)size) {
+        perror("host_partition");
+    }
+}
+
+/* Every write and erase goes through here. Returns the number of bytes the operation may touch. */
+static size_t power_budget(size_t size) {
+    if (power_cut_remaining == 0) {
+        return power_cut_torn_bytes < size ? power_cut_torn_bytes : size;
+    }
+    if (power_cut_remaining > 0) {
+        power_cut_remaining--;
+    }
+    return size;
+}
+
+static void power_cut_if_armed(void) {
+    if (power_cut_remaining == 0) {
+        fflush(NULL);
+        _exit(HOST_PARTITION_POWER_CUT_EXIT);
+    }
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label) {
+    const esp_partition_t *found = NULL;
+    pthread_mutex_lock(&partition_lock);
+    for (const t_host_partition *part = partitions; part < &partitions[partition_count] && found == NULL; part++) {
+        const esp_partition_t *info = &part->info;
+        if ((type == ESP_PARTITION_TYPE_ANY || type == info->type) &&
+            (subtype == ESP_PARTITION_SUBTYPE_ANY || subtype == info->subtype) &&
+            (label == NULL || strcmp(info->label, label) == 0)) {
+            found = info;
+        }
+    }
+    pthread_mutex_unlock(&partition_lock);
+    return found;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size) {
+    t_host_partition *part = lookup(partition);
+    if (part == NULL || dst == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (src_offset > partition->size || size > partition->size - src_offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    pthread_mutex_lock(&partition_lock);
+    counters.reads++;
+    memcpy(dst, part->data + src_offset, size);
+    pthread_mutex_unlock(&partition_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size) {
+    t_host_partition *part = lookup(partition);
+    if (part == NULL || src == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (dst_offset > partition->size || size > partition->size - dst_offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    pthread_mutex_lock(&partition_lock);
+    size_t budget = power_budget(size);
+    const uint8_t *bytes = src;
+    for (size_t i = 0; i < budget; i++) {
+        part->data[dst_offset + i] &= bytes[i];
+    }
+    store(part, dst_offset, budget);
+    power_cut_if_armed();
+    counters.writes++;
+    counters.bytes_written += size;
+    pthread_mutex_unlock(&partition_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size) {
+    t_host_partition *part = lookup(partition);
+    if (part == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset % SPI_FLASH_SEC_SIZE != 0 || size % SPI_FLASH_SEC_SIZE != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset > partition->size || size > partition->size - offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    pthread_mutex_lock(&partition_lock);
+    size_t budget = power_budget(size);
+    memset(part->data + offset, 0xFF, budget);
+    store(part, offset, budget);
+    power_cut_if_armed();
+    counters.erases += size / SPI_FLASH_SEC_SIZE;
+    pthread_mutex_unlock(&partition_lock);
+    return ESP_OK;
+}
+
+/*==============================================================================================================================*/
+/* Host-only hooks */
+
+esp_err_t host_partition_add(const char *label, esp_partition_subtype_t subtype, uint32_t size, const char *path) {
+    if (label == NULL || path == NULL || size == 0 || size % SPI_FLASH_SEC_SIZE != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&partition_lock);
+    esp_err_t err = ESP_OK;
+    if (partition_count == HOST_PARTITION_MAX) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        t_host_partition *part = &partitions[partition_count];
+        memset(part, 0, sizeof(*part));
+        part->info.type = ESP_PARTITION_TYPE_DATA;
+        part->info.subtype = subtype;
+        part->info.address = 0x110000 + (uint32_t)partition_count * 0x100000;
+        part->info.size = size;
+        snprintf(part->info.label, sizeof(part->info.label), "%s", label);
+        snprintf(part->path, sizeof(part->path), "%s", path);
+        part->data = malloc(size);
+        part->fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (part->data == NULL || part->fd < 0) {
+            free(part->data);
+            err = ESP_FAIL;
+        } else {
+            load(part);
+            partition_count++;
+        }
+    }
+    pthread_mutex_unlock(&partition_lock);
+    return err;
+}
+
+void host_partition_get_counters(t_host_partition_counters *out) {
+    pthread_mutex_lock(&partition_lock);
+    *out = counters;
+    pthread_mutex_unlock(&partition_lock);
+}
+
+void host_partition_reset_counters(void) {
+    pthread_mutex_lock(&partition_lock);
+    memset(&counters, 0, sizeof(counters));
+    pthread_mutex_unlock(&partition_lock);
+}
+
+void host_partition_reload(void) {
+    pthread_mutex_lock(&partition_lock);
+    for (int i = 0; i < partition_count; i++) {
+        load(&partitions[i]);
+    }
+    pthread_mutex_unlock(&partition_lock);
+}
+
+void host_partition_power_cut_after(int operations, size_t torn_bytes) {
+    pthread_mutex_lock(&partition_lock);
+    power_cut_remaining = operations < 0 ? -1 : operations;
+    power_cut_torn_bytes = torn_bytes;
+    pthread_mutex_unlock(&partition_lock);
+}
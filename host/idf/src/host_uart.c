@@ -0,0 +1,395 @@
+/******************************************************************************************************************************
+ File Name      : host_uart.c
+ Description    : Host stand-in for the ESP-IDF UART driver. Each port has a TX ring drained by a "wire" thread into the
+                  RX ring of its peer (UART0 <-> UART1 by default), with optional baud-rate pacing and bit errors.
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include "driver/uart.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#define HOST_UART_CHUNK         120     // Bytes moved per "RX FIFO full" interrupt
+#define HOST_UART_PATTERN_MAX   32
+
+pthread_condattr_t *host_monotonic_condattr(void);
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t head;
+    size_t count;
+} t_host_ring;
+
+typedef struct {
+    bool installed;
+    pthread_mutex_t tx_mux;             // Held for a whole uart_write_bytes() call, as in the real driver
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    pthread_t wire;
+    t_host_ring rx;
+    t_host_ring tx;
+    bool tx_busy;
+    int baud_rate;
+    uart_port_t peer;
+    uint32_t error_one_in_n;
+    uint32_t error_counter;
+    QueueHandle_t events;
+    char pattern_chr;
+    bool pattern_enabled;
+    uint64_t rx_total;
+    uint64_t rx_consumed;
+    uint64_t pattern_pos[HOST_UART_PATTERN_MAX];
+    int pattern_head;
+    int pattern_count;
+    uint64_t write_calls;
+} t_host_uart;
+
+static t_host_uart ports[UART_NUM_MAX] = {
+    [0] = { .tx_mux = PTHREAD_MUTEX_INITIALIZER, .lock = PTHREAD_MUTEX_INITIALIZER, .peer = 1 },
+    [1] = { .tx_mux = PTHREAD_MUTEX_INITIALIZER, .lock = PTHREAD_MUTEX_INITIALIZER, .peer = 0 },
+};
+static bool wire_pacing;
+
+static size_t ring_put(t_host_ring *ring, const uint8_t *src, size_t length) {
+    size_t n = 0;
+    while (n < length && ring->count < ring->size) {
+        ring->data[(ring->head + ring->count) % ring->size] = src[n++];
+        ring->count++;
+    }
+    return n;
+}
+
+static size_t ring_get(t_host_ring *ring, uint8_t *dst, size_t length) {
+    size_t n = 0;
+    while (n < length && ring->count > 0) {
+        dst[n++] = ring->data[ring->head];
+        ring->head = (ring->head + 1) % ring->size;
+        ring->count--;
+    }
+    return n;
+}
+
+static struct timespec deadline_after_ticks(TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ);
+    ts.tv_sec += (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+static bool timed_wait(t_host_uart *uart, TickType_t ticks, const struct timespec *deadline) {
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(&uart->changed, &uart->lock);
+        return true;
+    }
+    return pthread_cond_timedwait(&uart->changed, &uart->lock, deadline) == 0;
+}
+
+static void post_event(t_host_uart *uart, uart_event_type_t type, size_t size) {
+    if (uart->events != NULL) {
+        uart_event_t event = { .type = type, .size = size, .timeout_flag = false };
+        xQueueSend(uart->events, &event, 0);
+    }
+}
+
+/* Delivers one chunk into the receiving port, raising the same events the real RX ISR would. */
+static void deliver(t_host_uart *rx, uint8_t *chunk, size_t length) {
+    pthread_mutex_lock(&rx->lock);
+    if (!rx->installed) {
+        pthread_mutex_unlock(&rx->lock);
+        return;
+    }
+    bool pattern_seen = false;
+    for (size_t i = 0; i < length; i++) {
+        if (rx->pattern_enabled && chunk[i] == (uint8_t)rx->pattern_chr && rx->pattern_count < HOST_UART_PATTERN_MAX) {
+            rx->pattern_pos[(rx->pattern_head + rx->pattern_count) % HOST_UART_PATTERN_MAX] = rx->rx_total + i;
+            rx->pattern_count++;
+            pattern_seen = true;
+        }
+    }
+    size_t stored = ring_put(&rx->rx, chunk, length);
+    rx->rx_total += stored;
+    pthread_cond_broadcast(&rx->changed);
+    pthread_mutex_unlock(&rx->lock);
+    if (stored > 0) {
+        post_event(rx, UART_DATA, stored);
+    }
+    if (stored < length) {
+        post_event(rx, UART_BUFFER_FULL, length - stored);
+    }
+    if (pattern_seen) {
+        post_event(rx, UART_PATTERN_DET, 0);
+    }
+}
+
+static void *wire_thread(void *arg) {
+    t_host_uart *uart = arg;
+    uint8_t chunk[HOST_UART_CHUNK];
+    for (;;) {
+        pthread_mutex_lock(&uart->lock);
+        while (uart->installed && uart->tx.count == 0) {
+            uart->tx_busy = false;
+            pthread_cond_broadcast(&uart->changed);
+            pthread_cond_wait(&uart->changed, &uart->lock);
+        }
+        if (!uart->installed) {
+            pthread_mutex_unlock(&uart->lock);
+            return NULL;
+        }
+        uart->tx_busy = true;
+        size_t length = ring_get(&uart->tx, chunk, sizeof(chunk));
+        for (size_t i = 0; i < length && uart->error_one_in_n != 0; i++) {
+            if (++uart->error_counter >= uart->error_one_in_n) {
+                uart->error_counter = 0;
+                chunk[i] ^= 0x10;
+            }
+        }
+        int baud = uart->baud_rate;
+        t_host_uart *rx = &ports[uart->peer];
+        pthread_cond_broadcast(&uart->changed);
+        pthread_mutex_unlock(&uart->lock);
+
+        if (wire_pacing && baud > 0) {
+            /* 10 bit times per byte (start + 8 data + stop). */
+            uint64_t ns = (uint64_t)length * 10u * 1000000000ULL / (uint64_t)baud;
+            struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+            nanosleep(&ts, NULL);
+        }
+        deliver(rx, chunk, length);
+    }
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || rx_buffer_size <= UART_FIFO_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    t_host_uart *uart = &ports[uart_num];
+    pthread_mutex_lock(&uart->lock);
+    if (uart->installed) {
+        pthread_mutex_unlock(&uart->lock);
+        return ESP_FAIL;
+    }
+    pthread_cond_init(&uart->changed, host_monotonic_condattr());
+    uart->rx.size = (size_t)rx_buffer_size;
+    uart->rx.data = calloc(1, uart->rx.size);
+    uart->tx.size = (size_t)(tx_buffer_size > 0 ? tx_buffer_size : UART_FIFO_LEN);
+    uart->tx.data = calloc(1, uart->tx.size);
+    uart->rx.head = uart->rx.count = 0;
+    uart->tx.head = uart->tx.count = 0;
+    uart->events = NULL;
+    if (queue_size > 0 && uart_queue != NULL) {
+        uart->events = xQueueCreate((UBaseType_t)queue_size, sizeof(uart_event_t));
+        *uart_queue = uart->events;
+    }
+    uart->installed = true;
+    pthread_create(&uart->wire, NULL, wire_thread, uart);
+    pthread_detach(uart->wire);
+    pthread_mutex_unlock(&uart->lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num) {
+    t_host_uart *uart = &ports[uart_num];
+    pthread_mutex_lock(&uart->lock);
+    uart->installed = false;
+    pthread_cond_broadcast(&uart->changed);
+    pthread_mutex_unlock(&uart->lock);
+    return ESP_OK;
+}
+
+bool uart_is_driver_installed(uart_port_t uart_num) {
+    return uart_num >= 0 && uart_num < UART_NUM_MAX && ports[uart_num].installed;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) {
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || uart_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ports[uart_num].baud_rate = uart_config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num) {
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+    return (uart_num >= 0 && uart_num < UART_NUM_MAX) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size) {
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || !ports[uart_num].installed) {
+        return -1;
+    }
+    t_host_uart *uart = &ports[uart_num];
+    const uint8_t *bytes = src;
+    size_t written = 0;
+    pthread_mutex_lock(&uart->tx_mux);
+    pthread_mutex_lock(&uart->lock);
+    uart->write_calls++;
+    while (written < size) {
+        size_t n = ring_put(&uart->tx, bytes + written, size - written);
+        written += n;
+        pthread_cond_broadcast(&uart->changed);
+        if (written < size) {
+            pthread_cond_wait(&uart->changed, &uart->lock);
+        }
+    }
+    pthread_mutex_unlock(&uart->lock);
+    pthread_mutex_unlock(&uart->tx_mux);
+    return (int)written;
+}
+
+int uart_tx_chars(uart_port_t uart_num, const char *buffer, uint32_t len) {
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || !ports[uart_num].installed) {
+        return -1;
+    }
+    t_host_uart *uart = &ports[uart_num];
+    pthread_mutex_lock(&uart->lock);
+    uart->write_calls++;
+    size_t n = ring_put(&uart->tx, (const uint8_t *)buffer, len);
+    pthread_cond_broadcast(&uart->changed);
+    pthread_mutex_unlock(&uart->lock);
+    return (int)n;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait) {
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || !ports[uart_num].installed) {
+        return -1;
+    }
+    t_host_uart *uart = &ports[uart_num];
+    struct timespec deadline = deadline_after_ticks(ticks_to_wait);
+    size_t copied = 0;
+    pthread_mutex_lock(&uart->lock);
+    /* Like the real driver: keep waiting until the request is satisfied or the timeout expires. */
+    for (;;) {
+        copied += ring_get(&uart->rx, (uint8_t *)buf + copied, length - copied);
+        if (copied == length || !timed_wait(uart, ticks_to_wait, &deadline)) {
+            copied += ring_get(&uart->rx, (uint8_t *)buf + copied, length - copied);
+            break;
+        }
+    }
+    uart->rx_consumed += copied;
+    pthread_mutex_unlock(&uart->lock);
+    return (int)copied;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t uart_num, TickType_t ticks_to_wait) {
+    t_host_uart *uart = &ports[uart_num];
+    struct timespec deadline = deadline_after_ticks(ticks_to_wait);
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&uart->lock);
+    while (uart->tx.count != 0 || uart->tx_busy) {
+        if (!timed_wait(uart, ticks_to_wait, &deadline)) {
+            err = (uart->tx.count != 0 || uart->tx_busy) ? ESP_ERR_TIMEOUT : ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return err;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size) {
+    t_host_uart *uart = &ports[uart_num];
+    pthread_mutex_lock(&uart->lock);
+    *size = uart->rx.count;
+    pthread_mutex_unlock(&uart->lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    t_host_uart *uart = &ports[uart_num];
+    pthread_mutex_lock(&uart->lock);
+    uart->rx_consumed += uart->rx.count;
+    uart->rx.head = 0;
+    uart->rx.count = 0;
+    uart->pattern_count = 0;
+    pthread_mutex_unlock(&uart->lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_set_rx_full_threshold(uart_port_t uart_num, int threshold) {
+    return (uart_num >= 0 && uart_num < UART_NUM_MAX && threshold > 0 && threshold < UART_FIFO_LEN)
+           ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_rx_timeout(uart_port_t uart_num, const uint8_t tout_thresh) {
+    (void)tout_thresh;
+    return (uart_num >= 0 && uart_num < UART_NUM_MAX) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_enable_pattern_det_baud_intr(uart_port_t uart_num, char pattern_chr, uint8_t chr_num,
+                                            int chr_tout, int post_idle, int pre_idle) {
+    (void)chr_tout;
+    (void)post_idle;
+    (void)pre_idle;
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || chr_num != 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&ports[uart_num].lock);
+    ports[uart_num].pattern_chr = pattern_chr;
+    ports[uart_num].pattern_enabled = true;
+    pthread_mutex_unlock(&ports[uart_num].lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_disable_pattern_det_intr(uart_port_t uart_num) {
+    pthread_mutex_lock(&ports[uart_num].lock);
+    ports[uart_num].pattern_enabled = false;
+    pthread_mutex_unlock(&ports[uart_num].lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_pattern_queue_reset(uart_port_t uart_num, int queue_length) {
+    (void)queue_length;
+    pthread_mutex_lock(&ports[uart_num].lock);
+    ports[uart_num].pattern_head = 0;
+    ports[uart_num].pattern_count = 0;
+    pthread_mutex_unlock(&ports[uart_num].lock);
+    return ESP_OK;
+}
+
+int uart_pattern_pop_pos(uart_port_t uart_num) {
+    t_host_uart *uart = &ports[uart_num];
+    int pos = -1;
+    pthread_mutex_lock(&uart->lock);
+    while (uart->pattern_count > 0) {
+        uint64_t abs_pos = uart->pattern_pos[uart->pattern_head];
+        uart->pattern_head = (uart->pattern_head + 1) % HOST_UART_PATTERN_MAX;
+        uart->pattern_count--;
+        if (abs_pos >= uart->rx_consumed) {
+            pos = (int)(abs_pos - uart->rx_consumed);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return pos;
+}
+
+void host_uart_connect(uart_port_t tx_port, uart_port_t rx_port) {
+    ports[tx_port].peer = rx_port;
+}
+
+void host_uart_set_wire_pacing(bool enable) {
+    wire_pacing = enable;
+}
+
+void host_uart_set_error_rate(uart_port_t tx_port, uint32_t one_in_n) {
+    pthread_mutex_lock(&ports[tx_port].lock);
+    ports[tx_port].error_one_in_n = one_in_n;
+    ports[tx_port].error_counter = 0;
+    pthread_mutex_unlock(&ports[tx_port].lock);
+}
+
+uint64_t host_uart_write_calls(uart_port_t uart_num) {
+    return ports[uart_num].write_calls;
+}
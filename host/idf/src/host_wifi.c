@@ -0,0 +1,735 @@
+/******************************************************************************************************************************
+ File Name      : host_wifi.c
+ Description    : Host stand-in for esp_wifi, esp_netif, WPS, legacy esp_ping and the lwIP address helpers.
+                  A simulation task plays the radio: it scans, associates and leases addresses with configurable delays.
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_wps.h"
+#include "esp_ping.h"
+#include "lwip/ip4_addr.h"
+#include "lwip/dhcp.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#define HOST_WIFI_MAX_APS           16
+#define HOST_WIFI_CHANNELS          13
+#define HOST_WIFI_TASK_PRIORITY     19
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+typedef enum {
+    SIM_CONNECT,
+    SIM_SCAN,
+    SIM_RENEW
+} t_sim_command;
+
+typedef struct {
+    t_sim_command command;
+    uint32_t generation;
+} t_sim_request;
+
+struct esp_netif_obj {
+    bool dhcpc_running;
+    esp_netif_ip_info_t ip_info;
+    struct netif lwip_netif;
+    struct dhcp dhcp;
+};
+
+static pthread_mutex_t wifi_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static bool wifi_initialized;
+static bool wifi_started;
+static wifi_mode_t wifi_mode = WIFI_MODE_NULL;
+static wifi_config_t sta_config;
+static wifi_ps_type_t ps_type = WIFI_PS_MIN_MODEM;
+static t_host_wifi_ap aps[HOST_WIFI_MAX_APS];
+static int ap_count;
+static t_host_wifi_timing timing = { .scan_dwell_ms = 120, .auth_assoc_ms = 60, .dhcp_ms = 500 };
+static t_host_wifi_stats stats = {
+    .tx_power = 80,
+    .protocol = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N,
+    .bandwidth = WIFI_BW_HT20
+};
+static int connected_ap = -1;
+static bool connecting;
+static uint32_t link_generation;        // Bumped by every disconnect, so in-flight connects notice and give up
+static bool internet_reachable = true;
+static wifi_ap_record_t scan_records[HOST_WIFI_MAX_APS];
+static uint16_t scan_count;
+static struct esp_netif_obj sta_netif = { .dhcpc_running = true, .lwip_netif = { .dhcp = &sta_netif.dhcp } };
+static bool sta_netif_created;
+static QueueHandle_t sim_queue;
+
+/*==============================================================================================================================*/
+/* Simulation */
+
+static bool bssid_equal(const uint8_t a[6], const uint8_t b[6]) {
+    return memcmp(a, b, 6) == 0;
+}
+
+static void fill_record(wifi_ap_record_t *record, const t_host_wifi_ap *ap) {
+    memset(record, 0, sizeof(*record));
+    memcpy(record->bssid, ap->bssid, 6);
+    memcpy(record->ssid, ap->ssid, strnlen(ap->ssid, sizeof(record->ssid) - 1));
+    record->primary = ap->channel;
+    record->rssi = ap->rssi;
+    record->authmode = ap->password[0] != '\0' ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+    record->phy_11b = record->phy_11g = record->phy_11n = 1;
+}
+
+static void post_disconnected(const wifi_sta_config_t *config, const uint8_t *bssid, uint8_t reason) {
+    wifi_event_sta_disconnected_t event = { .reason = reason };
+    memcpy(event.ssid, config->ssid, sizeof(event.ssid));
+    event.ssid_len = (uint8_t)strnlen((const char *)config->ssid, sizeof(config->ssid));
+    if (bssid != NULL) {
+        memcpy(event.bssid, bssid, 6);
+    }
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event), portMAX_DELAY);
+}
+
+/* Sleeps, then reports whether the attempt identified by generation is still current. Takes the lock on success. */
+static bool sim_delay_and_lock(uint32_t ms, uint32_t generation) {
+    if (ms > 0) {
+        vTaskDelay(pdMS_TO_TICKS(ms));
+    }
+    pthread_mutex_lock(&wifi_lock);
+    if (generation != link_generation) {
+        pthread_mutex_unlock(&wifi_lock);
+        return false;
+    }
+    return true;
+}
+
+/* Hands out the AP's lease. Called with the lock held. */
+static void sim_lease_locked(const t_host_wifi_ap *ap, ip_event_got_ip_t *got_ip) {
+    stats.dhcp_leases++;
+    got_ip->ip_changed = sta_netif.ip_info.ip.addr != ap->lease.ip.addr;
+    sta_netif.ip_info = ap->lease;
+    sta_netif.dhcp.offered_t0_lease = ap->lease_time_s != 0 ? ap->lease_time_s : 86400;
+    sta_netif.dhcp.offered_t1_renew = sta_netif.dhcp.offered_t0_lease / 2;
+    sta_netif.dhcp.offered_t2_rebind = sta_netif.dhcp.offered_t0_lease / 8 * 7;
+}
+
+static void sim_connect(uint32_t generation) {
+    pthread_mutex_lock(&wifi_lock);
+    wifi_sta_config_t config = sta_config.sta;
+    pthread_mutex_unlock(&wifi_lock);
+
+    // A known channel is scanned first; a fast scan stops at the first match
+    uint8_t order[HOST_WIFI_CHANNELS];
+    int channels = 0;
+    if (config.channel >= 1 && config.channel <= HOST_WIFI_CHANNELS) {
+        order[channels++] = config.channel;
+    }
+    for (uint8_t ch = 1; ch <= HOST_WIFI_CHANNELS; ch++) {
+        if (ch != config.channel) {
+            order[channels++] = ch;
+        }
+    }
+
+    int found = -1;
+    for (int i = 0; i < channels; i++) {
+        if (!sim_delay_and_lock(timing.scan_dwell_ms, generation)) {
+            return;
+        }
+        stats.channels_scanned++;
+        for (int a = 0; a < ap_count; a++) {
+            const t_host_wifi_ap *ap = &aps[a];
+            if (ap->up && ap->channel == order[i] && strncmp(ap->ssid, (const char *)config.ssid, 32) == 0 &&
+                (!config.bssid_set || bssid_equal(ap->bssid, config.bssid)) &&
+                (found < 0 || ap->rssi > aps[found].rssi)) {
+                found = a;
+            }
+        }
+        pthread_mutex_unlock(&wifi_lock);
+        if (found >= 0 && config.scan_method == WIFI_FAST_SCAN) {
+            break;
+        }
+    }
+    if (found < 0) {
+        pthread_mutex_lock(&wifi_lock);
+        bool current = generation == link_generation;
+        if (current) {
+            connecting = false;
+        }
+        pthread_mutex_unlock(&wifi_lock);
+        if (current) {
+            post_disconnected(&config, NULL, WIFI_REASON_NO_AP_FOUND);
+        }
+        return;
+    }
+
+    if (!sim_delay_and_lock(timing.auth_assoc_ms, generation)) {
+        return;
+    }
+    t_host_wifi_ap ap = aps[found];
+    if (!ap.up || strncmp(ap.password, (const char *)config.password, 64) != 0) {
+        connecting = false;
+        pthread_mutex_unlock(&wifi_lock);
+        post_disconnected(&config, ap.bssid, ap.up ? WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT : WIFI_REASON_NO_AP_FOUND);
+        return;
+    }
+    connected_ap = found;
+    connecting = false;
+    bool dhcp = sta_netif.dhcpc_running;
+    pthread_mutex_unlock(&wifi_lock);
+
+    wifi_event_sta_connected_t connected = { .channel = ap.channel };
+    memcpy(connected.ssid, ap.ssid, sizeof(connected.ssid));
+    connected.ssid_len = (uint8_t)strnlen(ap.ssid, sizeof(connected.ssid));
+    memcpy(connected.bssid, ap.bssid, 6);
+    connected.authmode = ap.password[0] != '\0' ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &connected, sizeof(connected), portMAX_DELAY);
+
+    // A static address is usable at once; otherwise wait for the lease
+    if (!sim_delay_and_lock(dhcp ? timing.dhcp_ms : 0, generation)) {
+        return;
+    }
+    ip_event_got_ip_t got_ip = { .esp_netif = &sta_netif };
+    if (dhcp) {
+        sim_lease_locked(&ap, &got_ip);
+    }
+    got_ip.ip_info = sta_netif.ip_info;
+    pthread_mutex_unlock(&wifi_lock);
+    esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), portMAX_DELAY);
+}
+
+/* A DHCP client started on an associated station: one more lease from the same AP. */
+static void sim_renew(uint32_t generation) {
+    if (!sim_delay_and_lock(timing.dhcp_ms, generation)) {
+        return;
+    }
+    if (connected_ap < 0 || !sta_netif.dhcpc_running) {
+        pthread_mutex_unlock(&wifi_lock);
+        return;
+    }
+    t_host_wifi_ap ap = aps[connected_ap];
+    ip_event_got_ip_t got_ip = { .esp_netif = &sta_netif };
+    sim_lease_locked(&ap, &got_ip);
+    got_ip.ip_info = sta_netif.ip_info;
+    pthread_mutex_unlock(&wifi_lock);
+    esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), portMAX_DELAY);
+}
+
+static void sim_scan(void) {
+    uint16_t count = 0;
+    for (uint8_t ch = 1; ch <= HOST_WIFI_CHANNELS; ch++) {
+        vTaskDelay(pdMS_TO_TICKS(timing.scan_dwell_ms));
+        pthread_mutex_lock(&wifi_lock);
+        stats.channels_scanned++;
+        for (int a = 0; a < ap_count; a++) {
+            if (aps[a].up && aps[a].channel == ch && count < HOST_WIFI_MAX_APS) {
+                fill_record(&scan_records[count++], &aps[a]);
+            }
+        }
+        pthread_mutex_unlock(&wifi_lock);
+    }
+    pthread_mutex_lock(&wifi_lock);
+    scan_count = count;
+    pthread_mutex_unlock(&wifi_lock);
+    wifi_event_sta_scan_done_t done = { .status = 0, .number = (uint8_t)count };
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &done, sizeof(done), portMAX_DELAY);
+}
+
+static void sim_task(void *arg) {
+    (void)arg;
+    t_sim_request request;
+
+    for (;;) {
+        if (xQueueReceive(sim_queue, &request, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (request.command == SIM_CONNECT) {
+            sim_connect(request.generation);
+        } else if (request.command == SIM_RENEW) {
+            sim_renew(request.generation);
+        } else {
+            sim_scan();
+        }
+    }
+}
+
+/* Ends the association or connection attempt in progress. Returns true if one existed. Called with the lock held. */
+static bool drop_link_locked(wifi_sta_config_t *config, uint8_t bssid[6]) {
+    bool had_link = connected_ap >= 0 || connecting;
+    *config = sta_config.sta;
+    memset(bssid, 0, 6);
+    if (connected_ap >= 0) {
+        memcpy(bssid, aps[connected_ap].bssid, 6);
+    }
+    link_generation++;
+    connected_ap = -1;
+    connecting = false;
+    if (sta_netif.dhcpc_running) {
+        memset(&sta_netif.ip_info, 0, sizeof(sta_netif.ip_info));
+    }
+    return had_link;
+}
+
+/*==============================================================================================================================*/
+/* esp_wifi */
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) {
+    if (config == NULL || config->magic != WIFI_INIT_CONFIG_MAGIC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    if (sim_queue == NULL) {
+        sim_queue = xQueueCreate(8, sizeof(t_sim_request));
+        xTaskCreate(sim_task, "wifi_sim", 4096, NULL, HOST_WIFI_TASK_PRIORITY, NULL);
+    }
+    wifi_initialized = true;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit(void) {
+    esp_wifi_stop();
+    pthread_mutex_lock(&wifi_lock);
+    wifi_initialized = false;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) {
+    if (mode >= WIFI_MODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = wifi_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+    if (err == ESP_OK) {
+        wifi_mode = mode;
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t *mode) {
+    pthread_mutex_lock(&wifi_lock);
+    *mode = wifi_mode;
+    pthread_mutex_unlock(&wifi_lock);
+    return wifi_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_start(void) {
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = wifi_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+    bool post = err == ESP_OK && !wifi_started;
+    if (err == ESP_OK) {
+        wifi_started = true;
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    if (post) {
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0, portMAX_DELAY);
+    }
+    return err;
+}
+
+esp_err_t esp_wifi_stop(void) {
+    wifi_sta_config_t config;
+    uint8_t bssid[6];
+    pthread_mutex_lock(&wifi_lock);
+    if (!wifi_started) {
+        pthread_mutex_unlock(&wifi_lock);
+        return wifi_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+    }
+    bool was_connected = connected_ap >= 0;
+    drop_link_locked(&config, bssid);
+    wifi_started = false;
+    pthread_mutex_unlock(&wifi_lock);
+    if (was_connected) {
+        post_disconnected(&config, bssid, WIFI_REASON_ASSOC_LEAVE);
+    }
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_STOP, NULL, 0, portMAX_DELAY);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void) {
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = !wifi_initialized ? ESP_ERR_WIFI_NOT_INIT : !wifi_started ? ESP_ERR_WIFI_NOT_STARTED : ESP_OK;
+    // Calls while an attempt is running or the link is up are absorbed, as the driver does
+    if (err == ESP_OK && !connecting && connected_ap < 0) {
+        connecting = true;
+        stats.connect_attempts++;
+        t_sim_request request = { .command = SIM_CONNECT, .generation = link_generation };
+        xQueueSend(sim_queue, &request, portMAX_DELAY);
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+esp_err_t esp_wifi_disconnect(void) {
+    wifi_sta_config_t config;
+    uint8_t bssid[6];
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = !wifi_initialized ? ESP_ERR_WIFI_NOT_INIT : !wifi_started ? ESP_ERR_WIFI_NOT_STARTED : ESP_OK;
+    bool had_link = err == ESP_OK && drop_link_locked(&config, bssid);
+    pthread_mutex_unlock(&wifi_lock);
+    if (had_link) {
+        post_disconnected(&config, bssid, WIFI_REASON_ASSOC_LEAVE);
+    }
+    return err;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf) {
+    if (conf == NULL || interface != WIFI_IF_STA) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = wifi_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+    if (err == ESP_OK) {
+        sta_config = *conf;
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf) {
+    if (conf == NULL || interface != WIFI_IF_STA) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    *conf = sta_config;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_protocol(wifi_interface_t ifx, uint8_t protocol_bitmap) {
+    (void)ifx;
+    pthread_mutex_lock(&wifi_lock);
+    stats.protocol = protocol_bitmap;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_protocol(wifi_interface_t ifx, uint8_t *protocol_bitmap) {
+    (void)ifx;
+    *protocol_bitmap = stats.protocol;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t bw) {
+    (void)ifx;
+    if (bw != WIFI_BW_HT20 && bw != WIFI_BW_HT40) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    stats.bandwidth = bw;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t *bw) {
+    (void)ifx;
+    *bw = stats.bandwidth;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_max_tx_power(int8_t power) {
+    if (power < 8 || power > 84) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = wifi_started ? ESP_OK : ESP_ERR_WIFI_NOT_STARTED;
+    if (err == ESP_OK) {
+        stats.tx_power = power;
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+esp_err_t esp_wifi_get_max_tx_power(int8_t *power) {
+    *power = stats.tx_power;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type) {
+    ps_type = type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t *type) {
+    *type = ps_type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_channel(uint8_t *primary, wifi_second_chan_t *second) {
+    pthread_mutex_lock(&wifi_lock);
+    *primary = connected_ap >= 0 ? aps[connected_ap].channel : 1;
+    *second = WIFI_SECOND_CHAN_NONE;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info) {
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = connected_ap >= 0 ? ESP_OK : ESP_ERR_WIFI_NOT_CONNECT;
+    if (err == ESP_OK) {
+        fill_record(ap_info, &aps[connected_ap]);
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+esp_err_t esp_wifi_set_rssi_threshold(int32_t rssi) {
+    (void)rssi;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block) {
+    (void)config;
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = !wifi_initialized ? ESP_ERR_WIFI_NOT_INIT : !wifi_started ? ESP_ERR_WIFI_NOT_STARTED : ESP_OK;
+    pthread_mutex_unlock(&wifi_lock);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (block) {
+        sim_scan();
+    } else {
+        t_sim_request request = { .command = SIM_SCAN };
+        xQueueSend(sim_queue, &request, portMAX_DELAY);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number) {
+    pthread_mutex_lock(&wifi_lock);
+    *number = scan_count;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records) {
+    pthread_mutex_lock(&wifi_lock);
+    if (*number > scan_count) {
+        *number = scan_count;
+    }
+    memcpy(ap_records, scan_records, *number * sizeof(*ap_records));
+    scan_count = 0;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+/*==============================================================================================================================*/
+/* esp_wps (accepted, no simulated registrar) */
+
+esp_err_t esp_wifi_wps_enable(const esp_wps_config_t *config) {
+    return config != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_wifi_wps_disable(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_wps_start(int timeout_ms) {
+    (void)timeout_ms;
+    return ESP_OK;
+}
+
+/*==============================================================================================================================*/
+/* esp_netif */
+
+esp_err_t esp_netif_init(void) {
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void) {
+    pthread_mutex_lock(&wifi_lock);
+    sta_netif_created = true;
+    pthread_mutex_unlock(&wifi_lock);
+    return &sta_netif;
+}
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key) {
+    return (sta_netif_created && strcmp(if_key, "WIFI_STA_DEF") == 0) ? &sta_netif : NULL;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif, esp_netif_ip_info_t *ip_info) {
+    if (esp_netif == NULL || ip_info == NULL) {
+        return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    *ip_info = esp_netif->ip_info;
+    pthread_mutex_unlock(&wifi_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_set_ip_info(esp_netif_t *esp_netif, const esp_netif_ip_info_t *ip_info) {
+    if (esp_netif == NULL || ip_info == NULL) {
+        return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+    }
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = esp_netif->dhcpc_running ? ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED : ESP_OK;
+    if (err == ESP_OK) {
+        esp_netif->ip_info = *ip_info;
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *esp_netif) {
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = esp_netif->dhcpc_running ? ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED : ESP_OK;
+    esp_netif->dhcpc_running = true;
+    // Associated already (e.g. on a reused address): the client leases at once
+    if (err == ESP_OK && connected_ap >= 0 && !connecting && sim_queue != NULL) {
+        t_sim_request request = { .command = SIM_RENEW, .generation = link_generation };
+        xQueueSend(sim_queue, &request, portMAX_DELAY);
+    }
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+void *esp_netif_get_netif_impl(esp_netif_t *esp_netif) {
+    return esp_netif != NULL ? &esp_netif->lwip_netif : NULL;
+}
+
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif) {
+    pthread_mutex_lock(&wifi_lock);
+    esp_err_t err = esp_netif->dhcpc_running ? ESP_OK : ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED;
+    esp_netif->dhcpc_running = false;
+    pthread_mutex_unlock(&wifi_lock);
+    return err;
+}
+
+/*==============================================================================================================================*/
+/* Legacy esp_ping */
+
+static ip4_addr_t ping_target;
+
+esp_err_t esp_ping_set_target(ping_target_id_t opt_id, void *opt_val, uint32_t opt_len) {
+    if (opt_val == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (opt_id == PING_TARGET_IP_ADDRESS && opt_len == sizeof(ping_target)) {
+        memcpy(&ping_target, opt_val, sizeof(ping_target));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ping_get_target(ping_target_id_t opt_id, void *opt_val, uint32_t opt_len) {
+    if (opt_val == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (opt_id == PING_TARGET_IP_ADDRESS && opt_len == sizeof(ping_target)) {
+        memcpy(opt_val, &ping_target, sizeof(ping_target));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ping_result(uint8_t res_val, uint16_t res_len, uint32_t res_time) {
+    (void)res_len;
+    (void)res_time;
+    return (res_val == PING_RES_OK && host_wifi_internet_reachable()) ? ESP_OK : ESP_FAIL;
+}
+
+/*==============================================================================================================================*/
+/* lwIP helpers */
+
+int ip4addr_aton(const char *cp, ip4_addr_t *addr) {
+    struct in_addr parsed;
+    if (inet_pton(AF_INET, cp, &parsed) != 1) {
+        return 0;
+    }
+    addr->addr = parsed.s_addr;
+    return 1;
+}
+
+char *ip4addr_ntoa(const ip4_addr_t *addr) {
+    static char text[16];
+    const uint8_t *bytes = (const uint8_t *)&addr->addr;
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return text;
+}
+
+/*==============================================================================================================================*/
+/* Host hooks */
+
+void host_wifi_add_ap(const t_host_wifi_ap *ap) {
+    pthread_mutex_lock(&wifi_lock);
+    if (ap_count < HOST_WIFI_MAX_APS) {
+        aps[ap_count++] = *ap;
+    }
+    pthread_mutex_unlock(&wifi_lock);
+}
+
+void host_wifi_clear_aps(void) {
+    wifi_sta_config_t config;
+    uint8_t bssid[6];
+    pthread_mutex_lock(&wifi_lock);
+    bool was_connected = connected_ap >= 0;
+    drop_link_locked(&config, bssid);
+    ap_count = 0;
+    pthread_mutex_unlock(&wifi_lock);
+    if (was_connected) {
+        post_disconnected(&config, bssid, WIFI_REASON_BEACON_TIMEOUT);
+    }
+}
+
+void host_wifi_set_ap_up(const uint8_t bssid[6], bool up) {
+    pthread_mutex_lock(&wifi_lock);
+    for (int a = 0; a < ap_count; a++) {
+        if (bssid_equal(aps[a].bssid, bssid)) {
+            aps[a].up = up;
+        }
+    }
+    bool lost = !up && connected_ap >= 0 && bssid_equal(aps[connected_ap].bssid, bssid);
+    pthread_mutex_unlock(&wifi_lock);
+    if (lost) {
+        host_wifi_drop_link(WIFI_REASON_BEACON_TIMEOUT);
+    }
+}
+
+void host_wifi_set_ap_rssi(const uint8_t bssid[6], int8_t rssi) {
+    pthread_mutex_lock(&wifi_lock);
+    for (int a = 0; a < ap_count; a++) {
+        if (bssid_equal(aps[a].bssid, bssid)) {
+            aps[a].rssi = rssi;
+        }
+    }
+    pthread_mutex_unlock(&wifi_lock);
+}
+
+void host_wifi_set_timing(const t_host_wifi_timing *new_timing) {
+    pthread_mutex_lock(&wifi_lock);
+    timing = *new_timing;
+    pthread_mutex_unlock(&wifi_lock);
+}
+
+void host_wifi_drop_link(uint8_t reason) {
+    wifi_sta_config_t config;
+    uint8_t bssid[6];
+    pthread_mutex_lock(&wifi_lock);
+    bool had_link = drop_link_locked(&config, bssid);
+    pthread_mutex_unlock(&wifi_lock);
+    if (had_link) {
+        post_disconnected(&config, bssid, reason);
+    }
+}
+
+void host_wifi_set_internet(bool reachable) {
+    pthread_mutex_lock(&wifi_lock);
+    internet_reachable = reachable;
+    pthread_mutex_unlock(&wifi_lock);
+}
+
+bool host_wifi_internet_reachable(void) {
+    pthread_mutex_lock(&wifi_lock);
+    bool reachable = internet_reachable && connected_ap >= 0 && sta_netif.ip_info.ip.addr != 0;
+    pthread_mutex_unlock(&wifi_lock);
+    return reachable;
+}
+
+void host_wifi_get_stats(t_host_wifi_stats *out) {
+    pthread_mutex_lock(&wifi_lock);
+    *out = stats;
+    pthread_mutex_unlock(&wifi_lock);
+}
@@ -0,0 +1,221 @@
+/******************************************************************************************************************************
+ File Name      : flash_log_test.c
+ Description    : Host fault-injection test for the flash record log: cuts the power at every flash write and erase of an
+                  append workload (clean cut and torn write) and checks that the reopened log holds every synced record,
+                  in sequence and intact, and keeps accepting appends
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "FLASH_LOG/MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG.h"
+
+#define TEST_BASE_FILE      "flash_log_test_base.bin"
+#define TEST_WORK_FILE      "flash_log_test_work.bin"
+#define TEST_LABEL          "flashlog"
+#define TEST_SECTORS        4
+#define TEST_BASE_RECORDS   40      // Already on flash before the cut run
+#define TEST_RECORDS        160     // Appended by each cut run: wraps the 4-sector ring
+#define TEST_SYNC_EVERY     3
+
+static int failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                        \
+        printf("\n");                               \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+/* Record contents are a function of the sequence, so the reader can check any record it finds. */
+static size_t make_record(tlong seq, tbyte *data) {
+    size_t length = 1 + (seq * 53) % 300;
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (tbyte)(seq * 31 + i);
+    }
+    return length;
+}
+
+static esp_err_t append_next(t_flash_log *log, tlong *seq) {
+    tbyte data[FLASH_LOG_MAX_RECORD];
+    t_flash_log_info info;
+    Flash_Log_Get_Info(log, &info);
+    size_t length = make_record(info.next_seq, data);
+    esp_err_t err = Flash_Log_Append(log, data, length, seq);
+    if (err == ESP_OK && *seq != info.next_seq) {
+        return ESP_FAIL;
+    }
+    return err;
+}
+
+static void copy_file(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    FILE *out = fopen(to, "wb");
+    char buffer[4096];
+    size_t got;
+    while (in != NULL && out != NULL && (got = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, got, out);
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+}
+
+/*
+ * Reads the whole log back. Records must be consecutive and intact, and every record up to 'synced' must still be
+ * there (the ring only ever drops the oldest ones). Returns the number of records, or -1 after a failed check.
+ */
+static int verify_log(t_flash_log *log, tlong synced, const char *label, int cut) {
+    t_flash_log_iter iter;
+    t_flash_log_info info;
+    tbyte data[FLASH_LOG_MAX_RECORD];
+    tbyte expected[FLASH_LOG_MAX_RECORD];
+    size_t length;
+    tlong seq;
+    tlong last = 0;
+    int records = 0;
+
+    Flash_Log_Get_Info(log, &info);
+    CHECK(Flash_Log_Iter_Init(log, FLASH_LOG_SEQ_OLDEST, &iter) == ESP_OK, "%s, cut %d: iterator", label, cut);
+    while (Flash_Log_Read_Next(&iter, data, sizeof(data), &length, &seq) == ESP_OK) {
+        if (records == 0 ? seq != info.first_seq : seq != last + 1) {
+            CHECK(false, "%s, cut %d: record %lu after %lu", label, cut, (unsigned long)seq, (unsigned long)last);
+            return -1;
+        }
+        if (length != make_record(seq, expected) || memcmp(data, expected, length) != 0) {
+            CHECK(false, "%s, cut %d: record %lu corrupt (%u bytes)", label, cut, (unsigned long)seq, (unsigned)length);
+            return -1;
+        }
+        last = seq;
+        records++;
+    }
+    CHECK(records == 0 || info.next_seq == last + 1, "%s, cut %d: next_seq %lu after record %lu", label, cut,
+          (unsigned long)info.next_seq, (unsigned long)last);
+    if (records == 0 || last < synced) {
+        CHECK(false, "%s, cut %d: synced record %lu missing (last %lu)", label, cut, (unsigned long)synced,
+              (unsigned long)last);
+        return -1;
+    }
+    return records;
+}
+
+/* Appends TEST_RECORDS, syncing every few, and reports each synced sequence on 'progress'. Never returns. */
+static void child_workload(int progress, int cut, size_t torn_bytes) {
+    t_flash_log *log;
+    host_partition_reload();
+    if (Flash_Log_Open(TEST_LABEL, &log) != ESP_OK) {
+        _exit(1);
+    }
+    host_partition_power_cut_after(cut, torn_bytes);
+    for (int i = 1; i <= TEST_RECORDS; i++) {
+        tlong seq;
+        if (append_next(log, &seq) != ESP_OK) {
+            _exit(1);
+        }
+        if (i % TEST_SYNC_EVERY == 0) {
+            if (Flash_Log_Sync(log) != ESP_OK) {
+                _exit(1);
+            }
+            if (write(progress, &seq, sizeof(seq)) != sizeof(seq)) {
+                _exit(1);
+            }
+        }
+    }
+    _exit(Flash_Log_Close(log) == ESP_OK ? 0 : 1);
+}
+
+/* Replays the workload with the power cut after 0, 1, 2, ... writes/erases until one run completes. */
+static void run_power_cuts(const char *label, size_t torn_bytes, tlong base_synced) {
+    int cuts = 0;
+    int torn_seen = 0;
+
+    for (int cut = 0; cut < 10000; cut++) {
+        int pipe_fds[2];
+        copy_file(TEST_BASE_FILE, TEST_WORK_FILE);
+        if (pipe(pipe_fds) != 0) {
+            CHECK(false, "%s: pipe", label);
+            return;
+        }
+        fflush(NULL);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(pipe_fds[0]);
+            child_workload(pipe_fds[1], cut, torn_bytes);
+        }
+        close(pipe_fds[1]);
+        tlong synced = base_synced;
+        tlong seq;
+        while (read(pipe_fds[0], &seq, sizeof(seq)) == sizeof(seq)) {
+            synced = seq;
+        }
+        close(pipe_fds[0]);
+        int status;
+        waitpid(pid, &status, 0);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        CHECK(code == 0 || code == HOST_PARTITION_POWER_CUT_EXIT, "%s: workload exited with %d", label, code);
+
+        // Reboot onto what reached flash
+        t_flash_log *log;
+        t_flash_log_stats stats;
+        host_partition_reload();
+        if (Flash_Log_Open(TEST_LABEL, &log) != ESP_OK) {
+            CHECK(false, "%s, cut %d: open after the cut failed", label, cut);
+            continue;
+        }
+        Flash_Log_Get_Stats(log, &stats);
+        torn_seen += stats.torn_records > 0;
+        verify_log(log, synced, label, cut);
+
+        // The log must stay usable: a new record survives the next reboot
+        tlong appended = 0;
+        CHECK(append_next(log, &appended) == ESP_OK && Flash_Log_Close(log) == ESP_OK, "%s, cut %d: append after cut",
+              label, cut);
+        host_partition_reload();
+        if (Flash_Log_Open(TEST_LABEL, &log) == ESP_OK) {
+            verify_log(log, appended, label, cut);
+            Flash_Log_Close(log);
+        } else {
+            CHECK(false, "%s, cut %d: second open failed", label, cut);
+        }
+
+        if (code != HOST_PARTITION_POWER_CUT_EXIT) {
+            break;
+        }
+        cuts++;
+    }
+    printf("%-26s %4d cut points, %3d with a torn record\n", label, cuts, torn_seen);
+    CHECK(cuts > 0 && (torn_bytes == 0 || torn_seen > 0), "%s: the cuts never hit a record write", label);
+}
+
+int main(void) {
+    t_flash_log *log;
+    tlong seq = 0;
+
+    remove(TEST_WORK_FILE);
+    if (host_partition_add(TEST_LABEL, FLASH_LOG_PARTITION_SUBTYPE, TEST_SECTORS * FLASH_LOG_SECTOR_SIZE,
+                           TEST_WORK_FILE) != ESP_OK || Flash_Log_Open(TEST_LABEL, &log) != ESP_OK) {
+        printf("FAILED: cannot open the test partition\n");
+        return 1;
+    }
+    for (int i = 0; i < TEST_BASE_RECORDS; i++) {
+        CHECK(append_next(log, &seq) == ESP_OK, "base record %d", i);
+    }
+    CHECK(Flash_Log_Close(log) == ESP_OK, "base close");
+    copy_file(TEST_WORK_FILE, TEST_BASE_FILE);
+
+    run_power_cuts("clean cut", 0, seq);
+    run_power_cuts("torn write (7 bytes)", 7, seq);
+    run_power_cuts("torn write (130 bytes)", 130, seq);
+
+    remove(TEST_BASE_FILE);
+    remove(TEST_WORK_FILE);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/******************************************************************************************************************************
+ File Name      : gpio_capture_test.c
+ Description    : Host test for GPIO capture: a triggered capture keeps exactly the pre/post-trigger window, the export
+                  replays to the levels that were written, and gpio_capture_vcd converts it (and rejects a damaged one)
+ Device(s)      : Host (Linux)
+ Usage          : gpio_capture_test <path to gpio_capture_vcd>
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include "CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.h"
+
+#define TEST_FILE           "gpio_capture_test.bin"
+#define TEST_CLK            Pin_4
+#define TEST_FAULT          Pin_5   // Trigger: goes high once
+#define TEST_PRE            4
+#define TEST_POST           8
+#define TEST_TOGGLES_BEFORE 10
+#define TEST_TOGGLES_AFTER  20
+#define TEST_WRITES         (TEST_TOGGLES_BEFORE + 1 + TEST_TOGGLES_AFTER)
+
+static int failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                        \
+        printf("\n");                               \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+/* What each write changed, in pins, as the capture should report it */
+typedef struct {
+    t_gpio_mask changed;
+    t_gpio_mask levels;
+} t_write;
+
+static t_write writes[TEST_WRITES];
+
+static tword get_le16(const tbyte *in) {
+    return (tword)(in[0] | (in[1] << 8));
+}
+
+static tlong get_le32(const tbyte *in) {
+    return get_le16(in) | ((tlong)get_le16(in + 2) << 16);
+}
+
+static t_gpio_mask channels_to_pins(tword channels, const tbyte *channel_pin) {
+    t_gpio_mask pins = 0;
+    for (int ch = 0; ch < GPIO_CAPTURE_CHANNELS; ch++) {
+        if (channels & (1u << ch)) {
+            pins |= GPIO_PIN_MASK(channel_pin[ch]);
+        }
+    }
+    return pins;
+}
+
+static void write_pin(int index, tpin pin, tlong level) {
+    GPIO_Value_Set(pin, level);
+    writes[index].changed = GPIO_PIN_MASK(pin);
+    writes[index].levels = level ? GPIO_PIN_MASK(pin) : 0;
+}
+
+/* Checks the export against the writes: header fields, CRC, and the records of the trigger window in order. */
+static void check_export(const tbyte *image, size_t length) {
+    CHECK(length >= GPIO_CAPTURE_HEADER_SIZE + 4 && get_le32(image) == GPIO_CAPTURE_MAGIC &&
+          image[4] == GPIO_CAPTURE_VERSION, "bad header");
+    CHECK(image[5] == 2 && (image[6] & 1), "%u channels, flags 0x%02x", image[5], image[6]);
+    tlong count = get_le32(image + 8);
+    tlong trigger = get_le32(image + 12);
+    const tbyte *channel_pin = image + 20;
+    CHECK(length == GPIO_CAPTURE_HEADER_SIZE + count * GPIO_CAPTURE_RECORD_SIZE + 4, "length %zu for %lu records",
+          length, (unsigned long)count);
+    CHECK(CRC32_Update(CRC32_INIT, image, length - 4) == get_le32(image + length - 4), "CRC mismatch");
+
+    // Levels before the first record: TEST_CLK after the last write that fell out of the pre-trigger window
+    t_gpio_mask levels = channels_to_pins(get_le16(image + 18), channel_pin);
+    int first = TEST_TOGGLES_BEFORE - TEST_PRE;
+    CHECK((levels & GPIO_PIN_MASK(TEST_CLK)) == writes[first - 1].levels && !(levels & GPIO_PIN_MASK(TEST_FAULT)),
+          "base levels 0x%llx", (unsigned long long)levels);
+
+    int matched = 0;
+    for (tlong i = 0; i < count; i++) {
+        const tbyte *record = image + GPIO_CAPTURE_HEADER_SIZE + i * GPIO_CAPTURE_RECORD_SIZE;
+        tword changed = get_le16(record + 4);
+        if (changed == 0) {
+            continue;   // Time mark
+        }
+        const t_write *expected = &writes[first + matched];
+        t_gpio_mask pins = channels_to_pins(changed, channel_pin);
+        t_gpio_mask values = channels_to_pins(get_le16(record + 6) & changed, channel_pin);
+        CHECK(first + matched < TEST_WRITES && pins == expected->changed && values == expected->levels,
+              "record %lu: changed 0x%llx to 0x%llx", (unsigned long)i, (unsigned long long)pins,
+              (unsigned long long)values);
+        if (first + matched == TEST_TOGGLES_BEFORE) {
+            CHECK(i == trigger, "trigger index %lu, trigger write is record %lu", (unsigned long)trigger, (unsigned long)i);
+        }
+        matched++;
+    }
+    CHECK(matched == TEST_PRE + 1 + TEST_POST, "%d records in the window", matched);
+}
+
+/* Runs the converter; returns its exit status and counts the value changes and trigger marks it printed. */
+static int run_vcd(const char *tool, int *changes, int *marks) {
+    char command[512];
+    char line[256];
+    bool body = false;
+    snprintf(command, sizeof(command), "\"%s\" %s 2>/dev/null", tool, TEST_FILE);
+    FILE *vcd = popen(command, "r");
+    *changes = 0;
+    *marks = 0;
+    if (vcd == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), vcd) != NULL) {
+        if (strcmp(line, "$end\n") == 0) {
+            body = true;        // End of $dumpvars: value changes follow
+        } else if (body && (line[0] == '0' || line[0] == '1')) {
+            *changes += line[1] != '~';
+            *marks += line[1] == '~';
+        }
+    }
+    int status = pclose(vcd);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int main(int argc, char **argv) {
+    static tbyte image[GPIO_CAPTURE_MAX_SIZE];
+    t_gpio_capture_config config = {
+        .pins = GPIO_PIN_MASK(TEST_CLK) | GPIO_PIN_MASK(TEST_FAULT),
+        .trigger_mask = GPIO_PIN_MASK(TEST_FAULT),
+        .trigger_levels = GPIO_PIN_MASK(TEST_FAULT),
+        .pre_trigger = TEST_PRE,
+        .post_trigger = TEST_POST,
+    };
+    t_gpio_capture_status status;
+    size_t length = 0;
+
+    if (argc != 2) {
+        printf("usage: %s <gpio_capture_vcd>\n", argv[0]);
+        return 2;
+    }
+    GPIO_Output_Init(TEST_CLK, 0);
+    GPIO_Output_Init(TEST_FAULT, 0);
+    CHECK(GPIO_Capture_Arm(&config) == ESP_OK, "arm");
+    int w = 0;
+    for (int i = 1; i <= TEST_TOGGLES_BEFORE; i++) {
+        write_pin(w++, TEST_CLK, i & 1);
+    }
+    write_pin(w++, TEST_FAULT, 1);
+    for (int i = 1; i <= TEST_TOGGLES_AFTER; i++) {
+        write_pin(w++, TEST_CLK, (TEST_TOGGLES_BEFORE + i) & 1);
+    }
+    GPIO_Capture_Get_Status(&status);
+    CHECK(status.state == capture_done, "state %d after the post-trigger records", (int)status.state);
+
+    CHECK(GPIO_Capture_Serialize(image, sizeof(image), &length) == ESP_OK, "serialize");
+    check_export(image, length);
+
+    FILE *file = fopen(TEST_FILE, "wb");
+    if (file != NULL) {
+        fwrite(image, 1, length, file);
+        fclose(file);
+    }
+    int changes, marks;
+    int code = run_vcd(argv[1], &changes, &marks);
+    CHECK(code == 0 && changes == TEST_PRE + 1 + TEST_POST && marks == 1, "vcd: exit %d, %d changes, %d trigger marks",
+          code, changes, marks);
+
+    // One flipped bit in a record must fail the CRC check
+    image[GPIO_CAPTURE_HEADER_SIZE + 6] ^= 0x01;
+    file = fopen(TEST_FILE, "wb");
+    if (file != NULL) {
+        fwrite(image, 1, length, file);
+        fclose(file);
+    }
+    CHECK(run_vcd(argv[1], &changes, &marks) != 0, "vcd accepted a damaged capture");
+    remove(TEST_FILE);
+
+    printf("%-24s %lu records, %zu B exported\n", "triggered capture", (unsigned long)status.records, length);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/******************************************************************************************************************************
+ File Name      : nvs_group_test.c
+ Description    : Host fault-injection test for NVS group updates: cuts the power at every flash write of an update and
+                  checks that the group reboots into either the complete old or the complete new state
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP.h"
+
+#define TEST_BASE_FILE  "nvs_group_test_base.bin"
+#define TEST_WORK_FILE  "nvs_group_test_work.bin"
+#define TEST_GROUP      "settings"
+#define TEST_TABLE_LEN  64
+
+/* One state of the settings group. has_* false means the key is absent. */
+typedef struct {
+    tsword mode;
+    bool has_retries;
+    tsword retries;
+    tsword table[TEST_TABLE_LEN];
+    tsbyte name[32];
+} t_settings;
+
+static int failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                        \
+        printf("\n");                               \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+static void make_state(t_settings *state, tsword seed, bool has_retries) {
+    memset(state, 0, sizeof(*state));
+    state->mode = seed;
+    state->has_retries = has_retries;
+    state->retries = has_retries ? seed * 3 : 0;
+    for (int i = 0; i < TEST_TABLE_LEN; i++) {
+        state->table[i] = (tsword)(seed * 1000 + i);
+    }
+    snprintf(state->name, sizeof(state->name), "profile-%d", (int)seed);
+}
+
+/* Simulated reboot onto a file */
+static void reboot(const char *path) {
+    NVS_Close_Handles();
+    NVS_Cache_Clear();
+    host_nvs_set_file(path);
+    host_nvs_reload();
+    NVS_Init();
+}
+
+static void copy_file(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    FILE *out = fopen(to, "wb");
+    char buffer[4096];
+    size_t got;
+    while (in != NULL && out != NULL && (got = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, got, out);
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+}
+
+static esp_err_t write_state(t_nvs_group *group, const t_settings *state) {
+    t_nvs_txn *txn;
+    esp_err_t err = NVS_Group_Begin(group, &txn);
+    if (err != ESP_OK) {
+        return err;
+    }
+    NVS_Txn_Write_Int(txn, "mode", state->mode);
+    if (state->has_retries) {
+        NVS_Txn_Write_Int(txn, "retries", state->retries);
+    } else {
+        NVS_Txn_Erase_Key(txn, "retries");
+    }
+    NVS_Txn_Write_Array(txn, "table", state->table, TEST_TABLE_LEN);
+    NVS_Txn_Write_String(txn, "name", state->name);
+    return NVS_Group_Commit(group, txn);
+}
+
+static bool group_equals(t_nvs_group *group, const t_settings *state) {
+    t_settings read;
+    memset(&read, 0, sizeof(read));
+    NVS_Group_Read_Int(group, "mode", &read.mode);
+    read.has_retries = NVS_Group_Read_Int(group, "retries", &read.retries) == ESP_OK;
+    NVS_Group_Read_Array(group, "table", read.table, TEST_TABLE_LEN);
+    NVS_Group_Read_String(group, "name", read.name, sizeof(read.name));
+    return read.mode == state->mode && read.has_retries == state->has_retries && read.retries == state->retries &&
+           memcmp(read.table, state->table, sizeof(read.table)) == 0 && strcmp(read.name, state->name) == 0;
+}
+
+/*
+ * Builds a base file holding 'commits' versions of the group, then replays the update to 'next'
+ * with the power cut after 0, 1, 2, ... flash writes until one run completes.
+ */
+static void run_power_cuts(const char *label, const t_settings *history, int commits, const t_settings *next) {
+    t_nvs_group *group;
+    remove(TEST_BASE_FILE);
+    reboot(TEST_BASE_FILE);
+    NVS_Group_Open(TEST_GROUP, &group);
+    for (int i = 0; i < commits; i++) {
+        CHECK(write_state(group, &history[i]) == ESP_OK, "%s: setup commit %d", label, i);
+    }
+    NVS_Group_Close(group);
+    const t_settings *previous = &history[commits - 1];
+
+    int cuts = 0, old_seen = 0, new_seen = 0;
+    for (int writes = 0; writes < 1000; writes++) {
+        copy_file(TEST_BASE_FILE, TEST_WORK_FILE);
+        fflush(NULL);
+        pid_t pid = fork();
+        if (pid == 0) {
+            reboot(TEST_WORK_FILE);
+            NVS_Group_Open(TEST_GROUP, &group);
+            host_nvs_power_cut_after(writes);
+            _exit(write_state(group, next) == ESP_OK ? 0 : 1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        CHECK(code == 0 || code == HOST_NVS_POWER_CUT_EXIT, "%s: update exited with %d", label, code);
+
+        // Reboot onto what reached flash: recovery is just the open
+        t_host_nvs_counters counters;
+        reboot(TEST_WORK_FILE);
+        host_nvs_reset_counters();
+        NVS_Group_Open(TEST_GROUP, &group);
+        host_nvs_get_counters(&counters);
+        CHECK(counters.reads <= 2, "%s: recovery took %llu reads", label, (unsigned long long)counters.reads);
+
+        bool is_old = group_equals(group, previous);
+        bool is_new = group_equals(group, next);
+        CHECK(is_old || is_new, "%s: mixed state after a cut at write %d", label, writes);
+        CHECK(code != 0 || is_new, "%s: completed update not visible", label);
+        old_seen += is_old;
+        new_seen += is_new;
+
+        // The next update after a cut must still work from the recovered state
+        if (code == HOST_NVS_POWER_CUT_EXIT) {
+            CHECK(write_state(group, next) == ESP_OK && group_equals(group, next), "%s: update after cut %d", label, writes);
+        }
+        NVS_Group_Close(group);
+        if (code != HOST_NVS_POWER_CUT_EXIT) {
+            break;
+        }
+        cuts++;
+    }
+    printf("%-34s %3d cut points, %3d old, %3d new\n", label, cuts, old_seen, new_seen);
+    CHECK(cuts > 0 && old_seen > 0 && new_seen > 0, "%s: cuts did not cover both outcomes", label);
+}
+
+int main(void) {
+    t_settings history[4];
+    make_state(&history[0], 1, true);
+    make_state(&history[1], 2, false);
+    make_state(&history[2], 3, true);
+    make_state(&history[3], 4, false);
+
+    // First update of a fresh group, then updates into a bank that has to be synced first
+    run_power_cuts("first commit (erase key)", history, 1, &history[1]);
+    run_power_cuts("shadow bank reuse (re-add key)", history, 2, &history[2]);
+    run_power_cuts("shadow bank reuse (erase key)", history, 3, &history[3]);
+
+    NVS_Compression_Set(32);
+    run_power_cuts("shadow bank reuse, compressed", history, 3, &history[3]);
+    NVS_Compression_Set(0);
+
+    remove(TEST_BASE_FILE);
+    remove(TEST_WORK_FILE);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,342 @@
+/******************************************************************************************************************************
+ File Name      : nvs_test.c
+ Description    : Host test for the NVS driver: the read cache stays coherent with flash through every write path,
+                  compressed values round-trip, and namespace snapshots import exactly what was exported
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE.h"
+
+#define TEST_FILE           "nvs_test.bin"
+#define TEST_BASE_FILE      "nvs_test_base.bin"
+#define TEST_TABLE_LEN      512
+#define TEST_KEYS           100     // More than NVS_CACHE_MAX_ENTRIES, so the clock sweep evicts
+
+static int failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                        \
+        printf("\n");                               \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+/* Simulated reboot onto the same file */
+static void reboot(void) {
+    NVS_Close_Handles();
+    NVS_Cache_Clear();
+    host_nvs_reload();
+    NVS_Init();
+}
+
+static tsword read_int(const tsbyte *name_space, const tsbyte *key, esp_err_t *err) {
+    tsword value = -1;
+    *err = NVS_NS_Read_Int(name_space, key, &value);
+    return value;
+}
+
+static void test_cache_coherence(void) {
+    t_nvs_cache_stats stats;
+    t_host_nvs_counters counters;
+    tsbyte text[32];
+    tsword array[4];
+    const tsword values[4] = { 4, 3, 2, 1 };
+    esp_err_t err;
+    tsword value;
+
+    NVS_Cache_Enable();
+    NVS_Cache_Reset_Stats();
+
+    // Repeated reads come from RAM, and a write is visible without a flash read
+    NVS_Write_Int("hot", 1);
+    NVS_Read_Int("hot", &value);
+    host_nvs_reset_counters();
+    NVS_Read_Int("hot", &value);
+    NVS_Write_Int("hot", 2);
+    NVS_Read_Int("hot", &value);
+    host_nvs_get_counters(&counters);
+    CHECK(value == 2 && counters.reads == 0, "write-through: read %d, %llu flash reads", value,
+          (unsigned long long)counters.reads);
+
+    // A cached absence must not outlive the first write
+    value = read_int("cache", "late", &err);
+    CHECK(err == ESP_ERR_NVS_NOT_FOUND, "missing key: %s", esp_err_to_name(err));
+    NVS_NS_Write_Int("cache", "late", 7);
+    value = read_int("cache", "late", &err);
+    CHECK(err == ESP_OK && value == 7, "absent then written: %s, %d", esp_err_to_name(err), value);
+
+    // Erase key and erase all
+    NVS_NS_Erase_Key("cache", "late");
+    value = read_int("cache", "late", &err);
+    CHECK(err == ESP_ERR_NVS_NOT_FOUND, "erased key still read as %d", value);
+    NVS_NS_Write_Int("cache", "a", 1);
+    NVS_NS_Write_String("cache", "s", "cached");
+    NVS_NS_Read_String("cache", "s", text, sizeof(text));
+    NVS_NS_Erase_All("cache");
+    value = read_int("cache", "a", &err);
+    CHECK(err == ESP_ERR_NVS_NOT_FOUND, "erase all: int still read as %d", value);
+    CHECK(NVS_NS_Read_String("cache", "s", text, sizeof(text)) == ESP_ERR_NVS_NOT_FOUND, "erase all: string still read");
+
+    // Transactions update the cache when they flush
+    t_nvs_txn *txn;
+    NVS_Txn_Begin("cache", NULL, &txn);
+    NVS_Txn_Write_Int(txn, "a", 11);
+    NVS_Txn_Write_String(txn, "s", "from txn");
+    NVS_Txn_Write_Array(txn, "arr", values, 4);
+    NVS_Txn_Commit(txn);
+    value = read_int("cache", "a", &err);
+    NVS_NS_Read_String("cache", "s", text, sizeof(text));
+    NVS_NS_Read_Array("cache", "arr", array, 4);
+    CHECK(err == ESP_OK && value == 11 && strcmp(text, "from txn") == 0 && memcmp(array, values, sizeof(values)) == 0,
+          "transaction: %d, \"%s\"", value, text);
+
+    // ... but only once the commit succeeded: after a failed one the keys are read from NVS again
+    NVS_Txn_Begin("cache", NULL, &txn);
+    NVS_Txn_Write_Int(txn, "a", 13);
+    host_nvs_fail_next_commit(ESP_ERR_NVS_NOT_ENOUGH_SPACE);
+    err = NVS_Txn_Commit(txn);
+    CHECK(err == ESP_ERR_NVS_NOT_ENOUGH_SPACE, "failed commit returned %s", esp_err_to_name(err));
+    host_nvs_reset_counters();
+    read_int("cache", "a", &err);
+    host_nvs_get_counters(&counters);
+    CHECK(counters.reads == 1, "failed commit: %llu flash reads", (unsigned long long)counters.reads);
+
+    // A raw handle write is seen after the documented invalidate
+    nvs_handle_t handle;
+    NVS_Get_Handle("cache", NVS_READWRITE, &handle);
+    nvs_set_i32(handle, "a", 12);
+    nvs_commit(handle);
+    NVS_Cache_Invalidate("cache", "a");
+    value = read_int("cache", "a", &err);
+    CHECK(value == 12, "raw write after invalidate: read %d", value);
+
+    // Past the table capacity every key still reads its own value
+    tsbyte key[16];
+    for (int k = 0; k < TEST_KEYS; k++) {
+        snprintf(key, sizeof(key), "k%d", k);
+        NVS_NS_Write_Int("many", key, k * 3);
+    }
+    int wrong = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int k = 0; k < TEST_KEYS; k++) {
+            snprintf(key, sizeof(key), "k%d", k);
+            wrong += read_int("many", key, &err) != k * 3;
+        }
+    }
+    NVS_Cache_Get_Stats(&stats);
+    CHECK(wrong == 0 && stats.evictions > 0, "eviction: %d wrong reads, %lu evictions", wrong,
+          (unsigned long)stats.evictions);
+
+    // What the cache served is what flash holds
+    reboot();
+    value = read_int("cache", "a", &err);
+    NVS_NS_Read_String("cache", "s", text, sizeof(text));
+    CHECK(value == 12 && strcmp(text, "from txn") == 0, "after reboot: %d, \"%s\"", value, text);
+    NVS_Cache_Get_Stats(&stats);
+    printf("%-24s %lu hits, %lu misses, %lu evictions\n", "cache coherence", (unsigned long)stats.hits,
+           (unsigned long)stats.misses, (unsigned long)stats.evictions);
+    NVS_Cache_Disable();
+}
+
+static void test_compression(void) {
+    static tsbyte json[2048];
+    static tsbyte json_back[2048];
+    static tsword table[TEST_TABLE_LEN];
+    static tsword noise[TEST_TABLE_LEN];
+    static tsword back[TEST_TABLE_LEN];
+    t_nvs_compression_stats stats;
+    tsbyte text[32];
+
+    size_t length = 0;
+    length += (size_t)snprintf(json, sizeof(json), "{\"channels\":[");
+    for (int i = 0; i < 16; i++) {
+        length += (size_t)snprintf(json + length, sizeof(json) - length, "%s{\"id\":%d,\"gain\":%d,\"unit\":\"mV\"}",
+                                   i > 0 ? "," : "", i, 1 << (i % 4));
+    }
+    snprintf(json + length, sizeof(json) - length, "]}");
+    srand(1);
+    for (int i = 0; i < TEST_TABLE_LEN; i++) {
+        table[i] = (tsword)(i / 8 * 8);
+        noise[i] = (tsword)rand();
+    }
+
+    NVS_Compression_Set(32);
+    NVS_Compression_Reset_Stats();
+    NVS_NS_Write_String("lz", "json", json);
+    NVS_NS_Write_Array("lz", "table", table, TEST_TABLE_LEN);
+    NVS_NS_Write_Array("lz", "noise", noise, TEST_TABLE_LEN);
+    NVS_NS_Write_String("lz", "short", "tiny");
+    // The same key switches from a packed to a plain string
+    NVS_NS_Write_String("lz", "flip", json);
+    NVS_NS_Write_String("lz", "flip", "plain now");
+
+    for (int pass = 0; pass < 2; pass++) {
+        const char *when = pass == 0 ? "written" : "after reboot, compression off";
+        NVS_NS_Read_String("lz", "json", json_back, sizeof(json_back));
+        CHECK(strcmp(json_back, json) == 0, "%s: json differs", when);
+        NVS_NS_Read_Array("lz", "table", back, TEST_TABLE_LEN);
+        CHECK(memcmp(back, table, sizeof(table)) == 0, "%s: table differs", when);
+        NVS_NS_Read_Array("lz", "noise", back, TEST_TABLE_LEN);
+        CHECK(memcmp(back, noise, sizeof(noise)) == 0, "%s: incompressible array differs", when);
+        NVS_NS_Read_String("lz", "short", text, sizeof(text));
+        CHECK(strcmp(text, "tiny") == 0, "%s: short string \"%s\"", when, text);
+        NVS_NS_Read_String("lz", "flip", text, sizeof(text));
+        CHECK(strcmp(text, "plain now") == 0, "%s: packed -> plain string \"%s\"", when, text);
+        // Reading never depends on the write-side setting
+        NVS_Compression_Set(0);
+        reboot();
+    }
+
+    NVS_Compression_Get_Stats(&stats);
+    CHECK(stats.packed_writes >= 2 && stats.raw_writes >= 1 && stats.unpack_errors == 0,
+          "%lu packed, %lu raw, %lu unpack errors", (unsigned long)stats.packed_writes, (unsigned long)stats.raw_writes,
+          (unsigned long)stats.unpack_errors);
+    CHECK(stats.bytes_stored < stats.bytes_in, "packed %lu -> %lu bytes", (unsigned long)stats.bytes_in,
+          (unsigned long)stats.bytes_stored);
+    printf("%-24s %lu packed writes, %lu -> %lu B\n", "compression round-trip", (unsigned long)stats.packed_writes,
+           (unsigned long)stats.bytes_in, (unsigned long)stats.bytes_stored);
+}
+
+static void copy_file(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    FILE *out = fopen(to, "wb");
+    char buffer[4096];
+    size_t got;
+    while (in != NULL && out != NULL && (got = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, got, out);
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+}
+
+/*
+ * A string moving between its plain and packed form is two entries of different types. Cuts the power at every
+ * flash write of the rewrite: after the reboot the key must hold the old or the new value, never nothing.
+ */
+static void run_form_switch_cuts(const char *label, const tsbyte *from, const tsbyte *to) {
+    static tsbyte back[2048];
+    int cuts = 0, old_seen = 0, new_seen = 0;
+
+    NVS_Compression_Set(32);
+    NVS_NS_Erase_All("form");
+    NVS_NS_Write_String("form", "value", from);
+    NVS_Close_Handles();
+    copy_file(TEST_FILE, TEST_BASE_FILE);
+    for (int writes = 0; writes < 100; writes++) {
+        copy_file(TEST_BASE_FILE, TEST_FILE);
+        fflush(NULL);
+        pid_t pid = fork();
+        if (pid == 0) {
+            reboot();
+            host_nvs_power_cut_after(writes);
+            _exit(NVS_NS_Write_String("form", "value", to) == ESP_OK ? 0 : 1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        CHECK(code == 0 || code == HOST_NVS_POWER_CUT_EXIT, "%s: rewrite exited with %d", label, code);
+
+        reboot();
+        back[0] = '\0';
+        esp_err_t err = NVS_NS_Read_String("form", "value", back, sizeof(back));
+        bool is_old = err == ESP_OK && strcmp(back, from) == 0;
+        bool is_new = err == ESP_OK && strcmp(back, to) == 0;
+        CHECK(is_old || is_new, "%s, cut at write %d: read %s", label, writes, esp_err_to_name(err));
+        CHECK(code != 0 || is_new, "%s: completed rewrite not visible", label);
+        old_seen += is_old;
+        new_seen += is_new;
+        if (code != HOST_NVS_POWER_CUT_EXIT) {
+            break;
+        }
+        cuts++;
+    }
+    remove(TEST_BASE_FILE);
+    NVS_Compression_Set(0);
+    printf("%-24s %d cut points, %d old, %d new\n", label, cuts, old_seen, new_seen);
+}
+
+static void test_snapshot(void) {
+    static tbyte snapshot[4096];
+    static tsbyte json_back[2048];
+    tsword table[TEST_TABLE_LEN];
+    tsword table_src[TEST_TABLE_LEN];
+    tsbyte text[32];
+    size_t length = 0;
+    esp_err_t err;
+
+    NVS_NS_Write_Int("src", "mode", 3);
+    NVS_NS_Write_String("src", "name", "node-07");
+    CHECK(NVS_NS_Export("src", NULL, 0, &length) == ESP_OK && length > NVS_SNAPSHOT_HEADER_SIZE,
+          "size query: %zu", length);
+    CHECK(NVS_NS_Export("src", snapshot, length - 1, &length) == ESP_ERR_NVS_INVALID_LENGTH, "short buffer accepted");
+    CHECK(NVS_NS_Export("src", snapshot, sizeof(snapshot), &length) == ESP_OK, "export");
+
+    // Replace: the destination ends up exactly as exported
+    NVS_NS_Write_Int("dst", "stale", 1);
+    NVS_NS_Write_Int("dst", "mode", 9);
+    CHECK(NVS_NS_Import("dst", snapshot, length, true) == ESP_OK, "import (replace)");
+    CHECK(read_int("dst", "mode", &err) == 3 && err == ESP_OK, "replace: mode");
+    read_int("dst", "stale", &err);
+    CHECK(err == ESP_ERR_NVS_NOT_FOUND, "replace: stale key survived");
+    NVS_NS_Read_String("dst", "name", text, sizeof(text));
+    CHECK(strcmp(text, "node-07") == 0, "replace: name \"%s\"", text);
+
+    // Merge keeps keys the snapshot does not have
+    NVS_NS_Write_Int("dst", "extra", 5);
+    NVS_NS_Write_Int("dst", "mode", 9);
+    CHECK(NVS_NS_Import("dst", snapshot, length, false) == ESP_OK, "import (merge)");
+    CHECK(read_int("dst", "mode", &err) == 3 && read_int("dst", "extra", &err) == 5, "merge");
+
+    // A damaged or truncated snapshot is rejected before anything is written
+    NVS_NS_Write_Int("dst", "mode", 9);
+    snapshot[length - 1] ^= 0x01;
+    CHECK(NVS_NS_Import("dst", snapshot, length, true) == ESP_ERR_INVALID_CRC, "corrupt snapshot accepted");
+    snapshot[length - 1] ^= 0x01;
+    CHECK(NVS_NS_Import("dst", snapshot, length - 3, true) != ESP_OK, "truncated snapshot accepted");
+    CHECK(read_int("dst", "mode", &err) == 9 && read_int("dst", "extra", &err) == 5, "rejected import wrote data");
+
+    // Compressed values: the copy reads back through the same unpacking path
+    CHECK(NVS_NS_Export("lz", snapshot, sizeof(snapshot), &length) == ESP_OK, "export packed namespace");
+    CHECK(NVS_NS_Import("lzcopy", snapshot, length, true) == ESP_OK, "import packed namespace");
+    NVS_NS_Read_Array("lz", "table", table_src, TEST_TABLE_LEN);
+    NVS_NS_Read_Array("lzcopy", "table", table, TEST_TABLE_LEN);
+    NVS_NS_Read_String("lzcopy", "json", json_back, sizeof(json_back));
+    CHECK(memcmp(table, table_src, sizeof(table)) == 0 && strncmp(json_back, "{\"channels\":[", 13) == 0,
+          "packed values differ after import");
+
+    reboot();
+    CHECK(read_int("dst", "mode", &err) == 9, "after reboot");
+    printf("%-24s %zu B packed namespace\n", "snapshot import", length);
+}
+
+int main(void) {
+    remove(TEST_FILE);
+    host_nvs_set_file(TEST_FILE);
+    host_nvs_reload();
+    NVS_Init();
+
+    test_cache_coherence();
+    test_compression();
+    test_snapshot();
+
+    static tsbyte packed[1024];
+    memset(packed, 'a', sizeof(packed) - 1);
+    run_form_switch_cuts("plain -> packed string", "plain", packed);
+    run_form_switch_cuts("packed -> plain string", packed, "plain");
+
+    remove(TEST_FILE);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/******************************************************************************************************************************
+ File Name      : uart_frame_test.c
+ Description    : Host test for the UART frame transport: a consumer far slower than the sender must throttle it
+                  (RNR flow control) without a single frame being dropped, lost, or delivered out of order, and
+                  frames corrupted on the wire must still arrive in order (selective repeat)
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART.h"
+#include "UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define TEST_FRAMES         200
+#define TEST_PAYLOAD        64
+#define TEST_CONSUMER_MS    5       // Per frame: ~16x slower than the wire, and the queue fills within a few frames
+#define TEST_ERROR_FRAMES   400
+#define TEST_ERROR_ONE_IN   1000    // Flipped bytes on both directions: about one frame in 14
+
+static int failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                        \
+        printf("\n");                               \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+static volatile bool sender_done;
+static volatile int send_errors;
+static int send_count;
+
+static void fill_payload(tbyte *payload, int index) {
+    for (int i = 0; i < TEST_PAYLOAD; i++) {
+        payload[i] = (tbyte)(index * 7 + i);
+    }
+    payload[0] = (tbyte)index;
+    payload[1] = (tbyte)(index >> 8);
+}
+
+static void sender_task(void *arg) {
+    tbyte payload[TEST_PAYLOAD];
+    (void)arg;
+    for (int i = 0; i < send_count; i++) {
+        fill_payload(payload, i);
+        if (UART_Frame_Send(ESP_UART_NUM_0, payload, sizeof(payload), pdMS_TO_TICKS(5000)) != ESP_OK) {
+            send_errors++;
+        }
+    }
+    if (UART_Frame_Flush(ESP_UART_NUM_0, pdMS_TO_TICKS(10000)) != ESP_OK) {
+        send_errors++;
+    }
+    sender_done = true;
+    vTaskDelete(NULL);
+}
+
+static void start_sender(int count) {
+    UART_Frame_Reset_Stats(ESP_UART_NUM_0);
+    UART_Frame_Reset_Stats(ESP_UART_NUM_1);
+    send_count = count;
+    send_errors = 0;
+    sender_done = false;
+    xTaskCreate(sender_task, "sender", 4096, NULL, 5, NULL);
+}
+
+static void test_slow_consumer(void) {
+    start_sender(TEST_FRAMES);
+
+    tbyte expected[TEST_PAYLOAD];
+    tbyte payload[UART_FRAME_MAX_PAYLOAD];
+    size_t length;
+    int received = 0;
+    while (received < TEST_FRAMES && UART_Frame_Receive(ESP_UART_NUM_1, payload, &length, pdMS_TO_TICKS(2000)) == ESP_OK) {
+        fill_payload(expected, received);
+        CHECK(length == TEST_PAYLOAD && memcmp(payload, expected, TEST_PAYLOAD) == 0,
+              "frame %d: wrong payload (got #%d, %u bytes)", received, payload[0] | (payload[1] << 8), (unsigned)length);
+        received++;
+        vTaskDelay(pdMS_TO_TICKS(TEST_CONSUMER_MS));
+    }
+    while (!sender_done) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    t_uart_frame_stats tx;
+    t_uart_frame_stats rx;
+    UART_Frame_Get_Stats(ESP_UART_NUM_0, &tx);
+    UART_Frame_Get_Stats(ESP_UART_NUM_1, &rx);
+    CHECK(received == TEST_FRAMES, "received %d of %d frames", received, TEST_FRAMES);
+    CHECK(send_errors == 0, "%d send/flush errors", send_errors);
+    CHECK(tx.frames_dropped == 0, "sender dropped %lu frames", (unsigned long)tx.frames_dropped);
+    CHECK(rx.frames_lost == 0, "receiver lost %lu frames", (unsigned long)rx.frames_lost);
+    CHECK(tx.frames_acked == TEST_FRAMES, "sender saw %lu ACKs", (unsigned long)tx.frames_acked);
+    CHECK(rx.rnrs_sent > 0 && tx.rnrs_received > 0, "flow control never engaged (%lu RNR sent, %lu received)",
+          (unsigned long)rx.rnrs_sent, (unsigned long)tx.rnrs_received);
+    printf("%-20s %d frames, %lu RNR, %lu retx\n", "slow consumer", received, (unsigned long)rx.rnrs_sent,
+           (unsigned long)tx.retransmissions);
+}
+
+/* Every frame is delivered in order or dropped by the sender after its retries; nothing is delivered twice. */
+static void test_line_errors(void) {
+    host_uart_set_error_rate(ESP_UART_NUM_0, TEST_ERROR_ONE_IN);
+    host_uart_set_error_rate(ESP_UART_NUM_1, TEST_ERROR_ONE_IN);
+    start_sender(TEST_ERROR_FRAMES);
+
+    tbyte expected[TEST_PAYLOAD];
+    tbyte payload[UART_FRAME_MAX_PAYLOAD];
+    size_t length;
+    int received = 0;
+    int last = -1;
+    while (UART_Frame_Receive(ESP_UART_NUM_1, payload, &length, pdMS_TO_TICKS(1000)) == ESP_OK) {
+        int index = payload[0] | (payload[1] << 8);
+        fill_payload(expected, index);
+        CHECK(index > last && index < TEST_ERROR_FRAMES, "frame #%d delivered after #%d", index, last);
+        CHECK(length == TEST_PAYLOAD && memcmp(payload, expected, TEST_PAYLOAD) == 0, "frame #%d corrupt", index);
+        last = index;
+        received++;
+    }
+    while (!sender_done) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    host_uart_set_error_rate(ESP_UART_NUM_0, 0);
+    host_uart_set_error_rate(ESP_UART_NUM_1, 0);
+
+    t_uart_frame_stats tx;
+    t_uart_frame_stats rx;
+    UART_Frame_Get_Stats(ESP_UART_NUM_0, &tx);
+    UART_Frame_Get_Stats(ESP_UART_NUM_1, &rx);
+    CHECK(send_errors == 0, "%d send/flush errors", send_errors);
+    // A frame the sender dropped after losing all its ACKs was delivered all the same, so this is not an equality
+    CHECK(received <= TEST_ERROR_FRAMES && received + (int)tx.frames_dropped >= TEST_ERROR_FRAMES,
+          "%d delivered + %lu dropped of %d sent", received, (unsigned long)tx.frames_dropped, TEST_ERROR_FRAMES);
+    CHECK(rx.frames_corrupt > 0 && tx.retransmissions > 0, "no corruption seen (%lu corrupt, %lu retx)",
+          (unsigned long)rx.frames_corrupt, (unsigned long)tx.retransmissions);
+    printf("%-20s %d frames, %lu corrupt, %lu retx, %lu dropped\n", "line errors", received,
+           (unsigned long)rx.frames_corrupt, (unsigned long)tx.retransmissions, (unsigned long)tx.frames_dropped);
+}
+
+int main(void) {
+    // Short timeout and retry budget: without flow control a parked window exhausts them within a few frames
+    t_uart_frame_config config = UART_FRAME_CONFIG_DEFAULT();
+    config.ack_timeout_ms = 20;
+    config.max_retries = 2;
+    config.window_size = UART_FRAME_MAX_WINDOW;
+
+    host_uart_set_wire_pacing(true);
+    UART_Init(ESP_UART_NUM_0, ESP_baudrate_921600, ESP_UART_DATA_8_BITS, ESP_UART_PARITY_DISABLE,
+              ESP_UART_STOP_BITS_1, ESP_UART_HW_FLOWCTRL_DISABLE);
+    UART_Init(ESP_UART_NUM_1, ESP_baudrate_921600, ESP_UART_DATA_8_BITS, ESP_UART_PARITY_DISABLE,
+              ESP_UART_STOP_BITS_1, ESP_UART_HW_FLOWCTRL_DISABLE);
+    CHECK(UART_Frame_Init(ESP_UART_NUM_0, &config) == ESP_OK, "frame init port 0");
+    CHECK(UART_Frame_Init(ESP_UART_NUM_1, &config) == ESP_OK, "frame init port 1");
+
+    test_slow_consumer();
+    test_line_errors();
+
+    printf(failures == 0 ? "ok\n" : "FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
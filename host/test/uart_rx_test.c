@@ -0,0 +1,139 @@
+/******************************************************************************************************************************
+ File Name      : uart_rx_test.c
+ Description    : Host test for the UART RX ring: polled fill/peek/commit across the ring wrap, UART_Receive_Byte on
+                  both receive paths, and an event-driven burst larger than the ring that must arrive complete
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define TEST_TX             ESP_UART_NUM_0
+#define TEST_RX             ESP_UART_NUM_1
+#define TEST_POLL_BLOCK     300     // Not a divisor of the ring size, so blocks straddle the wrap
+#define TEST_POLL_BLOCKS    20
+#define TEST_BURST          (UART_RX_RING_SIZE + UART_RX_RING_SIZE * 3 / 4)
+
+static int failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                        \
+        printf("\n");                               \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+static tbyte pattern(size_t position) {
+    return (tbyte)(position * 7 + (position >> 8));
+}
+
+/* Fill, then consume through Peek/Commit in two steps so a block is released piecemeal and across the wrap. */
+static void test_polled_ring(void) {
+    tbyte block[TEST_POLL_BLOCK];
+    size_t sent = 0;
+    size_t checked = 0;
+    int bad = 0;
+    t_uart_rx_stats before;
+    t_uart_rx_stats after;
+
+    UART_Rx_Get_Stats(TEST_RX, &before);
+    for (int b = 0; b < TEST_POLL_BLOCKS; b++) {
+        for (size_t i = 0; i < sizeof(block); i++) {
+            block[i] = pattern(sent + i);
+        }
+        UART_Send_Buffer(block, sizeof(block), TEST_TX);
+        sent += sizeof(block);
+
+        TickType_t start = xTaskGetTickCount();
+        while (UART_Rx_Available(TEST_RX) < sizeof(block) && xTaskGetTickCount() - start < pdMS_TO_TICKS(1000)) {
+            UART_Rx_Fill(TEST_RX, pdMS_TO_TICKS(10));
+        }
+        CHECK(UART_Rx_Available(TEST_RX) == sizeof(block), "block %d: %zu bytes in the ring", b,
+              UART_Rx_Available(TEST_RX));
+
+        const tbyte *data;
+        size_t length;
+        while ((length = UART_Rx_Peek(TEST_RX, &data)) > 0) {
+            size_t take = length > 1 ? length / 2 : length;
+            for (size_t i = 0; i < take; i++) {
+                bad += data[i] != pattern(checked + i);
+            }
+            checked += take;
+            UART_Rx_Commit(TEST_RX, take);
+        }
+    }
+    UART_Rx_Get_Stats(TEST_RX, &after);
+    CHECK(checked == sent && bad == 0, "polled: %zu of %zu bytes, %d wrong", checked, sent, bad);
+    CHECK(after.bytes_received - before.bytes_received == sent, "polled: stats count %lu bytes",
+          (unsigned long)(after.bytes_received - before.bytes_received));
+    CHECK(after.overflow_count == before.overflow_count, "polled: driver overflow");
+    printf("%-24s %zu bytes, high water %lu\n", "polled ring", checked, (unsigned long)after.high_water_mark);
+}
+
+/* UART_Receive_Byte() must return ring bytes in order, whichever path refills the ring. */
+static void test_receive_byte(const char *label) {
+    const tbyte text[] = "receive-byte";
+    tbyte got[sizeof(text)];
+
+    UART_Send_Buffer(text, sizeof(text), TEST_TX);
+    for (size_t i = 0; i < sizeof(text); i++) {
+        UART_Receive_Byte(&got[i], TEST_RX);
+    }
+    CHECK(memcmp(got, text, sizeof(text)) == 0, "%s: UART_Receive_Byte returned \"%.*s\"", label, (int)sizeof(got) - 1,
+          (const char *)got);
+    printf("%-24s ok\n", label);
+}
+
+/* A burst bigger than the ring: the RX task parks the rest in the driver and refills once the consumer catches up. */
+static void test_event_burst(void) {
+    static tbyte burst[TEST_BURST];
+    t_uart_rx_event_config config = UART_RX_EVENT_CONFIG_DEFAULT();
+    t_uart_rx_stats before;
+    t_uart_rx_stats after;
+
+    config.mode = UART_RX_MODE_CHUNK;
+    CHECK(UART_Rx_Event_Start(TEST_RX, &config) == ESP_OK, "event start");
+    UART_Rx_Get_Stats(TEST_RX, &before);
+    for (size_t i = 0; i < sizeof(burst); i++) {
+        burst[i] = pattern(i);
+    }
+    UART_Send_Buffer(burst, sizeof(burst), TEST_TX);
+    vTaskDelay(pdMS_TO_TICKS(100));     // Let the ring fill up before anything is consumed
+
+    size_t got = 0;
+    int bad = 0;
+    while (got < sizeof(burst) && UART_Rx_Wait(TEST_RX, pdMS_TO_TICKS(500)) == ESP_OK) {
+        tbyte chunk[64];
+        size_t length = UART_Rx_Read(TEST_RX, chunk, sizeof(chunk));
+        for (size_t i = 0; i < length && got + i < sizeof(burst); i++) {
+            bad += chunk[i] != burst[got + i];
+        }
+        got += length;
+    }
+    UART_Rx_Get_Stats(TEST_RX, &after);
+    CHECK(got == sizeof(burst) && bad == 0, "event burst: %zu of %zu bytes, %d wrong", got, sizeof(burst), bad);
+    CHECK(after.full_count > before.full_count, "event burst: the ring never filled");
+    CHECK(after.overflow_count == before.overflow_count, "event burst: driver overflow");
+    printf("%-24s %zu bytes, ring full %lu times\n", "event burst", got, (unsigned long)(after.full_count - before.full_count));
+}
+
+int main(void) {
+    host_uart_set_wire_pacing(false);
+    UART_Init(TEST_TX, ESP_baudrate_921600, ESP_UART_DATA_8_BITS, ESP_UART_PARITY_DISABLE,
+              ESP_UART_STOP_BITS_1, ESP_UART_HW_FLOWCTRL_DISABLE);
+    UART_Init(TEST_RX, ESP_baudrate_921600, ESP_UART_DATA_8_BITS, ESP_UART_PARITY_DISABLE,
+              ESP_UART_STOP_BITS_1, ESP_UART_HW_FLOWCTRL_DISABLE);
+
+    test_polled_ring();
+    test_receive_byte("receive byte, polled");
+    // Event-driven receive cannot be stopped, so it goes last
+    test_event_burst();
+    test_receive_byte("receive byte, event");
+
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
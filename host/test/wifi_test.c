@@ -0,0 +1,215 @@
+/******************************************************************************************************************************
+ File Name      : wifi_test.c
+ Description    : Host test for the WiFi reconnect policy and the reachability probe against the simulated AP: backoff
+                  while the AP is down stays within its bounds, the station is back soon after the AP returns, a wrong
+                  password gives up, and the probe fails over between targets and reports a lost target and link
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI.h"
+#include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#define TEST_NVS_FILE       "wifi_test_nvs.bin"
+#define TEST_SSID           "test-ap"
+#define TEST_PASSWORD       "test-pass"
+#define TEST_INITIAL_MS     20
+#define TEST_MAX_MS         160
+#define TEST_AUTH_MS        50
+#define TEST_AUTH_ATTEMPTS  3
+#define TEST_OUTAGE_MS      1000
+#define TEST_PROBE_PERIOD   20
+
+static int failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__);                        \
+        printf("\n");                               \
+        failures++;                                 \
+    }                                               \
+} while (0)
+
+static tlong elapsed_ms(int64_t start_us) {
+    return (tlong)((esp_timer_get_time() - start_us) / 1000);
+}
+
+static bool wait_reconnect_state(t_wifi_reconnect_state state, tlong timeout_ms) {
+    t_wifi_reconnect_stats stats;
+    int64_t start = esp_timer_get_time();
+    for (;;) {
+        WiFi_Get_Reconnect_Stats(&stats);
+        if (stats.state == state) {
+            return true;
+        }
+        if (elapsed_ms(start) >= timeout_ms) {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+}
+
+static bool wait_probe_state(t_wifi_probe_state state, tlong timeout_ms) {
+    int64_t start = esp_timer_get_time();
+    while (WiFi_Probe_Get_State() != state) {
+        if (elapsed_ms(start) >= timeout_ms) {
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+/* Opens a TCP listener on an ephemeral loopback port; returns the socket, or -1. */
+static int open_listener(tword *port) {
+    struct sockaddr_in address = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t length = sizeof(address);
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0 ||
+        getsockname(listener, (struct sockaddr *)&address, &length) != 0) {
+        if (listener >= 0) {
+            close(listener);
+        }
+        return -1;
+    }
+    *port = ntohs(address.sin_port);
+    return listener;
+}
+
+/* AP down: retries back off to max_delay_ms (plus jitter) and never give up; AP back: connected within one delay. */
+static void test_ap_outage(const t_host_wifi_ap *ap) {
+    t_wifi_reconnect_stats stats;
+    t_host_wifi_stats before, after;
+    tlong max_with_jitter = TEST_MAX_MS + TEST_MAX_MS / 5;
+
+    host_wifi_get_stats(&before);
+    host_wifi_set_ap_up(ap->bssid, false);
+    vTaskDelay(pdMS_TO_TICKS(TEST_OUTAGE_MS));
+    host_wifi_get_stats(&after);
+    WiFi_Get_Reconnect_Stats(&stats);
+    tlong attempts = after.connect_attempts - before.connect_attempts;
+    // At least one per max delay once backed off; at most one per initial delay
+    CHECK(attempts >= TEST_OUTAGE_MS / max_with_jitter && attempts <= TEST_OUTAGE_MS / TEST_INITIAL_MS,
+          "%lu attempts in %u ms", (unsigned long)attempts, (unsigned)TEST_OUTAGE_MS);
+    CHECK(stats.next_delay_ms > TEST_INITIAL_MS && stats.next_delay_ms <= max_with_jitter, "next delay %lu ms",
+          (unsigned long)stats.next_delay_ms);
+    CHECK(stats.state != wifi_reconnect_gave_up, "gave up while the AP was down");
+
+    int64_t start = esp_timer_get_time();
+    host_wifi_set_ap_up(ap->bssid, true);
+    CHECK(wait_reconnect_state(wifi_reconnect_connected, 5000), "no reconnect after the AP came back");
+    tlong back_ms = elapsed_ms(start);
+    CHECK(back_ms <= max_with_jitter + 200, "reconnected after %lu ms", (unsigned long)back_ms);
+    printf("%-24s %lu attempts, back after %lu ms\n", "AP outage", (unsigned long)attempts, (unsigned long)back_ms);
+}
+
+/* A wrong password is retried auth_max_attempts times, then the station gives up. */
+static void test_wrong_password(void) {
+    t_host_wifi_stats before, after;
+
+    WiFi_Disable();
+    vTaskDelay(1);
+    host_wifi_get_stats(&before);
+    WiFi_Connect(TEST_SSID, "wrong-pass");
+    CHECK(wait_reconnect_state(wifi_reconnect_gave_up, 5000), "never gave up on a wrong password");
+    host_wifi_get_stats(&after);
+    tlong attempts = after.connect_attempts - before.connect_attempts;
+    CHECK(attempts == TEST_AUTH_ATTEMPTS, "%lu attempts before giving up", (unsigned long)attempts);
+    printf("%-24s gave up after %lu attempts\n", "wrong password", (unsigned long)attempts);
+}
+
+static void test_probe(void) {
+    t_wifi_probe_stats stats;
+    tword port = 0;
+    int listener = open_listener(&port);
+    if (listener < 0) {
+        printf("%-24s skipped: no loopback TCP\n", "probe");
+        return;
+    }
+    t_wifi_probe_config config = {
+        .targets = {
+            { .kind = wifi_probe_tcp, .address = "127.0.0.1", .port = port },
+            { .kind = wifi_probe_icmp, .address = "127.0.0.1" },
+        },
+        .target_count = 2, .period_ms = TEST_PROBE_PERIOD, .timeout_ms = 100, .fail_rounds = 2,
+    };
+
+    CHECK(WiFi_Probe_Start(&config) == ESP_OK, "probe start");
+    CHECK(wait_probe_state(wifi_probe_reachable, 2000) && WiFi_Check_Internet() == 1, "not reachable");
+
+    // The TCP target goes away: the round moves on to the ICMP target and the state holds
+    close(listener);
+    int64_t start = esp_timer_get_time();
+    do {
+        vTaskDelay(1);
+        WiFi_Probe_Get_Stats(&stats);
+    } while (stats.last_target != 1 && elapsed_ms(start) < 2000);
+    vTaskDelay(pdMS_TO_TICKS(10 * TEST_PROBE_PERIOD));
+    WiFi_Probe_Get_Stats(&stats);
+    CHECK(stats.last_target == 1 && stats.state == wifi_probe_reachable, "failover: target %u, state %d",
+          (unsigned)stats.last_target, (int)stats.state);
+    WiFi_Probe_Stop();
+
+    // A single target that goes away: unreachable after fail_rounds rounds without an answer
+    listener = open_listener(&port);
+    config.targets[0].port = port;
+    config.target_count = 1;
+    CHECK(listener >= 0 && WiFi_Probe_Start(&config) == ESP_OK, "probe restart");
+    CHECK(wait_probe_state(wifi_probe_reachable, 2000), "single target not reachable");
+    WiFi_Probe_Get_Stats(&stats);
+    tlong rounds = stats.rounds;
+    close(listener);
+    CHECK(wait_probe_state(wifi_probe_unreachable, 2000) && WiFi_Check_Internet() == 0, "never went unreachable");
+    WiFi_Probe_Get_Stats(&stats);
+    // The round in flight when the target went may still have been answered
+    CHECK(stats.rounds - rounds <= (tlong)config.fail_rounds + 1, "unreachable after %lu rounds",
+          (unsigned long)(stats.rounds - rounds));
+    printf("%-24s failover ok, unreachable after %lu rounds\n", "probe", (unsigned long)(stats.rounds - rounds));
+
+    // No IP on the station: nothing to probe from
+    WiFi_Disable();
+    CHECK(wait_probe_state(wifi_probe_no_link, 2000), "state %d with the radio off", (int)WiFi_Probe_Get_State());
+    WiFi_Probe_Stop();
+}
+
+int main(void) {
+    t_host_wifi_timing timing = { .scan_dwell_ms = 4, .auth_assoc_ms = 3, .dhcp_ms = 10 };
+    t_host_wifi_ap ap = {
+        .ssid = TEST_SSID, .password = TEST_PASSWORD, .bssid = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 },
+        .channel = 11, .rssi = -55, .lease_time_s = 2, .up = true
+    };
+    t_wifi_reconnect_policy policy = WIFI_RECONNECT_POLICY_DEFAULT();
+
+    ap.lease.ip.addr = ESP_IP4TOADDR(192, 168, 1, 50);
+    ap.lease.netmask.addr = ESP_IP4TOADDR(255, 255, 255, 0);
+    ap.lease.gw.addr = ESP_IP4TOADDR(192, 168, 1, 1);
+    host_wifi_set_timing(&timing);
+    host_wifi_add_ap(&ap);
+    remove(TEST_NVS_FILE);
+    host_nvs_set_file(TEST_NVS_FILE);
+
+    policy.initial_delay_ms = TEST_INITIAL_MS;
+    policy.max_delay_ms = TEST_MAX_MS;
+    policy.auth_retry_delay_ms = TEST_AUTH_MS;
+    policy.auth_max_attempts = TEST_AUTH_ATTEMPTS;
+    WiFi_Init();
+    WiFi_Set_Reconnect_Policy(&policy);
+    WiFi_Connect(TEST_SSID, TEST_PASSWORD);
+    CHECK(wait_reconnect_state(wifi_reconnect_connected, 5000), "no IP after WiFi_Connect");
+
+    test_ap_outage(&ap);
+    test_wrong_password();
+    WiFi_Connect(TEST_SSID, TEST_PASSWORD);
+    CHECK(wait_reconnect_state(wifi_reconnect_connected, 5000), "no IP after the wrong password");
+    test_probe();
+
+    remove(TEST_NVS_FILE);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
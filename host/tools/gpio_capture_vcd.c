@@ -0,0 +1,139 @@
+/******************************************************************************************************************************
+ File Name      : gpio_capture_vcd.c
+ Description    : Host tool: converts a GPIO capture (GPIO_Capture_Serialize / GPIO_Capture_Export) to a VCD file
+ Device(s)      : Host (Linux)
+*********************************************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.h"
+
+#define TRIGGER_ID  '~'         // VCD identifier of the trigger marker; channels use '!' + channel
+
+static tword get_le16(const tbyte *in) {
+    return (tword)(in[0] | (in[1] << 8));
+}
+
+static tlong get_le32(const tbyte *in) {
+    return get_le16(in) | ((tlong)get_le16(in + 2) << 16);
+}
+
+static tbyte *read_all(FILE *file, size_t *length) {
+    size_t capacity = 4096;
+    tbyte *data = malloc(capacity);
+    *length = 0;
+    size_t got;
+    while (data != NULL && (got = fread(data + *length, 1, capacity - *length, file)) > 0) {
+        *length += got;
+        if (*length == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+    return data;
+}
+
+static int convert(const tbyte *data, size_t length, FILE *out) {
+    if (length < GPIO_CAPTURE_HEADER_SIZE + 4 || get_le32(data) != GPIO_CAPTURE_MAGIC) {
+        fprintf(stderr, "not a GPIO capture\n");
+        return 1;
+    }
+    if (data[4] != GPIO_CAPTURE_VERSION) {
+        fprintf(stderr, "unsupported capture version %u\n", data[4]);
+        return 1;
+    }
+    tbyte channels = data[5];
+    tlong count = get_le32(data + 8);
+    tlong trigger = get_le32(data + 12);
+    tword time_hi = get_le16(data + 16);
+    tword levels = get_le16(data + 18);
+    const tbyte *pins = data + 20;
+    size_t size = GPIO_CAPTURE_HEADER_SIZE + (size_t)count * GPIO_CAPTURE_RECORD_SIZE + 4;
+    if (channels > GPIO_CAPTURE_CHANNELS || length < size) {
+        fprintf(stderr, "truncated capture: %zu of %zu bytes\n", length, size);
+        return 1;
+    }
+    if (CRC32_Update(CRC32_INIT, data, size - 4) != get_le32(data + size - 4)) {
+        fprintf(stderr, "capture CRC mismatch\n");
+        return 1;
+    }
+
+    // Times are written relative to the first record
+    const tbyte *records = data + GPIO_CAPTURE_HEADER_SIZE;
+    uint64_t origin = count > 0 ? ((uint64_t)time_hi << 32) | get_le32(records) : 0;
+    if (count > 0 && get_le16(records + 4) == 0) {
+        origin = ((uint64_t)get_le16(records + 6) << 32) | get_le32(records);
+    }
+
+    fprintf(out, "$comment GPIO capture, %u records, first at %llu us $end\n", count, (unsigned long long)origin);
+    fprintf(out, "$timescale 1us $end\n$scope module gpio $end\n");
+    for (tbyte ch = 0; ch < channels; ch++) {
+        fprintf(out, "$var wire 1 %c gpio%u $end\n", '!' + ch, pins[ch]);
+    }
+    fprintf(out, "$var wire 1 %c trigger $end\n$upscope $end\n$enddefinitions $end\n", TRIGGER_ID);
+    fprintf(out, "#0\n$dumpvars\n");
+    for (tbyte ch = 0; ch < channels; ch++) {
+        fprintf(out, "%u%c\n", (levels >> ch) & 1, '!' + ch);
+    }
+    fprintf(out, "0%c\n$end\n", TRIGGER_ID);
+
+    uint64_t last = 0;
+    for (tlong i = 0; i < count; i++) {
+        const tbyte *record = records + (size_t)i * GPIO_CAPTURE_RECORD_SIZE;
+        tword changed = get_le16(record + 4);
+        tword value = get_le16(record + 6);
+        if (changed == 0) {
+            time_hi = value;
+            continue;
+        }
+        uint64_t time = (((uint64_t)time_hi << 32) | get_le32(record)) - origin;
+        if (time != last) {
+            fprintf(out, "#%llu\n", (unsigned long long)time);
+            last = time;
+        }
+        for (tbyte ch = 0; ch < channels; ch++) {
+            if (changed & (1u << ch)) {
+                fprintf(out, "%u%c\n", (value >> ch) & 1, '!' + ch);
+            }
+        }
+        if (i == trigger) {
+            fprintf(out, "1%c\n", TRIGGER_ID);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <capture.bin | -> [out.vcd]\n", argv[0]);
+        return 2;
+    }
+    FILE *in = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    size_t length;
+    tbyte *data = read_all(in, &length);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (data == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    FILE *out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (out == NULL) {
+        perror(argv[2]);
+        free(data);
+        return 1;
+    }
+    int status = convert(data, length, out);
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(data);
+    return status;
+}
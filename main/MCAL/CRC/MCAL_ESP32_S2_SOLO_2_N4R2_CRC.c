@@ -0,0 +1,146 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_CRC.C
+ Description    : Word-at-a-time byte sum and slice-by-8 CRC-8/16/32
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
+#include <string.h>
+#include <stdatomic.h>
+
+#define CRC8_POLY           0x07
+#define CRC16_CCITT_POLY    0x1021
+#define CRC32_POLY          0xEDB88320u     // 0x04C11DB7 reflected
+#define CRC_SLICES          8
+
+#define CRC_SUM8_BLOCK_WORDS 128            // Keeps every 16-bit lane below 65536 (128 * 2 * 255)
+
+// table[0] is the classic byte table; table[k][i] is the CRC of byte i followed by k zero bytes.
+static tbyte crc8_table[CRC_SLICES][256];
+static tword crc16_table[CRC_SLICES][256];
+static tlong crc32_table[CRC_SLICES][256];
+static atomic_bool tables_ready;
+
+// The CPU is little-endian; memcpy keeps unaligned loads legal and compiles to a plain load when aligned.
+static inline tlong load_le32(const tbyte *data) {
+    tlong word;
+    memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+void CRC_Init(void) {
+    if (atomic_load_explicit(&tables_ready, memory_order_acquire)) {
+        return;
+    }
+    // Concurrent first callers all write identical values, so no lock is needed
+    for (int i = 0; i < 256; i++) {
+        tbyte c8 = (tbyte)i;
+        tword c16 = (tword)(i << 8);
+        tlong c32 = (tlong)i;
+        for (int bit = 0; bit < 8; bit++) {
+            c8 = (c8 & 0x80) ? (tbyte)((c8 << 1) ^ CRC8_POLY) : (tbyte)(c8 << 1);
+            c16 = (c16 & 0x8000) ? (tword)((c16 << 1) ^ CRC16_CCITT_POLY) : (tword)(c16 << 1);
+            c32 = (c32 & 1) ? (c32 >> 1) ^ CRC32_POLY : c32 >> 1;
+        }
+        crc8_table[0][i] = c8;
+        crc16_table[0][i] = c16;
+        crc32_table[0][i] = c32;
+    }
+    for (int k = 1; k < CRC_SLICES; k++) {
+        for (int i = 0; i < 256; i++) {
+            crc8_table[k][i] = crc8_table[0][crc8_table[k - 1][i]];
+            crc16_table[k][i] = (tword)(crc16_table[k - 1][i] << 8) ^ crc16_table[0][crc16_table[k - 1][i] >> 8];
+            crc32_table[k][i] = (crc32_table[k - 1][i] >> 8) ^ crc32_table[0][crc32_table[k - 1][i] & 0xFF];
+        }
+    }
+    atomic_store_explicit(&tables_ready, true, memory_order_release);
+}
+
+tbyte CRC_Sum8_Update(tbyte sum, const tbyte *data, size_t length) {
+    tlong total = sum;
+
+    while (length >= 4) {
+        // even collects bytes 0 and 2 of each word in two 16-bit lanes; words is the plain 32-bit sum.
+        // Since word = even_bytes + (odd_bytes << 8), the odd lanes fall out as (words - even) >> 8,
+        // which costs one mask and two adds per four bytes.
+        size_t count = length / 4;
+        if (count > CRC_SUM8_BLOCK_WORDS) {
+            count = CRC_SUM8_BLOCK_WORDS;
+        }
+        tlong even = 0;
+        tlong words = 0;
+        for (size_t i = 0; i < count; i++) {
+            tlong word = load_le32(data);
+            even += word & 0x00FF00FF;
+            words += word;
+            data += 4;
+        }
+        tlong odd = (words - even) >> 8;    // Upper odd lane is only valid modulo 256, which is all we need
+        total += (even & 0xFFFF) + (even >> 16) + (odd & 0xFFFF) + ((odd >> 16) & 0xFF);
+        length -= count * 4;
+    }
+    while (length-- > 0) {
+        total += *data++;
+    }
+    return (tbyte)total;
+}
+
+tbyte CRC_FCC_Calculate(const tbyte *data, size_t length) {
+    return (tbyte)(0 - CRC_Sum8_Update(CRC_SUM8_INIT, data, length));
+}
+
+tbyte CRC8_Update(tbyte crc, const tbyte *data, size_t length) {
+    CRC_Init();
+    while (length >= 8) {
+        crc = crc8_table[7][crc ^ data[0]] ^ crc8_table[6][data[1]] ^
+              crc8_table[5][data[2]] ^ crc8_table[4][data[3]] ^
+              crc8_table[3][data[4]] ^ crc8_table[2][data[5]] ^
+              crc8_table[1][data[6]] ^ crc8_table[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = crc8_table[0][crc ^ *data++];
+    }
+    return crc;
+}
+
+tword CRC16_CCITT_Update(tword crc, const tbyte *data, size_t length) {
+    CRC_Init();
+    while (length >= 8) {
+        // The 16-bit CRC overlaps the first two bytes of the block
+        crc = crc16_table[7][(crc >> 8) ^ data[0]] ^ crc16_table[6][(crc & 0xFF) ^ data[1]] ^
+              crc16_table[5][data[2]] ^ crc16_table[4][data[3]] ^
+              crc16_table[3][data[4]] ^ crc16_table[2][data[5]] ^
+              crc16_table[1][data[6]] ^ crc16_table[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (tword)(crc << 8) ^ crc16_table[0][(crc >> 8) ^ *data++];
+    }
+    return crc;
+}
+
+tlong CRC32_Update(tlong crc, const tbyte *data, size_t length) {
+    CRC_Init();
+    crc = ~crc;
+    while (length >= 8) {
+        tlong one = load_le32(data) ^ crc;
+        tlong two = load_le32(data + 4);
+        crc = crc32_table[7][one & 0xFF] ^ crc32_table[6][(one >> 8) & 0xFF] ^
+              crc32_table[5][(one >> 16) & 0xFF] ^ crc32_table[4][one >> 24] ^
+              crc32_table[3][two & 0xFF] ^ crc32_table[2][(two >> 8) & 0xFF] ^
+              crc32_table[1][(two >> 16) & 0xFF] ^ crc32_table[0][two >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ crc32_table[0][(crc ^ *data++) & 0xFF];
+    }
+    return ~crc;
+}
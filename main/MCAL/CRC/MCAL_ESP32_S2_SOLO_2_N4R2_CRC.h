@@ -0,0 +1,86 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_CRC.H
+ Description    : This file as Header for (Checksum / CRC)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_CRC_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_CRC_H_
+
+#include "../ESP32_S2_SOLO_2_N4R2_Main.h"
+
+/*
+ * Every *_Update() function is streaming: pass the *_INIT value for the first block and the
+ * previous return value for each following block. Splitting the input anywhere gives the same
+ * result as one call over the whole buffer.
+ *
+ *   Algorithm            Polynomial   Init     Reflected  XorOut     Check ("123456789")
+ *   Sum8 (FCC)           -            0x00     -          -          0xDD (sum), FCC = 0x23
+ *   CRC-8/SMBUS          0x07         0x00     no         0x00       0xF4
+ *   CRC-16/CCITT-FALSE   0x1021       0xFFFF   no         0x0000     0x29B1
+ *   CRC-32 (IEEE, zlib)  0x04C11DB7   0x0      yes        0xFFFFFFFF 0xCBF43926
+ *
+ * The CRCs use slice-by-8 lookup tables (CRC-32 8 KB, CRC-16 4 KB, CRC-8 2 KB). They are built
+ * in DRAM on first use, or up front with CRC_Init() to keep that cost out of a time-critical path.
+ */
+#define CRC_SUM8_INIT       0x00
+#define CRC8_INIT           0x00
+#define CRC16_CCITT_INIT    0xFFFF
+#define CRC32_INIT          0x00000000
+
+/**
+* @brief Builds the CRC lookup tables. Optional; every CRC function does it on first use.
+*/
+void CRC_Init(void);
+
+/**
+* @brief Adds bytes to a running 8-bit byte sum, four bytes per iteration.
+*
+* @param sum    Previous sum, or CRC_SUM8_INIT.
+* @param data   Bytes to add.
+* @param length Number of bytes.
+* @return The byte sum modulo 256.
+*/
+tbyte CRC_Sum8_Update(tbyte sum, const tbyte *data, size_t length);
+
+/**
+* @brief Computes the frame check character (two's complement of the byte sum).
+*
+* Same value as calculate_fcc(): the byte sum of the data followed by its FCC is zero.
+*/
+tbyte CRC_FCC_Calculate(const tbyte *data, size_t length);
+
+/**
+* @brief Updates a CRC-8/SMBUS value.
+*
+* @param crc    Previous value, or CRC8_INIT.
+* @param data   Bytes to add.
+* @param length Number of bytes.
+* @return The updated CRC.
+*/
+tbyte CRC8_Update(tbyte crc, const tbyte *data, size_t length);
+
+/**
+* @brief Updates a CRC-16/CCITT-FALSE value.
+*
+* @param crc    Previous value, or CRC16_CCITT_INIT.
+* @param data   Bytes to add.
+* @param length Number of bytes.
+* @return The updated CRC.
+*/
+tword CRC16_CCITT_Update(tword crc, const tbyte *data, size_t length);
+
+/**
+* @brief Updates a CRC-32 (IEEE 802.3, same as zlib crc32()) value.
+*
+* @param crc    Previous value, or CRC32_INIT.
+* @param data   Bytes to add.
+* @param length Number of bytes.
+* @return The updated CRC.
+*/
+tlong CRC32_Update(tlong crc, const tbyte *data, size_t length);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_CRC_H_ */
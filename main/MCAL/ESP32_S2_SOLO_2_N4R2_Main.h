@@ -34,6 +34,7 @@
 
 #include "driver/gpio.h"
 #include "soc/io_mux_reg.h"
+#include "soc/gpio_reg.h"
 #include "driver/adc.h"
 #include "driver/periph_ctrl.h"
 #include "soc/sens_reg.h"
@@ -51,6 +52,7 @@
 /*==============================================================================================================================*/
 /* Definitions */
 
+#define GPIO_VALID_MASK     (0x00007FFFFC3FFFFFULL)     // GPIO 0-21 and 26-46 (22-25 are not bonded out)
 
 /*==============================================================================================================================*/
 /* BIT Math  */
@@ -64,55 +66,14 @@
 
 #define GPIO_SAFEGUARD_Init() \
     do { \
-        /* Set GPIO direction to input for all available pins on ESP32-S2 */ \
+        /* Release every output driver first: all pins are inputs after two register writes */ \
+        REG_WRITE(GPIO_ENABLE_W1TC_REG, (tlong)GPIO_VALID_MASK); \
+        REG_WRITE(GPIO_ENABLE1_W1TC_REG, (tlong)(GPIO_VALID_MASK >> 32)); \
+        /* Then set GPIO direction to input, pulls and interrupts off, for all available pins on ESP32-S2 */ \
         gpio_config_t io_conf; \
         io_conf.intr_type = GPIO_INTR_DISABLE; \
         io_conf.mode = GPIO_MODE_INPUT; \
-        io_conf.pin_bit_mask = ( \
-            (1ULL << GPIO_NUM_0) | \
-            (1ULL << GPIO_NUM_1) | \
-            (1ULL << GPIO_NUM_2) | \
-            (1ULL << GPIO_NUM_3) | \
-            (1ULL << GPIO_NUM_4) | \
-            (1ULL << GPIO_NUM_5) | \
-            (1ULL << GPIO_NUM_6) | \
-            (1ULL << GPIO_NUM_7) | \
-            (1ULL << GPIO_NUM_8) | \
-            (1ULL << GPIO_NUM_9) | \
-            (1ULL << GPIO_NUM_10) | \
-            (1ULL << GPIO_NUM_11) | \
-            (1ULL << GPIO_NUM_12) | \
-            (1ULL << GPIO_NUM_13) | \
-            (1ULL << GPIO_NUM_14) | \
-            (1ULL << GPIO_NUM_15) | \
-            (1ULL << GPIO_NUM_16) | \
-            (1ULL << GPIO_NUM_17) | \
-            (1ULL << GPIO_NUM_18) | \
-            (1ULL << GPIO_NUM_19) | \
-            (1ULL << GPIO_NUM_20) | \
-            (1ULL << GPIO_NUM_21) | \
-            (1ULL << GPIO_NUM_26) | \
-            (1ULL << GPIO_NUM_27) | \
-            (1ULL << GPIO_NUM_28) | \
-            (1ULL << GPIO_NUM_29) | \
-            (1ULL << GPIO_NUM_30) | \
-            (1ULL << GPIO_NUM_31) | \
-            (1ULL << GPIO_NUM_32) | \
-            (1ULL << GPIO_NUM_33) | \
-            (1ULL << GPIO_NUM_34) | \
-            (1ULL << GPIO_NUM_35) | \
-            (1ULL << GPIO_NUM_36) | \
-            (1ULL << GPIO_NUM_37) | \
-            (1ULL << GPIO_NUM_38) | \
-            (1ULL << GPIO_NUM_39) | \
-            (1ULL << GPIO_NUM_40) | \
-            (1ULL << GPIO_NUM_41) | \
-            (1ULL << GPIO_NUM_42) | \
-            (1ULL << GPIO_NUM_43) | \
-            (1ULL << GPIO_NUM_44) | \
-            (1ULL << GPIO_NUM_45) | \
-            (1ULL << GPIO_NUM_46) \
-        ); \
+        io_conf.pin_bit_mask = GPIO_VALID_MASK; \
         io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE; \
         io_conf.pull_up_en = GPIO_PULLUP_DISABLE; \
         gpio_config(&io_conf); \
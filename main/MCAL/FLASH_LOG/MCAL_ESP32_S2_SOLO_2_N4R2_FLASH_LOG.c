@@ -0,0 +1,593 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG.C
+ Description    : Append-only record log over a flash partition (sector ring, buffered page-aligned writes)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG.h"
+#include "../CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define LOG_SECTOR_MAGIC    0x474F4C46u     // "FLOG"
+#define LOG_ALIGN(n)        (((n) + 3u) & ~3u)
+#define LOG_RECORD_SIZE(n)  (sizeof(t_record_header) + LOG_ALIGN(n) + sizeof(tlong))
+#define SEQ_BEFORE(a, b)    ((tslong)((a) - (b)) < 0)   // Wrap-safe a < b
+
+typedef struct {
+    tlong magic;
+    tlong sector_seq;
+    tlong first_seq;        // Sequence of the first record written to the sector
+    tlong crc;              // CRC-32 of the fields above
+} t_sector_header;
+
+typedef struct {
+    tword length;
+    tword length_inv;       // ~length: an erased or half-programmed header fails this check
+    tlong seq;
+} t_record_header;
+
+typedef struct {
+    bool valid;             // Part of the ring (between tail and head)
+    tlong sector_seq;
+    tlong first_seq;
+} t_sector_info;
+
+struct t_flash_log {
+    const esp_partition_t *partition;
+    SemaphoreHandle_t lock;
+    tword sectors;
+    t_sector_info *info;
+    tword head;             // Sector being filled
+    tword tail;             // Oldest sector
+    tword used;             // Sectors from tail to head
+    tlong next_seq;
+    tlong next_sector_seq;
+    bool head_sealed;       // No more appends to the head sector (full, or torn data after the last record)
+    tword fill;             // Head-sector offset of the next append
+    tword flushed;          // Head-sector bytes already on flash
+    tword buffer_base;      // Head-sector offset of buffer[0]
+    tbyte buffer[FLASH_LOG_BUFFER_SIZE];
+    t_flash_log_stats stats;
+};
+
+_Static_assert(sizeof(t_sector_header) == FLASH_LOG_SECTOR_HEADER, "sector header size");
+_Static_assert(sizeof(t_record_header) + sizeof(tlong) == FLASH_LOG_RECORD_OVERHEAD, "record overhead");
+_Static_assert(FLASH_LOG_SECTOR_SIZE % FLASH_LOG_BUFFER_SIZE == 0, "FLASH_LOG_BUFFER_SIZE must divide the sector size");
+_Static_assert(FLASH_LOG_MAX_RECORD < 0xFFFF, "record length must fit a tword");
+
+static tlong seq_after(tlong seq) {
+    seq++;
+    return seq != FLASH_LOG_SEQ_OLDEST ? seq : seq + 1;
+}
+
+static size_t log_address(tword sector, tword offset) {
+    return (size_t)sector * FLASH_LOG_SECTOR_SIZE + offset;
+}
+
+static tlong sector_header_crc(const t_sector_header *header) {
+    return CRC32_Update(CRC32_INIT, (const tbyte *)header, offsetof(t_sector_header, crc));
+}
+
+/*==============================================================================================================================*/
+/* Writing */
+
+// Programs the buffered bytes that are not on flash yet
+static esp_err_t log_flush(t_flash_log *log) {
+    esp_err_t err = ESP_OK;
+    if (log->fill > log->flushed) {
+        err = esp_partition_write(log->partition, log_address(log->head, log->flushed),
+                                  &log->buffer[log->flushed - log->buffer_base], log->fill - log->flushed);
+        log->stats.flash_writes++;
+        if (err == ESP_OK) {
+            log->flushed = log->fill;
+        }
+    }
+    if (err == ESP_OK && log->fill - log->buffer_base == FLASH_LOG_BUFFER_SIZE) {
+        log->buffer_base += FLASH_LOG_BUFFER_SIZE;
+    }
+    return err;
+}
+
+static esp_err_t log_put(t_flash_log *log, const void *src, size_t length) {
+    const tbyte *bytes = src;
+    while (length > 0) {
+        size_t room = FLASH_LOG_BUFFER_SIZE - (log->fill - log->buffer_base);
+        size_t chunk = length < room ? length : room;
+        memcpy(&log->buffer[log->fill - log->buffer_base], bytes, chunk);
+        log->fill += chunk;
+        bytes += chunk;
+        length -= chunk;
+        if (chunk == room) {
+            esp_err_t err = log_flush(log);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+// Recycles the next sector of the ring (dropping its records if the ring is full) and makes it the head.
+// On failure the old head stays current but sealed, and the next append tries again.
+static esp_err_t log_open_sector(t_flash_log *log) {
+    if (log->used > 0 && !log->head_sealed) {
+        log_flush(log);     // On failure the buffered records are lost, like on a reset
+    }
+    log->head_sealed = true;
+    log->fill = log->flushed;
+
+    tword next = (log->head + 1) % log->sectors;
+    if (log->info[next].valid) {
+        tword after = (next + 1) % log->sectors;
+        log->stats.records_dropped += log->info[after].first_seq - log->info[next].first_seq;
+        log->info[next].valid = false;
+        log->tail = after;
+        log->used--;
+    }
+
+    log->stats.sector_erases++;
+    esp_err_t err = esp_partition_erase_range(log->partition, log_address(next, 0), FLASH_LOG_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    t_sector_header header = {
+        .magic = LOG_SECTOR_MAGIC,
+        .sector_seq = log->next_sector_seq,
+        .first_seq = log->next_seq,
+    };
+    header.crc = sector_header_crc(&header);
+    log->stats.flash_writes++;
+    err = esp_partition_write(log->partition, log_address(next, 0), &header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    log->info[next] = (t_sector_info){ .valid = true, .sector_seq = header.sector_seq, .first_seq = header.first_seq };
+    if (log->used == 0) {
+        log->tail = next;
+    }
+    log->head = next;
+    log->used++;
+    log->next_sector_seq++;
+    log->head_sealed = false;
+    log->fill = FLASH_LOG_SECTOR_HEADER;
+    log->flushed = FLASH_LOG_SECTOR_HEADER;
+    log->buffer_base = 0;
+    return ESP_OK;
+}
+
+/*==============================================================================================================================*/
+/* Reading */
+
+// Reads sector bytes, taking the part of the head sector that is still buffered from RAM
+static esp_err_t log_read(const t_flash_log *log, tword sector, tword offset, void *dst, size_t length) {
+    tbyte *bytes = dst;
+    if (sector == log->head && offset + length > log->flushed) {
+        size_t from_flash = offset < log->flushed ? log->flushed - offset : 0;
+        memcpy(bytes + from_flash, &log->buffer[offset + from_flash - log->buffer_base], length - from_flash);
+        length = from_flash;
+    }
+    return length > 0 ? esp_partition_read(log->partition, log_address(sector, offset), bytes, length) : ESP_OK;
+}
+
+// First sequence after the records of a sector
+static tlong sector_seq_limit(const t_flash_log *log, tword sector) {
+    return sector == log->head ? log->next_seq : log->info[(sector + 1) % log->sectors].first_seq;
+}
+
+// Length checks shared by reads and recovery; the record must also fit the sector from 'offset'
+static bool record_length_valid(tword offset, const t_record_header *header) {
+    tword inverted = (tword)~header->length;
+    return inverted == header->length_inv && header->length > 0 && header->length <= FLASH_LOG_MAX_RECORD &&
+           offset + LOG_RECORD_SIZE(header->length) <= FLASH_LOG_SECTOR_SIZE;
+}
+
+static bool record_header_valid(const t_flash_log *log, tword sector, tword offset, const t_record_header *header) {
+    return record_length_valid(offset, header) &&
+           !SEQ_BEFORE(header->seq, log->info[sector].first_seq) && SEQ_BEFORE(header->seq, sector_seq_limit(log, sector));
+}
+
+// CRC of a record whose payload is still in flash (used while opening, before any buffer exists)
+static esp_err_t record_crc_matches(const t_flash_log *log, tword sector, tword offset, const t_record_header *header,
+                                    bool *matches) {
+    tbyte chunk[64];
+    tlong crc = CRC32_Update(CRC32_INIT, (const tbyte *)header, sizeof(*header));
+    size_t position = offset + sizeof(*header);
+    size_t remaining = header->length;
+    while (remaining > 0) {
+        size_t length = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+        esp_err_t err = esp_partition_read(log->partition, log_address(sector, position), chunk, length);
+        if (err != ESP_OK) {
+            return err;
+        }
+        crc = CRC32_Update(crc, chunk, length);
+        position += length;
+        remaining -= length;
+    }
+    tlong stored;
+    esp_err_t err = esp_partition_read(log->partition, log_address(sector, offset + LOG_ALIGN(header->length) +
+                                       sizeof(*header)), &stored, sizeof(stored));
+    *matches = err == ESP_OK && stored == crc;
+    return err;
+}
+
+static bool sector_erased_from(const t_flash_log *log, tword sector, tword offset) {
+    tlong chunk[16];
+    while (offset < FLASH_LOG_SECTOR_SIZE) {
+        size_t remaining = (size_t)(FLASH_LOG_SECTOR_SIZE - offset);
+        size_t length = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+        if (esp_partition_read(log->partition, log_address(sector, offset), chunk, length) != ESP_OK) {
+            return false;
+        }
+        for (size_t i = 0; i < length / sizeof(tlong); i++) {
+            if (chunk[i] != 0xFFFFFFFFu) {
+                return false;
+            }
+        }
+        offset += length;
+    }
+    return true;
+}
+
+/*==============================================================================================================================*/
+/* Opening */
+
+static esp_err_t log_recover(t_flash_log *log) {
+    bool any = false;
+    for (tword s = 0; s < log->sectors; s++) {
+        t_sector_header header;
+        esp_err_t err = esp_partition_read(log->partition, log_address(s, 0), &header, sizeof(header));
+        if (err != ESP_OK) {
+            return err;
+        }
+        log->info[s].valid = header.magic == LOG_SECTOR_MAGIC && header.crc == sector_header_crc(&header);
+        log->info[s].sector_seq = header.sector_seq;
+        log->info[s].first_seq = header.first_seq;
+        if (log->info[s].valid && (!any || SEQ_BEFORE(log->info[log->head].sector_seq, header.sector_seq))) {
+            log->head = s;
+            any = true;
+        }
+    }
+    if (!any) {
+        // Blank or foreign partition: start a new ring at sector 0
+        log->head = log->sectors - 1;
+        log->next_seq = 1;
+        log->next_sector_seq = 1;
+        return log_open_sector(log);
+    }
+
+    // The ring is the run of sectors before the head whose sequences count down by one
+    tlong head_seq = log->info[log->head].sector_seq;
+    log->used = 0;
+    for (tword k = 0; k < log->sectors; k++) {
+        tword s = (log->head + log->sectors - k) % log->sectors;
+        if (!log->info[s].valid || log->info[s].sector_seq != head_seq - k) {
+            break;
+        }
+        log->tail = s;
+        log->used++;
+    }
+    for (tword s = 0; s < log->sectors; s++) {
+        tword age = (log->head + log->sectors - s) % log->sectors;
+        log->info[s].valid = log->info[s].valid && age < log->used;
+    }
+    log->next_sector_seq = head_seq + 1;
+
+    // Find the end of the head sector; seq limits are open-ended until next_seq is known
+    tword offset = FLASH_LOG_SECTOR_HEADER;
+    log->next_seq = log->info[log->head].first_seq;
+    log->head_sealed = false;
+    while (offset + sizeof(t_record_header) <= FLASH_LOG_SECTOR_SIZE) {
+        t_record_header header;
+        esp_err_t err = esp_partition_read(log->partition, log_address(log->head, offset), &header, sizeof(header));
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (header.length == 0xFFFF && header.length_inv == 0xFFFF && header.seq == 0xFFFFFFFFu) {
+            break;
+        }
+        bool matches = false;
+        if (header.seq == log->next_seq && record_length_valid(offset, &header)) {
+            err = record_crc_matches(log, log->head, offset, &header, &matches);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        if (!matches) {
+            log->stats.torn_records++;
+            log->head_sealed = true;
+            break;
+        }
+        log->next_seq = seq_after(header.seq);
+        offset += LOG_RECORD_SIZE(header.length);
+    }
+    if (!log->head_sealed && !sector_erased_from(log, log->head, offset)) {
+        // Programmed bytes past the last record: a write was cut before its header landed
+        log->stats.torn_records++;
+        log->head_sealed = true;
+    }
+    log->fill = offset;
+    log->flushed = offset;
+    log->buffer_base = offset & ~(FLASH_LOG_BUFFER_SIZE - 1);
+    return ESP_OK;
+}
+
+esp_err_t Flash_Log_Open(const tsbyte *label, t_flash_log **log) {
+    if (log == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+        label != NULL ? ESP_PARTITION_SUBTYPE_ANY : (esp_partition_subtype_t)FLASH_LOG_PARTITION_SUBTYPE, label);
+    if (partition == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (partition->size / FLASH_LOG_SECTOR_SIZE < 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    t_flash_log *created = calloc(1, sizeof(t_flash_log));
+    if (created != NULL) {
+        created->sectors = partition->size / FLASH_LOG_SECTOR_SIZE;
+        created->info = calloc(created->sectors, sizeof(t_sector_info));
+        created->lock = xSemaphoreCreateMutex();
+    }
+    if (created == NULL || created->info == NULL || created->lock == NULL) {
+        if (created != NULL) {
+            free(created->info);
+            if (created->lock != NULL) {
+                vSemaphoreDelete(created->lock);
+            }
+            free(created);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    created->partition = partition;
+
+    esp_err_t err = log_recover(created);
+    if (err != ESP_OK) {
+        vSemaphoreDelete(created->lock);
+        free(created->info);
+        free(created);
+        return err;
+    }
+    *log = created;
+    return ESP_OK;
+}
+
+esp_err_t Flash_Log_Close(t_flash_log *log) {
+    if (log == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = Flash_Log_Sync(log);
+    vSemaphoreDelete(log->lock);
+    free(log->info);
+    free(log);
+    return err;
+}
+
+/*==============================================================================================================================*/
+/* API */
+
+esp_err_t Flash_Log_Append(t_flash_log *log, const void *data, size_t length, tlong *seq) {
+    if (log == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (length == 0 || length > FLASH_LOG_MAX_RECORD) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    static const tbyte padding[3] = { 0 };
+    t_record_header header = {
+        .length = (tword)length,
+        .length_inv = (tword)~length,
+    };
+
+    xSemaphoreTake(log->lock, portMAX_DELAY);
+    esp_err_t err = ESP_OK;
+    if (log->head_sealed || log->fill + LOG_RECORD_SIZE(length) > FLASH_LOG_SECTOR_SIZE) {
+        err = log_open_sector(log);
+    }
+    if (err == ESP_OK) {
+        header.seq = log->next_seq;
+        tlong crc = CRC32_Update(CRC32_INIT, (const tbyte *)&header, sizeof(header));
+        crc = CRC32_Update(crc, data, length);
+        err = log_put(log, &header, sizeof(header));
+        if (err == ESP_OK) {
+            err = log_put(log, data, length);
+        }
+        if (err == ESP_OK) {
+            err = log_put(log, padding, LOG_ALIGN(length) - length);
+        }
+        if (err == ESP_OK) {
+            err = log_put(log, &crc, sizeof(crc));
+        }
+        if (err != ESP_OK) {
+            // Whatever reached flash fails its CRC; continue in a fresh sector
+            log->head_sealed = true;
+            log->fill = log->flushed;
+        }
+    }
+    if (err == ESP_OK) {
+        if (seq != NULL) {
+            *seq = header.seq;
+        }
+        log->next_seq = seq_after(header.seq);
+        log->stats.records_appended++;
+        log->stats.bytes_appended += length;
+    }
+    xSemaphoreGive(log->lock);
+    return err;
+}
+
+esp_err_t Flash_Log_Sync(t_flash_log *log) {
+    if (log == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(log->lock, portMAX_DELAY);
+    esp_err_t err = log->head_sealed ? ESP_OK : log_flush(log);
+    xSemaphoreGive(log->lock);
+    return err;
+}
+
+esp_err_t Flash_Log_Erase(t_flash_log *log) {
+    if (log == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(log->lock, portMAX_DELAY);
+    esp_err_t err = ESP_OK;
+    // Oldest first, so an interrupted erase leaves the newest records rather than a gap
+    while (log->used > 0 && err == ESP_OK) {
+        tword sector = log->tail;
+        err = esp_partition_erase_range(log->partition, log_address(sector, 0), FLASH_LOG_SECTOR_SIZE);
+        log->stats.sector_erases++;
+        log->info[sector].valid = false;
+        log->tail = (sector + 1) % log->sectors;
+        log->used--;
+    }
+    if (err == ESP_OK) {
+        err = log_open_sector(log);
+    }
+    xSemaphoreGive(log->lock);
+    return err;
+}
+
+// Moves an iterator to the start of a sector
+static void iter_enter(t_flash_log_iter *iter, tword sector) {
+    iter->sector = sector;
+    iter->offset = FLASH_LOG_SECTOR_HEADER;
+    iter->sector_seq = iter->log->info[sector].sector_seq;
+}
+
+esp_err_t Flash_Log_Iter_Init(t_flash_log *log, tlong from_seq, t_flash_log_iter *iter) {
+    if (log == NULL || iter == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(log->lock, portMAX_DELAY);
+    iter->log = log;
+    iter->lost = 0;
+    tlong first_seq = log->used > 0 ? log->info[log->tail].first_seq : log->next_seq;
+    if (log->used == 0) {
+        // Only after a failed erase; Flash_Log_Read_Next() repositions once a sector is open again
+        iter->next_seq = log->next_seq;
+        iter->sector = log->head;
+        iter->offset = FLASH_LOG_SECTOR_HEADER;
+        iter->sector_seq = 0;
+    } else if (from_seq == FLASH_LOG_SEQ_OLDEST || SEQ_BEFORE(from_seq, first_seq)) {
+        if (from_seq != FLASH_LOG_SEQ_OLDEST) {
+            iter->lost = first_seq - from_seq;
+        }
+        iter->next_seq = first_seq;
+        iter_enter(iter, log->tail);
+    } else if (!SEQ_BEFORE(from_seq, log->next_seq)) {
+        iter->next_seq = log->next_seq;
+        iter_enter(iter, log->head);
+        iter->offset = log->fill;
+    } else {
+        tword sector = log->tail;
+        while (sector != log->head && !SEQ_BEFORE(from_seq, sector_seq_limit(log, sector))) {
+            sector = (sector + 1) % log->sectors;
+        }
+        iter->next_seq = from_seq;
+        iter_enter(iter, sector);
+    }
+    xSemaphoreGive(log->lock);
+    return ESP_OK;
+}
+
+esp_err_t Flash_Log_Read_Next(t_flash_log_iter *iter, void *data, size_t capacity, size_t *length, tlong *seq) {
+    if (iter == NULL || iter->log == NULL || (data == NULL && capacity > 0) || length == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    t_flash_log *log = iter->log;
+    xSemaphoreTake(log->lock, portMAX_DELAY);
+    if (log->used == 0) {
+        xSemaphoreGive(log->lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (!log->info[iter->sector].valid || log->info[iter->sector].sector_seq != iter->sector_seq) {
+        // The ring wrapped over the iterator's sector
+        tlong first_seq = log->info[log->tail].first_seq;
+        if (SEQ_BEFORE(iter->next_seq, first_seq)) {
+            iter->lost += first_seq - iter->next_seq;
+            iter->next_seq = first_seq;
+        }
+        iter_enter(iter, log->tail);
+    }
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    for (;;) {
+        if (iter->sector == log->head && iter->offset >= log->fill) {
+            break;
+        }
+        t_record_header header;
+        tlong stored_crc = 0;
+        bool valid = iter->offset + sizeof(header) <= FLASH_LOG_SECTOR_SIZE;
+        if (valid) {
+            err = log_read(log, iter->sector, iter->offset, &header, sizeof(header));
+            if (err != ESP_OK) {
+                break;
+            }
+            valid = record_header_valid(log, iter->sector, iter->offset, &header);
+        }
+        if (valid && SEQ_BEFORE(header.seq, iter->next_seq)) {
+            iter->offset += LOG_RECORD_SIZE(header.length);
+            continue;
+        }
+        if (valid && header.length > capacity) {
+            *length = header.length;
+            err = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        if (valid) {
+            err = log_read(log, iter->sector, iter->offset + sizeof(header), data, header.length);
+            if (err == ESP_OK) {
+                err = log_read(log, iter->sector, iter->offset + sizeof(header) + LOG_ALIGN(header.length),
+                               &stored_crc, sizeof(stored_crc));
+            }
+            if (err != ESP_OK) {
+                break;
+            }
+            tlong crc = CRC32_Update(CRC32_INIT, (const tbyte *)&header, sizeof(header));
+            valid = CRC32_Update(crc, data, header.length) == stored_crc;
+        }
+        if (valid) {
+            *length = header.length;
+            if (seq != NULL) {
+                *seq = header.seq;
+            }
+            iter->next_seq = seq_after(header.seq);
+            iter->offset += LOG_RECORD_SIZE(header.length);
+            err = ESP_OK;
+            break;
+        }
+        // End of this sector's records (or a torn one): go on with the next sector of the ring
+        err = ESP_ERR_NOT_FOUND;
+        if (iter->sector == log->head) {
+            break;
+        }
+        iter_enter(iter, (iter->sector + 1) % log->sectors);
+    }
+    xSemaphoreGive(log->lock);
+    return err;
+}
+
+void Flash_Log_Get_Info(t_flash_log *log, t_flash_log_info *info) {
+    xSemaphoreTake(log->lock, portMAX_DELAY);
+    info->first_seq = log->used > 0 ? log->info[log->tail].first_seq : log->next_seq;
+    info->next_seq = log->next_seq;
+    info->sectors = log->sectors;
+    info->sectors_used = log->used;
+    info->buffered_bytes = log->head_sealed ? 0 : log->fill - log->flushed;
+    xSemaphoreGive(log->lock);
+}
+
+void Flash_Log_Get_Stats(t_flash_log *log, t_flash_log_stats *stats) {
+    xSemaphoreTake(log->lock, portMAX_DELAY);
+    *stats = log->stats;
+    xSemaphoreGive(log->lock);
+}
@@ -0,0 +1,134 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG.H
+ Description    : This file as Header for (Flash Record Log)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG_H_
+
+#include "../ESP32_S2_SOLO_2_N4R2_Main.h"
+#include "esp_err.h"
+#include "esp_partition.h"
+
+/*
+ * Append-only record log over a dedicated data partition, for samples that arrive too fast for
+ * the key/value NVS path. The partition is used as a ring of 4 KB sectors; when the ring is
+ * full the oldest sector is erased and its records are dropped.
+ *
+ * Each sector starts with a header (magic, sector sequence, sequence of its first record, CRC).
+ * Each record is a header (length, inverted length, record sequence), the payload padded to
+ * 4 bytes and a CRC-32 over header and payload. Records never cross a sector boundary.
+ *
+ * Appends are copied into a RAM buffer and programmed FLASH_LOG_BUFFER_SIZE bytes at a time, at
+ * aligned offsets, so flash is written once per buffer instead of once per record. Records are
+ * readable as soon as they are appended; Flash_Log_Sync() puts the buffered ones on flash.
+ *
+ * Power loss: flash is only ever programmed over erased bytes, and a record is valid only if its
+ * CRC matches. On open, the newest sector is scanned; a torn record ends that sector and appends
+ * continue in a fresh one. A reset loses at most the records still in the RAM buffer.
+ *
+ * Partition table entry (any label, pass it to Flash_Log_Open()):
+ *   flashlog, data, 0x40, , 256K
+ */
+#define FLASH_LOG_PARTITION_SUBTYPE 0x40
+#define FLASH_LOG_SECTOR_SIZE       4096
+#define FLASH_LOG_BUFFER_SIZE       256     // Bytes per flash program; divides FLASH_LOG_SECTOR_SIZE
+#define FLASH_LOG_SECTOR_HEADER     16
+#define FLASH_LOG_RECORD_OVERHEAD   12      // Record header + CRC, before padding
+#define FLASH_LOG_MAX_RECORD        (FLASH_LOG_SECTOR_SIZE - FLASH_LOG_SECTOR_HEADER - FLASH_LOG_RECORD_OVERHEAD)
+#define FLASH_LOG_SEQ_OLDEST        0       // Flash_Log_Iter_Init(): start at the oldest record. Never a record sequence.
+
+typedef struct t_flash_log t_flash_log;
+
+/**
+* @brief Read position. Plain data: persist next_seq (e.g. with NVS_Write_Int) to resume after a reboot.
+*/
+typedef struct {
+    t_flash_log *log;
+    tlong next_seq;         // Sequence of the next record to return
+    tlong lost;             // Records overwritten by the ring before this iterator reached them
+    tword sector;
+    tword offset;
+    tlong sector_seq;       // Sequence of 'sector' when the iterator entered it
+} t_flash_log_iter;
+
+typedef struct {
+    tlong first_seq;        // Oldest record still in the log (next_seq if empty)
+    tlong next_seq;         // Sequence the next append will get
+    tword sectors;          // Sectors in the partition
+    tword sectors_used;     // Sectors holding records, including the one being filled
+    tword buffered_bytes;   // Appended bytes not yet on flash
+} t_flash_log_info;
+
+typedef struct {
+    tlong records_appended;
+    tlong bytes_appended;   // Payload bytes
+    tlong flash_writes;     // esp_partition_write() calls, sector headers included
+    tlong sector_erases;
+    tlong records_dropped;  // Records erased by the ring wrapping
+    tlong torn_records;     // Invalid records found while opening (power loss mid-write)
+} t_flash_log_stats;
+
+/**
+* @brief Opens the log on a partition and recovers its state. A blank or foreign partition is formatted.
+*
+* @param label Partition label, or NULL for the first data partition of subtype FLASH_LOG_PARTITION_SUBTYPE.
+* @param log   Out: the log.
+* @return ESP_OK, ESP_ERR_NOT_FOUND (no such partition), ESP_ERR_INVALID_SIZE (fewer than two sectors),
+*         ESP_ERR_NO_MEM or a flash error.
+*/
+esp_err_t Flash_Log_Open(const tsbyte *label, t_flash_log **log);
+
+/**
+* @brief Writes the buffered records and frees the log. Iterators on it become invalid.
+*/
+esp_err_t Flash_Log_Close(t_flash_log *log);
+
+/**
+* @brief Appends one record.
+*
+* @param data   Record bytes.
+* @param length 1 to FLASH_LOG_MAX_RECORD bytes.
+* @param seq    Out (optional): the sequence number given to the record.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_SIZE or a flash error.
+*/
+esp_err_t Flash_Log_Append(t_flash_log *log, const void *data, size_t length, tlong *seq);
+
+/**
+* @brief Programs the buffered records to flash now.
+*/
+esp_err_t Flash_Log_Sync(t_flash_log *log);
+
+/**
+* @brief Drops every record. Sequence numbers keep counting up, so saved iterators do not go back in time.
+*/
+esp_err_t Flash_Log_Erase(t_flash_log *log);
+
+/**
+* @brief Positions an iterator at the first record with a sequence >= from_seq.
+*
+* @param from_seq FLASH_LOG_SEQ_OLDEST, or a saved t_flash_log_iter.next_seq. A sequence older than
+*                 the oldest record starts at the oldest one and counts the difference in iter->lost.
+*/
+esp_err_t Flash_Log_Iter_Init(t_flash_log *log, tlong from_seq, t_flash_log_iter *iter);
+
+/**
+* @brief Returns the next record and advances the iterator.
+*
+* @param data     Receives the record.
+* @param capacity Size of data.
+* @param length   Out: record length (also set when ESP_ERR_INVALID_SIZE is returned).
+* @param seq      Out (optional): record sequence.
+* @return ESP_OK, ESP_ERR_NOT_FOUND when no more records, ESP_ERR_INVALID_SIZE if capacity is too small
+*         (the iterator does not move), or a flash error.
+*/
+esp_err_t Flash_Log_Read_Next(t_flash_log_iter *iter, void *data, size_t capacity, size_t *length, tlong *seq);
+
+void Flash_Log_Get_Info(t_flash_log *log, t_flash_log_info *info);
+void Flash_Log_Get_Stats(t_flash_log *log, t_flash_log_stats *stats);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG_H_ */
@@ -8,16 +8,63 @@
  Testing Date   : 
 *********************************************************************************************************************************/
 #include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO.h"
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.h"
+#include "esp_attr.h"
 
-// Static array to store the direction of each GPIO pin
-static t_direction pin_directions[49]; // 49 pins available on ESP32-S2
+#define GPIO_BANK0(mask)    ((tlong)(mask))
+#define GPIO_BANK1(mask)    ((tlong)((mask) >> 32))
+#define GPIO_BANK(pin)      ((pin) >> 5)
+#define GPIO_BIT(pin)       (1UL << ((pin) & 31))
+#define GPIO_MASK(bank0, bank1) (((t_gpio_mask)(bank1) << 32) | (tlong)(bank0))
+
+// Direction of each pin, one bit per pin (1 = output); only changed by the Init functions
+static t_gpio_mask gpio_direction_map;
+
+// Last level written to each output pin, one word per bank so it can be updated atomically
+static volatile tlong gpio_level_map[2];
+
+// Output-set and output-clear registers of each bank
+static const tlong gpio_w1ts_reg[2] = {GPIO_OUT_W1TS_REG, GPIO_OUT1_W1TS_REG};
+static const tlong gpio_w1tc_reg[2] = {GPIO_OUT_W1TC_REG, GPIO_OUT1_W1TC_REG};
+
+// Output registers of each bank
+static const tlong gpio_out_reg[2] = {GPIO_OUT_REG, GPIO_OUT1_REG};
+
+// Serializes read-modify-write of the output registers against tasks and interrupts
+static portMUX_TYPE gpio_port_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Set once the shadow bitmap has been loaded from the output registers
+static bool gpio_level_map_seeded;
+
+// Loads the shadow bitmap from the output registers, so pins driven before this driver keep their level. Called with
+// gpio_port_lock held.
+static void gpio_seed_level_map_locked(void) {
+    if (!gpio_level_map_seeded) {
+        gpio_level_map[0] = REG_READ(GPIO_OUT_REG);
+        gpio_level_map[1] = REG_READ(GPIO_OUT1_REG);
+        gpio_level_map_seeded = true;
+    }
+}
+
+// Read-modify-write of one bank's output register, so pins outside the mask keep the level they have in hardware,
+// even if something other than this driver set it. Called with gpio_port_lock held; returns the previous levels.
+static IRAM_ATTR tlong gpio_port_write_bank(tlong bank, tlong mask, tlong values) {
+    if (mask == 0) {
+        return 0;
+    }
+    tlong previous = REG_READ(gpio_out_reg[bank]);
+    REG_WRITE(gpio_out_reg[bank], (previous & ~mask) | values);
+    __atomic_fetch_and(&gpio_level_map[bank], ~mask, __ATOMIC_RELAXED);
+    __atomic_fetch_or(&gpio_level_map[bank], values, __ATOMIC_RELAXED);
+    return previous;
+}
 
 /**
  * @brief Initializes a GPIO pin as an output and sets its initial value.
  *
  * This function configures a GPIO pin as an output. It disables interrupts for the pin,
  * and sets the initial output value based on the provided value. The direction of the pin 
- * is also tracked in the pin_directions array.
+ * is also tracked in the direction bitmap.
  *
  * @param pin The GPIO pin to initialize as output.
  * @param value The initial value to set for the pin (0 or 1).
@@ -31,9 +78,14 @@ void GPIO_Output_Init(tpin pin, tlong value) {
     io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE; // Disable pull-down resistor
     io_conf.pull_up_en = GPIO_PULLUP_DISABLE;     // Disable pull-up resistor
 
+    portENTER_CRITICAL(&gpio_port_lock);
+    gpio_seed_level_map_locked();                 // Start the shadow from the levels already in hardware
+    portEXIT_CRITICAL(&gpio_port_lock);
+    GPIO_Value_Set(pin, value);                   // Latch the initial value before the driver is enabled
     gpio_config(&io_conf);                        // Apply the configuration
-    GPIO_Value_Set(pin, value);                   // Set the initial value of the pin
-    pin_directions[pin] = output;                 // Store the direction in the array
+    portENTER_CRITICAL(&gpio_port_lock);
+    gpio_direction_map |= GPIO_PIN_MASK(pin);     // Store the direction in the bitmap
+    portEXIT_CRITICAL(&gpio_port_lock);
 }
 
 /**
@@ -54,32 +106,48 @@ void GPIO_Input_Init(tpin pin) {
     io_conf.pull_up_en = GPIO_PULLUP_ENABLE;      // Enable pull-up resistor
     
     gpio_config(&io_conf);                        // Apply the configuration
-    pin_directions[pin] = input;                  // Store the direction in the array
+    portENTER_CRITICAL(&gpio_port_lock);
+    gpio_direction_map &= ~GPIO_PIN_MASK(pin);    // Store the direction in the bitmap
+    portEXIT_CRITICAL(&gpio_port_lock);
 }
 
 /**
  * @brief Retrieves the direction of a specified GPIO pin.
  *
  * This function returns the current direction (input or output) of a GPIO pin 
- * based on the stored direction in the pin_directions array.
+ * based on the direction bitmap.
  *
  * @param pin The GPIO pin whose direction is to be retrieved.
  * @return t_direction The direction of the specified GPIO pin.
  */
 t_direction GPIO_Direction_get(tpin pin) {
-    return pin_directions[pin]; // Return the stored direction
+    return (gpio_direction_map & GPIO_PIN_MASK(pin)) ? output : input; // Return the stored direction
 }
 
 /**
  * @brief Sets the value of a GPIO pin.
  *
- * This function sets the output level of a specified GPIO pin.
+ * This function sets the output level of a specified GPIO pin with a single write to the
+ * W1TS or W1TC register of its bank, and records the level in the shadow bitmap. A change
+ * of level on a pin watched by GPIO_Capture_Arm() is recorded by the capture.
  *
  * @param pin The GPIO pin to set the value for.
  * @param value The value to set for the pin (0 or 1).
  */
 void GPIO_Value_Set(tpin pin, tlong value) {
-    gpio_set_level(pin, value); // Set the pin to the specified value
+    tlong bank = GPIO_BANK(pin);
+    tlong bit = GPIO_BIT(pin);
+    tlong previous;
+    if (value) {
+        previous = __atomic_fetch_or(&gpio_level_map[bank], bit, __ATOMIC_RELAXED);
+        REG_WRITE(gpio_w1ts_reg[bank], bit);
+    } else {
+        previous = __atomic_fetch_and(&gpio_level_map[bank], ~bit, __ATOMIC_RELAXED);
+        REG_WRITE(gpio_w1tc_reg[bank], bit);
+    }
+    if (((previous & bit) != 0) != (value != 0)) {
+        GPIO_Capture_Hook(GPIO_PIN_MASK(pin), value ? GPIO_PIN_MASK(pin) : 0);
+    }
 }
 
 /**
@@ -91,7 +159,7 @@ void GPIO_Value_Set(tpin pin, tlong value) {
  * @return tlong The current value of the GPIO pin (0 or 1).
  */
 tbyte GPIO_Value_Get(tpin pin) {
-    return gpio_get_level(pin); // Return the current value of the pin
+    return gpio_get_level((gpio_num_t)pin); // Return the current value of the pin
 }
 
 /**
@@ -100,9 +168,204 @@ tbyte GPIO_Value_Get(tpin pin) {
  * This function toggles the output level of a specified GPIO pin. If the current level is 0,
  * it will set it to 1, and if it is 1, it will set it to 0.
  *
+ * The current level comes from the shadow bitmap, not from the input register, so the
+ * toggle is one register write and stays correct on pins with a heavy external load.
+ *
  * @param pin The GPIO pin to toggle.
  */
 void GPIO_Value_Tog(tpin pin) {
-    tlong current_level = gpio_get_level(pin); // Get the current level of the pin
-    gpio_set_level(pin, !current_level);       // Set the pin to the opposite level
+    tlong bank = GPIO_BANK(pin);
+    tlong bit = GPIO_BIT(pin);
+    tlong previous = __atomic_fetch_xor(&gpio_level_map[bank], bit, __ATOMIC_RELAXED);
+    REG_WRITE((previous & bit) ? gpio_w1tc_reg[bank] : gpio_w1ts_reg[bank], bit);
+    GPIO_Capture_Hook(GPIO_PIN_MASK(pin), (previous & bit) ? 0 : GPIO_PIN_MASK(pin));
+}
+
+/**
+ * @brief Returns the direction bitmap.
+ *
+ * @return t_gpio_mask One bit per pin, set for pins initialized as outputs.
+ */
+t_gpio_mask GPIO_Direction_Get_Mask(void) {
+    return gpio_direction_map;
+}
+
+/**
+ * @brief Returns the last level written to each output pin.
+ *
+ * @return t_gpio_mask One bit per pin, taken from the shadow bitmap.
+ */
+t_gpio_mask GPIO_Output_Get_Mask(void) {
+    return ((t_gpio_mask)gpio_level_map[1] << 32) | gpio_level_map[0];
+}
+
+/**
+ * @brief Drives every pin in a mask high.
+ *
+ * Each bank the mask touches gets one write to its W1TS register.
+ *
+ * @param mask The pins to set.
+ */
+void GPIO_Port_Set(t_gpio_mask mask) {
+    tlong previous0 = 0, previous1 = 0;
+    mask &= GPIO_OUTPUT_MASK;
+    if (GPIO_BANK0(mask) != 0) {
+        previous0 = __atomic_fetch_or(&gpio_level_map[0], GPIO_BANK0(mask), __ATOMIC_RELAXED);
+        REG_WRITE(GPIO_OUT_W1TS_REG, GPIO_BANK0(mask));
+    }
+    if (GPIO_BANK1(mask) != 0) {
+        previous1 = __atomic_fetch_or(&gpio_level_map[1], GPIO_BANK1(mask), __ATOMIC_RELAXED);
+        REG_WRITE(GPIO_OUT1_W1TS_REG, GPIO_BANK1(mask));
+    }
+    t_gpio_mask previous = GPIO_MASK(previous0, previous1);
+    GPIO_Capture_Hook(mask & ~previous, mask);
+}
+
+/**
+ * @brief Drives every pin in a mask low.
+ *
+ * Each bank the mask touches gets one write to its W1TC register.
+ *
+ * @param mask The pins to clear.
+ */
+void GPIO_Port_Clear(t_gpio_mask mask) {
+    tlong previous0 = 0, previous1 = 0;
+    mask &= GPIO_OUTPUT_MASK;
+    if (GPIO_BANK0(mask) != 0) {
+        previous0 = __atomic_fetch_and(&gpio_level_map[0], ~GPIO_BANK0(mask), __ATOMIC_RELAXED);
+        REG_WRITE(GPIO_OUT_W1TC_REG, GPIO_BANK0(mask));
+    }
+    if (GPIO_BANK1(mask) != 0) {
+        previous1 = __atomic_fetch_and(&gpio_level_map[1], ~GPIO_BANK1(mask), __ATOMIC_RELAXED);
+        REG_WRITE(GPIO_OUT1_W1TC_REG, GPIO_BANK1(mask));
+    }
+    t_gpio_mask previous = GPIO_MASK(previous0, previous1);
+    GPIO_Capture_Hook(mask & previous, 0);
+}
+
+/**
+ * @brief Writes a value to a group of pins.
+ *
+ * The output register of each bank is read, merged with the new levels and written back once,
+ * so every pin of the bank changes in the same bus cycle and pins outside the mask keep the
+ * level they have in hardware. The shadow bitmap is updated for the pins in the mask.
+ *
+ * @param mask The pins to write.
+ * @param values The levels, one bit per pin.
+ */
+void GPIO_Port_Write(t_gpio_mask mask, t_gpio_mask values) {
+    mask &= GPIO_OUTPUT_MASK;
+    values &= mask;
+    portENTER_CRITICAL(&gpio_port_lock);
+    t_gpio_mask previous = GPIO_MASK(gpio_port_write_bank(0, GPIO_BANK0(mask), GPIO_BANK0(values)),
+                                     gpio_port_write_bank(1, GPIO_BANK1(mask), GPIO_BANK1(values)));
+    GPIO_Capture_Hook((previous ^ values) & mask, values);
+    portEXIT_CRITICAL(&gpio_port_lock);
+}
+
+/**
+ * @brief Writes a value to a group of pins from an interrupt handler.
+ *
+ * Same as GPIO_Port_Write(), with the ISR form of the critical section.
+ *
+ * @param mask The pins to write.
+ * @param values The levels, one bit per pin.
+ */
+IRAM_ATTR void GPIO_Port_Write_From_ISR(t_gpio_mask mask, t_gpio_mask values) {
+    mask &= GPIO_OUTPUT_MASK;
+    values &= mask;
+    portENTER_CRITICAL_ISR(&gpio_port_lock);
+    t_gpio_mask previous = GPIO_MASK(gpio_port_write_bank(0, GPIO_BANK0(mask), GPIO_BANK0(values)),
+                                     gpio_port_write_bank(1, GPIO_BANK1(mask), GPIO_BANK1(values)));
+    GPIO_Capture_Hook((previous ^ values) & mask, values);
+    portEXIT_CRITICAL_ISR(&gpio_port_lock);
+}
+
+/**
+ * @brief Reads the input level of a group of pins.
+ *
+ * Only the banks the mask touches are read.
+ *
+ * @param mask The pins to read.
+ * @return t_gpio_mask The levels of the pins in mask.
+ */
+t_gpio_mask GPIO_Port_Read(t_gpio_mask mask) {
+    t_gpio_mask levels = 0;
+    if (GPIO_BANK0(mask) != 0) {
+        levels |= REG_READ(GPIO_IN_REG);
+    }
+    if (GPIO_BANK1(mask) != 0) {
+        levels |= (t_gpio_mask)REG_READ(GPIO_IN1_REG) << 32;
+    }
+    return levels & mask;
+}
+
+/**
+ * @brief Configures every pin of a board pin table.
+ *
+ * The table is validated, the output levels are latched, then one gpio_config() call is
+ * made per distinct (direction, pull, interrupt type) group. Finally the direction bitmap
+ * is updated for all pins at once.
+ *
+ * @param table The pin table.
+ * @param count Number of entries.
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG, or the error of gpio_config().
+ */
+esp_err_t GPIO_Config_Table(const t_gpio_pin_config *table, size_t count) {
+    t_gpio_mask pins = 0, outputs = 0, levels = 0;
+
+    if (table == NULL && count > 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const t_gpio_pin_config *entry = &table[i];
+        if ((tlong)entry->pin > Pin_46 || !(GPIO_VALID_MASK & GPIO_PIN_MASK(entry->pin)) ||
+            (pins & GPIO_PIN_MASK(entry->pin)) || (entry->direction != output && entry->direction != input) ||
+            (entry->direction == output && entry->pin == Pin_46) || (tlong)entry->pull > pull_down ||
+            (tlong)entry->intr_type >= GPIO_INTR_MAX) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        pins |= GPIO_PIN_MASK(entry->pin);
+        if (entry->direction == output) {
+            outputs |= GPIO_PIN_MASK(entry->pin);
+            levels |= entry->level ? GPIO_PIN_MASK(entry->pin) : 0;
+        }
+    }
+
+    // Latch the levels while the output drivers are still off
+    portENTER_CRITICAL(&gpio_port_lock);
+    gpio_seed_level_map_locked();
+    portEXIT_CRITICAL(&gpio_port_lock);
+    GPIO_Port_Write(outputs, levels);
+
+    // One gpio_config() per group; each pass takes the first pin not yet applied as its group key
+    t_gpio_mask pending = pins;
+    for (size_t i = 0; i < count && pending != 0; i++) {
+        const t_gpio_pin_config *key = &table[i];
+        if (!(pending & GPIO_PIN_MASK(key->pin))) {
+            continue;
+        }
+        gpio_config_t io_conf;
+        io_conf.intr_type = key->intr_type;
+        io_conf.mode = (gpio_mode_t)key->direction;
+        io_conf.pull_up_en = key->pull == pull_up ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
+        io_conf.pull_down_en = key->pull == pull_down ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE;
+        io_conf.pin_bit_mask = 0;
+        for (size_t j = i; j < count; j++) {
+            const t_gpio_pin_config *entry = &table[j];
+            if (entry->direction == key->direction && entry->pull == key->pull && entry->intr_type == key->intr_type) {
+                io_conf.pin_bit_mask |= GPIO_PIN_MASK(entry->pin);
+            }
+        }
+        esp_err_t err = gpio_config(&io_conf);
+        if (err != ESP_OK) {
+            return err;
+        }
+        pending &= ~io_conf.pin_bit_mask;
+    }
+
+    portENTER_CRITICAL(&gpio_port_lock);
+    gpio_direction_map = (gpio_direction_map & ~pins) | outputs;
+    portEXIT_CRITICAL(&gpio_port_lock);
+    return ESP_OK;
 }
@@ -11,6 +11,7 @@
 #define MCAL_ESP32S2_S2_SOLO_2_N4R2_GPIO_H_
 
 #include "../ESP32_S2_SOLO_2_N4R2_Main.h"
+#include "freertos/FreeRTOS.h"
 
 /**
  * @brief Enumeration for GPIO pins.
@@ -73,6 +74,52 @@ typedef enum {
     input = GPIO_MODE_INPUT
 } t_direction;
 
+/**
+ * @brief Set of pins, one bit per tpin (bit n is Pin_n).
+ *
+ * Pins 0-31 live in the first GPIO bank (GPIO_OUT_REG / GPIO_IN_REG) and pins 32-46 in the
+ * second (GPIO_OUT1_REG / GPIO_IN1_REG). All pins of a mask that share a bank change with a
+ * single register write.
+ */
+typedef uint64_t t_gpio_mask;
+
+#define GPIO_PIN_MASK(pin)      (1ULL << (pin))
+#define GPIO_OUTPUT_MASK        (GPIO_VALID_MASK & ~GPIO_PIN_MASK(Pin_46))  // Pin_46 is input only
+
+/**
+ * @brief Enumeration for the internal pull resistors of a pin.
+ */
+typedef enum {
+    pull_none,
+    pull_up,
+    pull_down
+} t_pull;
+
+/**
+ * @brief One entry of a board pin table, applied with GPIO_Config_Table().
+ *
+ * Declare entries with GPIO_PIN_CONFIG() so that invalid pins are rejected at compile time.
+ */
+typedef struct {
+    tpin pin;
+    t_direction direction;
+    t_pull pull;
+    tbyte level;                    // Initial level of an output, latched before the driver is enabled
+    gpio_int_type_t intr_type;      // Interrupt trigger; the handler is installed separately
+} t_gpio_pin_config;
+
+// Fails the build for pins 22-25, pins above 46 and an output on Pin_46; evaluates to 0
+#define GPIO_PIN_CHECK(pin, direction)                                                              \
+    (0 * sizeof(struct {                                                                            \
+        _Static_assert((pin) >= 0 && (pin) <= Pin_46 && (GPIO_VALID_MASK & GPIO_PIN_MASK(pin)),     \
+                       "GPIO pin " #pin " does not exist on ESP32-S2");                             \
+        _Static_assert((direction) != output || (pin) != Pin_46, "Pin_46 is input only");          \
+        int unused;                                                                                 \
+    }))
+
+#define GPIO_PIN_CONFIG(pin, direction, pull, level, intr_type) \
+    { (tpin)((pin) + GPIO_PIN_CHECK(pin, direction)), (direction), (pull), (level), (intr_type) }
+
 /** Function Prototypes ===================================================================================================================*/
 
 /**
@@ -127,10 +174,100 @@ tbyte GPIO_Value_Get(tpin pin);
 /**
  * @brief Toggles the value of a GPIO pin.
  *
- * This function toggles the value of a specified GPIO pin.
+ * This function toggles the value of a specified GPIO pin. The current level is taken from
+ * the output shadow bitmap, so the toggle is a single register write.
  *
  * @param pin The GPIO pin to toggle.
  */
 void GPIO_Value_Tog(tpin pin);
 
+/**
+ * @brief Returns the direction bitmap: one bit per pin, set for outputs.
+ *
+ * @return t_gpio_mask The pins initialized with GPIO_Output_Init().
+ */
+t_gpio_mask GPIO_Direction_Get_Mask(void);
+
+/**
+ * @brief Returns the output shadow bitmap: the last level the driver wrote to each pin.
+ *
+ * Unlike GPIO_Port_Read(), this does not touch the hardware and is not affected by the
+ * load on the pin.
+ *
+ * @return t_gpio_mask One bit per pin.
+ */
+t_gpio_mask GPIO_Output_Get_Mask(void);
+
+/**
+ * @brief Drives every pin in a mask high.
+ *
+ * Writes the W1TS (write-1-to-set) register of each bank the mask touches, so pins outside
+ * the mask are not disturbed and no lock is needed, even against interrupts.
+ *
+ * @param mask The pins to set. Bits outside GPIO_OUTPUT_MASK are ignored.
+ */
+void GPIO_Port_Set(t_gpio_mask mask);
+
+/**
+ * @brief Drives every pin in a mask low, through the W1TC (write-1-to-clear) registers.
+ *
+ * @param mask The pins to clear. Bits outside GPIO_OUTPUT_MASK are ignored.
+ */
+void GPIO_Port_Clear(t_gpio_mask mask);
+
+/**
+ * @brief Writes a value to a group of pins.
+ *
+ * Pins in mask take the level of the matching bit in values; other pins keep theirs. Each
+ * bank is updated with one read-modify-write of its output register, so rising and falling
+ * pins of a bank switch together (e.g. a parallel bus or an LED bar), and pins outside the
+ * mask keep their hardware level even if another driver set it. The read-modify-write runs in
+ * a critical section.
+ *
+ * @param mask The pins to write. Bits outside GPIO_OUTPUT_MASK are ignored.
+ * @param values The levels, one bit per pin.
+ */
+void GPIO_Port_Write(t_gpio_mask mask, t_gpio_mask values);
+
+/**
+ * @brief GPIO_Port_Write() for interrupt handlers.
+ *
+ * Placed in IRAM, so it can run from an ISR registered with ESP_INTR_FLAG_IRAM or an
+ * esp_timer callback dispatched from ISR.
+ *
+ * @param mask The pins to write. Bits outside GPIO_OUTPUT_MASK are ignored.
+ * @param values The levels, one bit per pin.
+ */
+void GPIO_Port_Write_From_ISR(t_gpio_mask mask, t_gpio_mask values);
+
+/**
+ * @brief Reads the input level of a group of pins in one access per bank.
+ *
+ * @param mask The pins to read.
+ * @return t_gpio_mask The levels of the pins in mask; other bits are 0.
+ */
+t_gpio_mask GPIO_Port_Read(t_gpio_mask mask);
+
+/**
+ * @brief Configures every pin of a board pin table.
+ *
+ * Entries that share direction, pull and interrupt type are applied with one gpio_config()
+ * call, in the order their first entry appears in the table. The initial levels of all
+ * outputs are latched with one write per bank before any output driver is enabled, so
+ * outputs come up at their level without a glitch. The whole table is validated first;
+ * on error no pin is touched.
+ *
+ *   static const t_gpio_pin_config board_pins[] = {
+ *       GPIO_PIN_CONFIG(Pin_15, output, pull_none, 1, GPIO_INTR_DISABLE),
+ *       GPIO_PIN_CONFIG(Pin_0,  input,  pull_up,   0, GPIO_INTR_NEGEDGE),
+ *   };
+ *   GPIO_Config_Table(board_pins, sizeof(board_pins) / sizeof(board_pins[0]));
+ *
+ * @param table The pin table.
+ * @param count Number of entries.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an invalid or repeated pin, an output on Pin_46
+ *         or an unknown pull or interrupt type, or the error of gpio_config().
+ */
+esp_err_t GPIO_Config_Table(const t_gpio_pin_config *table, size_t count);
+
 #endif /* MCAL_ESP32S2_GPIO_H_ */
@@ -0,0 +1,318 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.C
+ Description    : This file as Source for (GPIO Edge Capture / Logic Analyzer)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.h"
+#include <string.h>
+#include "../CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+#define GPIO_CAPTURE_MASK       (GPIO_CAPTURE_DEPTH - 1)
+#define GPIO_CAPTURE_CHUNK      32      // Records per UART write
+#define GPIO_CAPTURE_NO_PIN     0xFF
+
+_Static_assert((GPIO_CAPTURE_DEPTH & GPIO_CAPTURE_MASK) == 0, "GPIO_CAPTURE_DEPTH must be a power of two");
+
+typedef struct {
+    tlong time_us;          // Timestamp bits 0-31
+    tword changed;          // Changed channels; 0 for a time mark
+    tword levels;           // New levels of the changed channels, or timestamp bits 32-47
+} t_capture_record;
+
+typedef struct {
+    t_capture_state state;
+    t_gpio_mask pins;
+    t_gpio_mask trigger_mask;
+    t_gpio_mask trigger_levels;
+    t_gpio_mask levels;             // Current level of the watched pins
+    tlong pre_trigger;
+    tlong post_trigger;
+    tlong post_left;                // Records still to take, counting the trigger record
+    tlong head;                     // Records written since armed (free-running)
+    bool triggered;
+    tlong trigger;                  // Record index of the trigger
+    tword base_levels;              // Channel levels before the oldest record in the ring
+    tword base_time_hi;             // Timestamp bits 32-47 at the oldest record in the ring
+    tword time_hi;                  // Timestamp bits 32-47 of the newest record
+    tbyte channels;
+    tbyte channel_pin[GPIO_CAPTURE_CHANNELS];
+} t_capture;
+
+// The part of the ring an export covers, and the state just before it
+typedef struct {
+    tlong start;
+    tlong count;
+    tlong trigger;
+    tword base_levels;
+    tword time_hi;
+} t_capture_view;
+
+typedef bool (*t_capture_sink)(const tbyte *data, size_t length, void *arg);
+
+static t_capture_record capture_ring[GPIO_CAPTURE_DEPTH];
+static t_capture capture;
+static tbyte pin_channel[Pin_46 + 1];
+static portMUX_TYPE capture_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Pins the hook records; 0 unless a capture is running and not paused for export
+static volatile t_gpio_mask capture_watch;
+
+static void put_le16(tbyte *out, tword value) {
+    out[0] = (tbyte)value;
+    out[1] = (tbyte)(value >> 8);
+}
+
+static void put_le32(tbyte *out, tlong value) {
+    put_le16(out, (tword)value);
+    put_le16(out + 2, (tword)(value >> 16));
+}
+
+static IRAM_ATTR tword pins_to_channels(t_gpio_mask pins) {
+    tword channels = 0;
+    while (pins != 0) {
+        channels |= (tword)(1u << pin_channel[__builtin_ctzll(pins)]);
+        pins &= pins - 1;
+    }
+    return channels;
+}
+
+// Called with capture_lock held
+static IRAM_ATTR void capture_push(tlong time_us, tword changed, tword levels) {
+    t_capture_record *record = &capture_ring[capture.head & GPIO_CAPTURE_MASK];
+    if (capture.head >= GPIO_CAPTURE_DEPTH) {
+        // Fold the record being overwritten into the state before the oldest one
+        if (record->changed == 0) {
+            capture.base_time_hi = record->levels;
+        } else {
+            capture.base_levels = (capture.base_levels & ~record->changed) | record->levels;
+        }
+    }
+    record->time_us = time_us;
+    record->changed = changed;
+    record->levels = levels;
+    capture.head++;
+    if (capture.state == capture_triggered && --capture.post_left == 0) {
+        capture.state = capture_done;
+        capture_watch = 0;
+    }
+}
+
+// Called with capture_lock held
+static IRAM_ATTR void capture_record(t_gpio_mask changed, t_gpio_mask levels) {
+    int64_t now = esp_timer_get_time();
+    tword time_hi = (tword)(now >> 32);
+    if (time_hi != capture.time_hi) {
+        capture.time_hi = time_hi;
+        capture_push((tlong)now, 0, time_hi);
+        if (capture.state == capture_done) {
+            return;
+        }
+    }
+    capture.levels = (capture.levels & ~changed) | levels;
+    bool fire = capture.state == capture_armed && (changed & capture.trigger_mask) != 0 &&
+                (capture.levels & capture.trigger_mask) == capture.trigger_levels;
+    if (fire) {
+        capture.triggered = true;
+        capture.trigger = capture.head;
+        capture.state = capture_triggered;
+        capture.post_left = capture.post_trigger + 1;
+    }
+    capture_push((tlong)now, pins_to_channels(changed), pins_to_channels(levels));
+}
+
+IRAM_ATTR void GPIO_Capture_Hook(t_gpio_mask changed, t_gpio_mask levels) {
+    changed &= capture_watch;
+    if (changed == 0) {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&capture_lock);
+    changed &= capture_watch;
+    if (changed != 0) {
+        capture_record(changed, levels & changed);
+    }
+    portEXIT_CRITICAL_SAFE(&capture_lock);
+}
+
+// Current level of each pin: the shadow level for outputs, the input register for the rest
+static t_gpio_mask capture_read_levels(t_gpio_mask pins) {
+    t_gpio_mask outputs = GPIO_Direction_Get_Mask();
+    return ((GPIO_Output_Get_Mask() & outputs) | (GPIO_Port_Read(pins) & ~outputs)) & pins;
+}
+
+static void capture_pause(void) {
+    portENTER_CRITICAL(&capture_lock);
+    capture_watch = 0;
+    portEXIT_CRITICAL(&capture_lock);
+}
+
+static void capture_resume(void) {
+    portENTER_CRITICAL(&capture_lock);
+    if (capture.state == capture_armed || capture.state == capture_triggered) {
+        // Catch up on what changed while the hook was off
+        t_gpio_mask levels = capture_read_levels(capture.pins);
+        t_gpio_mask changed = levels ^ capture.levels;
+        if (changed != 0) {
+            capture_record(changed, levels & changed);
+        }
+        if (capture.state != capture_done) {
+            capture_watch = capture.pins;
+        }
+    }
+    portEXIT_CRITICAL(&capture_lock);
+}
+
+// Called while paused, when the ring is not written
+static void capture_get_view(t_capture_view *view) {
+    tlong oldest = capture.head > GPIO_CAPTURE_DEPTH ? capture.head - GPIO_CAPTURE_DEPTH : 0;
+    view->start = oldest;
+    if (capture.triggered && capture.trigger >= oldest + capture.pre_trigger) {
+        view->start = capture.trigger - capture.pre_trigger;
+    }
+    view->count = capture.head - view->start;
+    view->trigger = capture.triggered ? capture.trigger - view->start : GPIO_CAPTURE_NO_TRIGGER;
+    view->base_levels = capture.base_levels;
+    view->time_hi = capture.base_time_hi;
+    for (tlong i = oldest; i < view->start; i++) {
+        const t_capture_record *record = &capture_ring[i & GPIO_CAPTURE_MASK];
+        if (record->changed == 0) {
+            view->time_hi = record->levels;
+        } else {
+            view->base_levels = (view->base_levels & ~record->changed) | record->levels;
+        }
+    }
+}
+
+static size_t capture_size(const t_capture_view *view) {
+    return GPIO_CAPTURE_HEADER_SIZE + (size_t)view->count * GPIO_CAPTURE_RECORD_SIZE + 4;
+}
+
+static esp_err_t capture_emit(const t_capture_view *view, t_capture_sink sink, void *arg) {
+    tbyte chunk[GPIO_CAPTURE_CHUNK * GPIO_CAPTURE_RECORD_SIZE];
+
+    put_le32(chunk, GPIO_CAPTURE_MAGIC);
+    chunk[4] = GPIO_CAPTURE_VERSION;
+    chunk[5] = capture.channels;
+    put_le16(chunk + 6, capture.triggered ? 1 : 0);
+    put_le32(chunk + 8, view->count);
+    put_le32(chunk + 12, view->trigger);
+    put_le16(chunk + 16, view->time_hi);
+    put_le16(chunk + 18, view->base_levels);
+    memcpy(chunk + 20, capture.channel_pin, GPIO_CAPTURE_CHANNELS);
+    tlong crc = CRC32_Update(CRC32_INIT, chunk, GPIO_CAPTURE_HEADER_SIZE);
+    if (!sink(chunk, GPIO_CAPTURE_HEADER_SIZE, arg)) {
+        return ESP_FAIL;
+    }
+
+    for (tlong done = 0; done < view->count;) {
+        tlong count = view->count - done < GPIO_CAPTURE_CHUNK ? view->count - done : GPIO_CAPTURE_CHUNK;
+        for (tlong i = 0; i < count; i++) {
+            const t_capture_record *record = &capture_ring[(view->start + done + i) & GPIO_CAPTURE_MASK];
+            tbyte *out = chunk + i * GPIO_CAPTURE_RECORD_SIZE;
+            put_le32(out, record->time_us);
+            put_le16(out + 4, record->changed);
+            put_le16(out + 6, record->levels);
+        }
+        crc = CRC32_Update(crc, chunk, count * GPIO_CAPTURE_RECORD_SIZE);
+        if (!sink(chunk, count * GPIO_CAPTURE_RECORD_SIZE, arg)) {
+            return ESP_FAIL;
+        }
+        done += count;
+    }
+
+    put_le32(chunk, crc);
+    return sink(chunk, 4, arg) ? ESP_OK : ESP_FAIL;
+}
+
+static bool buffer_sink(const tbyte *data, size_t length, void *arg) {
+    tbyte **out = arg;
+    memcpy(*out, data, length);
+    *out += length;
+    return true;
+}
+
+static bool uart_sink(const tbyte *data, size_t length, void *arg) {
+    return UART_Send_Buffer(data, length, *(t_uart_port *)arg) == (int)length;
+}
+
+esp_err_t GPIO_Capture_Arm(const t_gpio_capture_config *config) {
+    if (config == NULL || config->pins == 0 || (config->pins & ~GPIO_VALID_MASK) != 0 ||
+        __builtin_popcountll(config->pins) > GPIO_CAPTURE_CHANNELS ||
+        (config->trigger_mask & ~config->pins) != 0 || (config->trigger_levels & ~config->trigger_mask) != 0 ||
+        (tlong)config->pre_trigger + config->post_trigger >= GPIO_CAPTURE_DEPTH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&capture_lock);
+    capture_watch = 0;
+    memset(&capture, 0, sizeof(capture));
+    memset(capture.channel_pin, GPIO_CAPTURE_NO_PIN, sizeof(capture.channel_pin));
+    for (t_gpio_mask pins = config->pins; pins != 0; pins &= pins - 1) {
+        tpin pin = (tpin)__builtin_ctzll(pins);
+        pin_channel[pin] = capture.channels;
+        capture.channel_pin[capture.channels++] = pin;
+    }
+    capture.pins = config->pins;
+    capture.trigger_mask = config->trigger_mask;
+    capture.trigger_levels = config->trigger_levels;
+    capture.pre_trigger = config->pre_trigger;
+    capture.post_trigger = config->post_trigger;
+    capture.levels = capture_read_levels(config->pins);
+    capture.base_levels = pins_to_channels(capture.levels);
+    capture.time_hi = (tword)(esp_timer_get_time() >> 32);
+    capture.base_time_hi = capture.time_hi;
+    capture.state = capture_armed;
+    capture_watch = config->pins;
+    portEXIT_CRITICAL(&capture_lock);
+    return ESP_OK;
+}
+
+void GPIO_Capture_Stop(void) {
+    portENTER_CRITICAL(&capture_lock);
+    capture_watch = 0;
+    if (capture.state != capture_idle) {
+        capture.state = capture_done;
+    }
+    portEXIT_CRITICAL(&capture_lock);
+}
+
+void GPIO_Capture_Get_Status(t_gpio_capture_status *status) {
+    if (status != NULL) {
+        portENTER_CRITICAL(&capture_lock);
+        status->state = capture.state;
+        status->records = capture.head;
+        status->overwritten = capture.head > GPIO_CAPTURE_DEPTH ? capture.head - GPIO_CAPTURE_DEPTH : 0;
+        portEXIT_CRITICAL(&capture_lock);
+    }
+}
+
+esp_err_t GPIO_Capture_Serialize(tbyte *buffer, size_t capacity, size_t *length) {
+    if (length == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    t_capture_view view;
+    capture_pause();
+    capture_get_view(&view);
+    *length = capture_size(&view);
+    esp_err_t err = ESP_OK;
+    if (buffer != NULL) {
+        err = capacity < *length ? ESP_ERR_INVALID_SIZE : capture_emit(&view, buffer_sink, &buffer);
+    }
+    capture_resume();
+    return err;
+}
+
+esp_err_t GPIO_Capture_Export(t_uart_port port) {
+    t_capture_view view;
+    capture_pause();
+    capture_get_view(&view);
+    esp_err_t err = capture_emit(&view, uart_sink, &port);
+    capture_resume();
+    return err;
+}
@@ -0,0 +1,121 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.H
+ Description    : This file as Header for (GPIO Edge Capture / Logic Analyzer)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO.h"
+#include "../UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART.h"
+#include "esp_err.h"
+
+/*
+ * Capture records every transition of up to GPIO_CAPTURE_CHANNELS watched pins into a static
+ * ring of GPIO_CAPTURE_DEPTH records. Outputs are recorded where the GPIO driver writes them
+ * (GPIO_Value_Set/Tog, the port functions, the sequencer); inputs are recorded by the edge ISR
+ * of GPIO_Event_Attach(), so a watched input must be attached (any mode, any edge, before
+ * debounce). Pins that are not watched cost one mask test per write.
+ *
+ * With no trigger the ring keeps the latest records (flight recorder). With a trigger the
+ * capture keeps pre_trigger records before the first transition that makes the trigger pins
+ * match trigger_levels, records post_trigger more, then freezes until re-armed.
+ *
+ * Export format (little-endian), read by host/tools/gpio_capture_vcd:
+ *   header   36 bytes: magic "GCAP", version, channel count, flags (bit 0: triggered),
+ *            record count, trigger record index (0xFFFFFFFF if none), timestamp bits 32-47
+ *            at the first record, channel levels before the first record, and the pin of
+ *            each of the 16 channels (0xFF unused)
+ *   records  8 bytes each: timestamp bits 0-31 (us), changed channels, their new levels.
+ *            A record with no changed channels sets timestamp bits 32-47 to its levels field.
+ *   trailer  CRC-32 of header and records
+ */
+#define GPIO_CAPTURE_CHANNELS       16
+#define GPIO_CAPTURE_DEPTH          512     // Records; a power of two (8 bytes each)
+#define GPIO_CAPTURE_MAGIC          0x50414347u     // "GCAP"
+#define GPIO_CAPTURE_VERSION        1
+#define GPIO_CAPTURE_HEADER_SIZE    36
+#define GPIO_CAPTURE_RECORD_SIZE    8
+#define GPIO_CAPTURE_NO_TRIGGER     0xFFFFFFFFu
+#define GPIO_CAPTURE_MAX_SIZE       (GPIO_CAPTURE_HEADER_SIZE + GPIO_CAPTURE_DEPTH * GPIO_CAPTURE_RECORD_SIZE + 4)
+
+/**
+ * @brief Capture setup. trigger_mask 0 records continuously.
+ */
+typedef struct {
+    t_gpio_mask pins;               // Watched pins, at most GPIO_CAPTURE_CHANNELS
+    t_gpio_mask trigger_mask;       // Pins the trigger looks at; a subset of pins
+    t_gpio_mask trigger_levels;     // Levels of trigger_mask that fire the trigger
+    tword pre_trigger;              // Records kept before the trigger record
+    tword post_trigger;             // Records taken after it
+} t_gpio_capture_config;
+
+/**
+ * @brief Enumeration for the capture state.
+ */
+typedef enum {
+    capture_idle,
+    capture_armed,          // Recording, waiting for the trigger (or continuous)
+    capture_triggered,      // Recording the post-trigger records
+    capture_done            // Frozen until re-armed
+} t_capture_state;
+
+typedef struct {
+    t_capture_state state;
+    tlong records;          // Records taken since armed, including ones overwritten
+    tlong overwritten;      // Records lost to the ring wrapping
+} t_gpio_capture_status;
+
+/**
+ * @brief Starts a capture. The ring is cleared.
+ * @return ESP_OK or ESP_ERR_INVALID_ARG (no pins, too many pins, non-existent pins, trigger
+ *         pins outside pins, or pre_trigger + post_trigger not below GPIO_CAPTURE_DEPTH).
+ */
+esp_err_t GPIO_Capture_Arm(const t_gpio_capture_config *config);
+
+/**
+ * @brief Stops recording. The ring is kept for export.
+ */
+void GPIO_Capture_Stop(void);
+
+/**
+ * @brief Copies the capture state and counters.
+ */
+void GPIO_Capture_Get_Status(t_gpio_capture_status *status);
+
+/**
+ * @brief Writes the capture in the export format to a buffer.
+ *
+ * Recording pauses while the ring is read, then resumes in the state it was in; a record
+ * is added on resume for any watched output that changed meanwhile. The size can grow
+ * between two calls while recording, up to GPIO_CAPTURE_MAX_SIZE.
+ *
+ * @param buffer Destination, or NULL to only compute the size.
+ * @param capacity Size of buffer.
+ * @param length Out: bytes needed / written.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_SIZE if buffer is too small.
+ */
+esp_err_t GPIO_Capture_Serialize(tbyte *buffer, size_t capacity, size_t *length);
+
+/**
+ * @brief Sends the capture in the export format over a UART, in chunks from the ring.
+ *
+ * Recording pauses while it is sent, as for GPIO_Capture_Serialize().
+ *
+ * @return ESP_OK or ESP_FAIL if the UART driver refused the data.
+ */
+esp_err_t GPIO_Capture_Export(t_uart_port port);
+
+/**
+ * @brief Records a transition. Called by the GPIO driver; not for applications.
+ *
+ * @param changed Pins whose level changed.
+ * @param levels New levels of the changed pins.
+ */
+void GPIO_Capture_Hook(t_gpio_mask changed, t_gpio_mask levels);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE_H_ */
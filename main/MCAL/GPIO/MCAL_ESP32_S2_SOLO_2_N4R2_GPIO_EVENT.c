@@ -0,0 +1,237 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT.C
+ Description    : This file as Source for (GPIO Interrupt-Driven Inputs)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT.h"
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+
+#define GPIO_EVENT_QUEUE_MASK   (GPIO_EVENT_QUEUE_LEN - 1)
+
+_Static_assert((GPIO_EVENT_QUEUE_LEN & GPIO_EVENT_QUEUE_MASK) == 0, "GPIO_EVENT_QUEUE_LEN must be a power of two");
+
+typedef struct {
+    bool used;
+    tpin pin;
+    t_event_mode mode;
+    tlong debounce_us;
+    // Written by the ISR
+    volatile tlong count;
+    int64_t first_us;
+    int64_t last_us;
+    // Frequency window, owned by GPIO_Event_Get_Frequency()
+    bool window_valid;
+    tlong window_count;
+    int64_t window_us;
+} t_gpio_input_slot;
+
+static t_gpio_input_slot input_slots[GPIO_EVENT_MAX_PINS];
+static portMUX_TYPE event_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t event_signal;
+static t_gpio_event_stats event_stats;
+
+// Single-producer (the GPIO ISR) / single-consumer (GPIO_Event_Wait) ring; free-running indexes
+static t_gpio_event event_ring[GPIO_EVENT_QUEUE_LEN];
+static volatile tlong ring_head;
+static volatile tlong ring_tail;
+
+static IRAM_ATTR void gpio_event_isr(void *arg) {
+    t_gpio_input_slot *slot = arg;
+    int64_t now = esp_timer_get_time();
+    tbyte level = (REG_READ(slot->pin < 32 ? GPIO_IN_REG : GPIO_IN1_REG) >> (slot->pin & 31)) & 1;
+
+    // The capture sees every edge, bounces included
+    GPIO_Capture_Hook(GPIO_PIN_MASK(slot->pin), level ? GPIO_PIN_MASK(slot->pin) : 0);
+    if (slot->count > 0 && slot->debounce_us > 0 && now - slot->last_us < (int64_t)slot->debounce_us) {
+        event_stats.bounces++;
+        return;
+    }
+    portENTER_CRITICAL_ISR(&event_lock);
+    if (slot->count == 0) {
+        slot->first_us = now;
+    }
+    slot->last_us = now;
+    slot->count++;
+    portEXIT_CRITICAL_ISR(&event_lock);
+    event_stats.edges++;
+    if (slot->mode != event_queue) {
+        return;
+    }
+
+    tlong head = ring_head;
+    tlong tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= GPIO_EVENT_QUEUE_LEN) {
+        event_stats.overflows++;
+        return;
+    }
+    t_gpio_event *event = &event_ring[head & GPIO_EVENT_QUEUE_MASK];
+    event->timestamp_us = now;
+    event->pin = slot->pin;
+    event->level = level;
+    __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+
+    // The consumer checks the ring before it blocks, so it only needs a signal when the ring was empty
+    if (head == tail) {
+        BaseType_t woken = pdFALSE;
+        event_stats.wakeups++;
+        xSemaphoreGiveFromISR(event_signal, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static t_gpio_input_slot *find_slot(tpin pin) {
+    for (size_t i = 0; i < GPIO_EVENT_MAX_PINS; i++) {
+        if (input_slots[i].used && input_slots[i].pin == pin) {
+            return &input_slots[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t GPIO_Event_Init(void) {
+    if (event_signal != NULL) {
+        return ESP_OK;
+    }
+    // ISRs kept in IRAM keep running while NVS or the flash log hold the flash cache off
+    esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return err;
+    }
+    event_signal = xSemaphoreCreateBinary();
+    return event_signal != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t GPIO_Event_Attach(tpin pin, const t_gpio_input_config *config) {
+    if (config == NULL || (config->edge != edge_rising && config->edge != edge_falling && config->edge != edge_both) ||
+        (config->mode != event_queue && config->mode != event_count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (event_signal == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    t_gpio_input_slot *slot = find_slot(pin);
+    for (size_t i = 0; slot == NULL && i < GPIO_EVENT_MAX_PINS; i++) {
+        if (!input_slots[i].used) {
+            slot = &input_slots[i];
+        }
+    }
+    if (slot == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (slot->used) {
+        gpio_intr_disable((gpio_num_t)pin);
+    }
+
+    portENTER_CRITICAL(&event_lock);
+    slot->used = true;
+    slot->pin = pin;
+    slot->mode = config->mode;
+    slot->debounce_us = config->debounce_us;
+    slot->count = 0;
+    slot->window_valid = false;
+    portEXIT_CRITICAL(&event_lock);
+
+    t_gpio_pin_config entry = {pin, input, config->pull, 0, (gpio_int_type_t)config->edge};
+    esp_err_t err = GPIO_Config_Table(&entry, 1);
+    if (err == ESP_OK) {
+        err = gpio_isr_handler_add((gpio_num_t)pin, gpio_event_isr, slot);
+    }
+    if (err == ESP_OK) {
+        err = gpio_intr_enable((gpio_num_t)pin);
+    }
+    if (err != ESP_OK) {
+        gpio_set_intr_type((gpio_num_t)pin, GPIO_INTR_DISABLE);
+        gpio_isr_handler_remove((gpio_num_t)pin);
+        slot->used = false;
+    }
+    return err;
+}
+
+esp_err_t GPIO_Event_Detach(tpin pin) {
+    t_gpio_input_slot *slot = find_slot(pin);
+    if (slot == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    gpio_intr_disable((gpio_num_t)pin);
+    gpio_set_intr_type((gpio_num_t)pin, GPIO_INTR_DISABLE);
+    gpio_isr_handler_remove((gpio_num_t)pin);
+    slot->used = false;
+    return ESP_OK;
+}
+
+esp_err_t GPIO_Event_Wait(t_gpio_event *event, TickType_t ticks_to_wait) {
+    if (event == NULL || event_signal == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (;;) {
+        tlong tail = ring_tail;
+        if (__atomic_load_n(&ring_head, __ATOMIC_ACQUIRE) != tail) {
+            *event = event_ring[tail & GPIO_EVENT_QUEUE_MASK];
+            __atomic_store_n(&ring_tail, tail + 1, __ATOMIC_RELEASE);
+            return ESP_OK;
+        }
+        // A signal left over from an event already taken only costs one more pass
+        if (ticks_to_wait == 0 || xSemaphoreTake(event_signal, ticks_to_wait) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
+
+esp_err_t GPIO_Event_Get_Count(tpin pin, tlong *count, bool reset) {
+    t_gpio_input_slot *slot = find_slot(pin);
+    if (slot == NULL || count == NULL) {
+        return slot == NULL ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&event_lock);
+    *count = slot->count;
+    if (reset) {
+        slot->count = 0;
+        slot->window_valid = false;
+    }
+    portEXIT_CRITICAL(&event_lock);
+    return ESP_OK;
+}
+
+esp_err_t GPIO_Event_Get_Frequency(tpin pin, tlong *millihertz) {
+    t_gpio_input_slot *slot = find_slot(pin);
+    if (slot == NULL || millihertz == NULL) {
+        return slot == NULL ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&event_lock);
+    tlong count = slot->count;
+    int64_t first_us = slot->first_us;
+    int64_t last_us = slot->last_us;
+    portEXIT_CRITICAL(&event_lock);
+
+    *millihertz = 0;
+    if (count == 0) {
+        return ESP_OK;
+    }
+    if (!slot->window_valid) {
+        slot->window_valid = true;
+        slot->window_count = 1;
+        slot->window_us = first_us;
+    }
+    tlong edges = count - slot->window_count;
+    if (edges > 0 && last_us > slot->window_us) {
+        *millihertz = (tlong)(((uint64_t)edges * 1000000000ULL) / (uint64_t)(last_us - slot->window_us));
+        slot->window_count = count;
+        slot->window_us = last_us;
+    }
+    return ESP_OK;
+}
+
+void GPIO_Event_Get_Stats(t_gpio_event_stats *stats) {
+    if (stats != NULL) {
+        portENTER_CRITICAL(&event_lock);
+        *stats = event_stats;
+        portEXIT_CRITICAL(&event_lock);
+    }
+}
@@ -0,0 +1,147 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT.H
+ Description    : This file as Header for (GPIO Interrupt-Driven Inputs)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+/*
+ * Inputs attached here are serviced by the GPIO interrupt instead of being polled. The ISR
+ * timestamps each edge with esp_timer_get_time(), drops edges that fall inside the pin's
+ * debounce window, counts the rest and pushes them into a single-producer/single-consumer
+ * ring that one task drains with GPIO_Event_Wait(). The ring takes no lock; the ISR only
+ * signals the waiting task when the ring goes from empty to non-empty, so a busy input costs
+ * one semaphore give per burst rather than per edge, and an idle one costs nothing.
+ *
+ * Pins in counting mode skip the ring: the ISR only updates the edge counter and timestamps,
+ * which GPIO_Event_Get_Count() and GPIO_Event_Get_Frequency() read.
+ *
+ *   t_gpio_input_config button = GPIO_INPUT_CONFIG_DEFAULT();
+ *   button.debounce_us = 20000;
+ *   GPIO_Event_Init();
+ *   GPIO_Event_Attach(Pin_0, &button);
+ *   while (GPIO_Event_Wait(&event, portMAX_DELAY) == ESP_OK) { ... }
+ */
+#define GPIO_EVENT_QUEUE_LEN    64      // Ring entries; a power of two
+#define GPIO_EVENT_MAX_PINS     8       // Pins attached at the same time
+
+/**
+ * @brief Enumeration for the edges that raise an event.
+ */
+typedef enum {
+    edge_rising = GPIO_INTR_POSEDGE,
+    edge_falling = GPIO_INTR_NEGEDGE,
+    edge_both = GPIO_INTR_ANYEDGE
+} t_edge;
+
+/**
+ * @brief Enumeration for what the ISR does with an accepted edge.
+ */
+typedef enum {
+    event_queue,        // Count it and push it to the event ring
+    event_count         // Count it only (pulse counting / frequency measurement)
+} t_event_mode;
+
+/**
+ * @brief Configuration of an attached input.
+ */
+typedef struct {
+    t_edge edge;
+    t_pull pull;
+    t_event_mode mode;
+    tlong debounce_us;  // Edges closer than this to the last accepted edge are dropped; 0 disables
+} t_gpio_input_config;
+
+#define GPIO_INPUT_CONFIG_DEFAULT() {   \
+    .edge        = edge_both,           \
+    .pull        = pull_up,             \
+    .mode        = event_queue,         \
+    .debounce_us = 0                    \
+}
+
+/**
+ * @brief One accepted edge.
+ */
+typedef struct {
+    int64_t timestamp_us;   // esp_timer_get_time() when the ISR ran
+    tpin pin;
+    tbyte level;            // Pin level read by the ISR, i.e. after the edge
+} t_gpio_event;
+
+/**
+ * @brief Driver-wide event counters.
+ */
+typedef struct {
+    tlong edges;            // Edges accepted on all pins
+    tlong bounces;          // Edges dropped by a debounce window
+    tlong overflows;        // Accepted edges not queued because the ring was full
+    tlong wakeups;          // Times the ISR woke the waiting task
+} t_gpio_event_stats;
+
+/**
+ * @brief Installs the GPIO ISR service (if nobody has yet) and creates the event ring.
+ * @return ESP_OK, ESP_ERR_NO_MEM, or the error of gpio_install_isr_service().
+ */
+esp_err_t GPIO_Event_Init(void);
+
+/**
+ * @brief Configures a pin as an input and starts servicing its edges.
+ *
+ * The pin is configured through GPIO_Config_Table(), so it is validated and its direction is
+ * tracked like any other input. Attaching a pin again replaces its configuration and resets
+ * its counters.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE before GPIO_Event_Init(),
+ *         ESP_ERR_NO_MEM if GPIO_EVENT_MAX_PINS pins are attached, or a GPIO driver error.
+ */
+esp_err_t GPIO_Event_Attach(tpin pin, const t_gpio_input_config *config);
+
+/**
+ * @brief Stops servicing a pin. Its events already in the ring are still delivered.
+ * @return ESP_OK or ESP_ERR_NOT_FOUND if the pin is not attached.
+ */
+esp_err_t GPIO_Event_Detach(tpin pin);
+
+/**
+ * @brief Takes the oldest event from the ring, blocking until one arrives.
+ *
+ * Only one task may wait on the ring.
+ *
+ * @param event Out: the event.
+ * @param ticks_to_wait How long to block; 0 polls.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_TIMEOUT.
+ */
+esp_err_t GPIO_Event_Wait(t_gpio_event *event, TickType_t ticks_to_wait);
+
+/**
+ * @brief Number of edges accepted on a pin since it was attached (or since the last reset).
+ * @return ESP_OK or ESP_ERR_NOT_FOUND.
+ */
+esp_err_t GPIO_Event_Get_Count(tpin pin, tlong *count, bool reset);
+
+/**
+ * @brief Average edge rate of a pin since the previous call, in millihertz.
+ *
+ * Measured from the timestamps of the accepted edges themselves, so the result does not
+ * depend on when this function is called. With edge_both the rate is twice the signal
+ * frequency. Reads 0 until two edges have been seen in the window.
+ *
+ * @return ESP_OK or ESP_ERR_NOT_FOUND.
+ */
+esp_err_t GPIO_Event_Get_Frequency(tpin pin, tlong *millihertz);
+
+/**
+ * @brief Copies the driver-wide event counters.
+ */
+void GPIO_Event_Get_Stats(t_gpio_event_stats *stats);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT_H_ */
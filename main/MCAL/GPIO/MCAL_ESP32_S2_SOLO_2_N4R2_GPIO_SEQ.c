@@ -0,0 +1,253 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ.C
+ Description    : This file as Source for (GPIO Waveform Sequencer)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+
+typedef struct {
+    const t_gpio_seq_step *steps;
+    size_t count;                   // 0 = empty slot
+    tlong repeat;
+    bool streamed;                  // Came through GPIO_Seq_Queue(), so running dry is an underrun
+} t_seq_buffer;
+
+typedef struct {
+    t_seq_buffer active;
+    t_seq_buffer pending;
+    size_t index;                   // Next step of the active buffer
+    tlong pass;                     // Passes of the active buffer completed
+    int64_t due_us;                 // Deadline of the next step
+    tlong started;                  // Queued buffers that took over from the one before them
+    tlong stops;                    // GPIO_Seq_Stop() / GPIO_Seq_Start() calls so far
+} t_seq_state;
+
+static t_seq_state seq;
+static t_gpio_seq_stats seq_stats;
+static portMUX_TYPE seq_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t seq_timer;
+static SemaphoreHandle_t seq_signal;        // Given when a buffer starts or the sequencer stops
+
+// Called with seq_lock held at the end of each pass over the active buffer. Returns true if a waiter must be woken.
+static IRAM_ATTR bool seq_end_of_pass(void) {
+    seq.pass++;
+    bool looping = seq.active.repeat == GPIO_SEQ_LOOP;
+    if (looping ? seq.pending.count == 0 : seq.pass < seq.active.repeat) {
+        return false;
+    }
+    seq_stats.buffers++;
+    bool streamed = seq.active.streamed;
+    seq.active = seq.pending;
+    seq.pending.count = 0;
+    seq.pass = 0;
+    if (seq.active.count != 0) {
+        seq.started++;
+    } else if (streamed) {
+        seq_stats.underruns++;
+    }
+    return true;
+}
+
+static IRAM_ATTR void seq_timer_isr(void *arg) {
+    bool wake = false;
+    int64_t budget_end = esp_timer_get_time() + GPIO_SEQ_BURST_US;
+    (void)arg;
+
+    for (;;) {
+        // Snapshot the next deadline, then spin for it with interrupts enabled
+        portENTER_CRITICAL_ISR(&seq_lock);
+        if (seq.active.count == 0) {
+            portEXIT_CRITICAL_ISR(&seq_lock);
+            break;
+        }
+        int64_t due_us = seq.due_us;
+        tlong stops = seq.stops;
+        int64_t now = esp_timer_get_time();
+        int64_t wait = due_us - now;
+        // Zero-delay steps never move the deadline, so the budget is also checked against the clock
+        if (wait > GPIO_SEQ_SPIN_US || due_us > budget_end || now >= budget_end) {
+            // Fails harmlessly if GPIO_Seq_Start() armed the timer meanwhile
+            esp_timer_start_once(seq_timer, wait > 0 ? (uint64_t)wait : 0);
+            portEXIT_CRITICAL_ISR(&seq_lock);
+            break;
+        }
+        portEXIT_CRITICAL_ISR(&seq_lock);
+
+        while ((now = esp_timer_get_time()) < due_us) {
+        }
+
+        portENTER_CRITICAL_ISR(&seq_lock);
+        if (seq.stops != stops) {
+            // Stopped or restarted while spinning; GPIO_Seq_Start() armed its own timer
+            portEXIT_CRITICAL_ISR(&seq_lock);
+            break;
+        }
+        tlong late = (tlong)(now - due_us);
+        if (late > GPIO_SEQ_SPIN_US) {
+            seq_stats.late_steps++;
+        }
+        if (late > seq_stats.max_late_us) {
+            seq_stats.max_late_us = late;
+        }
+
+        const t_gpio_seq_step *step = &seq.active.steps[seq.index];
+        GPIO_Port_Write_From_ISR(step->mask, step->levels);
+        seq_stats.steps++;
+        seq.due_us += step->delay_us;
+        if (++seq.index == seq.active.count) {
+            seq.index = 0;
+            wake |= seq_end_of_pass();
+        }
+        portEXIT_CRITICAL_ISR(&seq_lock);
+    }
+
+    if (wake) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(seq_signal, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static bool buffer_is_valid(const t_gpio_seq_step *steps, size_t count, tlong repeat) {
+    if (steps == NULL || count == 0) {
+        return false;
+    }
+    uint64_t period_us = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (steps[i].mask & ~GPIO_OUTPUT_MASK) {
+            return false;
+        }
+        period_us += steps[i].delay_us;
+    }
+    // A looping table with no delay would never leave the ISR
+    return repeat != GPIO_SEQ_LOOP || period_us > 0;
+}
+
+// Called with seq_lock held
+static void seq_start_locked(const t_gpio_seq_step *steps, size_t count, tlong repeat, bool streamed) {
+    seq.active.steps = steps;
+    seq.active.count = count;
+    seq.active.repeat = repeat;
+    seq.active.streamed = streamed;
+    seq.index = 0;
+    seq.pass = 0;
+    seq.due_us = esp_timer_get_time();
+    esp_timer_stop(seq_timer);
+    esp_timer_start_once(seq_timer, 0);
+}
+
+esp_err_t GPIO_Seq_Init(void) {
+    if (seq_timer != NULL) {
+        return ESP_OK;
+    }
+    seq_signal = xSemaphoreCreateBinary();
+    if (seq_signal == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    const esp_timer_create_args_t timer_args = {
+        .callback = seq_timer_isr,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_ISR,
+        .name = "gpio_seq",
+        .skip_unhandled_events = false,
+    };
+    return esp_timer_create(&timer_args, &seq_timer);
+}
+
+esp_err_t GPIO_Seq_Start(const t_gpio_seq_step *steps, size_t count, tlong repeat) {
+    if (!buffer_is_valid(steps, count, repeat)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (seq_timer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&seq_lock);
+    seq.pending.count = 0;
+    seq.stops++;
+    seq_start_locked(steps, count, repeat, false);
+    portEXIT_CRITICAL(&seq_lock);
+    xSemaphoreGive(seq_signal);
+    return ESP_OK;
+}
+
+esp_err_t GPIO_Seq_Queue(const t_gpio_seq_step *steps, size_t count, tlong repeat, TickType_t ticks_to_wait) {
+    if (!buffer_is_valid(steps, count, repeat)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (seq_timer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Take the queue slot, or start at once when idle
+    tlong ticket, stops;
+    for (;;) {
+        portENTER_CRITICAL(&seq_lock);
+        if (seq.active.count == 0) {
+            seq_start_locked(steps, count, repeat, true);
+            portEXIT_CRITICAL(&seq_lock);
+            return ESP_OK;
+        }
+        if (seq.pending.count == 0) {
+            seq.pending.steps = steps;
+            seq.pending.count = count;
+            seq.pending.repeat = repeat;
+            seq.pending.streamed = true;
+            ticket = seq.started + 1;
+            stops = seq.stops;
+            portEXIT_CRITICAL(&seq_lock);
+            break;
+        }
+        portEXIT_CRITICAL(&seq_lock);
+        if (xSemaphoreTake(seq_signal, ticks_to_wait) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    // Wait for it to start; the buffer before it is then done
+    for (;;) {
+        portENTER_CRITICAL(&seq_lock);
+        bool started = (tslong)(seq.started - ticket) >= 0;
+        bool dropped = seq.stops != stops;
+        portEXIT_CRITICAL(&seq_lock);
+        if (started || dropped) {
+            return dropped && !started ? ESP_ERR_INVALID_STATE : ESP_OK;
+        }
+        if (xSemaphoreTake(seq_signal, ticks_to_wait) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
+
+void GPIO_Seq_Stop(void) {
+    if (seq_timer == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&seq_lock);
+    seq.active.count = 0;
+    seq.pending.count = 0;
+    seq.stops++;
+    esp_timer_stop(seq_timer);
+    portEXIT_CRITICAL(&seq_lock);
+    xSemaphoreGive(seq_signal);
+}
+
+bool GPIO_Seq_Is_Running(void) {
+    portENTER_CRITICAL(&seq_lock);
+    bool running = seq.active.count != 0;
+    portEXIT_CRITICAL(&seq_lock);
+    return running;
+}
+
+void GPIO_Seq_Get_Stats(t_gpio_seq_stats *stats) {
+    if (stats != NULL) {
+        portENTER_CRITICAL(&seq_lock);
+        *stats = seq_stats;
+        portEXIT_CRITICAL(&seq_lock);
+    }
+}
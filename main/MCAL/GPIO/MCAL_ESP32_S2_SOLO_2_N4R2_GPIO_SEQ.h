@@ -0,0 +1,116 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ.H
+ Description    : This file as Header for (GPIO Waveform Sequencer)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_GPIO.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+/*
+ * The sequencer plays a table of steps: each step writes a group of pins with
+ * GPIO_Port_Write_From_ISR() and holds them for delay_us before the next step. Steps run from
+ * an esp_timer callback dispatched from ISR, scheduled against absolute deadlines so that
+ * delays do not accumulate error. Holds shorter than GPIO_SEQ_SPIN_US are timed by spinning
+ * in the callback instead of re-arming the timer. The spin runs outside the sequencer lock, with
+ * interrupts enabled; the lock is only held to take and advance a step.
+ *
+ * Two buffers can be in flight: the one playing and one queued behind it. GPIO_Seq_Queue()
+ * returns once its buffer has started, which is when the buffer before it is free to be
+ * refilled, so a producer alternating between two tables streams without gaps:
+ *
+ *   static t_gpio_seq_step table[2][64];
+ *   for (int i = 0; ; i ^= 1) {
+ *       fill(table[i]);
+ *       GPIO_Seq_Queue(table[i], 64, 1, portMAX_DELAY);
+ *   }
+ *
+ * Requires CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD.
+ */
+#define GPIO_SEQ_SPIN_US        50      // Holds below this are spun rather than timed
+#define GPIO_SEQ_BURST_US       200     // Time one callback may spend spinning or stepping before it yields
+#define GPIO_SEQ_LOOP           0       // repeat value: play until stopped or until another buffer is queued
+
+/**
+ * @brief One step of a waveform: write levels to the pins in mask, then hold for delay_us.
+ */
+typedef struct {
+    t_gpio_mask mask;
+    t_gpio_mask levels;
+    tlong delay_us;
+} t_gpio_seq_step;
+
+// Fails the build for a step that writes a pin which cannot be an output; evaluates to 0
+#define GPIO_SEQ_CHECK(mask)                                                                        \
+    (0 * sizeof(struct {                                                                            \
+        _Static_assert(((mask) & ~GPIO_OUTPUT_MASK) == 0, "sequencer step writes a non-output pin");\
+        int unused;                                                                                 \
+    }))
+
+#define GPIO_SEQ_STEP(mask, levels, delay_us) \
+    { (t_gpio_mask)(mask) + GPIO_SEQ_CHECK(mask), (t_gpio_mask)(levels), (delay_us) }
+
+/**
+ * @brief Sequencer counters, since GPIO_Seq_Init().
+ */
+typedef struct {
+    tlong steps;            // Steps written
+    tlong late_steps;       // Steps written more than GPIO_SEQ_SPIN_US after their deadline
+    tlong max_late_us;
+    tlong buffers;          // Buffers played to the end (all repeats)
+    tlong underruns;        // Times a queued buffer ended with nothing queued behind it
+} t_gpio_seq_stats;
+
+/**
+ * @brief Creates the sequencer timer.
+ * @return ESP_OK, ESP_ERR_NO_MEM, or an esp_timer error.
+ */
+esp_err_t GPIO_Seq_Init(void);
+
+/**
+ * @brief Stops whatever is playing and plays a table from its first step.
+ *
+ * @param steps The table; it must stay valid until it has finished playing.
+ * @param count Number of steps.
+ * @param repeat Number of passes over the table, or GPIO_SEQ_LOOP.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (empty table, or a looping table whose delays add up
+ *         to 0), or ESP_ERR_INVALID_STATE before GPIO_Seq_Init().
+ */
+esp_err_t GPIO_Seq_Start(const t_gpio_seq_step *steps, size_t count, tlong repeat);
+
+/**
+ * @brief Queues a table behind the one playing and waits until it starts.
+ *
+ * If nothing is playing, the table starts at once. A looping table hands over at the end of
+ * its current pass. Only one table can wait: while one is queued, this blocks.
+ *
+ * @param ticks_to_wait How long to wait for the table to start. On timeout the table stays
+ *        queued (or, if the queue slot never freed, is not queued).
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_STATE before
+ *         GPIO_Seq_Init() or when GPIO_Seq_Stop() / GPIO_Seq_Start() dropped the table.
+ */
+esp_err_t GPIO_Seq_Queue(const t_gpio_seq_step *steps, size_t count, tlong repeat, TickType_t ticks_to_wait);
+
+/**
+ * @brief Stops the sequencer and drops the queued table. Pins keep their last levels.
+ */
+void GPIO_Seq_Stop(void);
+
+/**
+ * @brief True while a table is playing.
+ */
+bool GPIO_Seq_Is_Running(void);
+
+/**
+ * @brief Copies the sequencer counters.
+ */
+void GPIO_Seq_Get_Stats(t_gpio_seq_stats *stats);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ_H_ */
@@ -0,0 +1,184 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_LZ.C
+ Description    : Small-footprint LZ77 codec (LZ4-style sequences, 2 KB hash table)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_LZ.h"
+#include <string.h>
+
+#define LZ_NIBBLE_MAX   15
+
+static inline tlong load_le32(const tbyte *data) {
+    tlong word;
+    memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+// Knuth multiplicative hash of the next four bytes
+static inline tlong lz_hash(tlong sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Writes a nibble overflow as 255-continued bytes. Returns NULL if it does not fit.
+static tbyte *put_extension(tbyte *out, const tbyte *out_end, size_t value) {
+    while (value >= 255) {
+        if (out >= out_end) {
+            return NULL;
+        }
+        *out++ = 255;
+        value -= 255;
+    }
+    if (out >= out_end) {
+        return NULL;
+    }
+    *out++ = (tbyte)value;
+    return out;
+}
+
+// Emits one sequence; match_length 0 marks the final, literals-only sequence
+static tbyte *put_sequence(tbyte *out, const tbyte *out_end, const tbyte *literals, size_t literal_count,
+                           size_t offset, size_t match_length) {
+    if (out >= out_end) {
+        return NULL;
+    }
+    size_t match_code = match_length > 0 ? match_length - LZ_MIN_MATCH : 0;
+    tbyte *token = out++;
+    *token = (tbyte)(((literal_count < LZ_NIBBLE_MAX ? literal_count : LZ_NIBBLE_MAX) << 4) |
+                     (match_code < LZ_NIBBLE_MAX ? match_code : LZ_NIBBLE_MAX));
+    if (literal_count >= LZ_NIBBLE_MAX && (out = put_extension(out, out_end, literal_count - LZ_NIBBLE_MAX)) == NULL) {
+        return NULL;
+    }
+    if ((size_t)(out_end - out) < literal_count) {
+        return NULL;
+    }
+    memcpy(out, literals, literal_count);
+    out += literal_count;
+    if (match_length == 0) {
+        return out;
+    }
+    if (out_end - out < 2) {
+        return NULL;
+    }
+    *out++ = (tbyte)offset;
+    *out++ = (tbyte)(offset >> 8);
+    if (match_code >= LZ_NIBBLE_MAX) {
+        out = put_extension(out, out_end, match_code - LZ_NIBBLE_MAX);
+    }
+    return out;
+}
+
+size_t LZ_Compress(const tbyte *src, size_t length, tbyte *dst, size_t capacity, void *work) {
+    if (src == NULL || dst == NULL || length == 0 || length > LZ_MAX_INPUT) {
+        return 0;
+    }
+    tword *table = work != NULL ? work : malloc(LZ_WORK_SIZE);
+    if (table == NULL) {
+        return 0;
+    }
+    memset(table, 0, LZ_WORK_SIZE);
+
+    const tbyte *out_end = dst + capacity;
+    tbyte *out = dst;
+    size_t anchor = 0;
+    size_t position = 0;
+    while (out != NULL && position + LZ_MIN_MATCH <= length) {
+        tlong sequence = load_le32(src + position);
+        tlong hash = lz_hash(sequence);
+        size_t candidate = table[hash];
+        table[hash] = (tword)position;
+        // Position 0 doubles as "empty"; the byte compare rejects it when it is not a real match
+        if (candidate >= position || load_le32(src + candidate) != sequence) {
+            position++;
+            continue;
+        }
+        size_t match_length = LZ_MIN_MATCH;
+        while (position + match_length < length && src[candidate + match_length] == src[position + match_length]) {
+            match_length++;
+        }
+        out = put_sequence(out, out_end, src + anchor, position - anchor, position - candidate, match_length);
+        position += match_length;
+        anchor = position;
+        // Seed the table inside the match so the next repeat of its tail is found
+        if (position >= 2 && position + LZ_MIN_MATCH <= length) {
+            table[lz_hash(load_le32(src + position - 2))] = (tword)(position - 2);
+        }
+    }
+    if (out != NULL && anchor < length) {
+        out = put_sequence(out, out_end, src + anchor, length - anchor, 0, 0);
+    }
+
+    if (work == NULL) {
+        free(table);
+    }
+    return out != NULL ? (size_t)(out - dst) : 0;
+}
+
+size_t LZ_Decompress(const tbyte *src, size_t length, tbyte *dst, size_t capacity) {
+    if (src == NULL || dst == NULL) {
+        return 0;
+    }
+    const tbyte *in = src;
+    const tbyte *in_end = src + length;
+    size_t produced = 0;
+    while (in < in_end) {
+        tbyte token = *in++;
+        size_t literal_count = token >> 4;
+        if (literal_count == LZ_NIBBLE_MAX) {
+            tbyte extra;
+            do {
+                if (in >= in_end) {
+                    return 0;
+                }
+                extra = *in++;
+                literal_count += extra;
+            } while (extra == 255);
+        }
+        if ((size_t)(in_end - in) < literal_count || capacity - produced < literal_count) {
+            return 0;
+        }
+        memcpy(dst + produced, in, literal_count);
+        in += literal_count;
+        produced += literal_count;
+        if (in == in_end) {
+            break;      // Final sequence
+        }
+
+        if (in_end - in < 2) {
+            return 0;
+        }
+        size_t offset = in[0] | ((size_t)in[1] << 8);
+        in += 2;
+        size_t match_length = token & LZ_NIBBLE_MAX;
+        if (match_length == LZ_NIBBLE_MAX) {
+            tbyte extra;
+            do {
+                if (in >= in_end) {
+                    return 0;
+                }
+                extra = *in++;
+                match_length += extra;
+            } while (extra == 255);
+        }
+        match_length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > produced || capacity - produced < match_length) {
+            return 0;
+        }
+        tbyte *out = dst + produced;
+        const tbyte *from = out - offset;
+        if (offset >= match_length) {
+            memcpy(out, from, match_length);
+        } else {
+            // Overlapping copy repeats the last 'offset' bytes (run-length case)
+            for (size_t i = 0; i < match_length; i++) {
+                out[i] = from[i];
+            }
+        }
+        produced += match_length;
+    }
+    return produced;
+}
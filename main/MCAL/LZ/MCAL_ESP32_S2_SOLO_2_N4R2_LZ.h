@@ -0,0 +1,62 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_LZ.H
+ Description    : This file as Header for (LZ Compression)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_LZ_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_LZ_H_
+
+#include "../ESP32_S2_SOLO_2_N4R2_Main.h"
+
+/*
+ * Small-footprint LZ77 codec in the style of an LZ4 block. The output is a run of sequences:
+ *
+ *   token (literal count : 4 | match length - 4 : 4), literal count extension bytes, literals,
+ *   match offset (2 bytes, little-endian), match length extension bytes
+ *
+ * A nibble of 15 is continued by bytes that are added to it until one is below 255. The last
+ * sequence has literals only and ends the block. Matches are found through a hash table of
+ * LZ_HASH_SIZE 16-bit positions (LZ_WORK_SIZE bytes, the only RAM the encoder needs besides its
+ * output), so inputs are limited to LZ_MAX_INPUT bytes. The decoder needs no extra RAM.
+ */
+#define LZ_MIN_MATCH    4
+#define LZ_HASH_BITS    10
+#define LZ_HASH_SIZE    (1u << LZ_HASH_BITS)
+#define LZ_WORK_SIZE    (LZ_HASH_SIZE * sizeof(tword))
+#define LZ_MAX_INPUT    0xFFFFu
+
+/**
+* @brief Worst-case compressed size of an input (incompressible data grows slightly).
+*/
+#define LZ_BOUND(length)    ((length) + (length) / 255 + 16)
+
+/**
+* @brief Compresses a buffer.
+*
+* @param src      Input, at most LZ_MAX_INPUT bytes.
+* @param length   Input length.
+* @param dst      Output.
+* @param capacity Size of dst. The encoder gives up as soon as the output would not fit.
+* @param work     LZ_WORK_SIZE bytes of scratch memory, or NULL to allocate it from the heap.
+* @return Compressed length, or 0 if the input is empty, too long, or did not fit in capacity.
+*/
+size_t LZ_Compress(const tbyte *src, size_t length, tbyte *dst, size_t capacity, void *work);
+
+/**
+* @brief Decompresses a block produced by LZ_Compress().
+*
+* Every offset and length is checked, so corrupt input cannot write outside dst.
+*
+* @param src      Compressed block.
+* @param length   Block length.
+* @param dst      Output.
+* @param capacity Size of dst.
+* @return Decompressed length, or 0 if the block is corrupt or does not fit in capacity.
+*/
+size_t LZ_Decompress(const tbyte *src, size_t length, tbyte *dst, size_t capacity);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_LZ_H_ */
@@ -9,8 +9,21 @@
 #define MCAL_MCU_CONFIG_H_
 
 #include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_EVENT.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_SEQ.h"
+#include "GPIO/MCAL_ESP32_S2_SOLO_2_N4R2_GPIO_CAPTURE.h"
 #include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI.h"
+#include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE.h"
+#include "WIFI/MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL.h"
 #include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD.h"
+#include "NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP.h"
+#include "FLASH_LOG/MCAL_ESP32_S2_SOLO_2_N4R2_FLASH_LOG.h"
+#include "LZ/MCAL_ESP32_S2_SOLO_2_N4R2_LZ.h"
 #include "UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART.h"
+#include "UART/MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME.h"
+#include "CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
 
 #endif /* MCAL_MCU_CONFIG_H_ */
@@ -8,116 +8,718 @@
  Testing Date   : 
 *********************************************************************************************************************************/
 #include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+
+// One slot per namespace: handles[NVS_READONLY] and handles[NVS_READWRITE]
+typedef struct {
+    tsbyte name_space[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handles[2];
+    bool open[2];
+} t_nvs_pool_entry;
+
+static t_nvs_pool_entry nvs_pool[NVS_HANDLE_POOL_SIZE];
+static portMUX_TYPE nvs_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static size_t nvs_compression_threshold;
+static t_nvs_compression_stats nvs_compression_stats;
+static portMUX_TYPE nvs_compression_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Find the slot of a namespace, or a free one when create is set. Called with nvs_pool_lock held.
+static t_nvs_pool_entry *nvs_pool_find(const tsbyte *name_space, bool create) {
+    t_nvs_pool_entry *free_entry = NULL;
+    for (int i = 0; i < NVS_HANDLE_POOL_SIZE; i++) {
+        t_nvs_pool_entry *entry = &nvs_pool[i];
+        if (!entry->open[NVS_READONLY] && !entry->open[NVS_READWRITE]) {
+            if (free_entry == NULL) {
+                free_entry = entry;
+            }
+        } else if (strncmp(entry->name_space, name_space, NVS_KEY_NAME_MAX_SIZE) == 0) {
+            return entry;
+        }
+    }
+    if (create && free_entry != NULL) {
+        strncpy(free_entry->name_space, name_space, NVS_KEY_NAME_MAX_SIZE - 1);
+        free_entry->name_space[NVS_KEY_NAME_MAX_SIZE - 1] = '\0';
+    }
+    return create ? free_entry : NULL;
+}
+
+esp_err_t NVS_Get_Handle(const tsbyte *name_space, nvs_open_mode_t mode, nvs_handle_t *handle) {
+    if (name_space == NULL || handle == NULL || strlen(name_space) >= NVS_KEY_NAME_MAX_SIZE ||
+        (mode != NVS_READONLY && mode != NVS_READWRITE)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Fast path: already open
+    portENTER_CRITICAL(&nvs_pool_lock);
+    t_nvs_pool_entry *entry = nvs_pool_find(name_space, false);
+    bool cached = entry != NULL && entry->open[mode];
+    if (cached) {
+        *handle = entry->handles[mode];
+    }
+    portEXIT_CRITICAL(&nvs_pool_lock);
+    if (cached) {
+        return ESP_OK;
+    }
+
+    // nvs_open() may touch flash, so it runs outside the critical section; a task that loses the race closes its copy
+    nvs_handle_t opened;
+    esp_err_t err = nvs_open(name_space, mode, &opened);
+    if (err != ESP_OK) {
+        return err;
+    }
+    portENTER_CRITICAL(&nvs_pool_lock);
+    entry = nvs_pool_find(name_space, true);
+    bool duplicate = entry != NULL && entry->open[mode];
+    if (entry != NULL && !duplicate) {
+        entry->handles[mode] = opened;
+        entry->open[mode] = true;
+    }
+    if (entry != NULL) {
+        *handle = entry->handles[mode];
+    }
+    portEXIT_CRITICAL(&nvs_pool_lock);
+    if (entry == NULL || duplicate) {
+        nvs_close(opened);
+    }
+    return entry != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void NVS_Close_Handles(void) {
+    nvs_handle_t handles[NVS_HANDLE_POOL_SIZE * 2];
+    int count = 0;
+
+    portENTER_CRITICAL(&nvs_pool_lock);
+    for (int i = 0; i < NVS_HANDLE_POOL_SIZE; i++) {
+        for (int mode = NVS_READONLY; mode <= NVS_READWRITE; mode++) {
+            if (nvs_pool[i].open[mode]) {
+                handles[count++] = nvs_pool[i].handles[mode];
+                nvs_pool[i].open[mode] = false;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&nvs_pool_lock);
+    for (int i = 0; i < count; i++) {
+        nvs_close(handles[i]);
+    }
+}
+
+void NVS_Compression_Set(size_t threshold) {
+    portENTER_CRITICAL(&nvs_compression_lock);
+    nvs_compression_threshold = threshold;
+    portEXIT_CRITICAL(&nvs_compression_lock);
+}
+
+void NVS_Compression_Get_Stats(t_nvs_compression_stats *stats) {
+    portENTER_CRITICAL(&nvs_compression_lock);
+    *stats = nvs_compression_stats;
+    portEXIT_CRITICAL(&nvs_compression_lock);
+}
+
+void NVS_Compression_Reset_Stats(void) {
+    portENTER_CRITICAL(&nvs_compression_lock);
+    memset(&nvs_compression_stats, 0, sizeof(nvs_compression_stats));
+    portEXIT_CRITICAL(&nvs_compression_lock);
+}
+
+// Compresses data behind a header. Returns the packed length, or 0 (buffer freed) when raw storage is as small.
+static size_t nvs_pack(nvs_type_t type, const void *data, size_t length, tbyte **packed) {
+    // Only worth storing packed when it comes out at least one byte smaller than the raw value
+    size_t capacity = length - 1;
+    *packed = malloc(capacity);
+    if (*packed == NULL) {
+        return 0;
+    }
+    size_t compressed = LZ_Compress(data, length, *packed + sizeof(t_nvs_packed_header),
+                                    capacity - sizeof(t_nvs_packed_header), NULL);
+    if (compressed == 0) {
+        free(*packed);
+        *packed = NULL;
+        return 0;
+    }
+    t_nvs_packed_header header = {
+        .magic = NVS_PACKED_MAGIC,
+        .type = (tbyte)type,
+        .length = (tlong)length,
+        .crc = CRC32_Update(CRC32_INIT, data, length),
+    };
+    memcpy(*packed, &header, sizeof(header));
+    return sizeof(header) + compressed;
+}
+
+// Unpacks a stored blob into out if it carries a packed header of the wanted type.
+// Returns ESP_ERR_NOT_FOUND for a plain blob, ESP_ERR_NVS_INVALID_LENGTH if out is too small.
+static esp_err_t nvs_unpack(nvs_type_t type, const tbyte *stored, size_t stored_length, void *out, size_t *length) {
+    t_nvs_packed_header header;
+    if (stored_length <= sizeof(header)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memcpy(&header, stored, sizeof(header));
+    if (header.magic != NVS_PACKED_MAGIC || header.type != type || header.reserved != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (header.length > *length) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    size_t unpacked = LZ_Decompress(stored + sizeof(header), stored_length - sizeof(header), out, header.length);
+    esp_err_t err = ESP_OK;
+    if (unpacked != header.length || CRC32_Update(CRC32_INIT, out, unpacked) != header.crc) {
+        err = ESP_ERR_NOT_FOUND;     // Not ours after all (or corrupt): the caller falls back to the raw bytes
+    } else {
+        *length = unpacked;
+    }
+    portENTER_CRITICAL(&nvs_compression_lock);
+    nvs_compression_stats.unpacked_reads += err == ESP_OK ? 1 : 0;
+    nvs_compression_stats.unpack_errors += err == ESP_OK ? 0 : 1;
+    portEXIT_CRITICAL(&nvs_compression_lock);
+    return err;
+}
+
+static bool nvs_has_form(nvs_handle_t handle, const tsbyte *key, bool packed) {
+    size_t existing;
+    return packed ? nvs_get_blob(handle, key, NULL, &existing) == ESP_OK
+                  : nvs_get_str(handle, key, NULL, &existing) == ESP_OK;
+}
+
+// Erases the form of a string that was not just written. nvs_erase_key() takes the first entry of any type, so if it
+// took the new form, that is written again; either way one of the two values stays on flash at every step.
+static esp_err_t nvs_drop_stale_form(nvs_handle_t handle, const tsbyte *key, bool packed, const void *stored,
+                                     size_t stored_length) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        if (!nvs_has_form(handle, key, !packed)) {
+            return ESP_OK;
+        }
+        esp_err_t err = nvs_erase_key(handle, key);
+        if (err == ESP_OK && !nvs_has_form(handle, key, packed)) {
+            err = packed ? nvs_set_blob(handle, key, stored, stored_length) : nvs_set_str(handle, key, stored);
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return nvs_has_form(handle, key, !packed) ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t NVS_Set_Packed(nvs_handle_t handle, const tsbyte *key, nvs_type_t type, const void *data, size_t length) {
+    portENTER_CRITICAL(&nvs_compression_lock);
+    size_t threshold = nvs_compression_threshold;
+    portEXIT_CRITICAL(&nvs_compression_lock);
+
+    tbyte *packed = NULL;
+    size_t packed_length = 0;
+    if (threshold > 0 && length >= threshold && length > sizeof(t_nvs_packed_header) + 1 && length <= LZ_MAX_INPUT) {
+        packed_length = nvs_pack(type, data, length, &packed);
+        portENTER_CRITICAL(&nvs_compression_lock);
+        if (packed_length > 0) {
+            nvs_compression_stats.packed_writes++;
+            nvs_compression_stats.bytes_in += length;
+            nvs_compression_stats.bytes_stored += packed_length;
+        } else {
+            nvs_compression_stats.raw_writes++;
+        }
+        portEXIT_CRITICAL(&nvs_compression_lock);
+    }
+
+    esp_err_t err;
+    if (packed_length > 0) {
+        err = nvs_set_blob(handle, key, packed, packed_length);
+    } else if (type == NVS_TYPE_STR) {
+        err = nvs_set_str(handle, key, data);
+    } else {
+        err = nvs_set_blob(handle, key, data, length);
+    }
+    if (err == ESP_OK && type == NVS_TYPE_STR) {
+        // A string is kept either as a string entry or as a packed blob. The new form is on flash first, so a reset
+        // from here on leaves the key readable; only then is the other form dropped.
+        err = nvs_drop_stale_form(handle, key, packed_length > 0, packed_length > 0 ? packed : data,
+                                  packed_length > 0 ? packed_length : length);
+    }
+    free(packed);
+    return err;
+}
+
+esp_err_t NVS_Get_Packed(nvs_handle_t handle, const tsbyte *key, nvs_type_t type, void *out, size_t *length) {
+    size_t capacity = *length;
+    esp_err_t err;
+    if (type == NVS_TYPE_BLOB) {
+        tword magic = 0;
+        err = nvs_get_blob(handle, key, out, length);
+        if (err == ESP_OK && *length > sizeof(t_nvs_packed_header)) {
+            memcpy(&magic, out, sizeof(magic));
+        }
+        // A packed blob is smaller than its value, so if it was ours it fit in out
+        if (magic == NVS_PACKED_MAGIC) {
+            size_t stored_length = *length;
+            tbyte *stored = malloc(stored_length);
+            if (stored == NULL) {
+                return ESP_ERR_NO_MEM;
+            }
+            memcpy(stored, out, stored_length);
+            *length = capacity;
+            err = nvs_unpack(type, stored, stored_length, out, length);
+            if (err == ESP_ERR_NOT_FOUND) {
+                memcpy(out, stored, stored_length);     // A raw blob that merely starts like a header
+                *length = stored_length;
+                err = ESP_OK;
+            } else if (err != ESP_OK) {
+                memset(out, 0, capacity);
+            }
+            free(stored);
+        }
+        return err;
+    }
+
+    // Both forms exist only when a reset cut NVS_Set_Packed() short; the packed one wins. If it is the new value
+    // the string is stale, and if it is the old one the rewrite never completed, so the old value is the right answer.
+    size_t stored_length = 0;
+    if (nvs_get_blob(handle, key, NULL, &stored_length) == ESP_OK) {
+        tbyte *stored = malloc(stored_length);
+        if (stored == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        err = nvs_get_blob(handle, key, stored, &stored_length);
+        if (err == ESP_OK) {
+            *length = capacity;
+            err = nvs_unpack(type, stored, stored_length, out, length);
+        }
+        free(stored);
+        if (err != ESP_ERR_NOT_FOUND) {
+            return err;
+        }
+        *length = capacity;     // A plain blob under this key is not a string
+    }
+    return nvs_get_str(handle, key, out, length);
+}
+
+esp_err_t NVS_Erase_Packed(nvs_handle_t handle, const tsbyte *key) {
+    esp_err_t err = nvs_erase_key(handle, key);
+    // Entries of other types left behind under the same key (see NVS_Set_Packed())
+    while (err == ESP_OK && nvs_erase_key(handle, key) == ESP_OK) {
+    }
+    return err;
+}
+
 // Initialize NVS
 void NVS_Init(void) {
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        NVS_Close_Handles();
+        NVS_Cache_Clear();
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
 }
 
-// Write an integer to NVS
-void NVS_Write_Int(const tsbyte *key, tsword value) {
+// Write an integer to a namespace
+esp_err_t NVS_NS_Write_Int(const tsbyte *name_space, const tsbyte *key, tsword value) {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READWRITE, &nvs_handle);
     if (err == ESP_OK) {
         err = nvs_set_i32(nvs_handle, key, value);
         if (err == ESP_OK) {
             nvs_commit(nvs_handle);
         }
-        nvs_close(nvs_handle);
+        if (err == ESP_OK) {
+            NVS_Cache_Update(name_space, key, NVS_TYPE_I32, &value, sizeof(value));
+        } else {
+            NVS_Cache_Invalidate(name_space, key);
+        }
     }
-    ESP_ERROR_CHECK(err);
+    return err;
 }
 
-// Read an integer from NVS
-void NVS_Read_Int(const tsbyte *key, tsword *out_value) {
+// Read an integer from a namespace
+esp_err_t NVS_NS_Read_Int(const tsbyte *name_space, const tsbyte *key, tsword *out_value) {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    size_t length = sizeof(*out_value);
+    tlong generation;
+    t_nvs_cache_result cached = NVS_Cache_Lookup(name_space, key, NVS_TYPE_I32, out_value, &length, &generation);
+    if (cached != NVS_CACHE_MISS) {
+        if (cached == NVS_CACHE_HIT_ABSENT) {
+            *out_value = 0; // Default value
+        }
+        return cached == NVS_CACHE_HIT ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+    }
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READONLY, &nvs_handle);
     if (err == ESP_OK) {
         err = nvs_get_i32(nvs_handle, key, out_value);
         if (err == ESP_ERR_NVS_NOT_FOUND) {
             *out_value = 0; // Default value
         }
-        nvs_close(nvs_handle);
     } else {
         *out_value = 0; // Default value
     }
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+        NVS_Cache_Store(name_space, key, NVS_TYPE_I32, err == ESP_OK ? out_value : NULL, sizeof(*out_value), generation);
+    }
+    return err;
 }
 
-
-// Write an array to NVS
-void NVS_Write_Array(const tsbyte *key, tsword *data, size_t length) {
+// Write an array to a namespace
+esp_err_t NVS_NS_Write_Array(const tsbyte *name_space, const tsbyte *key, const tsword *data, size_t length) {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READWRITE, &nvs_handle);
     if (err == ESP_OK) {
-        err = nvs_set_blob(nvs_handle, key, data, length * sizeof(tsword));
+        err = NVS_Set_Packed(nvs_handle, key, NVS_TYPE_BLOB, data, length * sizeof(tsword));
         if (err == ESP_OK) {
             nvs_commit(nvs_handle);
         }
-        nvs_close(nvs_handle);
+        if (err == ESP_OK) {
+            NVS_Cache_Update(name_space, key, NVS_TYPE_BLOB, data, length * sizeof(tsword));
+        } else {
+            NVS_Cache_Invalidate(name_space, key);
+        }
     }
-    ESP_ERROR_CHECK(err);
+    return err;
 }
 
-// Read an array from NVS
-void NVS_Read_Array(const tsbyte *key, tsword *data, size_t length) {
+// Read an array from a namespace
+esp_err_t NVS_NS_Read_Array(const tsbyte *name_space, const tsbyte *key, tsword *data, size_t length) {
     nvs_handle_t nvs_handle;
     size_t required_size = length * sizeof(tsword);
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    tlong generation;
+    t_nvs_cache_result cached = NVS_Cache_Lookup(name_space, key, NVS_TYPE_BLOB, data, &required_size, &generation);
+    if (cached != NVS_CACHE_MISS) {
+        if (cached == NVS_CACHE_HIT_ABSENT) {
+            memset(data, 0, required_size); // Default to zero if not found
+        }
+        return cached == NVS_CACHE_HIT ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+    }
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READONLY, &nvs_handle);
     if (err == ESP_OK) {
-        err = nvs_get_blob(nvs_handle, key, data, &required_size);
+        err = NVS_Get_Packed(nvs_handle, key, NVS_TYPE_BLOB, data, &required_size);
         if (err == ESP_ERR_NVS_NOT_FOUND) {
             memset(data, 0, required_size); // Default to zero if not found
         }
-        nvs_close(nvs_handle);
     } else {
         memset(data, 0, required_size); // Default to zero if error
     }
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+        NVS_Cache_Store(name_space, key, NVS_TYPE_BLOB, err == ESP_OK ? data : NULL, required_size, generation);
+    }
+    return err;
 }
 
-
-// Write a string to NVS
-void NVS_Write_String(const tsbyte *key, const tsbyte *value) {
+// Write a string to a namespace
+esp_err_t NVS_NS_Write_String(const tsbyte *name_space, const tsbyte *key, const tsbyte *value) {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READWRITE, &nvs_handle);
     if (err == ESP_OK) {
-        err = nvs_set_str(nvs_handle, key, value);
+        err = NVS_Set_Packed(nvs_handle, key, NVS_TYPE_STR, value, strlen(value) + 1);
         if (err == ESP_OK) {
             nvs_commit(nvs_handle);
         }
-        nvs_close(nvs_handle);
+        if (err == ESP_OK) {
+            NVS_Cache_Update(name_space, key, NVS_TYPE_STR, value, strlen(value) + 1);
+        } else {
+            NVS_Cache_Invalidate(name_space, key);
+        }
     }
-    ESP_ERROR_CHECK(err);
+    return err;
 }
 
-// Read a string from NVS
-void NVS_Read_String(const tsbyte *key, tsbyte *out_value, size_t max_length) {
+// Read a string from a namespace
+esp_err_t NVS_NS_Read_String(const tsbyte *name_space, const tsbyte *key, tsbyte *out_value, size_t max_length) {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    size_t length = max_length;
+    tlong generation;
+    t_nvs_cache_result cached = NVS_Cache_Lookup(name_space, key, NVS_TYPE_STR, out_value, &length, &generation);
+    if (cached != NVS_CACHE_MISS) {
+        if (cached == NVS_CACHE_HIT_ABSENT) {
+            strcpy(out_value, ""); // Default to empty string if not found
+        }
+        return cached == NVS_CACHE_HIT ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+    }
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READONLY, &nvs_handle);
     if (err == ESP_OK) {
-        err = nvs_get_str(nvs_handle, key, out_value, &max_length);
+        err = NVS_Get_Packed(nvs_handle, key, NVS_TYPE_STR, out_value, &max_length);
         if (err == ESP_ERR_NVS_NOT_FOUND) {
             strcpy(out_value, ""); // Default to empty string if not found
         }
-        nvs_close(nvs_handle);
     } else {
         strcpy(out_value, ""); // Default to empty string if error
     }
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+        NVS_Cache_Store(name_space, key, NVS_TYPE_STR, err == ESP_OK ? out_value : NULL, max_length, generation);
+    }
+    return err;
 }
 
-void NVS_Erase_Key(const tsbyte *key) {
+esp_err_t NVS_NS_Erase_Key(const tsbyte *name_space, const tsbyte *key) {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READWRITE, &nvs_handle);
     if (err == ESP_OK) {
-        err = nvs_erase_key(nvs_handle, key);
+        err = NVS_Erase_Packed(nvs_handle, key);
         if (err == ESP_OK) {
             nvs_commit(nvs_handle);
         }
-        nvs_close(nvs_handle);
+        if (err == ESP_OK) {
+            NVS_Cache_Update(name_space, key, NVS_TYPE_ANY, NULL, 0);
+        } else {
+            NVS_Cache_Invalidate(name_space, key);
+        }
     }
-    ESP_ERROR_CHECK(err);
+    return err;
+}
+
+/*==============================================================================================================================*/
+/* Default namespace (NVS_NAMESPACE) */
+
+void NVS_Write_Int(const tsbyte *key, tsword value) {
+    ESP_ERROR_CHECK(NVS_NS_Write_Int(NVS_NAMESPACE, key, value));
+}
+
+void NVS_Read_Int(const tsbyte *key, tsword *out_value) {
+    NVS_NS_Read_Int(NVS_NAMESPACE, key, out_value);
+}
+
+void NVS_Write_Array(const tsbyte *key, tsword *data, size_t length) {
+    ESP_ERROR_CHECK(NVS_NS_Write_Array(NVS_NAMESPACE, key, data, length));
 }
 
+void NVS_Read_Array(const tsbyte *key, tsword *data, size_t length) {
+    NVS_NS_Read_Array(NVS_NAMESPACE, key, data, length);
+}
+
+void NVS_Write_String(const tsbyte *key, const tsbyte *value) {
+    ESP_ERROR_CHECK(NVS_NS_Write_String(NVS_NAMESPACE, key, value));
+}
+
+void NVS_Read_String(const tsbyte *key, tsbyte *out_value, size_t max_length) {
+    NVS_NS_Read_String(NVS_NAMESPACE, key, out_value, max_length);
+}
+
+void NVS_Erase_Key(const tsbyte *key) {
+    ESP_ERROR_CHECK(NVS_NS_Erase_Key(NVS_NAMESPACE, key));
+}
+
+/*==============================================================================================================================*/
+/* Whole-namespace operations */
+
+esp_err_t NVS_NS_Iterate(const tsbyte *name_space, nvs_type_t type, t_nvs_ns_visitor visitor, void *arg) {
+    if (name_space == NULL || visitor == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_entry_info_t info;
+    nvs_iterator_t it = nvs_entry_find(NVS_DEFAULT_PART_NAME, name_space, type);
+    while (it != NULL) {
+        nvs_entry_info(it, &info);
+        if (!visitor(&info, arg)) {
+            break;
+        }
+        it = nvs_entry_next(it);
+    }
+    nvs_release_iterator(it);
+    return ESP_OK;
+}
+
+esp_err_t NVS_NS_Erase_All(const tsbyte *name_space) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_erase_all(nvs_handle);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        NVS_Cache_Invalidate_Namespace(name_space);
+    }
+    return err;
+}
+
+static void put_le32(tbyte *out, tlong value) {
+    out[0] = (tbyte)value;
+    out[1] = (tbyte)(value >> 8);
+    out[2] = (tbyte)(value >> 16);
+    out[3] = (tbyte)(value >> 24);
+}
+
+static tlong get_le32(const tbyte *in) {
+    return (tlong)in[0] | ((tlong)in[1] << 8) | ((tlong)in[2] << 16) | ((tlong)in[3] << 24);
+}
+
+// Integer entries travel as their native (little-endian) bytes; the low nibble of the type is the size
+static esp_err_t nvs_get_integer(nvs_handle_t handle, const tsbyte *key, nvs_type_t type, tbyte *out) {
+    switch (type) {
+        case NVS_TYPE_U8:  return nvs_get_u8(handle, key, (uint8_t *)out);
+        case NVS_TYPE_I8:  return nvs_get_i8(handle, key, (int8_t *)out);
+        case NVS_TYPE_U16: return nvs_get_u16(handle, key, (uint16_t *)out);
+        case NVS_TYPE_I16: return nvs_get_i16(handle, key, (int16_t *)out);
+        case NVS_TYPE_U32: return nvs_get_u32(handle, key, (uint32_t *)out);
+        case NVS_TYPE_I32: return nvs_get_i32(handle, key, (int32_t *)out);
+        case NVS_TYPE_U64: return nvs_get_u64(handle, key, (uint64_t *)out);
+        case NVS_TYPE_I64: return nvs_get_i64(handle, key, (int64_t *)out);
+        default:           return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+}
+
+static esp_err_t nvs_set_integer(nvs_handle_t handle, const tsbyte *key, nvs_type_t type, const tbyte *in) {
+    union {
+        uint8_t u8;
+        uint16_t u16;
+        uint32_t u32;
+        uint64_t u64;
+    } value;
+    memcpy(&value, in, type & 0x0F);
+    switch (type) {
+        case NVS_TYPE_U8:  return nvs_set_u8(handle, key, value.u8);
+        case NVS_TYPE_I8:  return nvs_set_i8(handle, key, (int8_t)value.u8);
+        case NVS_TYPE_U16: return nvs_set_u16(handle, key, value.u16);
+        case NVS_TYPE_I16: return nvs_set_i16(handle, key, (int16_t)value.u16);
+        case NVS_TYPE_U32: return nvs_set_u32(handle, key, value.u32);
+        case NVS_TYPE_I32: return nvs_set_i32(handle, key, (int32_t)value.u32);
+        case NVS_TYPE_U64: return nvs_set_u64(handle, key, value.u64);
+        case NVS_TYPE_I64: return nvs_set_i64(handle, key, (int64_t)value.u64);
+        default:           return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+}
+
+static bool nvs_type_is_integer(nvs_type_t type) {
+    size_t size = type & 0x0F;
+    return (type & 0xE0) == 0 && (size == 1 || size == 2 || size == 4 || size == 8);
+}
+
+esp_err_t NVS_NS_Export(const tsbyte *name_space, tbyte *buffer, size_t capacity, size_t *length) {
+    if (name_space == NULL || length == NULL || (buffer == NULL && capacity > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t nvs_handle;
+    esp_err_t err = NVS_Get_Handle(name_space, NVS_READONLY, &nvs_handle);
+    bool empty = err == ESP_ERR_NVS_NOT_FOUND;      // Namespace never written: export zero entries
+    if (err != ESP_OK && !empty) {
+        return err;
+    }
+
+    size_t used = NVS_SNAPSHOT_HEADER_SIZE;
+    tword count = 0;
+    bool fits = capacity >= used;
+    nvs_entry_info_t info;
+    nvs_iterator_t it = empty ? NULL : nvs_entry_find(NVS_DEFAULT_PART_NAME, name_space, NVS_TYPE_ANY);
+    err = ESP_OK;
+    while (it != NULL && err == ESP_OK) {
+        nvs_entry_info(it, &info);
+        size_t key_length = strlen(info.key);
+        size_t value_length = info.type & 0x0F;
+        if (info.type == NVS_TYPE_STR) {
+            err = nvs_get_str(nvs_handle, info.key, NULL, &value_length);
+        } else if (info.type == NVS_TYPE_BLOB) {
+            err = nvs_get_blob(nvs_handle, info.key, NULL, &value_length);
+        } else if (!nvs_type_is_integer(info.type)) {
+            err = ESP_ERR_NVS_TYPE_MISMATCH;
+        }
+        size_t entry_length = NVS_SNAPSHOT_ENTRY_SIZE + key_length + value_length;
+        if (err == ESP_OK && count == 0xFFFF) {
+            err = ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        fits = fits && capacity - used >= entry_length;
+        if (err == ESP_OK && fits) {
+            tbyte *entry = buffer + used;
+            entry[0] = (tbyte)info.type;
+            entry[1] = (tbyte)key_length;
+            put_le32(entry + 2, (tlong)value_length);
+            memcpy(entry + NVS_SNAPSHOT_ENTRY_SIZE, info.key, key_length);
+            tbyte *value = entry + NVS_SNAPSHOT_ENTRY_SIZE + key_length;
+            // Strings and blobs are copied as stored, so packed values stay packed
+            if (info.type == NVS_TYPE_STR) {
+                err = nvs_get_str(nvs_handle, info.key, (tsbyte *)value, &value_length);
+            } else if (info.type == NVS_TYPE_BLOB) {
+                err = nvs_get_blob(nvs_handle, info.key, value, &value_length);
+            } else {
+                err = nvs_get_integer(nvs_handle, info.key, info.type, value);
+            }
+        }
+        used += entry_length;
+        count++;
+        it = nvs_entry_next(it);
+    }
+    nvs_release_iterator(it);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    *length = used;
+    if (!fits) {
+        return buffer == NULL ? ESP_OK : ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    put_le32(buffer, NVS_SNAPSHOT_MAGIC);
+    buffer[4] = NVS_SNAPSHOT_VERSION;
+    buffer[5] = 0;
+    buffer[6] = (tbyte)count;
+    buffer[7] = (tbyte)(count >> 8);
+    put_le32(buffer + 8, (tlong)(used - NVS_SNAPSHOT_HEADER_SIZE));
+    put_le32(buffer + 12, CRC32_Update(CRC32_INIT, buffer + NVS_SNAPSHOT_HEADER_SIZE, used - NVS_SNAPSHOT_HEADER_SIZE));
+    return ESP_OK;
+}
+
+// Walks the entries of a snapshot; with handle NULL it only validates them
+static esp_err_t nvs_snapshot_apply(const tbyte *buffer, size_t length, const nvs_handle_t *handle, const tsbyte *name_space) {
+    tword count = buffer[6] | (buffer[7] << 8);
+    size_t used = NVS_SNAPSHOT_HEADER_SIZE;
+    esp_err_t err = ESP_OK;
+    for (tword i = 0; i < count && err == ESP_OK; i++) {
+        if (length - used < NVS_SNAPSHOT_ENTRY_SIZE) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        const tbyte *entry = buffer + used;
+        nvs_type_t type = (nvs_type_t)entry[0];
+        size_t key_length = entry[1];
+        size_t value_length = get_le32(entry + 2);
+        if (key_length == 0 || key_length >= NVS_KEY_NAME_MAX_SIZE ||
+            length - used - NVS_SNAPSHOT_ENTRY_SIZE < key_length ||
+            length - used - NVS_SNAPSHOT_ENTRY_SIZE - key_length < value_length) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        const tbyte *value = entry + NVS_SNAPSHOT_ENTRY_SIZE + key_length;
+        bool valid = type == NVS_TYPE_BLOB ||
+                     (type == NVS_TYPE_STR && value_length > 0 && memchr(value, '\0', value_length) == value + value_length - 1) ||
+                     (nvs_type_is_integer(type) && value_length == (size_t)(type & 0x0F));
+        if (!valid) {
+            return ESP_ERR_NVS_TYPE_MISMATCH;
+        }
+        if (handle != NULL) {
+            tsbyte key[NVS_KEY_NAME_MAX_SIZE];
+            memcpy(key, entry + NVS_SNAPSHOT_ENTRY_SIZE, key_length);
+            key[key_length] = '\0';
+            NVS_Erase_Packed(*handle, key);     // The key may exist with another type
+            if (type == NVS_TYPE_STR) {
+                err = nvs_set_str(*handle, key, (const tsbyte *)value);
+            } else if (type == NVS_TYPE_BLOB) {
+                err = nvs_set_blob(*handle, key, value, value_length);
+            } else {
+                err = nvs_set_integer(*handle, key, type, value);
+            }
+            NVS_Cache_Invalidate(name_space, key);
+        }
+        used += NVS_SNAPSHOT_ENTRY_SIZE + key_length + value_length;
+    }
+    return err;
+}
+
+esp_err_t NVS_NS_Import(const tsbyte *name_space, const tbyte *buffer, size_t length, bool replace) {
+    if (name_space == NULL || buffer == NULL || length < NVS_SNAPSHOT_HEADER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t payload = get_le32(buffer + 8);
+    if (get_le32(buffer) != NVS_SNAPSHOT_MAGIC || buffer[4] != NVS_SNAPSHOT_VERSION ||
+        payload != length - NVS_SNAPSHOT_HEADER_SIZE ||
+        CRC32_Update(CRC32_INIT, buffer + NVS_SNAPSHOT_HEADER_SIZE, payload) != get_le32(buffer + 12)) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    // Nothing is written unless the whole snapshot is well formed
+    esp_err_t err = nvs_snapshot_apply(buffer, length, NULL, name_space);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    nvs_handle_t nvs_handle;
+    err = NVS_Get_Handle(name_space, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK && replace) {
+        err = nvs_erase_all(nvs_handle);
+        NVS_Cache_Invalidate_Namespace(name_space);
+    }
+    if (err == ESP_OK) {
+        err = nvs_snapshot_apply(buffer, length, &nvs_handle, name_space);
+        esp_err_t commit_err = nvs_commit(nvs_handle);
+        err = err == ESP_OK ? commit_err : err;
+    }
+    return err;
+}
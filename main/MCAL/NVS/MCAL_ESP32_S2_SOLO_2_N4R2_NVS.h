@@ -15,10 +15,64 @@
 #include "../ESP32_S2_SOLO_2_N4R2_Main.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE.h"
+#include "../LZ/MCAL_ESP32_S2_SOLO_2_N4R2_LZ.h"
+#include "../CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
 
 #define NVS_NAMESPACE "storage"
+#define NVS_HANDLE_POOL_SIZE 8 // Namespaces that can hold cached handles at the same time (each NVS group uses two)
+
+/*
+ * Optional compression of large blobs and strings. A compressed value is stored as a blob that
+ * starts with t_nvs_packed_header followed by the LZ block; strings lose their string type on
+ * flash but not to the reader. Reads recognise the header and unpack, so values written with
+ * compression on stay readable after it is turned off and the other way round.
+ */
+#define NVS_PACKED_MAGIC 0x5A4Cu // "LZ"
+
+typedef struct {
+    tword magic;            // NVS_PACKED_MAGIC
+    tbyte type;             // NVS_TYPE_BLOB or NVS_TYPE_STR: what the reader gets back
+    tbyte reserved;
+    tlong length;           // Unpacked length (strings include the terminator)
+    tlong crc;              // CRC-32 of the unpacked bytes
+} t_nvs_packed_header;
+
+typedef struct {
+    tlong packed_writes;    // Values stored compressed
+    tlong raw_writes;       // Values above the threshold stored raw because they did not shrink
+    tlong bytes_in;         // Unpacked bytes of packed_writes
+    tlong bytes_stored;     // Stored bytes of packed_writes, headers included
+    tlong unpacked_reads;
+    tlong unpack_errors;    // Packed values that failed to decompress or did not match their CRC
+} t_nvs_compression_stats;
+
+/*
+ * Namespace snapshot (NVS_NS_Export / NVS_NS_Import), all fields little-endian:
+ *
+ *   header: magic (4) | version (1) | reserved (1) | entry count (2) | payload length (4) | CRC-32 of payload (4)
+ *   entry:  nvs_type_t (1) | key length (1) | value length (4) | key (no terminator) | value
+ *
+ * Integers are stored in their own width, strings with their terminator, and blobs as found in
+ * flash (a compressed value stays compressed).
+ */
+#define NVS_SNAPSHOT_MAGIC          0x5353564Eu // "NVSS"
+#define NVS_SNAPSHOT_VERSION        1
+#define NVS_SNAPSHOT_HEADER_SIZE    16
+#define NVS_SNAPSHOT_ENTRY_SIZE     6
+
+/**
+* @brief Called by NVS_NS_Iterate() for each entry. Return false to stop.
+*/
+typedef bool (*t_nvs_ns_visitor)(const nvs_entry_info_t *entry, void *arg);
 
 void NVS_Init(void);
+
+/*
+ * The default namespace (NVS_NAMESPACE). Missing keys read as 0 / zero-filled / "" and a failed
+ * write aborts through ESP_ERROR_CHECK, as before.
+ */
 void NVS_Write_Int(const tsbyte *key, tsword value);
 void NVS_Read_Int(const tsbyte *key, tsword *out_value);
 void NVS_Write_Array(const tsbyte *key, tsword *data, size_t length);
@@ -27,4 +81,112 @@ void NVS_Write_String(const tsbyte *key, const tsbyte *value);
 void NVS_Read_String(const tsbyte *key, tsbyte *out_value, size_t max_length);
 void NVS_Erase_Key(const tsbyte *key);
 
+/*
+ * The same operations on any namespace, so each module can keep its keys apart. They share the
+ * handle pool (NVS_HANDLE_POOL_SIZE namespaces) and the read cache. Reads fill the same
+ * defaults on a miss and return ESP_ERR_NVS_NOT_FOUND; writes return the error instead of aborting.
+ */
+esp_err_t NVS_NS_Write_Int(const tsbyte *name_space, const tsbyte *key, tsword value);
+esp_err_t NVS_NS_Read_Int(const tsbyte *name_space, const tsbyte *key, tsword *out_value);
+esp_err_t NVS_NS_Write_Array(const tsbyte *name_space, const tsbyte *key, const tsword *data, size_t length);
+esp_err_t NVS_NS_Read_Array(const tsbyte *name_space, const tsbyte *key, tsword *data, size_t length);
+esp_err_t NVS_NS_Write_String(const tsbyte *name_space, const tsbyte *key, const tsbyte *value);
+esp_err_t NVS_NS_Read_String(const tsbyte *name_space, const tsbyte *key, tsbyte *out_value, size_t max_length);
+esp_err_t NVS_NS_Erase_Key(const tsbyte *name_space, const tsbyte *key);
+
+/**
+* @brief Calls visitor for every entry of a namespace.
+*
+* @param type NVS_TYPE_ANY, or a type to list only entries of that type.
+* @return ESP_OK (also for an empty or unknown namespace) or ESP_ERR_INVALID_ARG.
+*/
+esp_err_t NVS_NS_Iterate(const tsbyte *name_space, nvs_type_t type, t_nvs_ns_visitor visitor, void *arg);
+
+/**
+* @brief Erases every key of a namespace in one NVS operation (e.g. a subsystem factory reset).
+* @return ESP_OK or an NVS error.
+*/
+esp_err_t NVS_NS_Erase_All(const tsbyte *name_space);
+
+/**
+* @brief Serializes a namespace into a snapshot (format above).
+*
+* Call with buffer NULL and capacity 0 to get the required size in *length.
+*
+* @return ESP_OK, ESP_ERR_NVS_INVALID_LENGTH (buffer too small; *length is the size needed) or an NVS error.
+*/
+esp_err_t NVS_NS_Export(const tsbyte *name_space, tbyte *buffer, size_t capacity, size_t *length);
+
+/**
+* @brief Writes a snapshot's entries into a namespace, then commits.
+*
+* The whole snapshot is checked (CRC, bounds, types) before anything is written. The writes
+* themselves are not atomic; restore into an NVS group if that matters.
+*
+* @param replace Erase the namespace first, so it ends up exactly as exported.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_CRC, ESP_ERR_NVS_INVALID_LENGTH,
+*         ESP_ERR_NVS_TYPE_MISMATCH (malformed entry) or an NVS error.
+*/
+esp_err_t NVS_NS_Import(const tsbyte *name_space, const tbyte *buffer, size_t length, bool replace);
+
+/**
+* @brief Returns the cached handle of a namespace, opening it on first use.
+*
+* Each namespace keeps one read-only and one read-write handle for the life of the
+* application, so the NVS_* functions skip the namespace lookup of nvs_open(). Safe to
+* call from several tasks; the handles themselves are thread-safe. Do not nvs_close() them.
+*
+* @param name_space Namespace name (at most 15 characters).
+* @param mode       NVS_READONLY or NVS_READWRITE.
+* @param handle     Out: the cached handle.
+* @return ESP_OK, ESP_ERR_NVS_NOT_FOUND (read-only open of a namespace that does not exist yet),
+*         ESP_ERR_NO_MEM if NVS_HANDLE_POOL_SIZE namespaces are already cached, or an nvs_open() error.
+*/
+esp_err_t NVS_Get_Handle(const tsbyte *name_space, nvs_open_mode_t mode, nvs_handle_t *handle);
+
+/**
+* @brief Closes every cached handle. Call before erasing or deinitializing the NVS partition.
+*/
+void NVS_Close_Handles(void);
+
+/**
+* @brief Enables compression of blobs and strings of at least threshold bytes, or disables it with 0 (default).
+*
+* A value is only stored compressed if that saves space once the header is added. Values
+* larger than LZ_MAX_INPUT are always stored raw.
+*/
+void NVS_Compression_Set(size_t threshold);
+
+void NVS_Compression_Get_Stats(t_nvs_compression_stats *stats);
+void NVS_Compression_Reset_Stats(void);
+
+/**
+* @brief Stores a blob or string, compressed when it qualifies. Does not commit.
+*
+* Used by every NVS_* writer. A string that changes between its plain and compressed form
+* is written in the new form before the old entry is erased, so a reset in between leaves
+* one of the two values readable.
+*
+* @param type   NVS_TYPE_BLOB or NVS_TYPE_STR.
+* @param length Bytes of data (strings include the terminator).
+* @return ESP_OK, ESP_FAIL if the old form could not be dropped, or an nvs_set_*() error.
+*/
+esp_err_t NVS_Set_Packed(nvs_handle_t handle, const tsbyte *key, nvs_type_t type, const void *data, size_t length);
+
+/**
+* @brief Reads a blob or string written by NVS_Set_Packed() (or a plain nvs_set_*()), unpacking it.
+*
+* A string held in both forms (a rewrite cut short by a reset) is read from the packed one.
+*
+* @param length In: size of out. Out: the unpacked length.
+* @return ESP_OK, ESP_ERR_NVS_NOT_FOUND, ESP_ERR_NVS_INVALID_LENGTH (out too small) or another nvs_get_*() error.
+*/
+esp_err_t NVS_Get_Packed(nvs_handle_t handle, const tsbyte *key, nvs_type_t type, void *out, size_t *length);
+
+/**
+* @brief Erases a key in every type it is stored with. Does not commit.
+* @return ESP_OK, ESP_ERR_NVS_NOT_FOUND if there was nothing to erase, or an nvs_erase_key() error.
+*/
+esp_err_t NVS_Erase_Packed(nvs_handle_t handle, const tsbyte *key);
+
 #endif /* MCAL_ESP32_S2_SOLO_2_N4R2_NVS_H_ */
@@ -0,0 +1,290 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE.C
+ Description    : RAM read-through cache for hot NVS keys (open addressing, clock eviction)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+#define NVS_CACHE_MASK      (NVS_CACHE_SLOTS - 1)
+#define NVS_CACHE_ABSENT    0xFF    // t_cache_entry.length of a key known not to exist
+
+typedef struct {
+    tlong hash;                 // 0: empty slot
+    tbyte type;                 // nvs_type_t of the value; NVS_TYPE_ANY for an erased key
+    tbyte length;               // Value bytes, or NVS_CACHE_ABSENT
+    bool referenced;            // Read since the clock hand last passed
+    tsbyte name_space[NVS_KEY_NAME_MAX_SIZE];
+    tsbyte key[NVS_KEY_NAME_MAX_SIZE];
+    tbyte value[NVS_CACHE_VALUE_MAX];
+} t_cache_entry;
+
+static t_cache_entry *cache_slots;  // NULL while the cache is disabled
+static tword cache_count;
+static tword cache_hand;
+static tlong cache_generation;      // Bumped by every write, see NVS_Cache_Store()
+static t_nvs_cache_stats cache_stats;
+static portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+
+_Static_assert((NVS_CACHE_SLOTS & NVS_CACHE_MASK) == 0, "NVS_CACHE_SLOTS must be a power of two");
+_Static_assert(NVS_CACHE_VALUE_MAX < NVS_CACHE_ABSENT, "NVS_CACHE_VALUE_MAX must fit in a byte below NVS_CACHE_ABSENT");
+
+// FNV-1a over namespace, a separator, then key. Never 0, which marks an empty slot.
+static tlong cache_hash(const tsbyte *name_space, const tsbyte *key) {
+    tlong hash = 2166136261u;
+    for (const tsbyte *p = name_space; *p != '\0'; p++) {
+        hash = (hash ^ (tbyte)*p) * 16777619u;
+    }
+    hash = (hash ^ 0xFFu) * 16777619u;
+    for (const tsbyte *p = key; *p != '\0'; p++) {
+        hash = (hash ^ (tbyte)*p) * 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+static int cache_find(tlong hash, const tsbyte *name_space, const tsbyte *key) {
+    for (tword i = hash & NVS_CACHE_MASK; cache_slots[i].hash != 0; i = (i + 1) & NVS_CACHE_MASK) {
+        const t_cache_entry *entry = &cache_slots[i];
+        if (entry->hash == hash && strncmp(entry->key, key, NVS_KEY_NAME_MAX_SIZE) == 0 &&
+            strncmp(entry->name_space, name_space, NVS_KEY_NAME_MAX_SIZE) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Backward-shift deletion: pull later entries of the probe run into the hole, so no tombstones are needed
+static void cache_remove(tword hole) {
+    tword next = hole;
+    for (;;) {
+        next = (next + 1) & NVS_CACHE_MASK;
+        if (cache_slots[next].hash == 0) {
+            break;
+        }
+        tword home = cache_slots[next].hash & NVS_CACHE_MASK;
+        if (((next - home) & NVS_CACHE_MASK) >= ((next - hole) & NVS_CACHE_MASK)) {
+            cache_slots[hole] = cache_slots[next];
+            hole = next;
+        }
+    }
+    cache_slots[hole].hash = 0;
+    cache_count--;
+}
+
+// Clock (second chance): skip and clear recently read entries, evict the first one that was not
+static void cache_evict_one(void) {
+    for (;;) {
+        tword slot = cache_hand;
+        cache_hand = (cache_hand + 1) & NVS_CACHE_MASK;
+        if (cache_slots[slot].hash == 0) {
+            continue;
+        }
+        if (cache_slots[slot].referenced) {
+            cache_slots[slot].referenced = false;
+            continue;
+        }
+        cache_remove(slot);
+        cache_stats.evictions++;
+        return;
+    }
+}
+
+// Inserts or replaces an entry. Called with cache_lock held and the cache enabled.
+static void cache_put(tlong hash, const tsbyte *name_space, const tsbyte *key, nvs_type_t type,
+                      const void *data, tbyte length) {
+    int slot = cache_find(hash, name_space, key);
+    if (slot < 0) {
+        if (cache_count >= NVS_CACHE_MAX_ENTRIES) {
+            cache_evict_one();
+        }
+        slot = hash & NVS_CACHE_MASK;
+        while (cache_slots[slot].hash != 0) {
+            slot = (slot + 1) & NVS_CACHE_MASK;
+        }
+        t_cache_entry *entry = &cache_slots[slot];
+        entry->hash = hash;
+        strncpy(entry->name_space, name_space, NVS_KEY_NAME_MAX_SIZE - 1);
+        entry->name_space[NVS_KEY_NAME_MAX_SIZE - 1] = '\0';
+        strncpy(entry->key, key, NVS_KEY_NAME_MAX_SIZE - 1);
+        entry->key[NVS_KEY_NAME_MAX_SIZE - 1] = '\0';
+        cache_count++;
+    }
+    t_cache_entry *entry = &cache_slots[slot];
+    entry->type = (tbyte)type;
+    entry->length = length;
+    entry->referenced = true;
+    if (length != NVS_CACHE_ABSENT) {
+        memcpy(entry->value, data, length);
+    }
+}
+
+static bool cache_key_valid(const tsbyte *name_space, const tsbyte *key) {
+    return name_space != NULL && key != NULL && strlen(name_space) < NVS_KEY_NAME_MAX_SIZE &&
+           strlen(key) < NVS_KEY_NAME_MAX_SIZE;
+}
+
+esp_err_t NVS_Cache_Enable(void) {
+    t_cache_entry *slots = calloc(NVS_CACHE_SLOTS, sizeof(t_cache_entry));
+    if (slots == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    portENTER_CRITICAL(&cache_lock);
+    if (cache_slots == NULL) {
+        cache_slots = slots;
+        slots = NULL;
+        cache_count = 0;
+        cache_hand = 0;
+    }
+    portEXIT_CRITICAL(&cache_lock);
+    free(slots);
+    return ESP_OK;
+}
+
+void NVS_Cache_Disable(void) {
+    portENTER_CRITICAL(&cache_lock);
+    t_cache_entry *slots = cache_slots;
+    cache_slots = NULL;
+    cache_count = 0;
+    cache_generation++;
+    portEXIT_CRITICAL(&cache_lock);
+    free(slots);
+}
+
+void NVS_Cache_Clear(void) {
+    portENTER_CRITICAL(&cache_lock);
+    if (cache_slots != NULL) {
+        memset(cache_slots, 0, NVS_CACHE_SLOTS * sizeof(t_cache_entry));
+    }
+    cache_count = 0;
+    cache_generation++;
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+void NVS_Cache_Get_Stats(t_nvs_cache_stats *stats) {
+    portENTER_CRITICAL(&cache_lock);
+    *stats = cache_stats;
+    stats->entries = cache_count;
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+void NVS_Cache_Reset_Stats(void) {
+    portENTER_CRITICAL(&cache_lock);
+    memset(&cache_stats, 0, sizeof(cache_stats));
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+t_nvs_cache_result NVS_Cache_Lookup(const tsbyte *name_space, const tsbyte *key, nvs_type_t type,
+                                    void *out, size_t *length, tlong *generation) {
+    t_nvs_cache_result result = NVS_CACHE_MISS;
+    if (!cache_key_valid(name_space, key)) {
+        return result;
+    }
+    tlong hash = cache_hash(name_space, key);
+
+    portENTER_CRITICAL(&cache_lock);
+    *generation = cache_generation;
+    if (cache_slots != NULL) {
+        int slot = cache_find(hash, name_space, key);
+        if (slot >= 0) {
+            t_cache_entry *entry = &cache_slots[slot];
+            if (entry->type == NVS_TYPE_ANY || (entry->type == type && entry->length == NVS_CACHE_ABSENT)) {
+                result = NVS_CACHE_HIT_ABSENT;
+            } else if (entry->type == type && entry->length <= *length) {
+                memcpy(out, entry->value, entry->length);
+                *length = entry->length;
+                result = NVS_CACHE_HIT;
+            }
+            if (result != NVS_CACHE_MISS) {
+                entry->referenced = true;
+            }
+        }
+        if (result == NVS_CACHE_MISS) {
+            cache_stats.misses++;
+        } else {
+            cache_stats.hits++;
+        }
+    }
+    portEXIT_CRITICAL(&cache_lock);
+    return result;
+}
+
+void NVS_Cache_Store(const tsbyte *name_space, const tsbyte *key, nvs_type_t type,
+                     const void *data, size_t length, tlong generation) {
+    if (!cache_key_valid(name_space, key) || (data != NULL && length > NVS_CACHE_VALUE_MAX)) {
+        return;
+    }
+    tlong hash = cache_hash(name_space, key);
+
+    portENTER_CRITICAL(&cache_lock);
+    if (cache_slots != NULL && generation == cache_generation) {
+        cache_put(hash, name_space, key, type, data, data != NULL ? (tbyte)length : NVS_CACHE_ABSENT);
+    }
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+void NVS_Cache_Update(const tsbyte *name_space, const tsbyte *key, nvs_type_t type, const void *data, size_t length) {
+    if (!cache_key_valid(name_space, key)) {
+        return;
+    }
+    if (data != NULL && length > NVS_CACHE_VALUE_MAX) {
+        NVS_Cache_Invalidate(name_space, key);
+        return;
+    }
+    tlong hash = cache_hash(name_space, key);
+
+    portENTER_CRITICAL(&cache_lock);
+    cache_generation++;
+    if (cache_slots != NULL) {
+        if (data != NULL) {
+            cache_put(hash, name_space, key, type, data, (tbyte)length);
+        } else {
+            cache_put(hash, name_space, key, NVS_TYPE_ANY, NULL, NVS_CACHE_ABSENT);
+        }
+    }
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+void NVS_Cache_Invalidate(const tsbyte *name_space, const tsbyte *key) {
+    if (!cache_key_valid(name_space, key)) {
+        return;
+    }
+    tlong hash = cache_hash(name_space, key);
+
+    portENTER_CRITICAL(&cache_lock);
+    cache_generation++;
+    if (cache_slots != NULL) {
+        int slot = cache_find(hash, name_space, key);
+        if (slot >= 0) {
+            cache_remove(slot);
+            cache_stats.invalidations++;
+        }
+    }
+    portEXIT_CRITICAL(&cache_lock);
+}
+
+void NVS_Cache_Invalidate_Namespace(const tsbyte *name_space) {
+    if (name_space == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&cache_lock);
+    cache_generation++;
+    if (cache_slots != NULL) {
+        tword slot = 0;
+        while (slot < NVS_CACHE_SLOTS) {
+            t_cache_entry *entry = &cache_slots[slot];
+            if (entry->hash != 0 && strncmp(entry->name_space, name_space, NVS_KEY_NAME_MAX_SIZE) == 0) {
+                cache_remove(slot);     // May shift a later entry into this slot: look at it again
+                cache_stats.invalidations++;
+            } else {
+                slot++;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&cache_lock);
+}
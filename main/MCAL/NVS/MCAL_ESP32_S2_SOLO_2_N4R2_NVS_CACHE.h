@@ -0,0 +1,107 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE.H
+ Description    : This file as Header for (NVS Read Cache)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE_H_
+
+#include "../ESP32_S2_SOLO_2_N4R2_Main.h"
+#include "nvs.h"
+#include "esp_err.h"
+
+/*
+ * Read-through cache in front of NVS_Read_*. Keys are hashed on namespace + key into an
+ * open-addressing table (linear probing) of NVS_CACHE_SLOTS slots, filled to at most three
+ * quarters; past that, a clock sweep evicts an entry that has not been read since the hand
+ * last passed it. Values longer than NVS_CACHE_VALUE_MAX bytes are never cached, and a
+ * key that is not in flash is cached as absent so missing feature flags stay cheap too.
+ *
+ * NVS_Write_*, NVS_Erase_Key and transaction flushes update the cache after the flash
+ * write succeeds. Code that writes through raw nvs_* handles must call NVS_Cache_Update()
+ * or NVS_Cache_Invalidate() itself.
+ */
+#define NVS_CACHE_SLOTS         64      // Power of two
+#define NVS_CACHE_MAX_ENTRIES   (NVS_CACHE_SLOTS * 3 / 4)
+#define NVS_CACHE_VALUE_MAX     32      // Largest cached string (with its terminator) or array, in bytes
+
+typedef enum {
+    NVS_CACHE_MISS,
+    NVS_CACHE_HIT,
+    NVS_CACHE_HIT_ABSENT        // The key is known not to exist for this type
+} t_nvs_cache_result;
+
+/**
+* @brief Cache counters.
+*/
+typedef struct {
+    tlong hits;                 // Lookups answered from RAM, including cached absences
+    tlong misses;               // Lookups that had to read flash
+    tlong evictions;            // Entries dropped to make room
+    tlong invalidations;        // Entries dropped because a write could not be cached
+    tword entries;              // Entries held now
+} t_nvs_cache_stats;
+
+/**
+* @brief Allocates the cache table and starts caching. Reads before this go to flash.
+* @return ESP_OK (also if already enabled) or ESP_ERR_NO_MEM.
+*/
+esp_err_t NVS_Cache_Enable(void);
+
+/**
+* @brief Stops caching and frees the table.
+*/
+void NVS_Cache_Disable(void);
+
+/**
+* @brief Drops every entry, e.g. after the partition was erased behind the driver's back.
+*/
+void NVS_Cache_Clear(void);
+
+void NVS_Cache_Get_Stats(t_nvs_cache_stats *stats);
+void NVS_Cache_Reset_Stats(void);
+
+/* Used by the NVS drivers ====================================================================================================*/
+
+/**
+* @brief Looks a key up.
+*
+* @param name_space Namespace of the key.
+* @param key        Key name.
+* @param type       NVS_TYPE_I32, NVS_TYPE_STR or NVS_TYPE_BLOB; an entry of another type is a miss.
+* @param out        Receives the value on a hit.
+* @param length     In: capacity of out. Out: value length on a hit. A value that does not fit is a miss.
+* @param generation Out: pass to NVS_Cache_Store() after reading flash on a miss.
+*/
+t_nvs_cache_result NVS_Cache_Lookup(const tsbyte *name_space, const tsbyte *key, nvs_type_t type,
+                                    void *out, size_t *length, tlong *generation);
+
+/**
+* @brief Caches a value just read from flash (data NULL: the key was not found).
+*
+* Ignored if any write reached the cache since the NVS_Cache_Lookup() that returned generation,
+* so a slow reader cannot put back a value that a concurrent writer already replaced.
+*/
+void NVS_Cache_Store(const tsbyte *name_space, const tsbyte *key, nvs_type_t type,
+                     const void *data, size_t length, tlong generation);
+
+/**
+* @brief Records a value just written to flash, or an erase when data is NULL.
+*/
+void NVS_Cache_Update(const tsbyte *name_space, const tsbyte *key, nvs_type_t type, const void *data, size_t length);
+
+/**
+* @brief Drops a key whose flash state is unknown, e.g. after a failed write.
+*/
+void NVS_Cache_Invalidate(const tsbyte *name_space, const tsbyte *key);
+
+/**
+* @brief Drops every key of a namespace, e.g. after nvs_erase_all() or an import.
+*/
+void NVS_Cache_Invalidate_Namespace(const tsbyte *name_space);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_NVS_CACHE_H_ */
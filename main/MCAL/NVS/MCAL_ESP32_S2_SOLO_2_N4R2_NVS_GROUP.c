@@ -0,0 +1,312 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP.C
+ Description    : All-or-nothing updates of a group of NVS keys (double-buffered banks, generation switch)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP.h"
+#include <string.h>
+
+struct t_nvs_group {
+    bool in_use;
+    bool updating;
+    tsbyte banks[2][NVS_NS_NAME_MAX_SIZE];
+    volatile tbyte active;          // Bank readers use
+    tlong generation;               // Generation of the active bank
+    t_nvs_txn *txn;                 // Open update, on bank !active
+};
+
+static struct t_nvs_group group_pool[NVS_GROUP_MAX_OPEN];
+static portMUX_TYPE group_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Generation stored in a bank; false if the bank was never committed
+static bool group_bank_generation(const t_nvs_group *group, tbyte bank, tlong *generation) {
+    nvs_handle_t handle;
+    tslong value;
+    if (NVS_Get_Handle(group->banks[bank], NVS_READONLY, &handle) != ESP_OK ||
+        nvs_get_i32(handle, NVS_GROUP_GEN_KEY, &value) != ESP_OK) {
+        return false;
+    }
+    *generation = (tlong)value;
+    return true;
+}
+
+static bool group_has_entry(nvs_handle_t handle, const tsbyte *key, nvs_type_t type) {
+    tslong value;
+    size_t length = 0;
+    switch (type) {
+        case NVS_TYPE_I32:
+            return nvs_get_i32(handle, key, &value) == ESP_OK;
+        case NVS_TYPE_STR:
+            return nvs_get_str(handle, key, NULL, &length) == ESP_OK;
+        case NVS_TYPE_BLOB:
+            return nvs_get_blob(handle, key, NULL, &length) == ESP_OK;
+        default:
+            return false;
+    }
+}
+
+// Reads a string or blob entry as stored (no unpacking) into a heap buffer
+static esp_err_t group_get_bytes(nvs_handle_t handle, const tsbyte *key, nvs_type_t type, tbyte **data, size_t *length) {
+    *data = NULL;
+    *length = 0;
+    esp_err_t err = type == NVS_TYPE_STR ? nvs_get_str(handle, key, NULL, length) : nvs_get_blob(handle, key, NULL, length);
+    if (err != ESP_OK) {
+        return err;
+    }
+    *data = malloc(*length > 0 ? *length : 1);
+    if (*data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    err = type == NVS_TYPE_STR ? nvs_get_str(handle, key, (tsbyte *)*data, length) : nvs_get_blob(handle, key, *data, length);
+    if (err != ESP_OK) {
+        free(*data);
+        *data = NULL;
+    }
+    return err;
+}
+
+// Copies one entry from src to dst unless dst already holds the same value. Sets *written if it wrote.
+static esp_err_t group_copy_entry(nvs_handle_t src, nvs_handle_t dst, const nvs_entry_info_t *info, bool *written) {
+    if (info->type == NVS_TYPE_I32) {
+        tslong value, current;
+        esp_err_t err = nvs_get_i32(src, info->key, &value);
+        if (err == ESP_OK && (nvs_get_i32(dst, info->key, &current) != ESP_OK || current != value)) {
+            err = nvs_set_i32(dst, info->key, value);
+            *written = true;
+        }
+        return err;
+    }
+    if (info->type != NVS_TYPE_STR && info->type != NVS_TYPE_BLOB) {
+        return ESP_ERR_NOT_SUPPORTED;   // The NVS_* writers only produce these three types
+    }
+
+    tbyte *value, *current;
+    size_t value_length, current_length;
+    esp_err_t err = group_get_bytes(src, info->key, info->type, &value, &value_length);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (group_get_bytes(dst, info->key, info->type, &current, &current_length) != ESP_OK ||
+        current_length != value_length || memcmp(current, value, value_length) != 0) {
+        err = info->type == NVS_TYPE_STR ? nvs_set_str(dst, info->key, (const tsbyte *)value)
+                                         : nvs_set_blob(dst, info->key, value, value_length);
+        *written = true;
+    }
+    free(value);
+    free(current);
+    return err;
+}
+
+// Makes bank 'to' a copy of bank 'from' (generation key aside). Only entries that differ are written.
+static esp_err_t group_sync_bank(const t_nvs_group *group, tbyte from, tbyte to) {
+    nvs_handle_t src, dst;
+    esp_err_t err = NVS_Get_Handle(group->banks[to], NVS_READWRITE, &dst);
+    if (err != ESP_OK) {
+        return err;
+    }
+    bool have_src = NVS_Get_Handle(group->banks[from], NVS_READONLY, &src) == ESP_OK;
+    bool written = false;
+    nvs_entry_info_t info;
+
+    // Drop what the source does not have (or has with another type)
+    nvs_iterator_t it = nvs_entry_find(NVS_DEFAULT_PART_NAME, group->banks[to], NVS_TYPE_ANY);
+    while (it != NULL && err == ESP_OK) {
+        nvs_entry_info(it, &info);
+        if (strcmp(info.key, NVS_GROUP_GEN_KEY) != 0 && (!have_src || !group_has_entry(src, info.key, info.type))) {
+            err = NVS_Erase_Packed(dst, info.key);
+            err = err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+            NVS_Cache_Invalidate(group->banks[to], info.key);
+            written = true;
+        }
+        it = nvs_entry_next(it);
+    }
+    nvs_release_iterator(it);
+
+    it = have_src ? nvs_entry_find(NVS_DEFAULT_PART_NAME, group->banks[from], NVS_TYPE_ANY) : NULL;
+    while (it != NULL && err == ESP_OK) {
+        nvs_entry_info(it, &info);
+        if (strcmp(info.key, NVS_GROUP_GEN_KEY) != 0) {
+            bool copied = false;
+            err = group_copy_entry(src, dst, &info, &copied);
+            if (copied) {
+                NVS_Cache_Invalidate(group->banks[to], info.key);
+                written = true;
+            }
+        }
+        it = nvs_entry_next(it);
+    }
+    nvs_release_iterator(it);
+
+    if (written) {
+        esp_err_t commit_err = nvs_commit(dst);
+        err = err == ESP_OK ? commit_err : err;
+    }
+    return err;
+}
+
+esp_err_t NVS_Group_Open(const tsbyte *name, t_nvs_group **group) {
+    if (name == NULL || group == NULL || name[0] == '\0' || strlen(name) > NVS_GROUP_NAME_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    t_nvs_group *slot = NULL;
+    portENTER_CRITICAL(&group_lock);
+    for (int i = 0; i < NVS_GROUP_MAX_OPEN; i++) {
+        if (!group_pool[i].in_use) {
+            slot = &group_pool[i];
+            slot->in_use = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&group_lock);
+    if (slot == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (tbyte bank = 0; bank < 2; bank++) {
+        snprintf(slot->banks[bank], sizeof(slot->banks[bank]), "%s~%u", name, (unsigned)bank);
+    }
+    // A bank without a generation was never committed (or its first commit was cut short)
+    tlong generation[2];
+    bool valid[2];
+    valid[0] = group_bank_generation(slot, 0, &generation[0]);
+    valid[1] = group_bank_generation(slot, 1, &generation[1]);
+    if (valid[0] && valid[1]) {
+        slot->active = (tslong)(generation[1] - generation[0]) > 0 ? 1 : 0;
+    } else {
+        slot->active = valid[1] ? 1 : 0;
+    }
+    slot->generation = valid[slot->active] ? generation[slot->active] : 0;
+    slot->updating = false;
+    slot->txn = NULL;
+    *group = slot;
+    return ESP_OK;
+}
+
+void NVS_Group_Close(t_nvs_group *group) {
+    if (group == NULL || !group->in_use) {
+        return;
+    }
+    if (group->updating) {
+        NVS_Group_Abort(group, group->txn);
+    }
+    group->in_use = false;
+}
+
+esp_err_t NVS_Group_Begin(t_nvs_group *group, t_nvs_txn **txn) {
+    if (group == NULL || !group->in_use || txn == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&group_lock);
+    bool busy = group->updating;
+    group->updating = true;
+    portEXIT_CRITICAL(&group_lock);
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    tbyte active = group->active;
+    esp_err_t err = group_sync_bank(group, active, (tbyte)!active);
+    if (err == ESP_OK) {
+        err = NVS_Txn_Begin(group->banks[!active], NULL, &group->txn);
+    }
+    if (err != ESP_OK) {
+        group->updating = false;
+        return err;
+    }
+    *txn = group->txn;
+    return ESP_OK;
+}
+
+esp_err_t NVS_Group_Commit(t_nvs_group *group, t_nvs_txn *txn) {
+    if (group == NULL || !group->in_use || !group->updating || txn != group->txn) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    tbyte shadow = (tbyte)!group->active;
+    tlong generation = group->generation + 1;
+    esp_err_t err = NVS_Txn_Commit(txn);
+
+    // The switch: readers move to the shadow bank once its generation is on flash
+    nvs_handle_t handle;
+    if (err == ESP_OK) {
+        err = NVS_Get_Handle(group->banks[shadow], NVS_READWRITE, &handle);
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_i32(handle, NVS_GROUP_GEN_KEY, (tslong)generation);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    if (err == ESP_OK) {
+        group->generation = generation;
+        group->active = shadow;
+    }
+    group->txn = NULL;
+    group->updating = false;
+    return err;
+}
+
+void NVS_Group_Abort(t_nvs_group *group, t_nvs_txn *txn) {
+    if (group == NULL || !group->in_use || !group->updating || txn != group->txn) {
+        return;
+    }
+    NVS_Txn_Abort(txn);
+    group->txn = NULL;
+    group->updating = false;
+}
+
+tlong NVS_Group_Get_Generation(const t_nvs_group *group) {
+    return group != NULL ? group->generation : 0;
+}
+
+// Cached read from the active bank, following NVS_Read_*
+static esp_err_t group_read(t_nvs_group *group, const tsbyte *key, nvs_type_t type, void *out, size_t *length) {
+    if (group == NULL || !group->in_use || key == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const tsbyte *bank = group->banks[group->active];
+    tlong cache_generation;
+    t_nvs_cache_result cached = NVS_Cache_Lookup(bank, key, type, out, length, &cache_generation);
+    if (cached != NVS_CACHE_MISS) {
+        return cached == NVS_CACHE_HIT ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+    }
+    nvs_handle_t handle;
+    esp_err_t err = NVS_Get_Handle(bank, NVS_READONLY, &handle);
+    if (err == ESP_OK) {
+        err = type == NVS_TYPE_I32 ? nvs_get_i32(handle, key, out) : NVS_Get_Packed(handle, key, type, out, length);
+    }
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+        NVS_Cache_Store(bank, key, type, err == ESP_OK ? out : NULL, *length, cache_generation);
+    }
+    return err;
+}
+
+esp_err_t NVS_Group_Read_Int(t_nvs_group *group, const tsbyte *key, tsword *out_value) {
+    size_t length = sizeof(*out_value);
+    esp_err_t err = group_read(group, key, NVS_TYPE_I32, out_value, &length);
+    if (err != ESP_OK && out_value != NULL) {
+        *out_value = 0; // Default value
+    }
+    return err;
+}
+
+esp_err_t NVS_Group_Read_Array(t_nvs_group *group, const tsbyte *key, tsword *data, size_t length) {
+    size_t required_size = length * sizeof(tsword);
+    esp_err_t err = group_read(group, key, NVS_TYPE_BLOB, data, &required_size);
+    if (err != ESP_OK && data != NULL) {
+        memset(data, 0, length * sizeof(tsword)); // Default to zero if not found
+    }
+    return err;
+}
+
+esp_err_t NVS_Group_Read_String(t_nvs_group *group, const tsbyte *key, tsbyte *out_value, size_t max_length) {
+    esp_err_t err = group_read(group, key, NVS_TYPE_STR, out_value, &max_length);
+    if (err != ESP_OK && out_value != NULL) {
+        strcpy(out_value, ""); // Default to empty string if not found
+    }
+    return err;
+}
@@ -0,0 +1,99 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP.H
+ Description    : This file as Header for (NVS Atomic Group Updates)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN.h"
+#include "esp_err.h"
+
+/*
+ * A group is a set of related keys that is updated all-or-nothing. It lives in two namespaces,
+ * "<name>~0" and "<name>~1" (the banks); each bank holds a full copy of the group plus a
+ * generation number under NVS_GROUP_GEN_KEY. Readers only look at the bank with the newer
+ * generation.
+ *
+ * An update first makes the other (shadow) bank a copy of the active one, skipping values that
+ * already match. It then writes the staged changes there and writes the shadow bank's generation
+ * last. NVS writes land in order and each one is atomic, so a reset before that last write
+ * leaves the old group, and a reset after it leaves the new one. Recovery at boot is the
+ * NVS_Group_Open() of the group: two integer reads, whatever the group size.
+ *
+ *   t_nvs_group *group;
+ *   t_nvs_txn *txn;
+ *   NVS_Group_Open("wifi", &group);
+ *   NVS_Group_Begin(group, &txn);
+ *   NVS_Txn_Write_String(txn, "ssid", ssid);
+ *   NVS_Txn_Write_Int(txn, "channel", channel);
+ *   NVS_Group_Commit(group, txn);
+ */
+#define NVS_GROUP_MAX_OPEN      2
+#define NVS_GROUP_NAME_MAX      13          // Leaves room for the "~0" bank suffix in a namespace name
+#define NVS_GROUP_GEN_KEY       "~gen"      // Reserved in the banks; do not stage writes to it
+
+typedef struct t_nvs_group t_nvs_group;
+
+/**
+* @brief Opens a group and finds its active bank (the constant-time recovery step).
+*
+* A group that was never committed opens empty.
+*
+* @param name  Group name, 1 to NVS_GROUP_NAME_MAX characters.
+* @param group Out: the group.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM if NVS_GROUP_MAX_OPEN groups are open, or an NVS error.
+*/
+esp_err_t NVS_Group_Open(const tsbyte *name, t_nvs_group **group);
+
+/**
+* @brief Closes a group. An update in progress is aborted.
+*/
+void NVS_Group_Close(t_nvs_group *group);
+
+/**
+* @brief Starts an update: syncs the shadow bank and opens a transaction on it.
+*
+* Stage the new values with the NVS_Txn_Write_* / NVS_Txn_Erase_Key functions on txn. Keys
+* that are not staged keep their current value. Nothing is visible to readers until
+* NVS_Group_Commit() returns.
+*
+* @param txn Out: the transaction (no auto-flush triggers are needed; a forced flush is harmless).
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if an update is already in progress,
+*         ESP_ERR_NO_MEM if no transaction is free, or an NVS error.
+*/
+esp_err_t NVS_Group_Begin(t_nvs_group *group, t_nvs_txn **txn);
+
+/**
+* @brief Writes the staged values to the shadow bank, then switches readers to it.
+*
+* The transaction is closed in every case. On error the group keeps its previous values.
+*
+* @return ESP_OK or the first NVS error.
+*/
+esp_err_t NVS_Group_Commit(t_nvs_group *group, t_nvs_txn *txn);
+
+/**
+* @brief Drops a staged update. The group keeps its previous values.
+*/
+void NVS_Group_Abort(t_nvs_group *group, t_nvs_txn *txn);
+
+/**
+* @brief Generation of the active bank: 0 for a group never committed, +1 per successful commit.
+*/
+tlong NVS_Group_Get_Generation(const t_nvs_group *group);
+
+/**
+* @brief Reads a value from the active bank. Missing keys read as 0 / zero-filled / "" like NVS_Read_*.
+* @return ESP_OK, ESP_ERR_NVS_NOT_FOUND, ESP_ERR_INVALID_ARG or another NVS error.
+*/
+esp_err_t NVS_Group_Read_Int(t_nvs_group *group, const tsbyte *key, tsword *out_value);
+esp_err_t NVS_Group_Read_Array(t_nvs_group *group, const tsbyte *key, tsword *data, size_t length);
+esp_err_t NVS_Group_Read_String(t_nvs_group *group, const tsbyte *key, tsbyte *out_value, size_t max_length);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_NVS_GROUP_H_ */
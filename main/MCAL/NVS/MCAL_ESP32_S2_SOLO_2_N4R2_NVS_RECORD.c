@@ -0,0 +1,355 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD.C
+ Description    : Typed, versioned struct records stored as one compact (varint) NVS blob
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD.h"
+#include <string.h>
+
+#define WIRE_VARINT         0
+#define WIRE_LENGTH         2
+#define TAG_BOOLS           ((0 << 3) | WIRE_VARINT)    // Id 0 is reserved for the bool bitmap
+#define VARINT_MAX          5                           // Bytes of a 32-bit varint
+
+/*==============================================================================================================================*/
+/* Varints */
+
+static tbyte *varint_put(tbyte *out, tlong value) {
+    while (value >= 0x80) {
+        *out++ = (tbyte)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (tbyte)value;
+    return out;
+}
+
+// Returns NULL on a truncated or over-long varint
+static const tbyte *varint_get(const tbyte *in, const tbyte *end, tlong *value) {
+    tlong result = 0;
+    for (tbyte shift = 0; shift < 7 * VARINT_MAX && in < end; shift += 7) {
+        tbyte byte = *in++;
+        result |= (tlong)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return in;
+        }
+    }
+    return NULL;
+}
+
+static tlong zigzag_encode(tslong value) {
+    return ((tlong)value << 1) ^ (tlong)(value >> 31);
+}
+
+static tslong zigzag_decode(tlong value) {
+    return (tslong)(value >> 1) ^ -(tslong)(value & 1);
+}
+
+/*==============================================================================================================================*/
+/* Struct members */
+
+static tlong member_get_uint(const void *member, tword size) {
+    switch (size) {
+        case 1: { tbyte v; memcpy(&v, member, 1); return v; }
+        case 2: { tword v; memcpy(&v, member, 2); return v; }
+        default: { tlong v; memcpy(&v, member, 4); return v; }
+    }
+}
+
+static tslong member_get_int(const void *member, tword size) {
+    switch (size) {
+        case 1: { int8_t v; memcpy(&v, member, 1); return v; }
+        case 2: { int16_t v; memcpy(&v, member, 2); return v; }
+        default: { tslong v; memcpy(&v, member, 4); return v; }
+    }
+}
+
+// Stores the low bytes of value: a field narrowed between versions keeps its low bits
+static void member_set(void *member, tword size, tlong value) {
+    switch (size) {
+        case 1: { tbyte v = (tbyte)value; memcpy(member, &v, 1); break; }
+        case 2: { tword v = (tword)value; memcpy(member, &v, 2); break; }
+        default: memcpy(member, &value, 4); break;
+    }
+}
+
+static bool schema_valid(const t_nvs_record_schema *schema) {
+    if (schema == NULL || (schema->fields == NULL && schema->field_count > 0)) {
+        return false;
+    }
+    for (tbyte i = 0; i < schema->field_count; i++) {
+        const t_nvs_field *field = &schema->fields[i];
+        bool size_ok;
+        switch (field->type) {
+            case NVS_FIELD_UINT:
+            case NVS_FIELD_INT:
+                size_ok = field->size == 1 || field->size == 2 || field->size == 4;
+                break;
+            case NVS_FIELD_BOOL:
+                size_ok = field->size == sizeof(bool) && field->id < 32;
+                break;
+            case NVS_FIELD_STRING:
+            case NVS_FIELD_BYTES:
+                size_ok = field->size > 0;
+                break;
+            default:
+                size_ok = false;
+                break;
+        }
+        if (!size_ok || field->id == 0 || field->offset + field->size > schema->struct_size) {
+            return false;
+        }
+        for (tbyte j = 0; j < i; j++) {
+            if (schema->fields[j].id == field->id) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static const t_nvs_field *schema_field(const t_nvs_record_schema *schema, tlong id) {
+    for (tbyte i = 0; i < schema->field_count; i++) {
+        if (schema->fields[i].id == id) {
+            return &schema->fields[i];
+        }
+    }
+    return NULL;
+}
+
+/*==============================================================================================================================*/
+/* Encoding */
+
+size_t NVS_Record_Max_Size(const t_nvs_record_schema *schema) {
+    size_t size = 1 + VARINT_MAX + 1 + VARINT_MAX;     // Format, version, bool bitmap
+    for (tbyte i = 0; schema != NULL && i < schema->field_count; i++) {
+        const t_nvs_field *field = &schema->fields[i];
+        if (field->type == NVS_FIELD_STRING || field->type == NVS_FIELD_BYTES) {
+            size += 2 + VARINT_MAX + field->size;
+        } else if (field->type != NVS_FIELD_BOOL) {
+            size += 2 + VARINT_MAX;
+        }
+    }
+    return size;
+}
+
+esp_err_t NVS_Record_Encode(const t_nvs_record_schema *schema, const void *record, tbyte *buffer, size_t capacity,
+                            size_t *length) {
+    if (!schema_valid(schema) || record == NULL || buffer == NULL || length == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Encode into a worst-case sized scratch area only if the caller's buffer might be too small
+    size_t max_size = NVS_Record_Max_Size(schema);
+    tbyte *scratch = capacity >= max_size ? buffer : malloc(max_size);
+    if (scratch == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const tbyte *base = record;
+    tbyte *out = scratch;
+    *out++ = NVS_RECORD_FORMAT;
+    out = varint_put(out, schema->version);
+
+    tlong bools = 0;
+    for (tbyte i = 0; i < schema->field_count; i++) {
+        const t_nvs_field *field = &schema->fields[i];
+        const tbyte *member = base + field->offset;
+        tlong value = 0;
+        size_t bytes = 0;
+        switch (field->type) {
+            case NVS_FIELD_BOOL:
+                if (*(const bool *)member) {
+                    bools |= 1u << field->id;
+                }
+                continue;
+            case NVS_FIELD_UINT:
+                value = member_get_uint(member, field->size);
+                break;
+            case NVS_FIELD_INT:
+                value = zigzag_encode(member_get_int(member, field->size));
+                break;
+            case NVS_FIELD_STRING:
+                bytes = strnlen((const char *)member, field->size - 1);
+                break;
+            case NVS_FIELD_BYTES:
+                bytes = field->size;
+                while (bytes > 0 && member[bytes - 1] == 0) {
+                    bytes--;    // Trailing zeros come back from the zero fill on decode
+                }
+                break;
+        }
+        if (field->type == NVS_FIELD_STRING || field->type == NVS_FIELD_BYTES) {
+            if (bytes > 0) {
+                out = varint_put(out, ((tlong)field->id << 3) | WIRE_LENGTH);
+                out = varint_put(out, bytes);
+                memcpy(out, member, bytes);
+                out += bytes;
+            }
+        } else if (value != 0) {
+            out = varint_put(out, ((tlong)field->id << 3) | WIRE_VARINT);
+            out = varint_put(out, value);
+        }
+    }
+    if (bools != 0) {
+        *out++ = TAG_BOOLS;
+        out = varint_put(out, bools);
+    }
+
+    size_t used = out - scratch;
+    esp_err_t err = ESP_OK;
+    if (scratch != buffer) {
+        if (used <= capacity) {
+            memcpy(buffer, scratch, used);
+        } else {
+            err = ESP_ERR_INVALID_SIZE;
+        }
+        free(scratch);
+    }
+    *length = used;
+    return err;
+}
+
+esp_err_t NVS_Record_Decode(const t_nvs_record_schema *schema, const tbyte *buffer, size_t length, void *record,
+                            tword *version) {
+    if (!schema_valid(schema) || buffer == NULL || record == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const tbyte *in = buffer;
+    const tbyte *end = buffer + length;
+    tlong value;
+    if (length < 2 || *in++ != NVS_RECORD_FORMAT || (in = varint_get(in, end, &value)) == NULL || value > 0xFFFF) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    if (version != NULL) {
+        *version = (tword)value;
+    }
+
+    tbyte *base = record;
+    for (tbyte i = 0; i < schema->field_count; i++) {
+        memset(base + schema->fields[i].offset, 0, schema->fields[i].size);
+    }
+
+    while (in < end) {
+        tlong tag;
+        if ((in = varint_get(in, end, &tag)) == NULL) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        tlong id = tag >> 3;
+        const t_nvs_field *field = id != 0 ? schema_field(schema, id) : NULL;
+        if ((tag & 7) == WIRE_VARINT) {
+            if ((in = varint_get(in, end, &value)) == NULL) {
+                return ESP_ERR_NVS_INVALID_LENGTH;
+            }
+            if (tag == TAG_BOOLS) {
+                for (tbyte i = 0; i < schema->field_count; i++) {
+                    if (schema->fields[i].type == NVS_FIELD_BOOL) {
+                        *(bool *)(base + schema->fields[i].offset) = (value >> schema->fields[i].id) & 1;
+                    }
+                }
+            } else if (field != NULL && field->type == NVS_FIELD_UINT) {
+                member_set(base + field->offset, field->size, value);
+            } else if (field != NULL && field->type == NVS_FIELD_INT) {
+                member_set(base + field->offset, field->size, (tlong)zigzag_decode(value));
+            }
+        } else if ((tag & 7) == WIRE_LENGTH) {
+            if ((in = varint_get(in, end, &value)) == NULL || value > (tlong)(end - in)) {
+                return ESP_ERR_NVS_INVALID_LENGTH;
+            }
+            if (field != NULL && (field->type == NVS_FIELD_STRING || field->type == NVS_FIELD_BYTES)) {
+                size_t room = field->type == NVS_FIELD_STRING ? field->size - 1u : field->size;
+                memcpy(base + field->offset, in, value < room ? value : room);
+            }
+            in += value;
+        } else {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+    }
+    return ESP_OK;
+}
+
+/*==============================================================================================================================*/
+/* Storage */
+
+esp_err_t NVS_Record_Write(const tsbyte *key, const t_nvs_record_schema *schema, const void *record) {
+    if (key == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t capacity = NVS_Record_Max_Size(schema);
+    tbyte *buffer = malloc(capacity);
+    if (buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    size_t length;
+    esp_err_t err = NVS_Record_Encode(schema, record, buffer, capacity, &length);
+    nvs_handle_t nvs_handle;
+    if (err == ESP_OK) {
+        err = NVS_Get_Handle(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, key, buffer, length);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        if (err == ESP_OK) {
+            NVS_Cache_Update(NVS_NAMESPACE, key, NVS_TYPE_BLOB, buffer, length);
+        } else {
+            NVS_Cache_Invalidate(NVS_NAMESPACE, key);
+        }
+    }
+    free(buffer);
+    return err;
+}
+
+esp_err_t NVS_Record_Read(const tsbyte *key, const t_nvs_record_schema *schema, void *record) {
+    if (key == NULL || !schema_valid(schema) || record == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t nvs_handle;
+    esp_err_t err = NVS_Get_Handle(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // One lookup in the usual case; a record from a newer, larger schema needs a second one for its size
+    size_t length = NVS_Record_Max_Size(schema);
+    tbyte *buffer = malloc(length);
+    if (buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    err = nvs_get_blob(nvs_handle, key, buffer, &length);
+    if (err == ESP_ERR_NVS_INVALID_LENGTH) {
+        free(buffer);
+        err = nvs_get_blob(nvs_handle, key, NULL, &length);
+        buffer = err == ESP_OK ? malloc(length) : NULL;
+        if (err == ESP_OK) {
+            err = buffer != NULL ? nvs_get_blob(nvs_handle, key, buffer, &length) : ESP_ERR_NO_MEM;
+        }
+    }
+
+    // Decode into a copy so a malformed blob leaves the caller's record as it was
+    tword version = 0;
+    void *decoded = err == ESP_OK ? malloc(schema->struct_size) : NULL;
+    if (err == ESP_OK && decoded == NULL) {
+        err = ESP_ERR_NO_MEM;
+    }
+    if (err == ESP_OK) {
+        memcpy(decoded, record, schema->struct_size);
+        err = NVS_Record_Decode(schema, buffer, length, decoded, &version);
+        if (err == ESP_OK) {
+            memcpy(record, decoded, schema->struct_size);
+        }
+    }
+    free(decoded);
+    free(buffer);
+    if (err == ESP_OK && version < schema->version) {
+        if (schema->migrate != NULL) {
+            schema->migrate(version, record);
+        }
+        err = NVS_Record_Write(key, schema, record);
+    }
+    return err;
+}
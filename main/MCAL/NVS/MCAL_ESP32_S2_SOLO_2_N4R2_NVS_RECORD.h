@@ -0,0 +1,121 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD.H
+ Description    : This file as Header for (NVS Typed Records)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+#include "esp_err.h"
+
+/*
+ * Stores a whole C struct under one NVS key, described by a table of field descriptors.
+ *
+ * Encoding (one blob): a format byte, the schema version as a varint, then one entry per field
+ * that is not zero/empty: a varint tag (id << 3 | wire type) followed by a varint (integers,
+ * signed ones zig-zag encoded) or by a varint length and the bytes (strings without their
+ * terminator, byte arrays). All bool fields share one entry: a varint bitmap indexed by id.
+ *
+ * Fields are matched by id, not by position, so fields can be added, removed or widened
+ * between schema versions: unknown ids are skipped and missing ones read as zero. When the
+ * stored version is older than the schema, NVS_Record_Read() calls schema->migrate (e.g. to
+ * fill defaults for new fields) and writes the record back in the new version.
+ *
+ *   typedef struct { tword period_ms; tsword offset; bool enabled; tsbyte name[16]; } t_cfg;
+ *   static const t_nvs_field cfg_fields[] = {
+ *       NVS_FIELD(1, NVS_FIELD_UINT,   t_cfg, period_ms),
+ *       NVS_FIELD(2, NVS_FIELD_INT,    t_cfg, offset),
+ *       NVS_FIELD(3, NVS_FIELD_BOOL,   t_cfg, enabled),
+ *       NVS_FIELD(4, NVS_FIELD_STRING, t_cfg, name),
+ *   };
+ *   static const t_nvs_record_schema cfg_schema = NVS_RECORD_SCHEMA(2, t_cfg, cfg_fields, cfg_migrate);
+ */
+#define NVS_RECORD_FORMAT       0x01
+#define NVS_RECORD_MAX_ID       255     // Field ids are 1..255; bool fields 1..31
+
+typedef enum {
+    NVS_FIELD_UINT,         // Unsigned integer member of 1, 2 or 4 bytes
+    NVS_FIELD_INT,          // Signed integer member of 1, 2 or 4 bytes
+    NVS_FIELD_BOOL,         // bool member
+    NVS_FIELD_STRING,       // tsbyte array; stored up to its terminator, always terminated on read
+    NVS_FIELD_BYTES         // tbyte array; trailing zero bytes are not stored
+} t_nvs_field_type;
+
+typedef struct {
+    tbyte id;
+    tbyte type;             // t_nvs_field_type
+    tword offset;           // offsetof() the member
+    tword size;             // sizeof() the member
+} t_nvs_field;
+
+#define NVS_FIELD(field_id, field_type, struct_type, member) \
+    { (field_id), (field_type), offsetof(struct_type, member), sizeof(((struct_type *)0)->member) }
+
+/**
+* @brief Called on the decoded record when the stored version is older than the schema's.
+*        Fields the old version did not have are zero on entry.
+*/
+typedef void (*t_nvs_record_migrate)(tword from_version, void *record);
+
+typedef struct {
+    tword version;
+    tword struct_size;
+    const t_nvs_field *fields;
+    tbyte field_count;
+    t_nvs_record_migrate migrate;   // Optional
+} t_nvs_record_schema;
+
+#define NVS_RECORD_SCHEMA(schema_version, struct_type, field_table, migrate_fn) {          \
+    .version = (schema_version),                                                            \
+    .struct_size = sizeof(struct_type),                                                     \
+    .fields = (field_table),                                                                \
+    .field_count = sizeof(field_table) / sizeof((field_table)[0]),                          \
+    .migrate = (migrate_fn)                                                                 \
+}
+
+/**
+* @brief Upper bound of the encoded size of any record of a schema.
+*/
+size_t NVS_Record_Max_Size(const t_nvs_record_schema *schema);
+
+/**
+* @brief Encodes a record.
+*
+* @param buffer   Output, at least NVS_Record_Max_Size() bytes to be safe.
+* @param capacity Size of buffer.
+* @param length   Out: encoded length.
+* @return ESP_OK, ESP_ERR_INVALID_ARG (bad schema) or ESP_ERR_INVALID_SIZE (buffer too small).
+*/
+esp_err_t NVS_Record_Encode(const t_nvs_record_schema *schema, const void *record, tbyte *buffer, size_t capacity,
+                            size_t *length);
+
+/**
+* @brief Decodes a record. Every schema field is zeroed first; no migration is applied.
+*
+* @param version Out (optional): the schema version the record was written with.
+* @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_NVS_INVALID_LENGTH (malformed data).
+*/
+esp_err_t NVS_Record_Decode(const t_nvs_record_schema *schema, const tbyte *buffer, size_t length, void *record,
+                            tword *version);
+
+/**
+* @brief Encodes a record and stores it as one blob in NVS_NAMESPACE, then commits.
+* @return ESP_OK, an encode error or an NVS error.
+*/
+esp_err_t NVS_Record_Write(const tsbyte *key, const t_nvs_record_schema *schema, const void *record);
+
+/**
+* @brief Loads a record with one NVS lookup, migrating it if it was written with an older schema version.
+*
+* A record written by a newer schema version is decoded (unknown fields skipped) but not rewritten.
+*
+* @return ESP_OK, ESP_ERR_NVS_NOT_FOUND (record left untouched), a decode error or an NVS error.
+*/
+esp_err_t NVS_Record_Read(const tsbyte *key, const t_nvs_record_schema *schema, void *record);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD_H_ */
@@ -0,0 +1,373 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN.C
+ Description    : Batched NVS writes with coalescing and a single commit per flush
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+typedef enum {
+    TXN_OP_INT,
+    TXN_OP_BLOB,
+    TXN_OP_STRING,
+    TXN_OP_ERASE
+} t_txn_op;
+
+typedef struct {
+    tsbyte key[NVS_KEY_NAME_MAX_SIZE];
+    t_txn_op op;
+    tsword value;               // TXN_OP_INT
+    void *data;                 // TXN_OP_BLOB / TXN_OP_STRING (heap copy)
+    size_t length;              // TXN_OP_BLOB
+} t_txn_entry;
+
+/*
+ * Transactions live in a static pool and are never freed, so the age timer callback can
+ * always lock its slot safely, even if it races with NVS_Txn_Commit() or NVS_Txn_Abort().
+ */
+struct t_nvs_txn {
+    bool in_use;
+    SemaphoreHandle_t lock;     // Guards everything below; created on first use of the slot
+    esp_timer_handle_t age_timer;
+    tsbyte name_space[NVS_KEY_NAME_MAX_SIZE];
+    t_nvs_txn_config config;
+    t_txn_entry entries[NVS_TXN_MAX_ENTRIES];
+    tword count;
+};
+
+static struct t_nvs_txn txn_pool[NVS_TXN_MAX_OPEN];
+static portMUX_TYPE txn_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+static t_nvs_txn_stats txn_stats;
+static portMUX_TYPE txn_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void txn_entry_clear(t_txn_entry *entry) {
+    free(entry->data);
+    entry->data = NULL;
+    entry->length = 0;
+}
+
+// Mirrors a committed entry into the read cache
+static void txn_cache_update(const t_nvs_txn *txn, const t_txn_entry *entry) {
+    switch (entry->op) {
+        case TXN_OP_INT:
+            NVS_Cache_Update(txn->name_space, entry->key, NVS_TYPE_I32, &entry->value, sizeof(entry->value));
+            break;
+        case TXN_OP_BLOB:
+            NVS_Cache_Update(txn->name_space, entry->key, NVS_TYPE_BLOB, entry->data, entry->length);
+            break;
+        case TXN_OP_STRING:
+            NVS_Cache_Update(txn->name_space, entry->key, NVS_TYPE_STR, entry->data, strlen(entry->data) + 1);
+            break;
+        case TXN_OP_ERASE:
+            NVS_Cache_Update(txn->name_space, entry->key, NVS_TYPE_ANY, NULL, 0);
+            break;
+    }
+}
+
+// Writes entries in staging order and commits once. Called with txn->lock held.
+static esp_err_t txn_flush_locked(t_nvs_txn *txn, bool automatic) {
+    if (txn->count == 0) {
+        return ESP_OK;
+    }
+    if (txn->config.max_age_ms > 0) {
+        esp_timer_stop(txn->age_timer);
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = NVS_Get_Handle(txn->name_space, NVS_READWRITE, &handle);
+    tword written = 0;
+    while (err == ESP_OK && written < txn->count) {
+        t_txn_entry *entry = &txn->entries[written];
+        switch (entry->op) {
+            case TXN_OP_INT:
+                err = nvs_set_i32(handle, entry->key, entry->value);
+                break;
+            case TXN_OP_BLOB:
+                err = NVS_Set_Packed(handle, entry->key, NVS_TYPE_BLOB, entry->data, entry->length);
+                break;
+            case TXN_OP_STRING:
+                err = NVS_Set_Packed(handle, entry->key, NVS_TYPE_STR, entry->data, strlen(entry->data) + 1);
+                break;
+            case TXN_OP_ERASE:
+                err = NVS_Erase_Packed(handle, entry->key);
+                if (err == ESP_ERR_NVS_NOT_FOUND) {
+                    err = ESP_OK;
+                }
+                break;
+        }
+        if (err == ESP_OK) {
+            written++;
+        } else {
+            NVS_Cache_Invalidate(txn->name_space, entry->key);
+        }
+    }
+    bool committed = false;
+    if (written > 0) {
+        esp_err_t commit_err = nvs_commit(handle);
+        committed = true;
+        if (err == ESP_OK) {
+            err = commit_err;
+        }
+        // The cache only mirrors what the commit made durable; keys it may not have are read from NVS again
+        for (tword i = 0; i < written; i++) {
+            if (commit_err == ESP_OK) {
+                txn_cache_update(txn, &txn->entries[i]);
+            } else {
+                NVS_Cache_Invalidate(txn->name_space, txn->entries[i].key);
+            }
+            txn_entry_clear(&txn->entries[i]);
+        }
+    }
+
+    // Keep what did not make it, in order, for a retry
+    memmove(&txn->entries[0], &txn->entries[written], (txn->count - written) * sizeof(t_txn_entry));
+    txn->count -= written;
+    // txn_stage() only arms the timer for the first entry, so the leftovers need it here
+    if (txn->count > 0 && txn->config.max_age_ms > 0) {
+        esp_timer_start_once(txn->age_timer, (uint64_t)txn->config.max_age_ms * 1000);
+    }
+
+    portENTER_CRITICAL(&txn_stats_lock);
+    txn_stats.keys_written += written;
+    txn_stats.commits += committed ? 1 : 0;
+    txn_stats.auto_flushes += automatic ? 1 : 0;
+    portEXIT_CRITICAL(&txn_stats_lock);
+    return err;
+}
+
+static void txn_age_timer_cb(void *arg) {
+    t_nvs_txn *txn = arg;
+
+    xSemaphoreTake(txn->lock, portMAX_DELAY);
+    if (txn->in_use) {
+        txn_flush_locked(txn, true);
+    }
+    xSemaphoreGive(txn->lock);
+}
+
+// Finds the entry of a key, or appends one (flushing first if the staging area is full).
+// Called with txn->lock held. Returns NULL only if a forced flush failed.
+static t_txn_entry *txn_stage(t_nvs_txn *txn, const tsbyte *key, esp_err_t *err) {
+    *err = ESP_OK;
+    for (tword i = 0; i < txn->count; i++) {
+        if (strncmp(txn->entries[i].key, key, NVS_KEY_NAME_MAX_SIZE) == 0) {
+            txn_entry_clear(&txn->entries[i]);
+            portENTER_CRITICAL(&txn_stats_lock);
+            txn_stats.writes_staged++;
+            txn_stats.writes_coalesced++;
+            portEXIT_CRITICAL(&txn_stats_lock);
+            return &txn->entries[i];
+        }
+    }
+    if (txn->count == NVS_TXN_MAX_ENTRIES) {
+        *err = txn_flush_locked(txn, true);
+        if (*err != ESP_OK) {
+            return NULL;
+        }
+    }
+    if (txn->count == 0 && txn->config.max_age_ms > 0) {
+        esp_timer_start_once(txn->age_timer, (uint64_t)txn->config.max_age_ms * 1000);
+    }
+    t_txn_entry *entry = &txn->entries[txn->count++];
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->key, key, NVS_KEY_NAME_MAX_SIZE - 1);
+    portENTER_CRITICAL(&txn_stats_lock);
+    txn_stats.writes_staged++;
+    portEXIT_CRITICAL(&txn_stats_lock);
+    return entry;
+}
+
+// Size trigger, checked after each staged write. Called with txn->lock held.
+static esp_err_t txn_check_size(t_nvs_txn *txn) {
+    if (txn->config.max_entries > 0 && txn->count >= txn->config.max_entries) {
+        return txn_flush_locked(txn, true);
+    }
+    return ESP_OK;
+}
+
+static bool txn_key_valid(const t_nvs_txn *txn, const tsbyte *key) {
+    return txn != NULL && txn->in_use && key != NULL && key[0] != '\0' && strlen(key) < NVS_KEY_NAME_MAX_SIZE;
+}
+
+esp_err_t NVS_Txn_Begin(const tsbyte *name_space, const t_nvs_txn_config *config, t_nvs_txn **txn) {
+    t_nvs_txn_config defaults = NVS_TXN_CONFIG_DEFAULT();
+
+    if (name_space == NULL) {
+        name_space = NVS_NAMESPACE;
+    }
+    if (config == NULL) {
+        config = &defaults;
+    }
+    if (txn == NULL || strlen(name_space) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    t_nvs_txn *slot = NULL;
+    portENTER_CRITICAL(&txn_pool_lock);
+    for (int i = 0; i < NVS_TXN_MAX_OPEN; i++) {
+        if (!txn_pool[i].in_use) {
+            slot = &txn_pool[i];
+            slot->in_use = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&txn_pool_lock);
+    if (slot == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (slot->lock == NULL) {
+        esp_timer_create_args_t timer_args = {
+            .callback = txn_age_timer_cb,
+            .arg = slot,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "nvs_txn",
+        };
+        slot->lock = xSemaphoreCreateMutex();
+        if (slot->lock == NULL || esp_timer_create(&timer_args, &slot->age_timer) != ESP_OK) {
+            if (slot->lock != NULL) {
+                vSemaphoreDelete(slot->lock);
+                slot->lock = NULL;
+            }
+            slot->in_use = false;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(slot->lock, portMAX_DELAY);
+    strncpy(slot->name_space, name_space, NVS_KEY_NAME_MAX_SIZE - 1);
+    slot->name_space[NVS_KEY_NAME_MAX_SIZE - 1] = '\0';
+    slot->config = *config;
+    if (slot->config.max_entries > NVS_TXN_MAX_ENTRIES) {
+        slot->config.max_entries = NVS_TXN_MAX_ENTRIES;
+    }
+    slot->count = 0;
+    xSemaphoreGive(slot->lock);
+    *txn = slot;
+    return ESP_OK;
+}
+
+esp_err_t NVS_Txn_Write_Int(t_nvs_txn *txn, const tsbyte *key, tsword value) {
+    if (!txn_key_valid(txn, key)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err;
+    xSemaphoreTake(txn->lock, portMAX_DELAY);
+    t_txn_entry *entry = txn_stage(txn, key, &err);
+    if (entry != NULL) {
+        entry->op = TXN_OP_INT;
+        entry->value = value;
+        err = txn_check_size(txn);
+    }
+    xSemaphoreGive(txn->lock);
+    return err;
+}
+
+// Shared by the array and string writers: copies the bytes before taking the lock
+static esp_err_t txn_write_bytes(t_nvs_txn *txn, const tsbyte *key, t_txn_op op, const void *data, size_t length) {
+    void *copy = malloc(length > 0 ? length : 1);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, data, length);
+
+    esp_err_t err;
+    xSemaphoreTake(txn->lock, portMAX_DELAY);
+    t_txn_entry *entry = txn_stage(txn, key, &err);
+    if (entry != NULL) {
+        entry->op = op;
+        entry->data = copy;
+        entry->length = length;
+        copy = NULL;
+        err = txn_check_size(txn);
+    }
+    xSemaphoreGive(txn->lock);
+    free(copy);
+    return err;
+}
+
+esp_err_t NVS_Txn_Write_Array(t_nvs_txn *txn, const tsbyte *key, const tsword *data, size_t length) {
+    if (!txn_key_valid(txn, key) || (data == NULL && length > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return txn_write_bytes(txn, key, TXN_OP_BLOB, data, length * sizeof(tsword));
+}
+
+esp_err_t NVS_Txn_Write_String(t_nvs_txn *txn, const tsbyte *key, const tsbyte *value) {
+    if (!txn_key_valid(txn, key) || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return txn_write_bytes(txn, key, TXN_OP_STRING, value, strlen(value) + 1);
+}
+
+esp_err_t NVS_Txn_Erase_Key(t_nvs_txn *txn, const tsbyte *key) {
+    if (!txn_key_valid(txn, key)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err;
+    xSemaphoreTake(txn->lock, portMAX_DELAY);
+    t_txn_entry *entry = txn_stage(txn, key, &err);
+    if (entry != NULL) {
+        entry->op = TXN_OP_ERASE;
+        err = txn_check_size(txn);
+    }
+    xSemaphoreGive(txn->lock);
+    return err;
+}
+
+esp_err_t NVS_Txn_Flush(t_nvs_txn *txn) {
+    if (txn == NULL || !txn->in_use) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(txn->lock, portMAX_DELAY);
+    esp_err_t err = txn_flush_locked(txn, false);
+    xSemaphoreGive(txn->lock);
+    return err;
+}
+
+// Drops whatever is still staged and returns the slot to the pool
+static void txn_close(t_nvs_txn *txn) {
+    xSemaphoreTake(txn->lock, portMAX_DELAY);
+    esp_timer_stop(txn->age_timer);
+    for (tword i = 0; i < txn->count; i++) {
+        txn_entry_clear(&txn->entries[i]);
+    }
+    txn->count = 0;
+    txn->in_use = false;
+    xSemaphoreGive(txn->lock);
+}
+
+esp_err_t NVS_Txn_Commit(t_nvs_txn *txn) {
+    esp_err_t err = NVS_Txn_Flush(txn);
+    if (err != ESP_ERR_INVALID_ARG) {
+        txn_close(txn);
+    }
+    return err;
+}
+
+void NVS_Txn_Abort(t_nvs_txn *txn) {
+    if (txn != NULL && txn->in_use) {
+        txn_close(txn);
+    }
+}
+
+void NVS_Txn_Get_Stats(t_nvs_txn_stats *stats) {
+    portENTER_CRITICAL(&txn_stats_lock);
+    *stats = txn_stats;
+    portEXIT_CRITICAL(&txn_stats_lock);
+    stats->commits_saved = stats->writes_staged > stats->commits ? stats->writes_staged - stats->commits : 0;
+}
+
+void NVS_Txn_Reset_Stats(void) {
+    portENTER_CRITICAL(&txn_stats_lock);
+    memset(&txn_stats, 0, sizeof(txn_stats));
+    portEXIT_CRITICAL(&txn_stats_lock);
+}
@@ -0,0 +1,124 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN.H
+ Description    : This file as Header for (NVS Write Transactions)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_NVS.h"
+#include "esp_err.h"
+
+/*
+ * A transaction stages writes in RAM and sends them to NVS together, followed by a single
+ * nvs_commit(). Writing the same key twice before a flush keeps only the last value, so
+ * counters updated in a loop cost one flash write per flush instead of one per update.
+ *
+ * Staged writes are not visible to NVS_Read_* until they are flushed, and a flush is not
+ * atomic: a reset part-way through leaves the keys written so far.
+ */
+#define NVS_TXN_MAX_OPEN        2       // Transactions open at the same time
+#define NVS_TXN_MAX_ENTRIES     32      // Distinct keys staged before a forced flush
+
+typedef struct t_nvs_txn t_nvs_txn;
+
+/**
+* @brief Auto-flush policy of a transaction. Zero disables a trigger.
+*
+* Whichever trigger fires first flushes everything staged; the transaction stays open.
+* The age trigger runs from the esp_timer task, so keep it well above the flash write time.
+*/
+typedef struct {
+    tword max_entries;      // Flush when this many distinct keys are staged (capped at NVS_TXN_MAX_ENTRIES)
+    tlong max_age_ms;       // Flush this long after the first write staged since the last flush (or failed flush)
+} t_nvs_txn_config;
+
+#define NVS_TXN_CONFIG_DEFAULT() {  \
+    .max_entries = 0,               \
+    .max_age_ms  = 0                \
+}
+
+/**
+* @brief Driver-wide transaction counters.
+*
+* commits_saved is the number of nvs_commit() calls the per-call NVS_Write_* functions would
+* have made for the same writes, minus the commits the transactions actually made.
+*/
+typedef struct {
+    tlong writes_staged;        // NVS_Txn_Write_* / NVS_Txn_Erase_Key calls
+    tlong writes_coalesced;     // Staged writes that replaced an earlier write to the same key
+    tlong keys_written;         // nvs_set_* / nvs_erase_key calls made by flushes
+    tlong commits;              // nvs_commit() calls made by flushes
+    tlong commits_saved;
+    tlong auto_flushes;         // Flushes started by the size or age trigger
+} t_nvs_txn_stats;
+
+/**
+* @brief Opens a transaction on a namespace.
+*
+* @param name_space Namespace, or NULL for NVS_NAMESPACE.
+* @param config     Auto-flush policy, or NULL for NVS_TXN_CONFIG_DEFAULT() (flush only on commit).
+* @param txn        Out: the transaction.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if NVS_TXN_MAX_OPEN transactions are open.
+*/
+esp_err_t NVS_Txn_Begin(const tsbyte *name_space, const t_nvs_txn_config *config, t_nvs_txn **txn);
+
+/**
+* @brief Stages an integer write.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, or the error of a flush the write triggered.
+*/
+esp_err_t NVS_Txn_Write_Int(t_nvs_txn *txn, const tsbyte *key, tsword value);
+
+/**
+* @brief Stages an array write. The data is copied.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or the error of a flush the write triggered.
+*/
+esp_err_t NVS_Txn_Write_Array(t_nvs_txn *txn, const tsbyte *key, const tsword *data, size_t length);
+
+/**
+* @brief Stages a string write. The string is copied.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or the error of a flush the write triggered.
+*/
+esp_err_t NVS_Txn_Write_String(t_nvs_txn *txn, const tsbyte *key, const tsbyte *value);
+
+/**
+* @brief Stages a key erase. Erasing a key that does not exist is not an error.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, or the error of a flush the write triggered.
+*/
+esp_err_t NVS_Txn_Erase_Key(t_nvs_txn *txn, const tsbyte *key);
+
+/**
+* @brief Writes everything staged and commits once. The transaction stays open.
+*
+* On error the failed write and the ones after it stay staged, so the flush can be retried.
+*
+* @return ESP_OK or the first nvs_set_* / nvs_commit() error.
+*/
+esp_err_t NVS_Txn_Flush(t_nvs_txn *txn);
+
+/**
+* @brief Flushes and closes the transaction. It is closed even if the flush fails.
+* @return The result of the flush.
+*/
+esp_err_t NVS_Txn_Commit(t_nvs_txn *txn);
+
+/**
+* @brief Discards the staged writes and closes the transaction.
+*/
+void NVS_Txn_Abort(t_nvs_txn *txn);
+
+/**
+* @brief Copies the driver-wide transaction counters.
+*/
+void NVS_Txn_Get_Stats(t_nvs_txn_stats *stats);
+
+/**
+* @brief Clears the driver-wide transaction counters.
+*/
+void NVS_Txn_Reset_Stats(void);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_NVS_TXN_H_ */
@@ -7,16 +7,58 @@ Creation Date  : 17/08/2024
 *********************************************************************************************************************************/
  
 #include "MCAL_ESP32_S2_SOLO_2_N4R2_UART.h"
+#include "../CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include <stdatomic.h>
 
-uint8_t buffer[UART_BUF_SIZE];
-size_t received_length = 0;
+_Static_assert((UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1)) == 0, "UART_RX_RING_SIZE must be a power of two");
+
+// Single-producer/single-consumer ring: head is only written by the producer, tail only by the consumer.
+// Both are free-running; the fill level is head - tail.
+typedef struct {
+    tbyte data[UART_RX_RING_SIZE];
+    atomic_uint head;
+    atomic_uint tail;
+    t_uart_rx_stats stats;  // Written by the producer only
+} t_uart_rx_ring;
+
+static t_uart_rx_ring rx_rings[ESP_UART_NUM_MAX];
+
+// Event-driven receive state; the RX task is the only writer after UART_Rx_Event_Start()
+typedef struct {
+    t_uart_rx_event_config config;
+    SemaphoreHandle_t data_ready;       // Given on new data when there is no callback
+    atomic_bool stalled;                // No callback: the ring filled up with bytes still in the driver
+    size_t scanned;                     // Line mode: ring bytes already searched without finding the delimiter
+    tbyte line[UART_RX_LINE_MAX];       // Assembly buffer for lines that wrap around the end of the ring
+} t_uart_rx_event_ctx;
+
+// Scatter-gather TX state; stage is only touched with lock held
+typedef struct {
+    SemaphoreHandle_t lock;
+    QueueHandle_t requests;             // Asynchronous sends, created with the TX task on first use
+    tbyte stage[UART_TX_STAGE_SIZE];
+} t_uart_tx_ctx;
+
+typedef struct {
+    t_uart_iovec iov[UART_TX_MAX_SEGMENTS];
+    size_t count;
+    t_uart_tx_done_cb done;
+    void *arg;
+} t_uart_tx_request;
+
+static t_uart_tx_ctx tx_ctx[ESP_UART_NUM_MAX];
+static QueueHandle_t uart_event_queues[ESP_UART_NUM_MAX];
+static t_uart_rx_event_ctx *rx_event_ctx[ESP_UART_NUM_MAX];
 
 /**
 * @brief Initializes the UART peripheral with the specified configuration.
@@ -27,48 +69,480 @@ void UART_Init(t_uart_port port, t_baudrate baud_rate, t_data_bits data_bits,
     // Configure UART
     uart_config_t uart_config = {
         .baud_rate = baud_rate,
-        .data_bits = data_bits,
-        .parity    = parity,
-        .stop_bits = stop_bits,
-        .flow_ctrl = flow_ctrl
+        .data_bits = (uart_word_length_t)data_bits,
+        .parity    = (uart_parity_t)parity,
+        .stop_bits = (uart_stop_bits_t)stop_bits,
+        .flow_ctrl = (uart_hw_flowcontrol_t)flow_ctrl
     };
 
-    // Install UART
-    uart_driver_install(port, UART_BUF_SIZE, UART_BUF_SIZE, 0, NULL, 0);
+    // Install UART with an event queue so receivers can sleep until data arrives
+    uart_driver_install(port, UART_BUF_SIZE, UART_BUF_SIZE, UART_EVENT_QUEUE_LEN, &uart_event_queues[port], 0);
     uart_param_config(port, &uart_config);
 
     uart_set_pin(port, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+
+    if (tx_ctx[port].lock == NULL) {
+        tx_ctx[port].lock = xSemaphoreCreateMutex();
+    }
 }
  
 
+// Every writer of a port goes through its TX lock, so a vector written in several driver calls is never split
+static int uart_tx_write(t_uart_port port, const tbyte *data, size_t length) {
+    SemaphoreHandle_t lock = port < ESP_UART_NUM_MAX ? tx_ctx[port].lock : NULL;
+    if (lock == NULL) {
+        return -1;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    int written = uart_write_bytes(port, (const tsbyte *)data, length);
+    xSemaphoreGive(lock);
+    return written;
+}
+
 void UART_Send_String(const tsbyte* data, t_uart_port port) {
-    uart_write_bytes(port, data, strlen(data));
+    uart_tx_write(port, (const tbyte *)data, strlen(data));
 }
 
 void UART_Send_Byte(const tbyte* data, t_uart_port port) {
-    uart_write_bytes(port, (const tsbyte*)data, 1);
+    uart_tx_write(port, data, 1);
 }
 
 int UART_Receive_String(t_uart_port port) {
-    tsword length = uart_read_bytes(ESP_UART_NUM_0, buffer + received_length, UART_BUF_SIZE - received_length, 5 / portTICK_PERIOD_MS);
-    return length;
+    return UART_Rx_Fill(port, 5 / portTICK_PERIOD_MS);
 }
 
 void UART_Receive_Byte(tbyte* buffer, t_uart_port port) {
-    uart_read_bytes(port, buffer, 1, portMAX_DELAY);
+    // Bytes already moved into the ring come first, or the stream would be reordered
+    while (UART_Rx_Read(port, buffer, 1) == 0) {
+        if (rx_event_ctx[port] != NULL) {
+            UART_Rx_Wait(port, portMAX_DELAY);     // The RX task is the ring's producer
+        } else {
+            UART_Rx_Fill(port, portMAX_DELAY);
+        }
+    }
+}
+
+int UART_Send_Buffer(const tbyte *data, size_t length, t_uart_port port) {
+    return uart_tx_write(port, data, length);
+}
+
+// Merges the segments into as few driver writes as possible. Called with the port's TX lock held.
+static int uart_tx_gather(t_uart_port port, const t_uart_iovec *iov, size_t count) {
+    tbyte *stage = tx_ctx[port].stage;
+    size_t staged = 0;
+    int total = 0;
+    int written;
+
+    for (size_t i = 0; i < count; i++) {
+        const tbyte *data = iov[i].data;
+        size_t length = iov[i].length;
+
+        if (staged + length <= UART_TX_STAGE_SIZE) {
+            memcpy(stage + staged, data, length);
+            staged += length;
+            continue;
+        }
+        if (staged > 0) {
+            if ((written = uart_write_bytes(port, (const tsbyte *)stage, staged)) < 0) {
+                return -1;
+            }
+            total += written;
+            staged = 0;
+        }
+        if (length >= UART_TX_STAGE_SIZE) {
+            // Large segment: staging would only add a copy
+            if ((written = uart_write_bytes(port, (const tsbyte *)data, length)) < 0) {
+                return -1;
+            }
+            total += written;
+        } else {
+            memcpy(stage, data, length);
+            staged = length;
+        }
+    }
+    if (staged > 0) {
+        if ((written = uart_write_bytes(port, (const tsbyte *)stage, staged)) < 0) {
+            return -1;
+        }
+        total += written;
+    }
+    return total;
+}
+
+int UART_Send_Vector(const t_uart_iovec *iov, size_t count, t_uart_port port) {
+    if (port >= ESP_UART_NUM_MAX || tx_ctx[port].lock == NULL || (iov == NULL && count > 0)) {
+        return -1;
+    }
+    if (count == 1) {
+        return UART_Send_Buffer(iov[0].data, iov[0].length, port);
+    }
+    xSemaphoreTake(tx_ctx[port].lock, portMAX_DELAY);
+    int total = uart_tx_gather(port, iov, count);
+    xSemaphoreGive(tx_ctx[port].lock);
+    return total;
+}
+
+static void uart_tx_task(void *arg) {
+    t_uart_port port = (t_uart_port)(intptr_t)arg;
+    t_uart_tx_request request;
+
+    for (;;) {
+        if (xQueueReceive(tx_ctx[port].requests, &request, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        int result = UART_Send_Vector(request.iov, request.count, port);
+        if (request.done != NULL) {
+            request.done(port, result < 0 ? ESP_FAIL : ESP_OK, request.arg);
+        }
+    }
+}
+
+esp_err_t UART_Send_Vector_Async(const t_uart_iovec *iov, size_t count, t_uart_port port,
+                                 t_uart_tx_done_cb done, void *arg) {
+    if (port >= ESP_UART_NUM_MAX || iov == NULL || count == 0 || count > UART_TX_MAX_SEGMENTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    t_uart_tx_ctx *tx = &tx_ctx[port];
+    if (tx->lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (tx->requests == NULL) {
+        xSemaphoreTake(tx->lock, portMAX_DELAY);
+        if (tx->requests == NULL) {
+            QueueHandle_t requests = xQueueCreate(UART_TX_QUEUE_LEN, sizeof(t_uart_tx_request));
+            if (requests == NULL) {
+                xSemaphoreGive(tx->lock);
+                return ESP_ERR_NO_MEM;
+            }
+            tx->requests = requests;
+            if (xTaskCreate(uart_tx_task, "uart_tx", UART_TX_TASK_STACK, (void *)(intptr_t)port,
+                            UART_TX_TASK_PRIORITY, NULL) != pdPASS) {
+                tx->requests = NULL;
+                vQueueDelete(requests);
+                xSemaphoreGive(tx->lock);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        xSemaphoreGive(tx->lock);
+    }
+
+    t_uart_tx_request request = { .count = count, .done = done, .arg = arg };
+    memcpy(request.iov, iov, count * sizeof(*iov));
+    if (xQueueSend(tx->requests, &request, 0) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
 }
 
 uint8_t calculate_fcc(uint8_t *data, size_t length) {
-    uint16_t sum = 0;
-    for (size_t i = 0; i < length; ++i) {
-        sum += data[i];
+    return CRC_FCC_Calculate(data, length);
+}
+
+/*==============================================================================================================================*/
+/* RX ring */
+
+size_t UART_Rx_Write_Peek(t_uart_port port, tbyte **region) {
+    t_uart_rx_ring *ring = &rx_rings[port];
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    unsigned offset = head & (UART_RX_RING_SIZE - 1);
+    unsigned free_space = UART_RX_RING_SIZE - (head - tail);
+    unsigned to_end = UART_RX_RING_SIZE - offset;
+
+    *region = &ring->data[offset];
+    return free_space < to_end ? free_space : to_end;
+}
+
+void UART_Rx_Write_Commit(t_uart_port port, size_t length) {
+    t_uart_rx_ring *ring = &rx_rings[port];
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed) + (unsigned)length;
+    unsigned fill = head - atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+    ring->stats.bytes_received += length;
+    if (fill > ring->stats.high_water_mark) {
+        ring->stats.high_water_mark = fill;
+    }
+}
+
+size_t UART_Rx_Available(t_uart_port port) {
+    t_uart_rx_ring *ring = &rx_rings[port];
+    return atomic_load_explicit(&ring->head, memory_order_acquire) - atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+size_t UART_Rx_Peek(t_uart_port port, const tbyte **data) {
+    t_uart_rx_ring *ring = &rx_rings[port];
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned used = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+    unsigned offset = tail & (UART_RX_RING_SIZE - 1);
+    unsigned to_end = UART_RX_RING_SIZE - offset;
+
+    *data = &ring->data[offset];
+    return used < to_end ? used : to_end;
+}
+
+void UART_Rx_Commit(t_uart_port port, size_t length) {
+    t_uart_rx_ring *ring = &rx_rings[port];
+    atomic_fetch_add_explicit(&ring->tail, (unsigned)length, memory_order_release);
+}
+
+size_t UART_Rx_Read(t_uart_port port, tbyte *data, size_t max_length) {
+    size_t copied = 0;
+
+    // At most two passes: up to the end of the ring, then from its start
+    while (copied < max_length) {
+        const tbyte *region;
+        size_t length = UART_Rx_Peek(port, &region);
+        if (length == 0) {
+            break;
+        }
+        if (length > max_length - copied) {
+            length = max_length - copied;
+        }
+        memcpy(data + copied, region, length);
+        UART_Rx_Commit(port, length);
+        copied += length;
+    }
+    return copied;
+}
+
+int UART_Rx_Fill(t_uart_port port, TickType_t ticks_to_wait) {
+    t_uart_rx_ring *ring = &rx_rings[port];
+    size_t buffered = 0;
+    int total = 0;
+    tbyte *region;
+
+    uart_get_buffered_data_len(port, &buffered);
+    if (buffered == 0) {
+        // Nothing pending: block for the first byte only, so callers wake as soon as data arrives
+        if (UART_Rx_Write_Peek(port, &region) == 0) {
+            return 0;
+        }
+        int length = uart_read_bytes(port, region, 1, ticks_to_wait);
+        if (length <= 0) {
+            return 0;
+        }
+        UART_Rx_Write_Commit(port, (size_t)length);
+        total = length;
+        uart_get_buffered_data_len(port, &buffered);
+    }
+
+    // Drain what the driver already holds straight into ring memory
+    while (buffered > 0) {
+        size_t space = UART_Rx_Write_Peek(port, &region);
+        if (space == 0) {
+            // Back-pressure, not loss: the rest waits in the driver until the consumer makes room
+            ring->stats.full_count++;
+            break;
+        }
+        int length = uart_read_bytes(port, region, buffered < space ? buffered : space, 0);
+        if (length <= 0) {
+            break;
+        }
+        UART_Rx_Write_Commit(port, (size_t)length);
+        total += length;
+        buffered -= (size_t)length;
+    }
+    return total;
+}
+
+void UART_Rx_Get_Stats(t_uart_port port, t_uart_rx_stats *stats) {
+    *stats = rx_rings[port].stats;
+}
+
+/*==============================================================================================================================*/
+/* Event-driven RX */
+
+// Returns the offset (from the read position) of the first delimiter at or after 'from', or -1.
+static int rx_ring_find(t_uart_port port, size_t from, size_t used, tbyte delimiter) {
+    t_uart_rx_ring *ring = &rx_rings[port];
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    while (from < used) {
+        unsigned offset = (tail + (unsigned)from) & (UART_RX_RING_SIZE - 1);
+        size_t span = UART_RX_RING_SIZE - offset;
+        if (span > used - from) {
+            span = used - from;
+        }
+        const tbyte *hit = memchr(&ring->data[offset], delimiter, span);
+        if (hit != NULL) {
+            return (int)(from + (size_t)(hit - &ring->data[offset]));
+        }
+        from += span;
+    }
+    return -1;
+}
+
+// Hands length bytes at the read position to the callback, without copying when they are contiguous.
+static void rx_deliver(t_uart_port port, t_uart_rx_event_ctx *ctx, size_t length) {
+    while (length > 0) {
+        const tbyte *region;
+        size_t contiguous = UART_Rx_Peek(port, &region);
+        if (contiguous >= length) {
+            ctx->config.callback(port, region, length, ctx->config.arg);
+            UART_Rx_Commit(port, length);
+            return;
+        }
+        // Wraps: assemble in the line buffer, one UART_RX_LINE_MAX piece at a time
+        size_t piece = UART_Rx_Read(port, ctx->line, length < UART_RX_LINE_MAX ? length : UART_RX_LINE_MAX);
+        ctx->config.callback(port, ctx->line, piece, ctx->config.arg);
+        length -= piece;
+    }
+}
+
+static void rx_dispatch_lines(t_uart_port port, t_uart_rx_event_ctx *ctx) {
+    for (;;) {
+        size_t used = UART_Rx_Available(port);
+        int position = rx_ring_find(port, ctx->scanned, used, ctx->config.delimiter);
+        if (position < 0) {
+            if (used < UART_RX_RING_SIZE) {
+                ctx->scanned = used;    // Resume the search after these bytes next time
+                return;
+            }
+            // A full ring without a delimiter can never complete a line: flush it as is
+            rx_deliver(port, ctx, used);
+            ctx->scanned = 0;
+            continue;
+        }
+        rx_deliver(port, ctx, (size_t)position + 1);
+        ctx->scanned = 0;
+    }
+}
+
+static void rx_dispatch_chunk(t_uart_port port, t_uart_rx_event_ctx *ctx) {
+    const tbyte *region;
+    size_t length;
+
+    // At most two passes: up to the end of the ring, then from its start
+    while ((length = UART_Rx_Peek(port, &region)) > 0) {
+        ctx->config.callback(port, region, length, ctx->config.arg);
+        UART_Rx_Commit(port, length);
     }
-    return (uint8_t)(~sum + 1);
 }
 
+static void rx_dispatch(t_uart_port port, t_uart_rx_event_ctx *ctx) {
+    if (UART_Rx_Available(port) == 0) {
+        return;
+    }
+    if (ctx->config.callback == NULL) {
+        xSemaphoreGive(ctx->data_ready);
+    } else if (ctx->config.mode == UART_RX_MODE_LINE) {
+        rx_dispatch_lines(port, ctx);
+    } else {
+        rx_dispatch_chunk(port, ctx);
+    }
+}
 
+static void uart_rx_task(void *arg) {
+    t_uart_port port = (t_uart_port)(intptr_t)arg;
+    t_uart_rx_event_ctx *ctx = rx_event_ctx[port];
+    uart_event_t event;
+    size_t buffered;
 
+    for (;;) {
+        if (xQueueReceive(uart_event_queues[port], &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        switch (event.type) {
+            case UART_PATTERN_DET:
+                // Positions are not needed (the ring is searched directly); keep the driver's queue from filling
+                while (uart_pattern_pop_pos(port) >= 0) {
+                }
+                /* fall through */
+            case UART_DATA:
+                // With a callback the ring is emptied as it goes, so keep going until the driver is drained too
+                do {
+                    UART_Rx_Fill(port, 0);
+                    buffered = 0;
+                    uart_get_buffered_data_len(port, &buffered);
+                    if (ctx->config.callback == NULL && buffered > 0) {
+                        // Set before waking the consumer, so its next UART_Rx_Wait() asks for a refill
+                        atomic_store(&ctx->stalled, true);
+                    }
+                    rx_dispatch(port, ctx);
+                    buffered = 0;
+                    uart_get_buffered_data_len(port, &buffered);
+                } while (ctx->config.callback != NULL && buffered > 0);
+                break;
 
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // The driver lost bytes; what is left is unreliable, so start clean
+                rx_rings[port].stats.overflow_count++;
+                uart_flush_input(port);
+                xQueueReset(uart_event_queues[port]);
+                break;
 
+            default:
+                break;
+        }
+    }
+}
 
+esp_err_t UART_Rx_Event_Start(t_uart_port port, const t_uart_rx_event_config *config) {
+    static const t_uart_rx_event_config default_config = UART_RX_EVENT_CONFIG_DEFAULT();
 
+    if (port >= ESP_UART_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config == NULL) {
+        config = &default_config;
+    }
+    if (config->rx_threshold == 0 || config->rx_threshold >= UART_FIFO_LEN ||
+        config->idle_timeout == 0 || config->idle_timeout > 126) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (uart_event_queues[port] == NULL || rx_event_ctx[port] != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    t_uart_rx_event_ctx *ctx = calloc(1, sizeof(*ctx));
+    if (ctx == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ctx->config = *config;
+    ctx->data_ready = xSemaphoreCreateBinary();
+    if (ctx->data_ready == NULL) {
+        free(ctx);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uart_set_rx_full_threshold(port, config->rx_threshold);
+    uart_set_rx_timeout(port, config->idle_timeout);
+    if (config->mode == UART_RX_MODE_LINE) {
+        // Single delimiter character, no idle-time requirement around it
+        uart_enable_pattern_det_baud_intr(port, (char)config->delimiter, 1, 1, 0, 0);
+        uart_pattern_queue_reset(port, UART_EVENT_QUEUE_LEN);
+    }
+
+    rx_event_ctx[port] = ctx;
+    if (xTaskCreate(uart_rx_task, "uart_rx", UART_RX_TASK_STACK, (void *)(intptr_t)port,
+                    UART_RX_TASK_PRIORITY, NULL) != pdPASS) {
+        rx_event_ctx[port] = NULL;
+        vSemaphoreDelete(ctx->data_ready);
+        free(ctx);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t UART_Rx_Wait(t_uart_port port, TickType_t ticks_to_wait) {
+    if (port >= ESP_UART_NUM_MAX || rx_event_ctx[port] == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    t_uart_rx_event_ctx *ctx = rx_event_ctx[port];
+    if (atomic_exchange(&ctx->stalled, false)) {
+        // The consumer has made room since the ring filled up: have the RX task move the rest in.
+        // No new line activity may ever come to raise an event for those bytes.
+        uart_event_t refill = { .type = UART_DATA, .size = 0 };
+        xQueueSend(uart_event_queues[port], &refill, 0);
+    }
+    if (UART_Rx_Available(port) > 0) {
+        return ESP_OK;
+    }
+    if (xSemaphoreTake(ctx->data_ready, ticks_to_wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
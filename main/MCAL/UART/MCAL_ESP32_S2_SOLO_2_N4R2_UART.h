@@ -12,6 +12,8 @@ Testing Date   :
  
 #include "../ESP32_S2_SOLO_2_N4R2_Main.h"
 #include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
  
 /**
 * @brief Enumeration for UART used with the ESP32-S2.
@@ -88,6 +90,74 @@ typedef enum {
     ESP_UART1_RX_PIN_18 = 18,    // GPIO18 as RX pin for UART1
     ESP_UART1_RX_PIN_20 = 20     // GPIO20 as RX pin for UART1
 } t_uart_rx_pin;
+
+/**
+* @brief RX ring counters for one UART port.
+*
+* Use the high-water mark and full count from field units to size UART_RX_RING_SIZE.
+*/
+typedef struct {
+    tlong bytes_received;   // Bytes moved from the driver into the ring
+    tlong high_water_mark;  // Highest ring fill level seen, in bytes
+    tlong full_count;       // Times the ring was full while the driver still held data (nothing lost)
+    tlong overflow_count;   // Times the driver lost bytes (FIFO or driver buffer overflow)
+} t_uart_rx_stats;
+
+/**
+* @brief One segment of a scatter-gather transmit.
+*/
+typedef struct {
+    const tbyte *data;
+    size_t length;
+} t_uart_iovec;
+
+/**
+* @brief Completion callback of an asynchronous send, invoked from the port's TX task.
+*
+* @param port   The UART port.
+* @param result ESP_OK once every segment has been handed to the driver, ESP_FAIL otherwise.
+* @param arg    User argument given to UART_Send_Vector_Async().
+*/
+typedef void (*t_uart_tx_done_cb)(t_uart_port port, esp_err_t result, void *arg);
+
+/**
+* @brief What the event-driven receiver hands to the consumer.
+*/
+typedef enum {
+    UART_RX_MODE_CHUNK = 0,  // Whatever arrived, on every FIFO-threshold or idle-timeout wake-up
+    UART_RX_MODE_LINE  = 1   // Complete lines, each ending with the delimiter byte
+} t_uart_rx_mode;
+
+/**
+* @brief Callback invoked from the port's RX task.
+*
+* @param port   The UART port the data arrived on.
+* @param data   Pointer to the received bytes (valid only during the call; usually points into the RX ring).
+* @param length Number of bytes; in line mode this includes the delimiter.
+* @param arg    User argument from t_uart_rx_event_config.
+*/
+typedef void (*t_uart_rx_cb)(t_uart_port port, const tbyte *data, size_t length, void *arg);
+
+/**
+* @brief Event-driven receive configuration for one UART port.
+*/
+typedef struct {
+    t_uart_rx_mode mode;
+    tbyte delimiter;        // Line mode: end-of-line byte, also armed as the hardware pattern interrupt
+    tbyte rx_threshold;     // Wake when this many bytes sit in the RX FIFO (1..126)
+    tbyte idle_timeout;     // Wake after the line has been idle this many symbol times (1..126)
+    t_uart_rx_cb callback;  // Optional; if NULL, wait with UART_Rx_Wait() and consume the RX ring directly
+    void *arg;              // Passed to callback
+} t_uart_rx_event_config;
+
+#define UART_RX_EVENT_CONFIG_DEFAULT() {    \
+    .mode         = UART_RX_MODE_LINE,      \
+    .delimiter    = '\n',                   \
+    .rx_threshold = 64,                     \
+    .idle_timeout = 10,                     \
+    .callback     = NULL,                   \
+    .arg          = NULL                    \
+}
  
  
 // UART configuration parameters
@@ -96,6 +166,16 @@ typedef enum {
 #define NAK 0x15        // Negative acknowledgment code
 #define SHD 0xA5        // Service Header (example)
 #define UART_BUF_SIZE 1024 // UART buffer size
+#define UART_RX_RING_SIZE UART_BUF_SIZE // Per-port RX ring size (power of two)
+#define UART_EVENT_QUEUE_LEN 20 // Driver events buffered per port
+#define UART_RX_LINE_MAX 256    // Longest line handed to the RX callback in one piece
+#define UART_RX_TASK_STACK 3072
+#define UART_RX_TASK_PRIORITY 12
+#define UART_TX_STAGE_SIZE 256  // Gather buffer that merges small segments into one driver write
+#define UART_TX_MAX_SEGMENTS 8  // Segments per asynchronous send request
+#define UART_TX_QUEUE_LEN 16    // Pending asynchronous send requests per port
+#define UART_TX_TASK_STACK 2048
+#define UART_TX_TASK_PRIORITY 11
 #define T1_DELAY_MS  10   // Delay after sending frame (T1)
 #define T2_DELAY_MS  10   // Delay before retrying (T2)
 #define T3_TIMEOUT_MS 200 // Max wait time for response (T3)
@@ -131,13 +211,13 @@ void UART_Init(t_uart_port port, t_baudrate baud_rate, t_data_bits data_bits,
 void UART_Send_String(const tsbyte* data, t_uart_port port);
  
 /**
-* @brief Receives a string over UART.
+* @brief Receives pending bytes over UART into the port's RX ring.
 *
-* This function receives a string from the UART interface. It reads data until
-* a newline character (`\n`) is encountered or the buffer is full. The received
-* string is null-terminated.
+* This function moves the bytes waiting in the UART driver into the RX ring of
+* the given port. Consume them with UART_Rx_Peek()/UART_Rx_Commit() or UART_Rx_Read().
 *
-* @param[out] buffer Pointer to the buffer where the received string will be stored.
+* @param port The UART port to receive from.
+* @return Number of bytes added to the ring.
 */
 int UART_Receive_String(t_uart_port port) ;
  
@@ -154,12 +234,168 @@ void UART_Send_Byte(const tbyte* data, t_uart_port port);
 * @brief Receives a buffer of bytes over UART.
 *
 * This function receives a specified byte from the UART and stores them
-* in the provided buffer.
+* in the provided buffer. The byte is taken from the port's RX ring, which is
+* filled from the driver first if it is empty, so it keeps its place in the stream.
 *
 * @param[out] buffer Pointer to the buffer where the received byte will be stored.
 */
 void UART_Receive_Byte(tbyte* buffer, t_uart_port port);
 
+/**
+* @brief Sends a length-delimited buffer over UART in a single driver call.
+*
+* Unlike UART_Send_String(), the data may contain zero bytes and no strlen() is needed.
+* Like every send on the port, it is written under the port's TX lock.
+*
+* @param[in] data   Bytes to send.
+* @param     length Number of bytes.
+* @param     port   The UART port.
+* @return Number of bytes handed to the driver, or -1 on error.
+*/
+int UART_Send_Buffer(const tbyte *data, size_t length, t_uart_port port);
+
+/**
+* @brief Sends several segments (e.g. header, payload, checksum) as one TX transaction.
+*
+* Segments are gathered into a per-port staging buffer so that small pieces cost one driver call
+* in total; segments of UART_TX_STAGE_SIZE bytes or more are written straight from the caller's memory,
+* so a vector may take several driver calls. The whole vector is written under the port's TX lock,
+* which every send function of this driver and the frame transport take, so no other write on the
+* same port lands between its pieces.
+*
+* @param[in] iov   Array of segments.
+* @param     count Number of segments.
+* @param     port  The UART port.
+* @return Number of bytes handed to the driver, or -1 on error.
+*/
+int UART_Send_Vector(const t_uart_iovec *iov, size_t count, t_uart_port port);
+
+/**
+* @brief Queues a scatter-gather send without blocking the caller.
+*
+* The port's TX task (started on first use) performs the UART_Send_Vector() and then calls done.
+* The segment array is copied, but the bytes it points to are not: they must stay valid until
+* done is called. Requests on one port complete in submission order.
+*
+* @param[in] iov   Array of segments (at most UART_TX_MAX_SEGMENTS).
+* @param     count Number of segments.
+* @param     port  The UART port.
+* @param     done  Optional completion callback.
+* @param     arg   Passed to done.
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if UART_Init() was not called,
+*         ESP_ERR_TIMEOUT if UART_TX_QUEUE_LEN requests are already pending, or ESP_ERR_NO_MEM.
+*/
+esp_err_t UART_Send_Vector_Async(const t_uart_iovec *iov, size_t count, t_uart_port port,
+                                 t_uart_tx_done_cb done, void *arg);
+
+/**
+* @brief Computes the frame check character: the two's complement of the byte sum.
+*
+* Kept for existing callers; see CRC_FCC_Calculate() and the CRC module for stronger checks.
+*/
 uint8_t calculate_fcc(uint8_t *data, size_t length);
+
+/* RX ring ======================================================================================================================
+ * Each port owns a single-producer/single-consumer ring. The producer is whoever pulls bytes out of the
+ * driver (UART_Receive_String() / UART_Rx_Fill()); the consumer is one parser task. Neither side takes a lock.
+ */
+
+/**
+* @brief Moves bytes from the UART driver into the port's RX ring.
+*
+* Blocks up to ticks_to_wait for the first byte, then drains whatever else the driver
+* has buffered without waiting. Bytes are read straight into ring memory.
+*
+* @param port          The UART port.
+* @param ticks_to_wait Maximum time to wait for the first byte.
+* @return Number of bytes added to the ring.
+*/
+int UART_Rx_Fill(t_uart_port port, TickType_t ticks_to_wait);
+
+/**
+* @brief Returns the number of bytes waiting in the port's RX ring.
+*/
+size_t UART_Rx_Available(t_uart_port port);
+
+/**
+* @brief Exposes the oldest unread bytes of the RX ring without copying them.
+*
+* The returned region is contiguous, so it may be shorter than UART_Rx_Available()
+* when the data wraps; call again after UART_Rx_Commit() to get the rest.
+*
+* @param port The UART port.
+* @param[out] data Set to the first unread byte.
+* @return Number of contiguous bytes readable at *data.
+*/
+size_t UART_Rx_Peek(t_uart_port port, const tbyte **data);
+
+/**
+* @brief Releases bytes obtained through UART_Rx_Peek().
+*
+* @param port   The UART port.
+* @param length Number of bytes consumed (at most the value UART_Rx_Peek() returned).
+*/
+void UART_Rx_Commit(t_uart_port port, size_t length);
+
+/**
+* @brief Copies up to max_length bytes out of the RX ring.
+*
+* @return Number of bytes copied.
+*/
+size_t UART_Rx_Read(t_uart_port port, tbyte *data, size_t max_length);
+
+/**
+* @brief Exposes the free space of the RX ring for a producer to write into.
+*
+* @param port The UART port.
+* @param[out] region Set to the first free byte.
+* @return Number of contiguous bytes writable at *region.
+*/
+size_t UART_Rx_Write_Peek(t_uart_port port, tbyte **region);
+
+/**
+* @brief Publishes bytes written through UART_Rx_Write_Peek() to the consumer.
+*/
+void UART_Rx_Write_Commit(t_uart_port port, size_t length);
+
+/**
+* @brief Copies the RX ring counters of a port.
+*/
+void UART_Rx_Get_Stats(t_uart_port port, t_uart_rx_stats *stats);
+
+/* Event-driven RX ===============================================================================================================
+ * Instead of polling, a per-port RX task sleeps on the driver's event queue. The driver wakes it when the RX FIFO
+ * reaches rx_threshold, when the line goes idle for idle_timeout symbol times, or when the delimiter byte arrives,
+ * so a short request is seen within a few symbol times of its last byte rather than at the next 5 ms poll.
+ * The RX task becomes the producer of the port's RX ring; do not call UART_Rx_Fill() or start the frame
+ * transport on the same port.
+ */
+
+/**
+* @brief Starts event-driven receive on an initialized UART port.
+*
+* With a callback, the RX task delivers chunks or complete lines to it and consumes the ring itself.
+* Lines that do not wrap around the end of the ring are passed without copying. Lines longer than
+* UART_RX_LINE_MAX, and chunks that wrap, are delivered in several calls.
+* Without a callback, the RX task only fills the ring and signals UART_Rx_Wait().
+*
+* @param port   The UART port (use values from t_uart_port).
+* @param config Receive configuration, or NULL for UART_RX_EVENT_CONFIG_DEFAULT().
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if already started, or ESP_ERR_NO_MEM.
+*/
+esp_err_t UART_Rx_Event_Start(t_uart_port port, const t_uart_rx_event_config *config);
+
+/**
+* @brief Blocks until the RX task has added new bytes to the port's RX ring (no-callback mode).
+*
+* Returns immediately if unread bytes are already waiting. If the ring filled up while the driver
+* still held data, it first asks the RX task to move that data in, so call it again after
+* consuming rather than waiting for new line activity.
+*
+* @param port          The UART port.
+* @param ticks_to_wait Maximum time to wait.
+* @return ESP_OK, ESP_ERR_INVALID_STATE if event-driven receive is not running, or ESP_ERR_TIMEOUT.
+*/
+esp_err_t UART_Rx_Wait(t_uart_port port, TickType_t ticks_to_wait);
  
 #endif /* MCAL_ESP32_S2_SOLO_2_N4R2_UART_H_ */
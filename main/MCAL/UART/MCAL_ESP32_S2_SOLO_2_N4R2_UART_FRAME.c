@@ -0,0 +1,605 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME.C
+ Description    : Windowed frame transport (selective repeat) on top of the UART driver
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#define UART_FRAME_POLL_MS      10      // Retransmit timer granularity while the line is idle
+#define UART_FRAME_SEQ_HALF     128     // Sequence numbers closer than this are "ahead", not "behind"
+
+typedef enum {
+    SLOT_FREE,
+    SLOT_IN_FLIGHT,
+    SLOT_DONE           // Acked or dropped, waiting for the window base to pass it
+} t_slot_state;
+
+typedef struct {
+    t_slot_state state;
+    bool held;          // Not sent (or refused by RNR): waits for the peer to reopen its window
+    tbyte retries;
+    tword frame_length;
+    int64_t first_sent_us;
+    int64_t last_sent_us;
+    tbyte frame[UART_FRAME_MAX_SIZE];
+} t_tx_slot;
+
+typedef struct {
+    bool valid;
+    tbyte length;
+    tbyte payload[UART_FRAME_MAX_PAYLOAD];
+} t_rx_slot;
+
+typedef struct {
+    tword length;
+    tbyte payload[UART_FRAME_MAX_PAYLOAD];
+} t_rx_item;
+
+typedef struct {
+    t_uart_frame_config config;
+    SemaphoreHandle_t lock;         // Guards windows and counters
+    SemaphoreHandle_t window;       // Counts free send slots
+    QueueHandle_t rx_queue;         // In-order payloads when no callback is set
+    t_tx_slot tx[UART_FRAME_MAX_WINDOW];
+    tbyte snd_base;                 // Oldest sequence number not yet retired
+    tbyte snd_next;                 // Next sequence number to assign
+    bool peer_busy;                 // Peer sent RNR: hold data frames until it ACKs again
+    int64_t probe_us;               // Last RNR or window probe while peer_busy
+    t_rx_slot rx[UART_FRAME_MAX_WINDOW];
+    tbyte rcv_base;                 // Next sequence number to deliver
+    tbyte rcv_skip_to;              // Peer's BASE: frames before it will never be retransmitted
+    bool rcv_stopped;               // We sent RNR; send a window update once the queue has room
+    tbyte parse[UART_FRAME_MAX_SIZE];
+    size_t parse_length;
+    t_uart_frame_stats stats;
+} t_frame_port;
+
+static t_frame_port *frame_ports[ESP_UART_NUM_MAX];
+
+/*==============================================================================================================================*/
+/* Encoding */
+
+static size_t frame_encode(tbyte *out, tbyte type, tbyte seq, tbyte base, const tbyte *payload, tbyte length) {
+    out[0] = SHD;
+    out[1] = type;
+    out[2] = seq;
+    out[3] = base;
+    out[4] = length;
+    if (length > 0) {
+        memcpy(&out[UART_FRAME_HEADER_SIZE], payload, length);
+    }
+    out[UART_FRAME_HEADER_SIZE + length] = calculate_fcc(&out[1], UART_FRAME_HEADER_SIZE - 1 + length);
+    return UART_FRAME_HEADER_SIZE + length + 1;
+}
+
+static void frame_send_control(t_uart_port port, tbyte type, tbyte seq, tbyte base) {
+    tbyte frame[UART_FRAME_HEADER_SIZE + 1];
+    size_t length = frame_encode(frame, type, seq, base, NULL, 0);
+    UART_Send_Buffer(frame, length, port);
+}
+
+/*==============================================================================================================================*/
+/* Send window (called with ctx->lock held unless noted) */
+
+static void frame_retire(t_frame_port *ctx, t_tx_slot *slot) {
+    t_uart_frame_stats *stats = &ctx->stats;
+    tlong latency = (tlong)(esp_timer_get_time() - slot->first_sent_us);
+
+    slot->state = SLOT_DONE;
+    stats->frames_acked++;
+    stats->latency_total_us += latency;
+    if (stats->frames_acked == 1 || latency < stats->latency_min_us) {
+        stats->latency_min_us = latency;
+    }
+    if (latency > stats->latency_max_us) {
+        stats->latency_max_us = latency;
+    }
+    stats->retry_histogram[slot->retries < MAX_RETRIES ? slot->retries : MAX_RETRIES]++;
+}
+
+static void frame_advance_send_base(t_frame_port *ctx) {
+    while (ctx->snd_base != ctx->snd_next) {
+        t_tx_slot *slot = &ctx->tx[ctx->snd_base % UART_FRAME_MAX_WINDOW];
+        if (slot->state != SLOT_DONE) {
+            break;
+        }
+        slot->state = SLOT_FREE;
+        ctx->snd_base++;
+        xSemaphoreGive(ctx->window);
+    }
+}
+
+static bool frame_in_flight(t_frame_port *ctx, tbyte seq) {
+    return (tbyte)(seq - ctx->snd_base) < (tbyte)(ctx->snd_next - ctx->snd_base);
+}
+
+/* Retires every in-flight frame the peer reports as received (everything before its rcv_base). */
+static void frame_cumulative_ack(t_frame_port *ctx, tbyte peer_base) {
+    tbyte count = (tbyte)(peer_base - ctx->snd_base);
+    if (count > (tbyte)(ctx->snd_next - ctx->snd_base)) {
+        return; // Stale or bogus
+    }
+    for (tbyte i = 0; i < count; i++) {
+        t_tx_slot *slot = &ctx->tx[(tbyte)(ctx->snd_base + i) % UART_FRAME_MAX_WINDOW];
+        if (slot->state == SLOT_IN_FLIGHT) {
+            frame_retire(ctx, slot);
+        }
+    }
+}
+
+/* Prepares a slot for retransmission; returns false (and drops it) once the retry budget is spent. */
+static bool frame_prepare_retransmit(t_frame_port *ctx, t_tx_slot *slot) {
+    if (slot->retries >= ctx->config.max_retries) {
+        slot->state = SLOT_DONE;
+        ctx->stats.frames_dropped++;
+        return false;
+    }
+    slot->retries++;
+    slot->last_sent_us = esp_timer_get_time();
+    ctx->stats.retransmissions++;
+    // Refresh BASE so the peer learns about frames dropped since the first transmission
+    slot->frame[3] = ctx->snd_base;
+    slot->frame[slot->frame_length - 1] = calculate_fcc(&slot->frame[1], slot->frame_length - 2);
+    return true;
+}
+
+/* Peer refused new data (RNR): keep everything still in flight until it reopens the window. */
+static void frame_hold_all(t_frame_port *ctx) {
+    for (tbyte i = 0; i < UART_FRAME_MAX_WINDOW; i++) {
+        if (ctx->tx[i].state == SLOT_IN_FLIGHT) {
+            ctx->tx[i].held = true;
+        }
+    }
+    ctx->peer_busy = true;
+    ctx->probe_us = esp_timer_get_time();
+    ctx->stats.rnrs_received++;
+}
+
+/* Peer reopened its window: collects held frames for sending, in sequence order, without charging a retry. */
+static tbyte frame_release_held(t_frame_port *ctx, t_tx_slot **release) {
+    tbyte count = 0;
+    int64_t now = esp_timer_get_time();
+
+    ctx->peer_busy = false;
+    for (tbyte seq = ctx->snd_base; seq != ctx->snd_next; seq++) {
+        t_tx_slot *slot = &ctx->tx[seq % UART_FRAME_MAX_WINDOW];
+        if (slot->state == SLOT_IN_FLIGHT && slot->held) {
+            slot->held = false;
+            slot->last_sent_us = now;
+            release[count++] = slot;
+        }
+    }
+    return count;
+}
+
+static void frame_on_ack(t_uart_port port, t_frame_port *ctx, tbyte type, tbyte seq, tbyte peer_base) {
+    t_tx_slot *resend = NULL;
+    t_tx_slot *release[UART_FRAME_MAX_WINDOW];
+    tbyte release_count = 0;
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    frame_cumulative_ack(ctx, peer_base);
+    if (type == UART_FRAME_TYPE_RNR) {
+        frame_hold_all(ctx);
+    } else if (frame_in_flight(ctx, seq)) {
+        t_tx_slot *slot = &ctx->tx[seq % UART_FRAME_MAX_WINDOW];
+        if (slot->state == SLOT_IN_FLIGHT) {
+            if (type == ACK) {
+                frame_retire(ctx, slot);
+            } else {
+                ctx->stats.naks_received++;
+                if (frame_prepare_retransmit(ctx, slot)) {
+                    resend = slot;
+                }
+            }
+        }
+    }
+    if (type == ACK && ctx->peer_busy) {
+        release_count = frame_release_held(ctx, release);
+    }
+    frame_advance_send_base(ctx);
+    xSemaphoreGive(ctx->lock);
+
+    // Only this task retires slots, so the slot cannot be reused before the write completes, and only this task
+    // rewrites an in-flight frame (UART_Frame_Send() writes the first transmission before releasing the lock)
+    if (resend != NULL) {
+        UART_Send_Buffer(resend->frame, resend->frame_length, port);
+    }
+    for (tbyte i = 0; i < release_count; i++) {
+        UART_Send_Buffer(release[i]->frame, release[i]->frame_length, port);
+    }
+}
+
+static void frame_check_timeouts(t_uart_port port, t_frame_port *ctx) {
+    int64_t now = esp_timer_get_time();
+    int64_t timeout_us = (int64_t)ctx->config.ack_timeout_ms * 1000;
+
+    t_tx_slot *probe = NULL;
+
+    // A held frame is not lost, so it never uses up retries; the oldest one probes whether the window reopened
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    if (ctx->peer_busy && now - ctx->probe_us >= timeout_us) {
+        for (tbyte seq = ctx->snd_base; seq != ctx->snd_next; seq++) {
+            t_tx_slot *slot = &ctx->tx[seq % UART_FRAME_MAX_WINDOW];
+            if (slot->state == SLOT_IN_FLIGHT && slot->held) {
+                probe = slot;
+                break;
+            }
+        }
+        ctx->probe_us = now;
+    }
+    xSemaphoreGive(ctx->lock);
+    if (probe != NULL) {
+        UART_Send_Buffer(probe->frame, probe->frame_length, port);
+    }
+
+    for (tbyte i = 0; i < UART_FRAME_MAX_WINDOW; i++) {
+        t_tx_slot *slot = &ctx->tx[i];
+        bool resend = false;
+
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        if (slot->state == SLOT_IN_FLIGHT && !slot->held && now - slot->last_sent_us >= timeout_us) {
+            resend = frame_prepare_retransmit(ctx, slot);
+        }
+        frame_advance_send_base(ctx);
+        xSemaphoreGive(ctx->lock);
+
+        if (resend) {
+            UART_Send_Buffer(slot->frame, slot->frame_length, port);
+        }
+    }
+}
+
+/*==============================================================================================================================*/
+/* Receive window */
+
+/* True while the application queue is full; called with ctx->lock held. */
+static bool frame_rx_blocked(t_frame_port *ctx) {
+    return ctx->config.rx_callback == NULL && uxQueueSpacesAvailable(ctx->rx_queue) == 0;
+}
+
+/* Hands in-order payloads to the application, skipping frames the peer has given up on. Runs on the transport task
+   and, with no callback, on the consumer in UART_Frame_Receive(), so queue pushes happen under ctx->lock. */
+static void frame_deliver(t_uart_port port, t_frame_port *ctx) {
+    t_rx_item item;
+
+    for (;;) {
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        t_rx_slot *slot = &ctx->rx[ctx->rcv_base % UART_FRAME_MAX_WINDOW];
+        if (slot->valid) {
+            if (frame_rx_blocked(ctx)) {
+                xSemaphoreGive(ctx->lock); // Consumer is behind: frame_on_data() refuses new frames until it catches up
+                return;
+            }
+            item.length = slot->length;
+            memcpy(item.payload, slot->payload, slot->length);
+            slot->valid = false;
+            ctx->rcv_base++;
+            ctx->stats.frames_received++;
+            if (ctx->config.rx_callback == NULL) {
+                xQueueSend(ctx->rx_queue, &item, 0);
+            }
+            xSemaphoreGive(ctx->lock);
+
+            if (ctx->config.rx_callback != NULL) {
+                ctx->config.rx_callback(port, item.payload, item.length, ctx->config.rx_arg);
+            }
+        } else if ((tbyte)(ctx->rcv_skip_to - ctx->rcv_base) != 0 &&
+                   (tbyte)(ctx->rcv_skip_to - ctx->rcv_base) < UART_FRAME_SEQ_HALF) {
+            ctx->rcv_base++;
+            ctx->stats.frames_lost++;
+            xSemaphoreGive(ctx->lock);
+        } else {
+            xSemaphoreGive(ctx->lock);
+            return;
+        }
+    }
+}
+
+/* After an RNR, tells the peer the window is open again once the queue has room (a lost update is covered by its probe). */
+static void frame_reopen(t_uart_port port, t_frame_port *ctx) {
+    bool update = false;
+    tbyte rcv_base;
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    if (ctx->rcv_stopped && !frame_rx_blocked(ctx)) {
+        ctx->rcv_stopped = false;
+        update = true;
+    }
+    rcv_base = ctx->rcv_base;
+    xSemaphoreGive(ctx->lock);
+
+    if (update) {
+        frame_send_control(port, ACK, (tbyte)(rcv_base - 1), rcv_base);
+    }
+}
+
+static void frame_on_data(t_uart_port port, t_frame_port *ctx, tbyte seq, tbyte peer_base,
+                          const tbyte *payload, tbyte length) {
+    tbyte reply = 0;
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    // Track the peer's BASE only while it is ahead of us, so a stale value can never wrap around
+    ctx->rcv_skip_to = ((tbyte)(peer_base - ctx->rcv_base) < UART_FRAME_SEQ_HALF) ? peer_base : ctx->rcv_base;
+    tbyte offset = (tbyte)(seq - ctx->rcv_base);
+    if (offset >= (tbyte)(256 - UART_FRAME_MAX_WINDOW)) {
+        ctx->stats.frames_duplicate++; // Already delivered; our ACK was lost
+        reply = ACK;
+    } else if (frame_rx_blocked(ctx) || offset >= UART_FRAME_MAX_WINDOW) {
+        // Acking a stored frame lets the peer move its window past rcv_base, so while the consumer is behind
+        // nothing new is accepted, and a frame we cannot hold yet is refused rather than silently ignored
+        ctx->rcv_stopped = true;
+        ctx->stats.rnrs_sent++;
+        reply = UART_FRAME_TYPE_RNR;
+    } else {
+        t_rx_slot *slot = &ctx->rx[seq % UART_FRAME_MAX_WINDOW];
+        if (slot->valid) {
+            ctx->stats.frames_duplicate++;
+        } else {
+            slot->valid = true;
+            slot->length = length;
+            memcpy(slot->payload, payload, length);
+        }
+        reply = ACK;
+    }
+    xSemaphoreGive(ctx->lock);
+
+    if (reply == ACK) {
+        frame_deliver(port, ctx);
+    }
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    tbyte rcv_base = ctx->rcv_base;
+    xSemaphoreGive(ctx->lock);
+    frame_send_control(port, reply, seq, rcv_base);
+}
+
+/*==============================================================================================================================*/
+/* Parser */
+
+static bool frame_header_valid(const tbyte *frame) {
+    tbyte type = frame[1];
+    tbyte length = frame[4];
+    if (type == UART_FRAME_TYPE_DATA) {
+        return length > 0 && length <= UART_FRAME_MAX_PAYLOAD;
+    }
+    return (type == ACK || type == NAK || type == UART_FRAME_TYPE_RNR) && length == 0;
+}
+
+/* Drops the current candidate frame start and rescans the buffered bytes for the next SHD. */
+static void frame_resync(t_frame_port *ctx) {
+    size_t start = 1;
+    while (start < ctx->parse_length && ctx->parse[start] != SHD) {
+        start++;
+    }
+    ctx->parse_length -= start;
+    memmove(ctx->parse, &ctx->parse[start], ctx->parse_length);
+}
+
+static void frame_dispatch(t_uart_port port, t_frame_port *ctx, size_t total) {
+    tbyte *frame = ctx->parse;
+    tbyte type = frame[1];
+    tbyte seq = frame[2];
+    tbyte base = frame[3];
+
+    if (calculate_fcc(&frame[1], total - 1) != 0) {
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        ctx->stats.frames_corrupt++;
+        bool nak = type == UART_FRAME_TYPE_DATA && (tbyte)(seq - ctx->rcv_base) < UART_FRAME_MAX_WINDOW;
+        tbyte rcv_base = ctx->rcv_base;
+        xSemaphoreGive(ctx->lock);
+        if (nak) {
+            frame_send_control(port, NAK, seq, rcv_base);
+        }
+        frame_resync(ctx);
+        return;
+    }
+
+    if (type == UART_FRAME_TYPE_DATA) {
+        frame_on_data(port, ctx, seq, base, &frame[UART_FRAME_HEADER_SIZE], frame[4]);
+    } else {
+        frame_on_ack(port, ctx, type, seq, base);
+    }
+    ctx->parse_length = 0;
+}
+
+static void frame_feed(t_uart_port port, t_frame_port *ctx, const tbyte *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (ctx->parse_length == 0 && data[i] != SHD) {
+            continue;
+        }
+        ctx->parse[ctx->parse_length++] = data[i];
+
+        // A resync can leave several buffered bytes, so keep checking until the buffer needs more input
+        while (ctx->parse_length >= UART_FRAME_HEADER_SIZE) {
+            if (!frame_header_valid(ctx->parse)) {
+                frame_resync(ctx);
+                continue;
+            }
+            size_t total = UART_FRAME_HEADER_SIZE + ctx->parse[4] + 1;
+            if (ctx->parse_length < total) {
+                break;
+            }
+            frame_dispatch(port, ctx, total);
+        }
+    }
+}
+
+/*==============================================================================================================================*/
+/* Task */
+
+static void frame_task(void *arg) {
+    t_uart_port port = (t_uart_port)(intptr_t)arg;
+    t_frame_port *ctx = frame_ports[port];
+
+    for (;;) {
+        const tbyte *data;
+        size_t length;
+
+        // The task is both producer and consumer of the port's RX ring; bytes are parsed where they landed
+        UART_Rx_Fill(port, pdMS_TO_TICKS(UART_FRAME_POLL_MS));
+        while ((length = UART_Rx_Peek(port, &data)) > 0) {
+            frame_feed(port, ctx, data, length);
+            UART_Rx_Commit(port, length);
+        }
+        frame_deliver(port, ctx);
+        frame_reopen(port, ctx);
+        frame_check_timeouts(port, ctx);
+    }
+}
+
+/*==============================================================================================================================*/
+/* API */
+
+esp_err_t UART_Frame_Init(t_uart_port port, const t_uart_frame_config *config) {
+    t_uart_frame_config defaults = UART_FRAME_CONFIG_DEFAULT();
+
+    if (port >= ESP_UART_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config == NULL) {
+        config = &defaults;
+    }
+    if (config->window_size == 0 || config->window_size > UART_FRAME_MAX_WINDOW || config->ack_timeout_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (frame_ports[port] != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    t_frame_port *ctx = calloc(1, sizeof(t_frame_port));
+    if (ctx == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ctx->config = *config;
+    ctx->lock = xSemaphoreCreateMutex();
+    ctx->window = xSemaphoreCreateCounting(config->window_size, config->window_size);
+    ctx->rx_queue = (config->rx_callback == NULL) ? xQueueCreate(UART_FRAME_MAX_WINDOW, sizeof(t_rx_item)) : NULL;
+    if (ctx->lock == NULL || ctx->window == NULL || (config->rx_callback == NULL && ctx->rx_queue == NULL)) {
+        if (ctx->lock != NULL) {
+            vSemaphoreDelete(ctx->lock);
+        }
+        if (ctx->window != NULL) {
+            vSemaphoreDelete(ctx->window);
+        }
+        if (ctx->rx_queue != NULL) {
+            vQueueDelete(ctx->rx_queue);
+        }
+        free(ctx);
+        return ESP_ERR_NO_MEM;
+    }
+
+    frame_ports[port] = ctx;
+    if (xTaskCreate(frame_task, "uart_frame", UART_FRAME_TASK_STACK, (void *)(intptr_t)port,
+                    UART_FRAME_TASK_PRIORITY, NULL) != pdPASS) {
+        frame_ports[port] = NULL;
+        vSemaphoreDelete(ctx->lock);
+        vSemaphoreDelete(ctx->window);
+        if (ctx->rx_queue != NULL) {
+            vQueueDelete(ctx->rx_queue);
+        }
+        free(ctx);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t UART_Frame_Send(t_uart_port port, const tbyte *payload, size_t length, TickType_t ticks_to_wait) {
+    if (port >= ESP_UART_NUM_MAX || frame_ports[port] == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (payload == NULL || length == 0 || length > UART_FRAME_MAX_PAYLOAD) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    t_frame_port *ctx = frame_ports[port];
+
+    if (xSemaphoreTake(ctx->window, ticks_to_wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    tbyte seq = ctx->snd_next++;
+    t_tx_slot *slot = &ctx->tx[seq % UART_FRAME_MAX_WINDOW];
+    slot->frame_length = frame_encode(slot->frame, UART_FRAME_TYPE_DATA, seq, ctx->snd_base, payload, (tbyte)length);
+    slot->retries = 0;
+    slot->first_sent_us = esp_timer_get_time();
+    slot->last_sent_us = slot->first_sent_us;
+    slot->state = SLOT_IN_FLIGHT;
+    slot->held = ctx->peer_busy; // Sent when the peer reopens its window
+    ctx->stats.frames_sent++;
+    // Written under the lock: once it is released the task may release, probe or retransmit this slot, and a
+    // retransmission rewrites BASE and FCC in place
+    if (!slot->held) {
+        UART_Send_Buffer(slot->frame, slot->frame_length, port);
+    }
+    xSemaphoreGive(ctx->lock);
+    return ESP_OK;
+}
+
+esp_err_t UART_Frame_Flush(t_uart_port port, TickType_t ticks_to_wait) {
+    if (port >= ESP_UART_NUM_MAX || frame_ports[port] == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    t_frame_port *ctx = frame_ports[port];
+    TickType_t start = xTaskGetTickCount();
+
+    for (;;) {
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        bool idle = ctx->snd_base == ctx->snd_next;
+        xSemaphoreGive(ctx->lock);
+        if (idle) {
+            return ESP_OK;
+        }
+        if (ticks_to_wait != portMAX_DELAY && xTaskGetTickCount() - start >= ticks_to_wait) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+}
+
+esp_err_t UART_Frame_Receive(t_uart_port port, tbyte *payload, size_t *length, TickType_t ticks_to_wait) {
+    if (port >= ESP_UART_NUM_MAX || frame_ports[port] == NULL || frame_ports[port]->rx_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    t_frame_port *ctx = frame_ports[port];
+    t_rx_item item;
+
+    if (xQueueReceive(ctx->rx_queue, &item, ticks_to_wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    // Refill the freed queue slot from the window, and reopen the window if the peer was stopped
+    frame_deliver(port, ctx);
+    frame_reopen(port, ctx);
+    memcpy(payload, item.payload, item.length);
+    *length = item.length;
+    return ESP_OK;
+}
+
+void UART_Frame_Get_Stats(t_uart_port port, t_uart_frame_stats *stats) {
+    if (port >= ESP_UART_NUM_MAX || frame_ports[port] == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(frame_ports[port]->lock, portMAX_DELAY);
+    *stats = frame_ports[port]->stats;
+    xSemaphoreGive(frame_ports[port]->lock);
+}
+
+void UART_Frame_Reset_Stats(t_uart_port port) {
+    if (port >= ESP_UART_NUM_MAX || frame_ports[port] == NULL) {
+        return;
+    }
+    xSemaphoreTake(frame_ports[port]->lock, portMAX_DELAY);
+    memset(&frame_ports[port]->stats, 0, sizeof(t_uart_frame_stats));
+    xSemaphoreGive(frame_ports[port]->lock);
+}
@@ -0,0 +1,159 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME.H
+ Description    : This file as Header for (UART Frame Transport)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_UART.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+/*
+ * Frame layout (all frame types share the same header):
+ *
+ *   | SHD | TYPE | SEQ | BASE | LEN | PAYLOAD[LEN] | FCC |
+ *
+ * TYPE  : UART_FRAME_TYPE_DATA, ACK, NAK or UART_FRAME_TYPE_RNR.
+ * SEQ   : 8-bit sequence number of the data frame (echoed back by ACK/NAK/RNR).
+ * BASE  : DATA - oldest sequence number the sender still retransmits.
+ *         ACK/NAK/RNR - next sequence number the receiver expects (cumulative acknowledgment).
+ * LEN   : payload length (0 for ACK/NAK/RNR).
+ * FCC   : calculate_fcc() over TYPE..PAYLOAD, so the byte sum of TYPE..FCC is zero.
+ *
+ * Flow control: while the application queue is full the receiver refuses every new data frame with RNR.
+ * The sender then holds its unacknowledged frames (no retries are spent) and resends the oldest one every
+ * ack_timeout_ms as a probe. The receiver reopens the window with an ACK of BASE - 1 once the queue has room.
+ */
+#define UART_FRAME_TYPE_DATA        0x02    // Data frame (STX)
+#define UART_FRAME_TYPE_RNR         0x13    // Receiver not ready (XOFF)
+#define UART_FRAME_HEADER_SIZE      5       // SHD, TYPE, SEQ, BASE, LEN
+#define UART_FRAME_MAX_PAYLOAD      240     // Largest payload carried by one frame
+#define UART_FRAME_MAX_SIZE         (UART_FRAME_HEADER_SIZE + UART_FRAME_MAX_PAYLOAD + 1)
+#define UART_FRAME_MAX_WINDOW       16      // Upper bound for t_uart_frame_config.window_size
+#define UART_FRAME_DEFAULT_WINDOW   8       // Enough in-flight data to cover the T3 round trip at 921600 baud
+#define UART_FRAME_TASK_STACK       3072
+#define UART_FRAME_TASK_PRIORITY    10
+
+/**
+* @brief Callback invoked from the transport task for every frame delivered in order.
+*
+* @param port    The UART port the frame arrived on.
+* @param payload Pointer to the payload (valid only during the call).
+* @param length  Payload length in bytes.
+* @param arg     User argument from t_uart_frame_config.
+*/
+typedef void (*t_uart_frame_rx_cb)(t_uart_port port, const tbyte *payload, size_t length, void *arg);
+
+/**
+* @brief Frame transport configuration for one UART port.
+*/
+typedef struct {
+    tbyte window_size;              // Data frames in flight before UART_Frame_Send() blocks (1..UART_FRAME_MAX_WINDOW)
+    tword ack_timeout_ms;           // Retransmit an unacknowledged frame after this long (T3)
+    tbyte max_retries;              // Retransmissions before a frame is dropped
+    t_uart_frame_rx_cb rx_callback; // Optional; if NULL, frames are queued for UART_Frame_Receive()
+    void *rx_arg;                   // Passed to rx_callback
+} t_uart_frame_config;
+
+#define UART_FRAME_CONFIG_DEFAULT() {               \
+    .window_size    = UART_FRAME_DEFAULT_WINDOW,    \
+    .ack_timeout_ms = T3_TIMEOUT_MS,                \
+    .max_retries    = MAX_RETRIES,                  \
+    .rx_callback    = NULL,                         \
+    .rx_arg         = NULL                          \
+}
+
+/**
+* @brief Per-port transport counters.
+*
+* Latency is measured from the first transmission of a frame to the ACK that retires it,
+* so it includes any retransmissions. Average latency is latency_total_us / frames_acked.
+* frames_dropped is counted by the sender: a dropped frame whose ACKs were all lost was still
+* delivered, so the peer's frames_received can exceed frames_sent - frames_dropped.
+*/
+typedef struct {
+    tlong frames_sent;                      // Data frames submitted by UART_Frame_Send()
+    tlong frames_acked;                     // Data frames acknowledged by the peer
+    tlong frames_dropped;                   // Data frames abandoned after max_retries
+    tlong retransmissions;                  // Data frames sent again (timeout or NAK)
+    tlong naks_received;                    // NAKs received from the peer
+    tlong frames_received;                  // Data frames delivered in order to the application
+    tlong frames_duplicate;                 // Data frames received more than once
+    tlong frames_corrupt;                   // Frames that failed the FCC check
+    tlong frames_lost;                      // Data frames skipped because the peer gave up on them
+    tlong rnrs_sent;                        // Data frames refused because the application queue was full
+    tlong rnrs_received;                    // RNRs received from the peer
+    tlong retry_histogram[MAX_RETRIES + 1]; // Acked frames by retransmission count (last bucket is "or more")
+    tlong latency_min_us;
+    tlong latency_max_us;
+    uint64_t latency_total_us;
+} t_uart_frame_stats;
+
+/**
+* @brief Starts the frame transport on an initialized UART port.
+*
+* Allocates the send/receive windows and starts the transport task that parses incoming
+* frames, sends ACK/NAK, and retransmits timed-out frames. UART_Init() must be called first.
+* The transport task owns the port's RX ring; do not call UART_Receive_String() on it.
+*
+* @param port   The UART port (use values from t_uart_port).
+* @param config Transport configuration, or NULL for UART_FRAME_CONFIG_DEFAULT().
+* @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if already started, or ESP_ERR_NO_MEM.
+*/
+esp_err_t UART_Frame_Init(t_uart_port port, const t_uart_frame_config *config);
+
+/**
+* @brief Queues one payload for reliable, in-order delivery.
+*
+* Returns as soon as the frame is transmitted; it does not wait for the ACK. Blocks only
+* while the send window is full. While the peer reports RNR the frame is queued in the window
+* and transmitted when the peer reopens it.
+*
+* @param port          The UART port.
+* @param payload       Payload bytes.
+* @param length        Payload length (1..UART_FRAME_MAX_PAYLOAD).
+* @param ticks_to_wait How long to wait for a free window slot.
+* @return ESP_OK, ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_STATE, or ESP_ERR_TIMEOUT.
+*/
+esp_err_t UART_Frame_Send(t_uart_port port, const tbyte *payload, size_t length, TickType_t ticks_to_wait);
+
+/**
+* @brief Waits until every sent frame has been acknowledged or dropped.
+*
+* @param port          The UART port.
+* @param ticks_to_wait Maximum time to wait.
+* @return ESP_OK, ESP_ERR_INVALID_STATE, or ESP_ERR_TIMEOUT.
+*/
+esp_err_t UART_Frame_Flush(t_uart_port port, TickType_t ticks_to_wait);
+
+/**
+* @brief Receives the next in-order payload (only when no rx_callback is configured).
+*
+* Taking a payload frees room for the next buffered frame and, if the peer was stopped with RNR,
+* reopens its window, so a slow consumer throttles the sender instead of losing frames.
+*
+* @param port          The UART port.
+* @param payload       Buffer of at least UART_FRAME_MAX_PAYLOAD bytes.
+* @param length        Out: payload length.
+* @param ticks_to_wait How long to wait for a frame.
+* @return ESP_OK, ESP_ERR_INVALID_STATE, or ESP_ERR_TIMEOUT.
+*/
+esp_err_t UART_Frame_Receive(t_uart_port port, tbyte *payload, size_t *length, TickType_t ticks_to_wait);
+
+/**
+* @brief Copies the transport counters of a port.
+*/
+void UART_Frame_Get_Stats(t_uart_port port, t_uart_frame_stats *stats);
+
+/**
+* @brief Clears the transport counters of a port.
+*/
+void UART_Frame_Reset_Stats(t_uart_port port);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_UART_FRAME_H_ */
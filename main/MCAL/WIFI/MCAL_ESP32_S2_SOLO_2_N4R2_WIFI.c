@@ -8,9 +8,416 @@
  Testing Date   : 
 *********************************************************************************************************************************/
 #include "MCAL_ESP32_S2_SOLO_2_N4R2_WIFI.h"
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE.h"
+#include "../NVS/MCAL_ESP32_S2_SOLO_2_N4R2_NVS_RECORD.h"
+#include "../CRC/MCAL_ESP32_S2_SOLO_2_N4R2_CRC.h"
+#include "esp_system.h"
+#include "lwip/dhcp.h"
+#include <time.h>
 
 static EventGroupHandle_t wifi_event_group; ///< Event group for WiFi events
 const tsword WIFI_CONNECTED_BIT = BIT0;
+const tsword WIFI_ASSOCIATED_BIT = BIT1;    ///< Set from STA_CONNECTED until STA_DISCONNECTED
+const tsword WIFI_DOWN_BIT = BIT2;          ///< The complement of WIFI_ASSOCIATED_BIT
+
+/**
+ * @brief The last AP that gave an IP, as kept in NVS for fast connect.
+ */
+typedef struct {
+    tsbyte ssid[33];
+    tbyte bssid[6];
+    tbyte channel;
+    tlong password_crc;
+    tlong ip;
+    tlong netmask;
+    tlong gw;
+    tlong lease_start;          ///< time() when the lease was granted
+    tlong lease_expiry;         ///< time() when it runs out
+} t_wifi_ap_cache;
+
+static const t_nvs_field ap_cache_fields[] = {
+    NVS_FIELD(1, NVS_FIELD_STRING, t_wifi_ap_cache, ssid),
+    NVS_FIELD(2, NVS_FIELD_BYTES,  t_wifi_ap_cache, bssid),
+    NVS_FIELD(3, NVS_FIELD_UINT,   t_wifi_ap_cache, channel),
+    NVS_FIELD(4, NVS_FIELD_UINT,   t_wifi_ap_cache, password_crc),
+    NVS_FIELD(5, NVS_FIELD_UINT,   t_wifi_ap_cache, ip),
+    NVS_FIELD(6, NVS_FIELD_UINT,   t_wifi_ap_cache, netmask),
+    NVS_FIELD(7, NVS_FIELD_UINT,   t_wifi_ap_cache, gw),
+    NVS_FIELD(8, NVS_FIELD_UINT,   t_wifi_ap_cache, lease_start),
+    NVS_FIELD(9, NVS_FIELD_UINT,   t_wifi_ap_cache, lease_expiry),
+};
+// Version 1 records have no lease times, so their lease reads as expired
+static const t_nvs_record_schema ap_cache_schema = NVS_RECORD_SCHEMA(2, t_wifi_ap_cache, ap_cache_fields, NULL);
+
+static esp_netif_t *wifi_netif;                 ///< Default station interface
+static wifi_config_t wifi_base_config;          ///< SSID and password of the last WiFi_Connect()
+static t_wifi_ap_cache ap_cache;
+static bool ap_cache_valid;
+static bool fast_enabled;
+static bool fast_reuse_lease;
+static bool fast_attempt;                       ///< The attempt in progress is directed at the cached AP
+static bool lease_reused;                       ///< The attempt in progress put the cached address on the interface
+static bool wifi_has_ip;
+static tbyte link_bssid[6];                     ///< AP of the current association
+static tbyte link_channel;
+static int64_t connect_start_us;                ///< Start of the connection being timed
+static t_wifi_connect_stats connect_stats;
+static bool wifi_associated;                    ///< Between STA_CONNECTED and STA_DISCONNECTED
+static tlong pending_leaves;                    ///< Disconnections caused by WiFi_Disable() not yet delivered
+static t_wifi_reconnect_policy reconnect_policy = WIFI_RECONNECT_POLICY_DEFAULT();
+static t_wifi_reconnect_stats reconnect_stats;
+static tlong backoff_step;                      ///< Backoff delays used since the last IP
+static tlong auth_failures;                     ///< Authentication failures in a row
+static tlong disconnect_counts[256];            ///< By reason code
+static esp_timer_handle_t retry_timer;
+static t_wifi_snapshot link_snapshot;           ///< connected_us holds the association time
+static tlong link_snapshot_seq;                 ///< Odd while link_snapshot is being written
+static t_wifi_link_state link_state;            ///< Also in the snapshot; one load for the hot path
+static esp_timer_handle_t rssi_timer;
+static portMUX_TYPE wifi_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static tlong wifi_password_crc(const wifi_config_t *config) {
+    const tsbyte *password = (const tsbyte *)config->sta.password;
+    return CRC32_Update(CRC32_INIT, (const tbyte *)password, strnlen(password, sizeof(config->sta.password)));
+}
+
+/**
+ * @brief Loads the cached AP from NVS and checks that it belongs to the current credentials.
+ *
+ * @return bool True if the cache can be used for a directed connection.
+ */
+static bool wifi_load_ap_cache(void) {
+    t_wifi_ap_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    bool valid = NVS_Record_Read(WIFI_FAST_CONNECT_KEY, &ap_cache_schema, &cache) == ESP_OK &&
+                 strncmp(cache.ssid, (const tsbyte *)wifi_base_config.sta.ssid, sizeof(wifi_base_config.sta.ssid)) == 0 &&
+                 cache.password_crc == wifi_password_crc(&wifi_base_config) &&
+                 cache.channel >= 1 && cache.channel <= 14;
+    portENTER_CRITICAL(&wifi_lock);
+    ap_cache = cache;
+    ap_cache_valid = valid;
+    portEXIT_CRITICAL(&wifi_lock);
+    return valid;
+}
+
+/**
+ * @brief Applies the station configuration for the next attempt.
+ *
+ * A directed attempt pins the cached BSSID and channel and, with lease reuse and a lease that
+ * has not expired, sets the cached address on the interface with the DHCP client stopped; the
+ * client is restarted to renew the lease once the address is up. Otherwise the plain
+ * SSID/password configuration is used and the DHCP client runs.
+ *
+ * @param directed Use the cached AP.
+ */
+static void wifi_apply_config(bool directed) {
+    wifi_config_t wifi_config = wifi_base_config;
+    t_wifi_ap_cache cache;
+    portENTER_CRITICAL(&wifi_lock);
+    cache = ap_cache;
+    bool reuse_lease = fast_reuse_lease;
+    portEXIT_CRITICAL(&wifi_lock);
+
+    if (directed) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = cache.channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+    }
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+
+    // A clock behind lease_start was reset since the lease was granted, so its age is unknown
+    tlong now = (tlong)time(NULL);
+    bool reuse = directed && reuse_lease && cache.ip != 0 && now >= cache.lease_start && now < cache.lease_expiry;
+    portENTER_CRITICAL(&wifi_lock);
+    lease_reused = reuse;
+    portEXIT_CRITICAL(&wifi_lock);
+    if (reuse) {
+        esp_netif_ip_info_t ip_info = { .ip = { cache.ip }, .netmask = { cache.netmask }, .gw = { cache.gw } };
+        esp_netif_dhcpc_stop(wifi_netif);
+        esp_netif_set_ip_info(wifi_netif, &ip_info);
+    } else {
+        esp_netif_dhcpc_start(wifi_netif);
+    }
+}
+
+/**
+ * @brief Returns the lease time of the DHCP client's last lease, in seconds (0 if unknown).
+ */
+static tlong wifi_dhcp_lease_time(void) {
+    struct netif *netif = esp_netif_get_netif_impl(wifi_netif);
+    struct dhcp *dhcp = netif != NULL ? netif_dhcp_data(netif) : NULL;
+    return dhcp != NULL ? dhcp->offered_t0_lease : 0;
+}
+
+/**
+ * @brief Opens a snapshot update. Called with wifi_lock held, which keeps writers in order and,
+ * on the target, keeps readers from preempting a half-written snapshot.
+ */
+static void wifi_snapshot_begin_locked(void) {
+    __atomic_store_n(&link_snapshot_seq, link_snapshot_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Publishes a snapshot update. Called with wifi_lock held.
+ */
+static void wifi_snapshot_end_locked(void) {
+    __atomic_store_n(&link_state, link_snapshot.state, __ATOMIC_RELAXED);
+    __atomic_store_n(&link_snapshot_seq, link_snapshot_seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief RSSI timer callback: refreshes the RSSI of the snapshot while associated.
+ *
+ * @param arg Unused parameter.
+ */
+static void wifi_rssi_timer_cb(void *arg) {
+    (void)arg;
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    int8_t rssi = ap_info.rssi;
+    portENTER_CRITICAL(&wifi_lock);
+    if (link_snapshot.state != wifi_link_down) {
+        wifi_snapshot_begin_locked();
+        link_snapshot.rssi = rssi;
+        wifi_snapshot_end_locked();
+    }
+    portEXIT_CRITICAL(&wifi_lock);
+}
+
+/**
+ * @brief Sorts a disconnect reason code into the groups the reconnect policy handles.
+ *
+ * @param reason The wifi_err_reason_t code.
+ * @return t_wifi_reason_class The group.
+ */
+static t_wifi_reason_class wifi_reason_class(tbyte reason) {
+    switch (reason) {
+        case WIFI_REASON_AUTH_EXPIRE:
+        case WIFI_REASON_AUTH_LEAVE:
+        case WIFI_REASON_ASSOC_EXPIRE:
+        case WIFI_REASON_NOT_AUTHED:
+        case WIFI_REASON_NOT_ASSOCED:
+        case WIFI_REASON_ASSOC_LEAVE:
+        case WIFI_REASON_BEACON_TIMEOUT:
+            return wifi_reason_link_lost;
+        case WIFI_REASON_ASSOC_TOOMANY:
+        case WIFI_REASON_NO_AP_FOUND:
+        case WIFI_REASON_ASSOC_FAIL:
+        case WIFI_REASON_CONNECTION_FAIL:
+            return wifi_reason_not_found;
+        case WIFI_REASON_MIC_FAILURE:
+        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT:
+        case WIFI_REASON_802_1X_AUTH_FAILED:
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+            return wifi_reason_auth;
+        default:
+            return wifi_reason_other;
+    }
+}
+
+/**
+ * @brief Restarts the reconnect policy for a new connection. Called with wifi_lock held.
+ */
+static void wifi_reconnect_reset_locked(void) {
+    reconnect_stats.state = wifi_reconnect_connecting;
+    reconnect_stats.attempts = 0;
+    backoff_step = 0;
+    auth_failures = 0;
+}
+
+/**
+ * @brief Picks the delay of the next retry. Called with wifi_lock held.
+ *
+ * @param reason_class Group of the disconnect reason.
+ * @param immediate Retry at once (fast-connect fallback).
+ * @return tslong The delay in milliseconds, or -1 to give up.
+ */
+static tslong wifi_reconnect_delay_locked(t_wifi_reason_class reason_class, bool immediate) {
+    const t_wifi_reconnect_policy *policy = &reconnect_policy;
+    tlong delay_ms;
+
+    reconnect_stats.attempts++;
+    if (reason_class == wifi_reason_auth) {
+        auth_failures++;
+    } else {
+        auth_failures = 0;
+    }
+    if ((policy->max_attempts != 0 && reconnect_stats.attempts > policy->max_attempts) ||
+        (policy->auth_max_attempts != 0 && auth_failures >= policy->auth_max_attempts)) {
+        reconnect_stats.state = wifi_reconnect_gave_up;
+        reconnect_stats.give_ups++;
+        return -1;
+    }
+    reconnect_stats.total_attempts++;
+
+    if (immediate || (reason_class == wifi_reason_link_lost && reconnect_stats.attempts == 1)) {
+        delay_ms = 0;
+    } else if (reason_class == wifi_reason_auth) {
+        delay_ms = policy->auth_retry_delay_ms;
+    } else {
+        uint64_t backoff = (uint64_t)policy->initial_delay_ms << (backoff_step < 20 ? backoff_step : 20);
+        delay_ms = backoff < policy->max_delay_ms ? (tlong)backoff : policy->max_delay_ms;
+        backoff_step++;
+        // Spread the retries of devices that lost the same AP at the same moment
+        tlong span = (tlong)(((uint64_t)delay_ms * policy->jitter_percent) / 100);
+        if (span > 0) {
+            delay_ms = delay_ms - span + esp_random() % (2 * span + 1);
+        }
+    }
+    reconnect_stats.next_delay_ms = delay_ms;
+    reconnect_stats.state = delay_ms > 0 ? wifi_reconnect_waiting : wifi_reconnect_connecting;
+    return (tslong)delay_ms;
+}
+
+/**
+ * @brief Retry timer callback: starts the scheduled attempt.
+ *
+ * @param arg Unused parameter.
+ */
+static void wifi_retry_timer_cb(void *arg) {
+    (void)arg;
+    portENTER_CRITICAL(&wifi_lock);
+    bool due = reconnect_stats.state == wifi_reconnect_waiting;
+    if (due) {
+        reconnect_stats.state = wifi_reconnect_connecting;
+    }
+    portEXIT_CRITICAL(&wifi_lock);
+    if (due) {
+        esp_wifi_connect();
+    }
+}
+
+/**
+ * @brief Handles a disconnection: fast connect and the reconnect policy.
+ *
+ * Starts timing the reconnection if an IP was held. A failed directed attempt drops the cache
+ * and falls back to a scan at once; a lost link is retried at the cached AP first. Other
+ * retries are scheduled on the retry timer. A disconnection caused by WiFi_Disable() may be
+ * delivered after the next WiFi_Connect(), so it does not touch the attempt in progress.
+ *
+ * @param reason The reason code of the disconnection.
+ */
+static void wifi_on_disconnected(tbyte reason) {
+    portENTER_CRITICAL(&wifi_lock);
+    disconnect_counts[reason]++;
+    if (wifi_has_ip) {
+        wifi_has_ip = false;
+        connect_start_us = esp_timer_get_time();
+    }
+    wifi_associated = false;
+    bool local = reason == WIFI_REASON_ASSOC_LEAVE && pending_leaves > 0;
+    t_wifi_reason_class reason_class = local ? wifi_reason_local : wifi_reason_class(reason);
+    reconnect_stats.disconnects[reason_class]++;
+    if (local) {
+        pending_leaves--;
+    }
+    if (local || reconnect_stats.state == wifi_reconnect_idle || reconnect_stats.state == wifi_reconnect_gave_up) {
+        portEXIT_CRITICAL(&wifi_lock);
+        return;
+    }
+    bool fallback = fast_attempt;
+    if (fallback) {
+        fast_attempt = false;
+        ap_cache_valid = false;
+        connect_stats.fallbacks++;
+    }
+    bool directed = !fallback && fast_enabled && ap_cache_valid;
+    fast_attempt = directed;
+    tslong delay_ms = wifi_reconnect_delay_locked(reason_class, fallback);
+    portEXIT_CRITICAL(&wifi_lock);
+
+    if (fallback || directed) {
+        wifi_apply_config(directed);
+    }
+    if (delay_ms == 0) {
+        esp_wifi_connect();
+    } else if (delay_ms > 0) {
+        esp_timer_stop(retry_timer);
+        esp_timer_start_once(retry_timer, (uint64_t)delay_ms * 1000);
+    }
+}
+
+/**
+ * @brief Records the time to IP and refreshes the cached AP when it changed.
+ *
+ * On a reused address the cached lease times are kept and the DHCP client is started to renew
+ * the lease; its own IP_EVENT_STA_GOT_IP then refreshes them. A renewal only rewrites the cache
+ * once more than half of the cached lease has gone, so it does not cost a flash write per boot.
+ *
+ * @param got_ip The IP_EVENT_STA_GOT_IP data.
+ */
+static void wifi_on_got_ip(const ip_event_got_ip_t *got_ip) {
+    t_wifi_ap_cache fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    strncpy(fresh.ssid, (const tsbyte *)wifi_base_config.sta.ssid, sizeof(fresh.ssid) - 1);
+    fresh.password_crc = wifi_password_crc(&wifi_base_config);
+    fresh.ip = got_ip->ip_info.ip.addr;
+    fresh.netmask = got_ip->ip_info.netmask.addr;
+    fresh.gw = got_ip->ip_info.gw.addr;
+    tlong now = (tlong)time(NULL);
+    tlong lease_time = wifi_dhcp_lease_time();
+
+    portENTER_CRITICAL(&wifi_lock);
+    bool renewal = wifi_has_ip;
+    bool reused = lease_reused;
+    lease_reused = false;
+    if (reused) {
+        fresh.lease_start = ap_cache.lease_start;
+        fresh.lease_expiry = ap_cache.lease_expiry;
+    } else {
+        fresh.lease_start = now;
+        fresh.lease_expiry = now + lease_time;
+    }
+    memcpy(fresh.bssid, link_bssid, sizeof(fresh.bssid));
+    fresh.channel = link_channel;
+    t_wifi_ap_cache same_lease = fresh;
+    same_lease.lease_start = ap_cache.lease_start;
+    same_lease.lease_expiry = ap_cache.lease_expiry;
+    bool changed = !ap_cache_valid || memcmp(&same_lease, &ap_cache, sizeof(same_lease)) != 0 ||
+                   (!reused && (tslong)(ap_cache.lease_expiry - now) <
+                                   (tslong)(ap_cache.lease_expiry - ap_cache.lease_start) / 2);
+    ap_cache = fresh;
+    ap_cache_valid = true;
+    bool save = changed && fast_enabled;
+    if (renewal) {
+        // The DHCP client renewed the address of a connection already counted
+        portEXIT_CRITICAL(&wifi_lock);
+        if (save) {
+            NVS_Record_Write(WIFI_FAST_CONNECT_KEY, &ap_cache_schema, &fresh);
+        }
+        return;
+    }
+    tlong elapsed_us = (tlong)(esp_timer_get_time() - connect_start_us);
+    connect_stats.connects++;
+    connect_stats.last_was_fast = fast_attempt;
+    connect_stats.fast_connects += fast_attempt ? 1 : 0;
+    connect_stats.last_time_to_ip_us = elapsed_us;
+    if (connect_stats.connects == 1 || elapsed_us < connect_stats.best_time_to_ip_us) {
+        connect_stats.best_time_to_ip_us = elapsed_us;
+    }
+    if (elapsed_us > connect_stats.worst_time_to_ip_us) {
+        connect_stats.worst_time_to_ip_us = elapsed_us;
+    }
+    fast_attempt = false;
+    wifi_has_ip = true;
+    wifi_reconnect_reset_locked();
+    reconnect_stats.state = wifi_reconnect_connected;
+    portEXIT_CRITICAL(&wifi_lock);
+
+    // Written only when the AP or the lease changed, so a duty-cycled device does not wear the flash
+    if (save) {
+        NVS_Record_Write(WIFI_FAST_CONNECT_KEY, &ap_cache_schema, &fresh);
+    }
+    if (reused) {
+        esp_netif_dhcpc_start(wifi_netif);
+    }
+}
 
 /**
  * @brief Event handler for WiFi events.
@@ -24,14 +431,55 @@ const tsword WIFI_CONNECTED_BIT = BIT0;
  * @param event_id The ID of the event.
  * @param event_data Data associated with the event.
  */
-static void wifi_event_handler(void* arg, esp_event_base_t event_base, tlong event_id, void* event_data) {
+static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
+    (void)arg;
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        const wifi_event_sta_connected_t *connected = event_data;
+        wifi_ap_record_t ap_info;
+        tsbyte rssi = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK ? ap_info.rssi : 0;
+        portENTER_CRITICAL(&wifi_lock);
+        memcpy(link_bssid, connected->bssid, sizeof(link_bssid));
+        link_channel = connected->channel;
+        wifi_associated = true;
+        wifi_snapshot_begin_locked();
+        link_snapshot.state = wifi_link_associated;
+        memcpy(link_snapshot.bssid, connected->bssid, sizeof(link_snapshot.bssid));
+        link_snapshot.channel = connected->channel;
+        link_snapshot.rssi = rssi;
+        link_snapshot.ip = 0;
+        link_snapshot.connected_us = esp_timer_get_time();
+        wifi_snapshot_end_locked();
+        portEXIT_CRITICAL(&wifi_lock);
+        xEventGroupClearBits(wifi_event_group, WIFI_DOWN_BIT);
+        xEventGroupSetBits(wifi_event_group, WIFI_ASSOCIATED_BIT);
+        esp_timer_stop(rssi_timer);
+        esp_timer_start_periodic(rssi_timer, (uint64_t)WIFI_RSSI_REFRESH_MS * 1000);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        esp_wifi_connect();
-        xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        const wifi_event_sta_disconnected_t *disconnected = event_data;
+        esp_timer_stop(rssi_timer);
+        portENTER_CRITICAL(&wifi_lock);
+        wifi_snapshot_begin_locked();
+        memset(&link_snapshot, 0, sizeof(link_snapshot));
+        link_snapshot.state = wifi_link_down;
+        wifi_snapshot_end_locked();
+        portEXIT_CRITICAL(&wifi_lock);
+        xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT | WIFI_ASSOCIATED_BIT);
+        xEventGroupSetBits(wifi_event_group, WIFI_DOWN_BIT);
+        wifi_on_disconnected(disconnected->reason);
+        WiFi_Probe_Trigger();
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        const ip_event_got_ip_t *got_ip = event_data;
+        wifi_on_got_ip(got_ip);
+        portENTER_CRITICAL(&wifi_lock);
+        wifi_snapshot_begin_locked();
+        link_snapshot.state = wifi_link_connected;
+        link_snapshot.ip = got_ip->ip_info.ip.addr;
+        wifi_snapshot_end_locked();
+        portEXIT_CRITICAL(&wifi_lock);
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        WiFi_Probe_Trigger();   // Refresh the reachability state for the new link
     }
 }
 
@@ -52,7 +500,7 @@ void WiFi_Init(void) {
     esp_event_loop_create_default();
 
     // Create a default WiFi station (client)
-    esp_netif_create_default_wifi_sta();
+    wifi_netif = esp_netif_create_default_wifi_sta();
 
     // Initialize WiFi configuration
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
@@ -60,6 +508,26 @@ void WiFi_Init(void) {
 
     // Create an event group for WiFi events
     wifi_event_group = xEventGroupCreate();
+    xEventGroupSetBits(wifi_event_group, WIFI_DOWN_BIT);
+
+    // Reconnect attempts are scheduled on a timer, never issued from a busy loop
+    const esp_timer_create_args_t retry_args = {
+        .callback = wifi_retry_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_retry",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&retry_args, &retry_timer);
+
+    const esp_timer_create_args_t rssi_args = {
+        .callback = wifi_rssi_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_rssi",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&rssi_args, &rssi_timer);
 
     // Register event handlers for WiFi and IP events
     esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL);
@@ -72,6 +540,9 @@ void WiFi_Init(void) {
  * This function sets the WiFi mode to station and configures the WiFi settings
  * using the SSID and password defined in the configuration. It connects the WiFi
  * driver and initiates the connection process.
+ *
+ * With fast connect enabled and a cached AP for these credentials, the first attempt
+ * is directed at the cached AP.
  */
 
 void WiFi_Connect(const tsbyte *ssid, const tsbyte *password) {
@@ -80,8 +551,22 @@ void WiFi_Connect(const tsbyte *ssid, const tsbyte *password) {
     strncpy((tsbyte *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid) - 1);
     strncpy((tsbyte *)wifi_config.sta.password, password, sizeof(wifi_config.sta.password) - 1);
 
+    esp_timer_stop(retry_timer);
+    portENTER_CRITICAL(&wifi_lock);
+    wifi_base_config = wifi_config;
+    connect_start_us = esp_timer_get_time();
+    wifi_has_ip = false;
+    wifi_reconnect_reset_locked();
+    bool fast = fast_enabled;
+    portEXIT_CRITICAL(&wifi_lock);
+
+    bool directed = fast && wifi_load_ap_cache();
+    portENTER_CRITICAL(&wifi_lock);
+    fast_attempt = directed;
+    portEXIT_CRITICAL(&wifi_lock);
+
     esp_wifi_set_mode(WIFI_MODE_STA);
-    esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+    wifi_apply_config(directed);
     esp_wifi_start();
     esp_wifi_connect();
    
@@ -98,6 +583,10 @@ void WiFi_Connect(const tsbyte *ssid, const tsbyte *password) {
  * a network and perform communication over WiFi.
  */
 void WiFi_Enable(void) {
+    portENTER_CRITICAL(&wifi_lock);
+    connect_start_us = esp_timer_get_time();
+    wifi_reconnect_reset_locked();
+    portEXIT_CRITICAL(&wifi_lock);
 	// Connect the WiFi driver
     esp_wifi_connect();
     esp_wifi_start(); // Start the WiFi driver
@@ -107,9 +596,16 @@ void WiFi_Enable(void) {
  * @brief Disables the WiFi subsystem.
  *
  * This function stops the WiFi driver, disconnecting from any connected network
- * and halting WiFi communication.
+ * and halting WiFi communication. Pending reconnect attempts are cancelled.
  */
 void WiFi_Disable(void) {
+    esp_timer_stop(retry_timer);
+    portENTER_CRITICAL(&wifi_lock);
+    reconnect_stats.state = wifi_reconnect_idle;
+    if (wifi_associated) {
+        pending_leaves++;       // The driver reports the stop as a disconnection
+    }
+    portEXIT_CRITICAL(&wifi_lock);
     esp_wifi_stop(); // Stop the WiFi driver
 }
 
@@ -119,42 +615,57 @@ void WiFi_Disable(void) {
  * This function allows you to configure the TX mode based on specific RF modes
  * like 802.11b with different power and bandwidth settings.
  *
+ * The protocol, bandwidth and TX power are set in that order; the first driver call that fails
+ * stops the sequence and its error is returned.
+ *
  * @param mode The desired WiFi TX mode configuration.
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG for an unknown mode, or the driver's error.
  */
-void WiFi_SetTxMode(t_tx_mode mode) {
+esp_err_t WiFi_SetTxMode(t_tx_mode mode) {
+    uint8_t protocol;
+    wifi_bandwidth_t bandwidth;
+    int8_t power;
     switch(mode) {
         case TX_MODE_11B_1MBPS_19_5DBM:
             // Set TX mode to 802.11b, 20 MHz, 1 Mbps, @19.5 dBm
-            esp_wifi_set_protocol(ESP_IF_WIFI_STA, WIFI_PROTOCOL_11B);
-            esp_wifi_set_bandwidth(ESP_IF_WIFI_STA, WIFI_BW_HT20);
-            esp_wifi_set_max_tx_power(78); // Set power in units of 0.25 dBm (19.5 dBm * 4 = 78)
+            protocol = WIFI_PROTOCOL_11B;
+            bandwidth = WIFI_BW_HT20;
+            power = 78; // Set power in units of 0.25 dBm (19.5 dBm * 4 = 78)
             break;
         
         case TX_MODE_11G_54MBPS_18DBM:
             // Set TX mode to 802.11g, 20 MHz, 54 Mbps, @18 dBm
-            esp_wifi_set_protocol(ESP_IF_WIFI_STA, WIFI_PROTOCOL_11G);
-            esp_wifi_set_bandwidth(ESP_IF_WIFI_STA, WIFI_BW_HT20);
-            esp_wifi_set_max_tx_power(72); // 18 dBm * 4 = 72
+            protocol = WIFI_PROTOCOL_11G;
+            bandwidth = WIFI_BW_HT20;
+            power = 72; // 18 dBm * 4 = 72
             break;
 
         case TX_MODE_11N_150MBPS_17_5DBM:
             // Set TX mode to 802.11n, 40 MHz, 150 Mbps, @17.5 dBm
-            esp_wifi_set_protocol(ESP_IF_WIFI_STA, WIFI_PROTOCOL_11N);
-            esp_wifi_set_bandwidth(ESP_IF_WIFI_STA, WIFI_BW_HT40);
-            esp_wifi_set_max_tx_power(70); // 17.5 dBm * 4 = 70
+            protocol = WIFI_PROTOCOL_11N;
+            bandwidth = WIFI_BW_HT40;
+            power = 70; // 17.5 dBm * 4 = 70
             break;
 
         case TX_MODE_11N_40MHZ_16DBM:
             // Set TX mode to 802.11n, 40 MHz, 72 Mbps, @16 dBm
-            esp_wifi_set_protocol(ESP_IF_WIFI_STA, WIFI_PROTOCOL_11N);
-            esp_wifi_set_bandwidth(ESP_IF_WIFI_STA, WIFI_BW_HT40);
-            esp_wifi_set_max_tx_power(64); // 16 dBm * 4 = 64
+            protocol = WIFI_PROTOCOL_11N;
+            bandwidth = WIFI_BW_HT40;
+            power = 64; // 16 dBm * 4 = 64
             break;
 
         default:
             // Handle unsupported modes
-            break;
+            return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = esp_wifi_set_protocol(WIFI_IF_STA, protocol);
+    if (err == ESP_OK) {
+        err = esp_wifi_set_bandwidth(WIFI_IF_STA, bandwidth);
     }
+    if (err == ESP_OK) {
+        err = esp_wifi_set_max_tx_power(power);
+    }
+    return err;
 }
 /**
  * @brief Checks the current WiFi connection status.
@@ -165,47 +676,165 @@ void WiFi_SetTxMode(t_tx_mode mode) {
  * @return tsword 1 if connected to WiFi, 0 if not connected.
  */
 tsword WiFi_Check_Connection(void) {
-    wifi_ap_record_t ap_info; // Stores current access point info
+    // Kept by the event handler; no driver call
+    return WiFi_Get_Link_State() != wifi_link_down;
+}
 
-    // Check if connected to a Wi-Fi network
-    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        return 1; // Connected
-    } else {
-        return 0; // Not connected
+/**
+ * @brief Enables or disables fast connect.
+ *
+ * This function selects whether the following connections first try the cached AP, and
+ * whether they reuse the cached lease instead of running DHCP. It applies from the next
+ * WiFi_Connect() or disconnection.
+ *
+ * @param enable Try the cached AP before scanning.
+ * @param reuse_lease Also reuse the cached address.
+ */
+void WiFi_Set_Fast_Connect(bool enable, bool reuse_lease) {
+    portENTER_CRITICAL(&wifi_lock);
+    fast_enabled = enable;
+    fast_reuse_lease = reuse_lease;
+    portEXIT_CRITICAL(&wifi_lock);
+}
+
+/**
+ * @brief Erases the cached AP.
+ *
+ * This function removes the cached AP and lease from NVS and memory, so the next
+ * connection scans and runs DHCP.
+ */
+void WiFi_Forget_Fast_Connect(void) {
+    portENTER_CRITICAL(&wifi_lock);
+    ap_cache_valid = false;
+    portEXIT_CRITICAL(&wifi_lock);
+    NVS_NS_Erase_Key(NVS_NAMESPACE, WIFI_FAST_CONNECT_KEY);     // Not finding it is fine
+}
+
+/**
+ * @brief Copies the connection timing counters.
+ *
+ * @param stats Out: the counters.
+ */
+void WiFi_Get_Connect_Stats(t_wifi_connect_stats *stats) {
+    if (stats != NULL) {
+        portENTER_CRITICAL(&wifi_lock);
+        *stats = connect_stats;
+        portEXIT_CRITICAL(&wifi_lock);
+    }
+}
+
+/**
+ * @brief Replaces the reconnect policy.
+ *
+ * This function sets the backoff, jitter and give-up limits used for the following
+ * disconnections.
+ *
+ * @param policy The new policy.
+ */
+void WiFi_Set_Reconnect_Policy(const t_wifi_reconnect_policy *policy) {
+    if (policy != NULL) {
+        portENTER_CRITICAL(&wifi_lock);
+        reconnect_policy = *policy;
+        portEXIT_CRITICAL(&wifi_lock);
+    }
+}
+
+/**
+ * @brief Copies the reconnect state and counters.
+ *
+ * @param stats Out: the state and counters.
+ */
+void WiFi_Get_Reconnect_Stats(t_wifi_reconnect_stats *stats) {
+    if (stats != NULL) {
+        portENTER_CRITICAL(&wifi_lock);
+        *stats = reconnect_stats;
+        portEXIT_CRITICAL(&wifi_lock);
     }
 }
 
+/**
+ * @brief Returns how many disconnections had a given reason code.
+ *
+ * @param reason The wifi_err_reason_t code.
+ * @return tlong The count since WiFi_Init().
+ */
+tlong WiFi_Get_Disconnect_Count(tbyte reason) {
+    portENTER_CRITICAL(&wifi_lock);
+    tlong count = disconnect_counts[reason];
+    portEXIT_CRITICAL(&wifi_lock);
+    return count;
+}
+
 void WiFi_WPS_Enable(void) {
     esp_wps_config_t wps_config = WPS_CONFIG_INIT_DEFAULT(WPS_TYPE_PBC);
     esp_wifi_wps_enable(&wps_config);
     esp_wifi_wps_start(0);  
 }
 
+/**
+ * @brief Checks whether the internet is reachable.
+ *
+ * This function returns the state cached by the reachability probe and never waits on the
+ * network. The first call starts the probe with WIFI_PROBE_CONFIG_DEFAULT() if it is not
+ * running; until its first round completes the answer is 0.
+ *
+ * @return int 1 if the last probe round got an answer, 0 otherwise.
+ */
 int WiFi_Check_Internet(void) {
-    ip4_addr_t target_ip;
-    inet_aton("8.8.8.8", &target_ip); // Convert IP to struct
-
-    // Set the target IP for ping
-    if (esp_ping_set_target(PING_TARGET_IP_ADDRESS, &target_ip, sizeof(target_ip)) != ESP_OK) {
-        return 0; // Failed to set target
+    if (WiFi_Probe_Get_State() == wifi_probe_unknown) {
+        WiFi_Probe_Start(NULL);     // ESP_ERR_INVALID_STATE once running
     }
+    return WiFi_Probe_Get_State() == wifi_probe_reachable;
+}
 
-    uint32_t timeout_ms = 1000;
-    esp_ping_set_target(PING_TARGET_RCV_TIMEO, &timeout_ms, sizeof(timeout_ms));
-
-    // Set ping count to 1
-    uint32_t count = 1;
-    esp_ping_set_target(PING_TARGET_IP_ADDRESS_COUNT, &count, sizeof(count));
-
-    vTaskDelay(pdMS_TO_TICKS(1000)); // Wait for ping to execute
+/**
+ * @brief Returns the link state.
+ *
+ * This function reads the state the event handler keeps, with one atomic load.
+ *
+ * @return t_wifi_link_state The link state.
+ */
+t_wifi_link_state WiFi_Get_Link_State(void) {
+    return __atomic_load_n(&link_state, __ATOMIC_ACQUIRE);
+}
 
-    esp_ping_found result;
-    memset(&result, 0, sizeof(result));
+/**
+ * @brief Copies the link snapshot.
+ *
+ * This function copies the snapshot the event handler keeps without taking a lock: the copy
+ * is retried if an update was in progress or completed meanwhile.
+ *
+ * @param snapshot Out: the link state, AP, channel, RSSI, IP and time since the association.
+ */
+void WiFi_Get_Snapshot(t_wifi_snapshot *snapshot) {
+    tlong seq;
+    do {
+        seq = __atomic_load_n(&link_snapshot_seq, __ATOMIC_ACQUIRE);
+        *snapshot = *(volatile t_wifi_snapshot *)&link_snapshot;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) != 0 || __atomic_load_n(&link_snapshot_seq, __ATOMIC_RELAXED) != seq);
 
-    // Check ping results
-    if (esp_ping_result(PING_RES_OK, result.bytes, result.resp_time) == ESP_OK) {
-        return 1; // Internet is working
+    if (snapshot->state != wifi_link_down) {
+        snapshot->connected_us = esp_timer_get_time() - snapshot->connected_us;
     }
+}
 
-    return 0; // No internet connection
+/**
+ * @brief Waits until the link reaches a state.
+ *
+ * This function blocks on the event group bits kept by the event handler.
+ *
+ * @param state The state to wait for; wifi_link_associated is also reached by wifi_link_connected.
+ * @param ticks_to_wait Timeout, or portMAX_DELAY.
+ * @return esp_err_t ESP_OK, ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_STATE before WiFi_Init().
+ */
+esp_err_t WiFi_Wait_For_State(t_wifi_link_state state, TickType_t ticks_to_wait) {
+    if (wifi_event_group == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    EventBits_t bit = state == wifi_link_connected  ? WIFI_CONNECTED_BIT
+                    : state == wifi_link_associated ? WIFI_ASSOCIATED_BIT
+                                                    : WIFI_DOWN_BIT;
+    EventBits_t bits = xEventGroupWaitBits(wifi_event_group, bit, pdFALSE, pdTRUE, ticks_to_wait);
+    return (bits & bit) != 0 ? ESP_OK : ESP_ERR_TIMEOUT;
 }
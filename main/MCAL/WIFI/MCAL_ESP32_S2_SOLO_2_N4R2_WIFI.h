@@ -31,6 +31,125 @@ typedef enum {
     TX_MODE_11N_40MHZ_16DBM      ///< 802.11n, 40 MHz, 72 Mbps, @16 dBm
 } t_tx_mode;
 
+/*
+ * Fast connect: after every connection that gets an IP, the BSSID and channel of the AP and
+ * the DHCP lease with its expiry time are kept in NVS (key WIFI_FAST_CONNECT_KEY, only rewritten
+ * when they change or half of the lease has gone), tagged with the SSID and a CRC of the
+ * password. While fast connect is enabled, WiFi_Connect() and the reconnect after a
+ * disconnection first try a connection directed at that AP on that channel, and with
+ * reuse_lease and an unexpired lease they also put the cached address on the interface instead
+ * of waiting for DHCP. Once that address is up, the DHCP client is started to renew the lease.
+ * If the directed attempt fails, the cache is dropped and the station falls back to the normal
+ * scan and DHCP.
+ *
+ * Lease expiry is checked against time(), so reusing the lease needs a clock that keeps running
+ * across the sleep (the RTC through deep sleep, or SNTP); a clock that went back to before the
+ * lease was granted skips the reuse.
+ */
+#define WIFI_FAST_CONNECT_KEY "wifi_fast"
+
+/**
+ * @brief Connection timing counters, since WiFi_Init().
+ *
+ * Time to IP runs from WiFi_Connect() or from the disconnection to IP_EVENT_STA_GOT_IP.
+ */
+typedef struct {
+    tlong connects;             // Connections that reached an IP
+    tlong fast_connects;        // ... through the cached AP
+    tlong fallbacks;            // Directed attempts that failed and fell back to a scan
+    tlong last_time_to_ip_us;
+    tlong best_time_to_ip_us;
+    tlong worst_time_to_ip_us;
+    bool last_was_fast;
+} t_wifi_connect_stats;
+
+/*
+ * Reconnect policy: every disconnection the station did not ask for schedules the next
+ * attempt on a one-shot esp_timer instead of reconnecting from the event handler, by reason:
+ *   link lost (beacon timeout, AP deauth) - the first retry is immediate, then backoff
+ *   AP not found / association failed    - exponential backoff from initial_delay_ms, doubling
+ *                                          up to max_delay_ms, randomized by +-jitter_percent
+ *   authentication failed                - fixed auth_retry_delay_ms; gives up after
+ *                                          auth_max_attempts failures in a row (wrong password)
+ * A failed fast-connect attempt falls back to a scan at once. The station gives up after
+ * max_attempts retries without an IP (0: never); WiFi_Connect() or WiFi_Enable() starts over.
+ */
+#define WIFI_RECONNECT_POLICY_DEFAULT() {   \
+    .initial_delay_ms    = 1000,            \
+    .max_delay_ms        = 60000,           \
+    .jitter_percent      = 20,              \
+    .max_attempts        = 0,               \
+    .auth_retry_delay_ms = 30000,           \
+    .auth_max_attempts   = 3                \
+}
+
+typedef struct {
+    tlong initial_delay_ms;
+    tlong max_delay_ms;
+    tbyte jitter_percent;
+    tword max_attempts;             // Retries without an IP before giving up; 0 retries forever
+    tlong auth_retry_delay_ms;
+    tword auth_max_attempts;        // Authentication failures in a row before giving up
+} t_wifi_reconnect_policy;
+
+/**
+ * @brief Enumeration for the groups of disconnect reasons the policy tells apart.
+ */
+typedef enum {
+    wifi_reason_link_lost,          // Beacon timeout, deauthenticated/disassociated by the AP
+    wifi_reason_not_found,          // No AP found, association failed or refused
+    wifi_reason_auth,               // Handshake or authentication failed
+    wifi_reason_local,              // WiFi_Disable()
+    wifi_reason_other,
+    WIFI_REASON_CLASSES
+} t_wifi_reason_class;
+
+/**
+ * @brief Enumeration for the reconnect state.
+ */
+typedef enum {
+    wifi_reconnect_idle,            // Not started, or stopped by WiFi_Disable()
+    wifi_reconnect_connecting,      // An attempt is in progress
+    wifi_reconnect_waiting,         // The retry timer is running
+    wifi_reconnect_connected,       // Got an IP
+    wifi_reconnect_gave_up
+} t_wifi_reconnect_state;
+
+typedef struct {
+    t_wifi_reconnect_state state;
+    tlong attempts;                 // Retries since the last IP
+    tlong total_attempts;
+    tlong give_ups;
+    tlong next_delay_ms;            // Delay before the last retry scheduled
+    tlong disconnects[WIFI_REASON_CLASSES];
+} t_wifi_reconnect_stats;
+
+/*
+ * Link snapshot: the event handler keeps the link state, AP, channel, RSSI and IP in a
+ * sequence-counted snapshot, so readers neither call the driver nor take a lock. The RSSI is
+ * read from the driver at association and then every WIFI_RSSI_REFRESH_MS by a timer while
+ * associated. WiFi_Wait_For_State() blocks on the bits the handler keeps in the event group.
+ */
+#define WIFI_RSSI_REFRESH_MS    1000
+
+/**
+ * @brief Enumeration for the link state, in order: a state includes the ones below it.
+ */
+typedef enum {
+    wifi_link_down,                 // Not associated
+    wifi_link_associated,           // Associated, no IP yet
+    wifi_link_connected             // Associated with an IP
+} t_wifi_link_state;
+
+typedef struct {
+    t_wifi_link_state state;
+    tbyte bssid[6];
+    tbyte channel;
+    tsbyte rssi;                    // dBm, at the last refresh
+    tlong ip;                       // Network byte order, 0 without an IP
+    int64_t connected_us;           // Time since the association, 0 when down
+} t_wifi_snapshot;
+
 // Function prototypes
 
 /**
@@ -107,8 +226,10 @@ void WiFi_Disable(void);
  *   - Outdoor Range: 70 to 90 meters
  *
  * @param mode The desired WiFi TX mode configuration.
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_ARG for an unknown mode, or the error of the first
+ *         driver call (protocol, bandwidth, TX power) that failed.
  */
-void WiFi_SetTxMode(t_tx_mode mode);
+esp_err_t WiFi_SetTxMode(t_tx_mode mode);
 /**
  * @brief Checks the current WiFi connection status.
  *
@@ -119,8 +240,62 @@ void WiFi_SetTxMode(t_tx_mode mode);
  */
 tsword WiFi_Check_Connection(void);
 
+/**
+ * @brief Enables or disables fast connect for the following connections.
+ *
+ * @param enable Try the cached AP before scanning.
+ * @param reuse_lease Also reuse the cached address instead of running DHCP.
+ */
+void WiFi_Set_Fast_Connect(bool enable, bool reuse_lease);
+
+/**
+ * @brief Erases the cached AP and lease, so the next connection scans.
+ */
+void WiFi_Forget_Fast_Connect(void);
+
+/**
+ * @brief Copies the connection timing counters.
+ */
+void WiFi_Get_Connect_Stats(t_wifi_connect_stats *stats);
+
+/**
+ * @brief Replaces the reconnect policy. Applies from the next disconnection.
+ */
+void WiFi_Set_Reconnect_Policy(const t_wifi_reconnect_policy *policy);
+
+/**
+ * @brief Copies the reconnect state and counters.
+ */
+void WiFi_Get_Reconnect_Stats(t_wifi_reconnect_stats *stats);
+
+/**
+ * @brief Number of disconnections with a given reason code (wifi_err_reason_t) since WiFi_Init().
+ */
+tlong WiFi_Get_Disconnect_Count(tbyte reason);
+
 void WiFi_WPS_Enable(void);
 
 int WiFi_Check_Internet(void);
 
+/**
+ * @brief Returns the link state: one atomic load, no driver call.
+ */
+t_wifi_link_state WiFi_Get_Link_State(void);
+
+/**
+ * @brief Copies a consistent link snapshot without a lock or a driver call.
+ */
+void WiFi_Get_Snapshot(t_wifi_snapshot *snapshot);
+
+/**
+ * @brief Waits until the link reaches a state.
+ *
+ * wifi_link_associated is also reached by wifi_link_connected.
+ *
+ * @param state The state to wait for.
+ * @param ticks_to_wait Timeout, or portMAX_DELAY.
+ * @return ESP_OK, ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_STATE before WiFi_Init().
+ */
+esp_err_t WiFi_Wait_For_State(t_wifi_link_state state, TickType_t ticks_to_wait);
+
 #endif /* MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_H_ */
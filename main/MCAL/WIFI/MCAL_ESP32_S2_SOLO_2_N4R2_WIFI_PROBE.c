@@ -0,0 +1,289 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE.C
+ Description    : Asynchronous internet reachability probe (ICMP echo / TCP connect) with a cached state
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "lwip/inet.h"
+
+#define ICMP_ECHO_REQUEST       8
+#define ICMP_ECHO_REPLY         0
+#define ICMP_HEADER_SIZE        8
+#define ICMP_PAYLOAD_SIZE       24
+#define PROBE_ICMP_ID           0x5052      // "PR"
+#define PROBE_RX_BUFFER_SIZE    128         // IP header + echo reply
+#define PROBE_RTT_WEIGHT_SHIFT  3           // Moving average weight 1/8
+
+static t_wifi_probe_config probe_config;
+static struct sockaddr_in probe_addresses[WIFI_PROBE_MAX_TARGETS];
+static volatile t_wifi_probe_state probe_state;     // Read without the lock
+static t_wifi_probe_stats probe_stats;
+static TaskHandle_t probe_task_handle;
+static volatile bool probe_running;
+static volatile bool probe_exited = true;
+static tword probe_sequence;
+static tbyte probe_failed_rounds;
+static portMUX_TYPE probe_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static tword probe_checksum(const tbyte *data, size_t length) {
+    tlong sum = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        sum += (tword)((data[i] << 8) | data[i + 1]);
+    }
+    if (length & 1) {
+        sum += (tword)(data[length - 1] << 8);
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (tword)~sum;
+}
+
+// Waits until the socket is readable (or writable) or the deadline passes
+static bool probe_wait(int sock, bool for_write, int64_t deadline_us) {
+    int64_t left_us = deadline_us - esp_timer_get_time();
+    if (left_us <= 0) {
+        return false;
+    }
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(sock, &set);
+    struct timeval timeout = { .tv_sec = left_us / 1000000, .tv_usec = left_us % 1000000 };
+    return select(sock + 1, for_write ? NULL : &set, for_write ? &set : NULL, NULL, &timeout) > 0;
+}
+
+static bool probe_icmp(const struct sockaddr_in *address, int64_t deadline_us) {
+    int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    if (sock < 0) {
+        return false;
+    }
+    tbyte packet[ICMP_HEADER_SIZE + ICMP_PAYLOAD_SIZE] = { 0 };
+    tword sequence = ++probe_sequence;
+    packet[0] = ICMP_ECHO_REQUEST;
+    packet[4] = PROBE_ICMP_ID >> 8;
+    packet[5] = PROBE_ICMP_ID & 0xFF;
+    packet[6] = sequence >> 8;
+    packet[7] = sequence & 0xFF;
+    tword checksum = probe_checksum(packet, sizeof(packet));
+    packet[2] = checksum >> 8;
+    packet[3] = checksum & 0xFF;
+
+    bool answered = false;
+    if (sendto(sock, packet, sizeof(packet), 0, (const struct sockaddr *)address, sizeof(*address)) == sizeof(packet)) {
+        tbyte reply[PROBE_RX_BUFFER_SIZE];
+        // The socket sees every ICMP packet for the station: skip until our reply
+        while (!answered && probe_wait(sock, false, deadline_us)) {
+            struct sockaddr_in from;
+            socklen_t from_length = sizeof(from);
+            int length = recvfrom(sock, reply, sizeof(reply), 0, (struct sockaddr *)&from, &from_length);
+            if (length < 20 || from.sin_addr.s_addr != address->sin_addr.s_addr) {
+                continue;
+            }
+            int header_length = (reply[0] & 0x0F) * 4;
+            const tbyte *icmp = reply + header_length;
+            answered = length >= header_length + ICMP_HEADER_SIZE && icmp[0] == ICMP_ECHO_REPLY &&
+                       ((icmp[4] << 8) | icmp[5]) == PROBE_ICMP_ID && ((icmp[6] << 8) | icmp[7]) == sequence;
+        }
+    }
+    close(sock);
+    return answered;
+}
+
+static bool probe_tcp(const struct sockaddr_in *address, int64_t deadline_us) {
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return false;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    bool answered = false;
+    if (connect(sock, (const struct sockaddr *)address, sizeof(*address)) == 0) {
+        answered = true;
+    } else if (errno == EINPROGRESS && probe_wait(sock, true, deadline_us)) {
+        int error = 0;
+        socklen_t error_length = sizeof(error);
+        answered = getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &error_length) == 0 && error == 0;
+    }
+    close(sock);
+    return answered;
+}
+
+static void probe_record(bool answered, tbyte target, tlong rtt_us) {
+    portENTER_CRITICAL(&probe_lock);
+    if (answered) {
+        probe_stats.answered++;
+        probe_stats.last_target = target;
+        probe_stats.last_rtt_us = rtt_us;
+        if (probe_stats.answered == 1) {
+            probe_stats.min_rtt_us = rtt_us;
+            probe_stats.max_rtt_us = rtt_us;
+            probe_stats.avg_rtt_us = rtt_us;
+        } else {
+            probe_stats.min_rtt_us = rtt_us < probe_stats.min_rtt_us ? rtt_us : probe_stats.min_rtt_us;
+            probe_stats.max_rtt_us = rtt_us > probe_stats.max_rtt_us ? rtt_us : probe_stats.max_rtt_us;
+            probe_stats.avg_rtt_us = (tlong)((tslong)probe_stats.avg_rtt_us +
+                                             (((tslong)rtt_us - (tslong)probe_stats.avg_rtt_us) >> PROBE_RTT_WEIGHT_SHIFT));
+        }
+    } else {
+        probe_stats.lost++;
+    }
+    portEXIT_CRITICAL(&probe_lock);
+}
+
+static void probe_set_state(t_wifi_probe_state state) {
+    portENTER_CRITICAL(&probe_lock);
+    if (state != probe_state) {
+        probe_state = state;
+        probe_stats.state = state;
+        probe_stats.transitions++;
+    }
+    probe_stats.rounds++;
+    probe_stats.last_round_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&probe_lock);
+}
+
+static void probe_round(void) {
+    // Associated is not enough: without an IP there is nothing to probe from
+    if (WiFi_Get_Link_State() != wifi_link_connected) {
+        probe_failed_rounds = 0;
+        probe_set_state(wifi_probe_no_link);
+        return;
+    }
+
+    tbyte first = probe_stats.last_target;
+    for (tbyte i = 0; i < probe_config.target_count && probe_running; i++) {
+        tbyte target = (first + i) % probe_config.target_count;
+        int64_t start_us = esp_timer_get_time();
+        int64_t deadline_us = start_us + (int64_t)probe_config.timeout_ms * 1000;
+        bool answered = probe_config.targets[target].kind == wifi_probe_icmp
+                            ? probe_icmp(&probe_addresses[target], deadline_us)
+                            : probe_tcp(&probe_addresses[target], deadline_us);
+        probe_record(answered, target, (tlong)(esp_timer_get_time() - start_us));
+        if (answered) {
+            probe_failed_rounds = 0;
+            probe_set_state(wifi_probe_reachable);
+            return;
+        }
+    }
+
+    // Without an earlier answer there is nothing to hold on to
+    if (++probe_failed_rounds >= probe_config.fail_rounds || probe_state != wifi_probe_reachable) {
+        probe_set_state(wifi_probe_unreachable);
+    } else {
+        probe_set_state(wifi_probe_reachable);
+    }
+}
+
+static void probe_task(void *arg) {
+    (void)arg;
+    for (;;) {
+        // Nothing notifies the task once it has seen probe_running cleared
+        portENTER_CRITICAL(&probe_lock);
+        bool running = probe_running;
+        probe_exited = !running;
+        portEXIT_CRITICAL(&probe_lock);
+        if (!running) {
+            break;
+        }
+        probe_round();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(probe_config.period_ms));
+    }
+    vTaskDelete(NULL);
+}
+
+esp_err_t WiFi_Probe_Start(const t_wifi_probe_config *config) {
+    static const t_wifi_probe_config defaults = WIFI_PROBE_CONFIG_DEFAULT();
+    if (config == NULL) {
+        config = &defaults;
+    }
+    if (config->target_count == 0 || config->target_count > WIFI_PROBE_MAX_TARGETS || config->period_ms == 0 ||
+        config->timeout_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct sockaddr_in addresses[WIFI_PROBE_MAX_TARGETS];
+    memset(addresses, 0, sizeof(addresses));
+    for (tbyte i = 0; i < config->target_count; i++) {
+        const t_wifi_probe_target *target = &config->targets[i];
+        ip4_addr_t ip;
+        if (!inet_aton(target->address, &ip) || (target->kind == wifi_probe_tcp && target->port == 0)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        addresses[i].sin_family = AF_INET;
+        addresses[i].sin_port = htons(target->port);
+        addresses[i].sin_addr.s_addr = ip.addr;
+    }
+
+    portENTER_CRITICAL(&probe_lock);
+    if (probe_running || !probe_exited) {
+        portEXIT_CRITICAL(&probe_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    probe_running = true;
+    probe_exited = false;
+    probe_task_handle = NULL;
+    portEXIT_CRITICAL(&probe_lock);
+
+    probe_config = *config;
+    if (probe_config.fail_rounds == 0) {
+        probe_config.fail_rounds = 1;
+    }
+    memcpy(probe_addresses, addresses, sizeof(addresses));
+    memset(&probe_stats, 0, sizeof(probe_stats));
+    probe_state = wifi_probe_unknown;
+    probe_failed_rounds = 0;
+    TaskHandle_t task;
+    if (xTaskCreate(probe_task, "wifi_probe", WIFI_PROBE_TASK_STACK, NULL, WIFI_PROBE_TASK_PRIORITY, &task) != pdPASS) {
+        portENTER_CRITICAL(&probe_lock);
+        probe_running = false;
+        probe_exited = true;
+        portEXIT_CRITICAL(&probe_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    portENTER_CRITICAL(&probe_lock);
+    probe_task_handle = task;
+    portEXIT_CRITICAL(&probe_lock);
+    return ESP_OK;
+}
+
+void WiFi_Probe_Stop(void) {
+    portENTER_CRITICAL(&probe_lock);
+    bool running = probe_running;
+    probe_running = false;
+    if (running && probe_task_handle != NULL) {
+        xTaskNotifyGive(probe_task_handle);
+    }
+    portEXIT_CRITICAL(&probe_lock);
+    while (running && !probe_exited) {
+        vTaskDelay(1);
+    }
+}
+
+void WiFi_Probe_Trigger(void) {
+    portENTER_CRITICAL(&probe_lock);
+    if (probe_running && probe_task_handle != NULL) {
+        xTaskNotifyGive(probe_task_handle);
+    }
+    portEXIT_CRITICAL(&probe_lock);
+}
+
+t_wifi_probe_state WiFi_Probe_Get_State(void) {
+    return probe_state;
+}
+
+void WiFi_Probe_Get_Stats(t_wifi_probe_stats *stats) {
+    if (stats != NULL) {
+        portENTER_CRITICAL(&probe_lock);
+        *stats = probe_stats;
+        portEXIT_CRITICAL(&probe_lock);
+    }
+}
@@ -0,0 +1,117 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE.H
+ Description    : This file as Header for (WIFI Internet Reachability Probe)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_WIFI.h"
+#include "esp_err.h"
+
+/*
+ * The probe task checks internet access once per period_ms and caches the answer, so readers
+ * never wait on the network. A round tries the targets in order, starting with the one that
+ * answered last, and stops at the first answer:
+ *   ICMP  one echo request (raw socket), answered by the matching echo reply
+ *   TCP   a connect to address:port, answered by a completed handshake (a refusal is not an
+ *         answer: it may come from a firewall or a captive portal)
+ * Each probe waits at most timeout_ms. The state goes to reachable on the first answered round
+ * and to unreachable after fail_rounds rounds without an answer. While the station has no AP
+ * no probe is sent; the WiFi driver starts a round as soon as it gets an IP.
+ */
+#define WIFI_PROBE_MAX_TARGETS      4
+#define WIFI_PROBE_TASK_STACK       3072
+#define WIFI_PROBE_TASK_PRIORITY    5
+
+typedef enum {
+    wifi_probe_icmp,
+    wifi_probe_tcp
+} t_wifi_probe_kind;
+
+typedef struct {
+    t_wifi_probe_kind kind;
+    char address[16];       // Dotted IPv4 address
+    tword port;             // TCP only
+} t_wifi_probe_target;
+
+typedef struct {
+    t_wifi_probe_target targets[WIFI_PROBE_MAX_TARGETS];
+    tbyte target_count;
+    tlong period_ms;
+    tlong timeout_ms;       // Per probe
+    tbyte fail_rounds;      // Rounds without an answer before the state goes to unreachable
+} t_wifi_probe_config;
+
+#define WIFI_PROBE_CONFIG_DEFAULT() {                           \
+    .targets = {                                                \
+        { .kind = wifi_probe_icmp, .address = "8.8.8.8" },      \
+        { .kind = wifi_probe_tcp, .address = "1.1.1.1", .port = 53 }, \
+    },                                                          \
+    .target_count = 2,                                          \
+    .period_ms = 10000,                                         \
+    .timeout_ms = 1000,                                         \
+    .fail_rounds = 2,                                           \
+}
+
+/**
+ * @brief Enumeration for the cached reachability state.
+ */
+typedef enum {
+    wifi_probe_unknown,         // No round finished yet
+    wifi_probe_no_link,         // No IP on the station (not associated, or no lease yet)
+    wifi_probe_reachable,
+    wifi_probe_unreachable
+} t_wifi_probe_state;
+
+/**
+ * @brief Probe counters, since WiFi_Probe_Start(). RTTs are of answered probes.
+ */
+typedef struct {
+    t_wifi_probe_state state;
+    tlong rounds;
+    tlong answered;             // Probes answered
+    tlong lost;                 // Probes not answered
+    tlong transitions;          // State changes
+    tbyte last_target;          // Index of the target that answered last
+    tlong last_rtt_us;
+    tlong min_rtt_us;
+    tlong max_rtt_us;
+    tlong avg_rtt_us;           // Moving average, weight 1/8
+    int64_t last_round_us;      // esp_timer time of the last round
+} t_wifi_probe_stats;
+
+/**
+ * @brief Starts the probe task. The first round runs at once.
+ *
+ * @param config Probe configuration, or NULL for WIFI_PROBE_CONFIG_DEFAULT().
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (no targets, too many, a bad address or a zero
+ *         period/timeout), ESP_ERR_INVALID_STATE if already started, or ESP_ERR_NO_MEM.
+ */
+esp_err_t WiFi_Probe_Start(const t_wifi_probe_config *config);
+
+/**
+ * @brief Stops the probe task. Waits for a probe in flight, at most timeout_ms.
+ */
+void WiFi_Probe_Stop(void);
+
+/**
+ * @brief Asks the probe task for a round now instead of at the end of the period.
+ */
+void WiFi_Probe_Trigger(void);
+
+/**
+ * @brief Returns the cached reachability state, without locking.
+ */
+t_wifi_probe_state WiFi_Probe_Get_State(void);
+
+/**
+ * @brief Copies the state and counters.
+ */
+void WiFi_Probe_Get_Stats(t_wifi_probe_stats *stats);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_PROBE_H_ */
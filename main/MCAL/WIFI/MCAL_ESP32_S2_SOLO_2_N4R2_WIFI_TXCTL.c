@@ -0,0 +1,323 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL.C
+ Description    : Closed-loop WiFi TX mode / power controller driven by RSSI, retry rate and throughput
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#define TXCTL_NO_RATE           0xFFFF      // Retry rate of a sample with too few frames
+#define TXCTL_USABLE_PERCENT    50          // Share of the PHY rate a level can carry as payload
+
+static const char *TAG = "wifi_txctl";
+static const char *const cause_names[] = { "start", "retries", "weak signal", "link lost", "good link" };
+
+static t_wifi_txctl_config txctl_config;
+static t_wifi_txctl_status txctl_status;
+static esp_timer_handle_t txctl_timer;
+static tlong report_bytes;                  // Reported since the last sample, atomically
+static tlong report_frames;
+static tlong report_retries;
+static tbyte degraded_samples;              // In a row
+static tbyte good_samples;                  // In a row
+static tbyte down_needed;                   // Good samples needed for the next step down
+static bool down_on_trial;                  // The last step down has not yet lasted down_needed samples
+static tlong last_down_sample;
+static int64_t grace_until_us;              // Link loss is ignored until then, after a mode change
+static bool mode_unknown;                   // An apply failed partway: set the mode on the next one
+static t_wifi_txctl_decision txctl_log[WIFI_TXCTL_LOG_DEPTH];
+static tlong txctl_log_count;
+static portMUX_TYPE txctl_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Payload rate a TX mode can carry, from its PHY rate
+static tlong txctl_usable_bps(t_tx_mode mode) {
+    tlong phy_bps;
+    switch (mode) {
+        case TX_MODE_11B_1MBPS_19_5DBM:     phy_bps = 1000000;      break;
+        case TX_MODE_11G_54MBPS_18DBM:      phy_bps = 54000000;     break;
+        case TX_MODE_11N_150MBPS_17_5DBM:   phy_bps = 150000000;    break;
+        default:                            phy_bps = 72000000;     break;
+    }
+    return phy_bps / 100 * TXCTL_USABLE_PERCENT;
+}
+
+// Moves to a level and logs the decision. Called with txctl_lock held; the caller applies it.
+static void txctl_move_locked(tbyte level, t_wifi_txctl_cause cause) {
+    t_wifi_txctl_decision *decision = &txctl_log[txctl_log_count++ % WIFI_TXCTL_LOG_DEPTH];
+    int64_t now_us = esp_timer_get_time();
+    decision->time_us = now_us;
+    decision->from_level = txctl_status.level;
+    decision->to_level = level;
+    decision->cause = cause;
+    decision->rssi = txctl_status.rssi;
+    decision->retry_permille = txctl_status.retry_permille;
+    decision->throughput_bps = txctl_status.throughput_bps;
+    decision->result = ESP_OK;
+
+    // The driver may reassociate on a mode change: that link loss is not the radio's doing
+    if (txctl_config.levels[level].mode != txctl_status.mode) {
+        grace_until_us = now_us + (int64_t)txctl_config.mode_grace_ms * 1000;
+    }
+    if (level > txctl_status.level) {
+        txctl_status.steps_up++;
+    } else if (level < txctl_status.level) {
+        txctl_status.steps_down++;
+    }
+    txctl_status.level = level;
+    txctl_status.mode = txctl_config.levels[level].mode;
+    txctl_status.power = txctl_config.levels[level].power;
+}
+
+static esp_err_t txctl_apply(const t_wifi_txctl_decision *decision, bool mode_changed) {
+    const t_wifi_tx_level *level = &txctl_config.levels[decision->to_level];
+    esp_err_t err = ESP_OK;
+    if (mode_changed) {
+        err = WiFi_SetTxMode(level->mode);
+    }
+    if (err == ESP_OK) {
+        err = esp_wifi_set_max_tx_power((int8_t)level->power);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "level %u -> %u (%s) not applied: %s", decision->from_level, decision->to_level,
+                 cause_names[decision->cause], esp_err_to_name(err));
+    } else if (decision->retry_permille == TXCTL_NO_RATE) {
+        ESP_LOGI(TAG, "level %u -> %u (%s): %d dBm, %lu bps, %u.%02u dBm", decision->from_level, decision->to_level,
+                 cause_names[decision->cause], decision->rssi, (unsigned long)decision->throughput_bps,
+                 level->power / 4, (level->power % 4) * 25);
+    } else {
+        ESP_LOGI(TAG, "level %u -> %u (%s): %d dBm, %u.%u%% retries, %lu bps, %u.%02u dBm", decision->from_level,
+                 decision->to_level, cause_names[decision->cause], decision->rssi, decision->retry_permille / 10,
+                 decision->retry_permille % 10, (unsigned long)decision->throughput_bps, level->power / 4,
+                 (level->power % 4) * 25);
+    }
+    return err;
+}
+
+// Applies the decision at log index 'index' and, if the driver refused it, goes back to the level it left
+static esp_err_t txctl_apply_logged(tlong index, t_tx_mode mode) {
+    portENTER_CRITICAL(&txctl_lock);
+    t_wifi_txctl_decision decision = txctl_log[index % WIFI_TXCTL_LOG_DEPTH];
+    bool mode_changed = mode_unknown || txctl_config.levels[decision.to_level].mode != mode;
+    portEXIT_CRITICAL(&txctl_lock);
+
+    esp_err_t err = txctl_apply(&decision, mode_changed);
+
+    portENTER_CRITICAL(&txctl_lock);
+    if (txctl_log_count - index <= WIFI_TXCTL_LOG_DEPTH) {
+        txctl_log[index % WIFI_TXCTL_LOG_DEPTH].result = err;
+    }
+    if (err != ESP_OK) {
+        txctl_status.apply_failures++;
+        mode_unknown = mode_unknown || mode_changed;
+        // A later decision owns the state if one was made meanwhile
+        if (txctl_log_count == index + 1) {
+            const t_wifi_tx_level *from = &txctl_config.levels[decision.from_level];
+            txctl_status.level = decision.from_level;
+            txctl_status.mode = from->mode;
+            txctl_status.power = from->power;
+        }
+    } else if (mode_changed) {
+        mode_unknown = false;
+    }
+    portEXIT_CRITICAL(&txctl_lock);
+    return err;
+}
+
+// Decides on one sample. Called with txctl_lock held; returns whether the level changed.
+static bool txctl_decide_locked(bool linked) {
+    tbyte top = txctl_config.level_count - 1;
+    tbyte level = txctl_status.level;
+
+    if (!linked) {
+        degraded_samples = 0;
+        good_samples = 0;
+        if (esp_timer_get_time() < grace_until_us) {
+            return false;
+        }
+        if (level < txctl_config.start_level) {
+            down_on_trial = false;
+            txctl_move_locked(txctl_config.start_level, wifi_txctl_link_lost);
+            return true;
+        }
+        return false;
+    }
+
+    bool retrying = txctl_status.retry_permille != TXCTL_NO_RATE &&
+                    txctl_status.retry_permille >= txctl_config.retry_high_permille;
+    bool weak = txctl_status.rssi < txctl_config.rssi_floor_dbm;
+    if (retrying || weak) {
+        good_samples = 0;
+        if (++degraded_samples >= txctl_config.up_samples && level < top) {
+            degraded_samples = 0;
+            if (down_on_trial) {
+                // The last step down did not hold: ask for longer proof before the next one
+                down_on_trial = false;
+                down_needed = down_needed * 2 < WIFI_TXCTL_MAX_DOWN_SAMPLES ? down_needed * 2 : WIFI_TXCTL_MAX_DOWN_SAMPLES;
+            }
+            txctl_move_locked(level + 1, retrying ? wifi_txctl_retries : wifi_txctl_weak_signal);
+            return true;
+        }
+        return false;
+    }
+
+    degraded_samples = 0;
+    if (down_on_trial && txctl_status.samples - last_down_sample >= down_needed) {
+        down_on_trial = false;
+        down_needed = down_needed / 2 > txctl_config.down_samples ? down_needed / 2 : txctl_config.down_samples;
+    }
+    // A level too slow for the target cannot prove the link with throughput
+    bool fast_enough = txctl_status.throughput_bps >= txctl_config.target_bps ||
+                       txctl_usable_bps(txctl_status.mode) < txctl_config.target_bps;
+    bool good = txctl_status.retry_permille != TXCTL_NO_RATE &&
+                txctl_status.retry_permille <= txctl_config.retry_low_permille &&
+                txctl_status.rssi >= txctl_config.rssi_floor_dbm + txctl_config.rssi_margin_db && fast_enough;
+    if (!good) {
+        good_samples = 0;
+        return false;
+    }
+    if (++good_samples >= down_needed && level > 0) {
+        good_samples = 0;
+        down_on_trial = true;
+        last_down_sample = txctl_status.samples;
+        txctl_move_locked(level - 1, wifi_txctl_good_link);
+        return true;
+    }
+    return false;
+}
+
+static void txctl_timer_cb(void *arg) {
+    (void)arg;
+    tlong bytes = __atomic_exchange_n(&report_bytes, 0, __ATOMIC_RELAXED);
+    tlong frames = __atomic_exchange_n(&report_frames, 0, __ATOMIC_RELAXED);
+    tlong retries = __atomic_exchange_n(&report_retries, 0, __ATOMIC_RELAXED);
+    wifi_ap_record_t ap_info;
+    bool linked = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK;
+
+    portENTER_CRITICAL(&txctl_lock);
+    if (!txctl_status.running) {
+        portEXIT_CRITICAL(&txctl_lock);
+        return;
+    }
+    t_tx_mode mode = txctl_status.mode;
+    txctl_status.samples++;
+    txctl_status.power_samples += txctl_status.power;
+    txctl_status.rssi = linked ? ap_info.rssi : 0;
+    txctl_status.throughput_bps = (tlong)(((uint64_t)bytes * 8 * 1000) / txctl_config.period_ms);
+    if (frames == 0 || frames < txctl_config.min_frames) {
+        txctl_status.retry_permille = TXCTL_NO_RATE;
+    } else {
+        uint64_t permille = ((uint64_t)retries * 1000) / frames;
+        txctl_status.retry_permille = (tword)(permille < 1000 ? permille : 1000);
+    }
+    bool changed = txctl_decide_locked(linked);
+    tlong index = txctl_log_count - 1;
+    portEXIT_CRITICAL(&txctl_lock);
+
+    if (changed) {
+        txctl_apply_logged(index, mode);
+    }
+}
+
+esp_err_t WiFi_TxCtl_Start(const t_wifi_txctl_config *config) {
+    static const t_wifi_txctl_config defaults = WIFI_TXCTL_CONFIG_DEFAULT();
+    if (config == NULL) {
+        config = &defaults;
+    }
+    if (config->level_count == 0 || config->level_count > WIFI_TXCTL_MAX_LEVELS || config->period_ms == 0 ||
+        config->up_samples == 0 || config->down_samples == 0 || config->start_level >= config->level_count ||
+        config->retry_low_permille > config->retry_high_permille) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (txctl_timer != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = txctl_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_txctl",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&timer_args, &txctl_timer) != ESP_OK) {
+        txctl_timer = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&txctl_lock);
+    txctl_config = *config;
+    memset(&txctl_status, 0, sizeof(txctl_status));
+    txctl_log_count = 0;
+    degraded_samples = 0;
+    good_samples = 0;
+    down_needed = config->down_samples;
+    down_on_trial = false;
+    mode_unknown = true;
+    grace_until_us = 0;
+    txctl_status.level = config->start_level;
+    txctl_move_locked(config->start_level, wifi_txctl_start);
+    portEXIT_CRITICAL(&txctl_lock);
+
+    __atomic_store_n(&report_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&report_frames, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&report_retries, 0, __ATOMIC_RELAXED);
+    esp_err_t err = txctl_apply_logged(0, txctl_status.mode);
+    if (err != ESP_OK) {
+        esp_timer_delete(txctl_timer);
+        txctl_timer = NULL;
+        return err;
+    }
+    portENTER_CRITICAL(&txctl_lock);
+    txctl_status.running = true;
+    portEXIT_CRITICAL(&txctl_lock);
+    esp_timer_start_periodic(txctl_timer, (uint64_t)config->period_ms * 1000);
+    return ESP_OK;
+}
+
+void WiFi_TxCtl_Stop(void) {
+    if (txctl_timer == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&txctl_lock);
+    txctl_status.running = false;
+    portEXIT_CRITICAL(&txctl_lock);
+    esp_timer_stop(txctl_timer);
+    esp_timer_delete(txctl_timer);
+    txctl_timer = NULL;
+}
+
+void WiFi_TxCtl_Report(tlong bytes, tlong frames, tlong retries) {
+    __atomic_fetch_add(&report_bytes, bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&report_frames, frames, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&report_retries, retries, __ATOMIC_RELAXED);
+}
+
+void WiFi_TxCtl_Get_Status(t_wifi_txctl_status *status) {
+    if (status != NULL) {
+        portENTER_CRITICAL(&txctl_lock);
+        *status = txctl_status;
+        portEXIT_CRITICAL(&txctl_lock);
+    }
+}
+
+tword WiFi_TxCtl_Get_Log(t_wifi_txctl_decision *decisions, tword max) {
+    if (decisions == NULL) {
+        return 0;
+    }
+    portENTER_CRITICAL(&txctl_lock);
+    tlong count = txctl_log_count < WIFI_TXCTL_LOG_DEPTH ? txctl_log_count : WIFI_TXCTL_LOG_DEPTH;
+    count = count < max ? count : max;
+    for (tlong i = 0; i < count; i++) {
+        decisions[i] = txctl_log[(txctl_log_count - count + i) % WIFI_TXCTL_LOG_DEPTH];
+    }
+    portEXIT_CRITICAL(&txctl_lock);
+    return (tword)count;
+}
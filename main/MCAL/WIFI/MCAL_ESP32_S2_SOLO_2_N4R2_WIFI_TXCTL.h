@@ -0,0 +1,171 @@
+/******************************************************************************************************************************
+ File Name      : MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL.H
+ Description    : This file as Header for (WIFI Adaptive TX Mode / Power Controller)
+ Author         : agent
+ Tester         :
+ Device(s)      : ESP32_S2_SOLO_2_N4R2
+ Creation Date  : 17/10/2026
+ Testing Date   :
+*********************************************************************************************************************************/
+#ifndef MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL_H_
+#define MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL_H_
+
+#include "MCAL_ESP32_S2_SOLO_2_N4R2_WIFI.h"
+#include "esp_err.h"
+
+/*
+ * The controller walks a ladder of TX levels, each a t_tx_mode preset with a TX power, ordered
+ * from the cheapest level (lowest power) to the most robust one. It starts at start_level. Every
+ * period_ms it samples the RSSI of the AP, and the frames, retries and bytes the application
+ * reported since the last sample with WiFi_TxCtl_Report(), then:
+ *   steps up one level after up_samples degraded samples in a row: retry rate at or above
+ *   retry_high_permille, or RSSI below rssi_floor_dbm;
+ *   steps down one level after down_samples good samples in a row: the target throughput was
+ *   reached (not required on a level whose mode cannot carry it, e.g. 11B at 1 Mbps), the
+ *   retry rate is at or below retry_low_permille and the RSSI is at least rssi_floor_dbm +
+ *   rssi_margin_db. A step down that is undone within down_samples samples doubles the good
+ *   samples needed for the next one (up to WIFI_TXCTL_MAX_DOWN_SAMPLES);
+ *   goes back up to start_level when the link is lost, unless the loss comes within
+ *   mode_grace_ms of a mode change.
+ * Samples with fewer than min_frames frames carry no retry rate and never step down.
+ *
+ * Only the power changes between levels with the same t_tx_mode; a mode change (11N -> 11G ->
+ * 11B) may cost the driver a reassociation, hence the grace period. Each decision is logged
+ * (ESP_LOGI, tag "wifi_txctl"; ESP_LOGW if the driver refused it, in which case the controller
+ * stays at the level it was at) and kept in a ring of the last WIFI_TXCTL_LOG_DEPTH decisions.
+ */
+#define WIFI_TXCTL_MAX_LEVELS           8
+#define WIFI_TXCTL_LOG_DEPTH            32
+#define WIFI_TXCTL_MAX_DOWN_SAMPLES     64
+
+/**
+ * @brief One rung of the ladder. power is in 0.25 dBm units, at most the preset's own power.
+ */
+typedef struct {
+    t_tx_mode mode;
+    tbyte power;
+} t_wifi_tx_level;
+
+typedef struct {
+    t_wifi_tx_level levels[WIFI_TXCTL_MAX_LEVELS];  // Cheapest first
+    tbyte level_count;
+    tlong period_ms;
+    tlong target_bps;               // Throughput the application needs; 0: any
+    tword retry_high_permille;
+    tword retry_low_permille;
+    tsbyte rssi_floor_dbm;
+    tbyte rssi_margin_db;
+    tbyte up_samples;
+    tbyte down_samples;
+    tlong min_frames;               // Frames a sample needs to carry a retry rate
+    tbyte start_level;              // Level to start at, and to go back up to on a link loss
+    tlong mode_grace_ms;            // Link loss ignored this long after a mode change
+} t_wifi_txctl_config;
+
+#define WIFI_TXCTL_CONFIG_DEFAULT() {                           \
+    .levels = {                                                 \
+        { TX_MODE_11N_40MHZ_16DBM, 34 },                        \
+        { TX_MODE_11N_40MHZ_16DBM, 44 },                        \
+        { TX_MODE_11N_40MHZ_16DBM, 54 },                        \
+        { TX_MODE_11N_40MHZ_16DBM, 64 },                        \
+        { TX_MODE_11N_150MBPS_17_5DBM, 70 },                    \
+        { TX_MODE_11G_54MBPS_18DBM, 72 },                       \
+        { TX_MODE_11B_1MBPS_19_5DBM, 78 },                      \
+    },                                                          \
+    .level_count = 7,                                           \
+    .period_ms = 1000,                                          \
+    .target_bps = 0,                                            \
+    .retry_high_permille = 150,                                 \
+    .retry_low_permille = 50,                                   \
+    .rssi_floor_dbm = -75,                                      \
+    .rssi_margin_db = 6,                                        \
+    .up_samples = 1,                                            \
+    .down_samples = 5,                                          \
+    .min_frames = 20,                                           \
+    .start_level = 4,                                           \
+    .mode_grace_ms = 3000,                                      \
+}
+
+/**
+ * @brief Enumeration for the cause of a decision.
+ */
+typedef enum {
+    wifi_txctl_start,
+    wifi_txctl_retries,             // Up: retry rate
+    wifi_txctl_weak_signal,         // Up: RSSI below the floor
+    wifi_txctl_link_lost,           // Up to start_level
+    wifi_txctl_good_link            // Down
+} t_wifi_txctl_cause;
+
+/**
+ * @brief One decision and the sample behind it.
+ */
+typedef struct {
+    int64_t time_us;                // esp_timer time
+    tbyte from_level;
+    tbyte to_level;
+    t_wifi_txctl_cause cause;
+    tsbyte rssi;
+    tword retry_permille;           // 0xFFFF: too few frames
+    tlong throughput_bps;
+    esp_err_t result;               // Of applying it to the driver
+} t_wifi_txctl_decision;
+
+/**
+ * @brief Controller state and counters, since WiFi_TxCtl_Start().
+ */
+typedef struct {
+    bool running;
+    tbyte level;
+    t_tx_mode mode;
+    tbyte power;                    // 0.25 dBm units
+    tsbyte rssi;                    // Last sample
+    tword retry_permille;
+    tlong throughput_bps;
+    tlong samples;
+    tlong steps_up;
+    tlong steps_down;
+    tlong power_samples;            // Sum of the power of every sample, for the average
+    tlong apply_failures;           // Decisions the driver refused
+} t_wifi_txctl_status;
+
+/**
+ * @brief Starts the controller at start_level.
+ *
+ * @param config Controller configuration, or NULL for WIFI_TXCTL_CONFIG_DEFAULT().
+ * @return ESP_OK, ESP_ERR_INVALID_ARG (no levels, too many, a zero period or up/down samples,
+ *         start_level outside the ladder, or retry_low_permille above retry_high_permille),
+ *         ESP_ERR_INVALID_STATE if already started, ESP_ERR_NO_MEM, or the driver's error if
+ *         the start level could not be applied (the controller is then not started).
+ */
+esp_err_t WiFi_TxCtl_Start(const t_wifi_txctl_config *config);
+
+/**
+ * @brief Stops the controller. The TX mode and power stay at the current level.
+ */
+void WiFi_TxCtl_Stop(void);
+
+/**
+ * @brief Reports traffic to the controller. Lock-free; call it from the send path.
+ *
+ * @param bytes Payload bytes delivered.
+ * @param frames Frames sent.
+ * @param retries Frames that had to be sent again (retransmissions, failed sends).
+ */
+void WiFi_TxCtl_Report(tlong bytes, tlong frames, tlong retries);
+
+/**
+ * @brief Copies the controller state and counters.
+ */
+void WiFi_TxCtl_Get_Status(t_wifi_txctl_status *status);
+
+/**
+ * @brief Copies the logged decisions, oldest first.
+ *
+ * @param decisions Destination.
+ * @param max Capacity of decisions.
+ * @return tword Decisions copied, at most WIFI_TXCTL_LOG_DEPTH.
+ */
+tword WiFi_TxCtl_Get_Log(t_wifi_txctl_decision *decisions, tword max);
+
+#endif /* MCAL_ESP32_S2_SOLO_2_N4R2_WIFI_TXCTL_H_ */